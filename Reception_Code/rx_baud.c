@@ -0,0 +1,291 @@
+/**
+ * @file rx_baud.c
+ * @brief Velocidad que genera el firmware y verificacion de la tabla de divisores del UART2.
+ *
+ * Las CCLK posibles salen de las mismas formulas de system_LPC17xx.c: F_cco = 2 * M * F_in / N, con F_in el
+ * oscilador principal (12 MHz) o el IRC (4 MHz), 6 <= M <= 512, 1 <= N <= 32 y 275 MHz <= F_cco <= 550 MHz, y
+ * CCLK = F_cco / (CCLKCFG + 1) con 2 <= CCLKCFG <= 255 y CCLK <= 120 MHz; sin PLL0, CCLK = F_in / (CCLKCFG + 1).
+ * Se toman las combinaciones que dan una frecuencia entera, que son las que se pueden escribir sin redondeo en
+ * SystemCoreClock.
+ */
+
+#include "rx_baud.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "uart_baud.h"
+
+// Definiciones del modulo:
+#define RX_BAUD_XTAL       12000000UL  /**< Oscilador principal de la placa (XTAL en system_LPC17xx.c) */
+#define RX_BAUD_IRC        4000000UL   /**< Oscilador RC interno */
+#define RX_BAUD_FCCO_MIN   275000000UL /**< F_cco minima de PLL0 */
+#define RX_BAUD_FCCO_MAX   550000000UL /**< F_cco maxima de PLL0 */
+#define RX_BAUD_CCLK_MAX   120000000UL /**< CCLK maxima del LPC1769 */
+#define RX_BAUD_MAX_CLOCKS (64 * 1024) /**< Capacidad de la lista de CCLK */
+#define RX_BAUD_MAX_REPORT 10          /**< Fallas que se muestran en detalle */
+
+static const uint32_t Rates[] = {1200,  2400,  4800,   9600,   14400,  19200,
+                                 38400, 57600, 115200, 230400, 460800, 921600};
+static const uint8_t Pclk_Divs[] = {1, 2, 4, 8};
+
+/**
+ * @brief Compara dos frecuencias para qsort().
+ */
+static int RX_BAUD_Compare(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Agrega una CCLK a la lista si hay lugar.
+ */
+static void RX_BAUD_Add(uint32_t* clocks, size_t* count, uint64_t cclk)
+{
+    if (*count < RX_BAUD_MAX_CLOCKS)
+    {
+        clocks[(*count)++] = (uint32_t)cclk;
+    }
+}
+
+/**
+ * @brief Arma la lista ordenada y sin repeticiones de las CCLK posibles.
+ *
+ * @param clocks Donde se deja la lista (RX_BAUD_MAX_CLOCKS elementos).
+ * @return Cantidad de CCLK.
+ */
+static size_t RX_BAUD_Clocks(uint32_t* clocks)
+{
+    static const uint64_t Sources[] = {RX_BAUD_XTAL, RX_BAUD_IRC};
+    size_t count = 0;
+    size_t unique = 0;
+    uint64_t fcco;
+
+    for (size_t s = 0; s < sizeof(Sources) / sizeof(Sources[0]); s++)
+    {
+        // Sin PLL0:
+        for (uint32_t div = 1; div <= 256; div++)
+        {
+            if (Sources[s] % div == 0)
+            {
+                RX_BAUD_Add(clocks, &count, Sources[s] / div);
+            }
+        }
+
+        // Con PLL0:
+        for (uint32_t n = 1; n <= 32; n++)
+        {
+            for (uint32_t m = 6; m <= 512; m++)
+            {
+                if ((2 * m * Sources[s]) % n != 0)
+                {
+                    continue;
+                }
+                fcco = 2 * m * Sources[s] / n;
+                if (fcco < RX_BAUD_FCCO_MIN || fcco > RX_BAUD_FCCO_MAX)
+                {
+                    continue;
+                }
+                for (uint32_t div = 3; div <= 256; div++)
+                {
+                    if (fcco % div == 0 && fcco / div <= RX_BAUD_CCLK_MAX)
+                    {
+                        RX_BAUD_Add(clocks, &count, fcco / div);
+                    }
+                }
+            }
+        }
+    }
+
+    qsort(clocks, count, sizeof(clocks[0]), RX_BAUD_Compare);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (unique == 0 || clocks[unique - 1] != clocks[i])
+        {
+            clocks[unique++] = clocks[i];
+        }
+    }
+
+    return unique;
+}
+
+/**
+ * @brief Error de una combinacion de divisores, en ppm (punto flotante).
+ */
+static double RX_BAUD_ErrorPpm(uint32_t pclk, uint32_t baud, double divisor, uint32_t mul, uint32_t add)
+{
+    return ((double)pclk * mul / (16.0 * divisor * (mul + add)) / baud - 1.0) * 1e6;
+}
+
+/**
+ * @brief Menor error posible a una PCLK, en valor absoluto y en ppm, por busqueda exhaustiva.
+ *
+ * Para cada fraccion el error crece al alejarse del DLM:DLL ideal, de modo que alcanza con probar los dos enteros
+ * que lo rodean.
+ */
+static double RX_BAUD_Best(uint32_t pclk, uint32_t baud)
+{
+    double best = INFINITY;
+    double ideal;
+    double candidates[2];
+    double min_divisor;
+
+    for (uint32_t mul = 1; mul <= UART_BAUD_MAX_MUL; mul++)
+    {
+        for (uint32_t add = 0; add < mul; add++)
+        {
+            min_divisor = (add > 0) ? UART_BAUD_MIN_FRACTION : 1;
+            ideal = (double)pclk * mul / (16.0 * baud * (mul + add));
+            candidates[0] = floor(ideal);
+            candidates[1] = ceil(ideal);
+
+            for (int c = 0; c < 2; c++)
+            {
+                double divisor = fmin(fmax(candidates[c], min_divisor), UART_BAUD_MAX_DIVISOR);
+                best = fmin(best, fabs(RX_BAUD_ErrorPpm(pclk, baud, divisor, mul, add)));
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Verifica una configuracion elegida por UART_BAUD_Search() a partir de UART_BAUD_DEFAULT_DIV.
+ *
+ * La configuracion tiene que usar la PCLK por defecto con su error minimo si este es aceptable, y si no, el
+ * menor error de los cuatro divisores de PCLK.
+ *
+ * @return NULL si es correcta, o la descripcion de la falla.
+ */
+static const char* RX_BAUD_Verify(uint32_t cclk, uint32_t baud, Status status, const UART_BAUD_Config_Type* config)
+{
+    double error;
+    double exact;
+    double best = RX_BAUD_Best(cclk / UART_BAUD_DEFAULT_DIV, baud);
+    uint8_t expected_div = UART_BAUD_DEFAULT_DIV;
+
+    if (config->Pclk_Div != 1 && config->Pclk_Div != 2 && config->Pclk_Div != 4 && config->Pclk_Div != 8)
+    {
+        return "divisor de PCLK invalido";
+    }
+    if (config->Pclk != cclk / config->Pclk_Div)
+    {
+        return "PCLK inconsistente";
+    }
+    if (config->Mul < 1 || config->Mul > UART_BAUD_MAX_MUL || config->Div_Add >= config->Mul)
+    {
+        return "FDR invalido";
+    }
+    if (config->Divisor < ((config->Div_Add > 0) ? UART_BAUD_MIN_FRACTION : 1))
+    {
+        return "DLM:DLL invalido";
+    }
+
+    error = RX_BAUD_ErrorPpm(config->Pclk, baud, config->Divisor, config->Mul, config->Div_Add);
+    exact = (double)config->Pclk * config->Mul / (16.0 * config->Divisor * (config->Mul + config->Div_Add));
+    if (fabs(error - config->Error_Ppm) > 1.0 || fabs(exact - config->Actual) > 1.0)
+    {
+        return "error o velocidad informados incorrectos";
+    }
+    if (best > UART_BAUD_MAX_ERROR_PPM)
+    {
+        for (size_t d = 0; d < sizeof(Pclk_Divs); d++)
+        {
+            best = fmin(best, RX_BAUD_Best(cclk / Pclk_Divs[d], baud));
+        }
+        expected_div = 0;
+    }
+    if (expected_div != 0 && config->Pclk_Div != expected_div)
+    {
+        return "cambia la PCLK sin necesidad";
+    }
+    if (fabs(error) > best + 1.0)
+    {
+        return "no es el error minimo";
+    }
+    if ((status == SUCCESS) != (abs(config->Error_Ppm) <= UART_BAUD_MAX_ERROR_PPM))
+    {
+        return "resultado inconsistente con el error";
+    }
+
+    return NULL;
+}
+
+int RX_BAUD_Report(unsigned long baud)
+{
+    UART_BAUD_Config_Type config;
+    char line[UART_BAUD_LINE_SIZE];
+    Status status = UART_BAUD_Search(RX_BAUD_FIRMWARE_CCLK, UART_BAUD_DEFAULT_DIV, (uint32_t)baud, &config);
+
+    UART_BAUD_Format(line, &config);
+    fprintf(stderr, "uart_receiver: el firmware a %u MHz configura %s", RX_BAUD_FIRMWARE_CCLK / 1000000, line);
+    if (status != SUCCESS)
+    {
+        fprintf(stderr, "uart_receiver: advertencia: el firmware no puede generar %lu baudios\n", baud);
+        return -1;
+    }
+
+    return 0;
+}
+
+int RX_BAUD_CheckTable(void)
+{
+    static uint32_t clocks[RX_BAUD_MAX_CLOCKS];
+    size_t count = RX_BAUD_Clocks(clocks);
+    UART_BAUD_Config_Type config;
+    char line[UART_BAUD_LINE_SIZE];
+    unsigned long failures = 0;
+    unsigned long accepted;
+    uint32_t worst;
+    uint32_t lowest;
+    const char* failure;
+    Status status;
+
+    fprintf(stderr, "uart_receiver: %zu CCLK posibles entre %u y %u Hz\n", count, clocks[0], clocks[count - 1]);
+
+    for (size_t r = 0; r < sizeof(Rates) / sizeof(Rates[0]); r++)
+    {
+        accepted = 0;
+        worst = 0;
+        lowest = 0;
+
+        for (size_t c = 0; c < count; c++)
+        {
+            status = UART_BAUD_Search(clocks[c], UART_BAUD_DEFAULT_DIV, Rates[r], &config);
+            failure = RX_BAUD_Verify(clocks[c], Rates[r], status, &config);
+            if (failure != NULL)
+            {
+                if (failures++ < RX_BAUD_MAX_REPORT)
+                {
+                    UART_BAUD_Format(line, &config);
+                    fprintf(stderr, "uart_receiver: FALLA a %u Hz (%s): %s", clocks[c], failure, line);
+                }
+                continue;
+            }
+            if (status == SUCCESS)
+            {
+                accepted++;
+                worst = (abs(config.Error_Ppm) > (int32_t)worst) ? (uint32_t)abs(config.Error_Ppm) : worst;
+                lowest = (lowest == 0) ? clocks[c] : lowest;
+            }
+        }
+
+        UART_BAUD_Search(RX_BAUD_FIRMWARE_CCLK, UART_BAUD_DEFAULT_DIV, Rates[r], &config);
+        UART_BAUD_Format(line, &config);
+        fprintf(stderr, "%7u: aceptada con %5lu de %zu CCLK (desde %9u Hz), error maximo %u ppm; a %u MHz: %s",
+                Rates[r], accepted, count, lowest, worst, RX_BAUD_FIRMWARE_CCLK / 1000000, line);
+    }
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "uart_receiver: %lu configuraciones incorrectas\nuart_receiver: FALLA\n", failures);
+        return 2;
+    }
+    fprintf(stderr, "uart_receiver: OK\n");
+    return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file rx_baud.h
+ * @brief Velocidad que genera el firmware y verificacion de la tabla de divisores del UART2.
+ *
+ * El receptor compila la misma busqueda de divisores que el firmware (Src/uart_baud.c). Con ella informa la
+ * velocidad real que va a generar el LPC1769 para la velocidad elegida y verifica, para todas las CCLK que puede
+ * configurar system_LPC17xx.c y cada velocidad estandar, que la busqueda devuelva registros validos y el error
+ * minimo posible, comparandola con una busqueda exhaustiva en punto flotante.
+ */
+
+#ifndef RX_BAUD_H
+#define RX_BAUD_H
+
+#include <stdint.h>
+
+// Definiciones del modulo:
+#define RX_BAUD_FIRMWARE_CCLK 100000000 /**< CCLK del firmware (system_LPC17xx.c: PLL0 a 400 MHz, CCLKCFG = 3) */
+
+/**
+ * @brief Muestra la velocidad que genera el firmware para una velocidad pedida.
+ *
+ * @param baud Velocidad pedida.
+ * @return 0 si el firmware la puede generar con un error aceptable, -1 si no.
+ */
+int RX_BAUD_Report(unsigned long baud);
+
+/**
+ * @brief Verifica la busqueda de divisores para cada velocidad estandar y cada CCLK posible.
+ *
+ * Muestra un resumen por velocidad y la configuracion elegida a RX_BAUD_FIRMWARE_CCLK.
+ *
+ * @return 0 si todas las configuraciones son correctas, 2 si alguna falla.
+ */
+int RX_BAUD_CheckTable(void);
+
+#endif /* RX_BAUD_H */
@@ -0,0 +1,201 @@
+/**
+ * @file rx_output.c
+ * @brief Registro de los paquetes recibidos en CSV o en binario, con escrituras por lotes.
+ *
+ * Las lineas CSV se arman a mano en lugar de usar printf: con el puerto a maxima velocidad el formateo es la parte
+ * mas cara del receptor.
+ */
+
+#include "rx_output.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char Csv_Header[] = "tiempo_us,secuencia,temperatura,iluminacion,gas,ventilacion\n";
+
+/**
+ * @brief Escribe un bloque completo, reintentando las escrituras parciales.
+ */
+static int RX_OUTPUT_WriteAll(RX_Output_Type* output, const char* data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t done = write(output->Fd, data, length);
+
+        if (done < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        data += done;
+        length -= (size_t)done;
+        output->Written += (unsigned long long)done;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Agrega un numero decimal a una linea.
+ *
+ * @return Cantidad de caracteres agregados.
+ */
+static size_t RX_OUTPUT_PutNumber(char* line, unsigned long long value)
+{
+    char digits[20];
+    size_t count = 0;
+    size_t length;
+
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    length = count;
+    while (count > 0)
+    {
+        *line++ = digits[--count];
+    }
+
+    return length;
+}
+
+/**
+ * @brief Arma la linea CSV de un paquete.
+ *
+ * @return Longitud de la linea.
+ */
+static size_t RX_OUTPUT_FormatCsv(char* line, const RX_Packet_Type* packet)
+{
+    size_t pos = RX_OUTPUT_PutNumber(line, packet->Time_Us);
+
+    line[pos++] = ',';
+    pos += RX_OUTPUT_PutNumber(&line[pos], packet->Sequence);
+    line[pos++] = ',';
+    pos += RX_OUTPUT_PutNumber(&line[pos], packet->Temperature);
+    line[pos++] = ',';
+    pos += RX_OUTPUT_PutNumber(&line[pos], packet->Light);
+    line[pos++] = ',';
+    pos += RX_OUTPUT_PutNumber(&line[pos], packet->Gas);
+    line[pos++] = ',';
+    pos += RX_OUTPUT_PutNumber(&line[pos], packet->Vent);
+    line[pos++] = '\n';
+
+    return pos;
+}
+
+/**
+ * @brief Arma el registro binario de un paquete.
+ *
+ * @return Longitud del registro.
+ */
+static size_t RX_OUTPUT_FormatBinary(char* record, const RX_Packet_Type* packet)
+{
+    for (unsigned i = 0; i < 8; i++)
+    {
+        record[i] = (char)(packet->Time_Us >> (8 * i));
+    }
+    record[8] = (char)packet->Sequence;
+    record[9] = (char)packet->Temperature;
+    record[10] = (char)packet->Light;
+    record[11] = (char)packet->Gas;
+    record[12] = (char)packet->Vent;
+
+    return RX_OUTPUT_RECORD_SIZE;
+}
+
+int RX_OUTPUT_Open(RX_Output_Type* output, const char* path, RX_OUTPUT_Format_Type format)
+{
+    output->Format = format;
+    output->Used = 0;
+    output->Written = 0;
+    output->Owned = 0;
+    output->Fd = -1;
+
+    if (path == NULL)
+    {
+        return 0;
+    }
+
+    if (strcmp(path, "-") == 0)
+    {
+        output->Fd = STDOUT_FILENO;
+    }
+    else
+    {
+        output->Fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (output->Fd < 0)
+        {
+            return -1;
+        }
+        output->Owned = 1;
+    }
+
+    if (format == RX_OUTPUT_CSV)
+    {
+        memcpy(output->Buffer, Csv_Header, sizeof(Csv_Header) - 1);
+        output->Used = sizeof(Csv_Header) - 1;
+    }
+
+    return 0;
+}
+
+int RX_OUTPUT_Write(RX_Output_Type* output, const RX_Packet_Type* packets, size_t count)
+{
+    int result = 0;
+
+    if (output->Fd < 0)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (RX_OUTPUT_BUFFER_SIZE - output->Used < RX_OUTPUT_LINE_SIZE && RX_OUTPUT_Flush(output) != 0)
+        {
+            result = -1;
+        }
+
+        if (output->Format == RX_OUTPUT_CSV)
+        {
+            output->Used += RX_OUTPUT_FormatCsv(&output->Buffer[output->Used], &packets[i]);
+        }
+        else
+        {
+            output->Used += RX_OUTPUT_FormatBinary(&output->Buffer[output->Used], &packets[i]);
+        }
+    }
+
+    return result;
+}
+
+int RX_OUTPUT_Flush(RX_Output_Type* output)
+{
+    int result = 0;
+
+    if (output->Fd >= 0 && output->Used > 0)
+    {
+        result = RX_OUTPUT_WriteAll(output, output->Buffer, output->Used);
+    }
+    // Si la escritura fallo, el lote se pierde para no bloquear la recepcion.
+    output->Used = 0;
+
+    return result;
+}
+
+void RX_OUTPUT_Close(RX_Output_Type* output)
+{
+    RX_OUTPUT_Flush(output);
+    if (output->Owned)
+    {
+        close(output->Fd);
+    }
+    output->Fd = -1;
+    output->Owned = 0;
+}
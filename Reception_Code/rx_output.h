@@ -0,0 +1,81 @@
+/**
+ * @file rx_output.h
+ * @brief Registro de los paquetes recibidos en CSV o en binario, con escrituras por lotes.
+ *
+ * Los registros se arman en un buffer de RX_OUTPUT_BUFFER_SIZE bytes y se escriben con una sola llamada a write()
+ * cuando el buffer se llena o cuando el llamador lo pide (por ejemplo, si el puerto queda en silencio), de modo que
+ * el costo de la salida no depende de la cantidad de paquetes sino de la cantidad de lotes.
+ *
+ * Formato CSV: una linea de encabezado y una linea por paquete:
+ *
+ *     tiempo_us,secuencia,temperatura,iluminacion,gas,ventilacion
+ *
+ * Formato binario: un registro de RX_OUTPUT_RECORD_SIZE bytes por paquete, sin encabezado: el instante en
+ * microsegundos (8 bytes, little-endian) seguido de secuencia, temperatura, iluminacion, gas y ventilacion (1 byte
+ * cada uno).
+ */
+
+#ifndef RX_OUTPUT_H
+#define RX_OUTPUT_H
+
+#include <stddef.h>
+
+#include "rx_parser.h"
+
+// Definiciones del modulo:
+#define RX_OUTPUT_BUFFER_SIZE (64 * 1024) /**< Tamaño del buffer de escritura */
+#define RX_OUTPUT_RECORD_SIZE 13          /**< Bytes de un registro binario */
+#define RX_OUTPUT_LINE_SIZE   56          /**< Longitud maxima de una linea CSV */
+
+/**
+ * @brief Formatos de salida.
+ */
+typedef enum
+{
+    RX_OUTPUT_CSV,   /**< Texto separado por comas */
+    RX_OUTPUT_BINARY /**< Registros binarios de tamaño fijo */
+} RX_OUTPUT_Format_Type;
+
+/**
+ * @brief Salida abierta.
+ */
+typedef struct
+{
+    int Fd;                             /**< Descriptor del archivo, o -1 si la salida esta deshabilitada */
+    int Owned;                          /**< 1 si el descriptor se cierra con RX_OUTPUT_Close */
+    RX_OUTPUT_Format_Type Format;       /**< Formato de los registros */
+    size_t Used;                        /**< Bytes ocupados del buffer */
+    unsigned long long Written;         /**< Bytes escritos en el archivo */
+    char Buffer[RX_OUTPUT_BUFFER_SIZE]; /**< Registros pendientes de escribir */
+} RX_Output_Type;
+
+/**
+ * @brief Abre la salida.
+ *
+ * @param output Salida a abrir.
+ * @param path Archivo destino; "-" para la salida estandar y NULL para descartar los registros.
+ * @param format Formato de los registros.
+ * @return 0 si se pudo abrir, -1 si no (errno indica la causa).
+ */
+int RX_OUTPUT_Open(RX_Output_Type* output, const char* path, RX_OUTPUT_Format_Type format);
+
+/**
+ * @brief Agrega paquetes a la salida; escribe el buffer cada vez que se llena.
+ *
+ * @return 0 si no hubo errores de escritura, -1 si los hubo.
+ */
+int RX_OUTPUT_Write(RX_Output_Type* output, const RX_Packet_Type* packets, size_t count);
+
+/**
+ * @brief Escribe lo pendiente en el buffer.
+ *
+ * @return 0 si no hubo errores de escritura, -1 si los hubo.
+ */
+int RX_OUTPUT_Flush(RX_Output_Type* output);
+
+/**
+ * @brief Escribe lo pendiente y cierra la salida.
+ */
+void RX_OUTPUT_Close(RX_Output_Type* output);
+
+#endif /* RX_OUTPUT_H */
@@ -0,0 +1,79 @@
+/**
+ * @file rx_parser.c
+ * @brief Separacion del flujo de bytes del UART en paquetes de medicion.
+ */
+
+#include "rx_parser.h"
+
+#include <string.h>
+
+/**
+ * @brief Indica si la carga de una trama de mediciones tiene valores posibles.
+ *
+ * Es una segunda barrera, despues del CRC, contra tramas armadas con bytes de tramas dañadas.
+ */
+static int RX_PARSER_IsValid(const uint8_t* payload, uint8_t length)
+{
+    for (uint8_t i = 0; i < TELEMETRY_MEASURE_VENT(length); i++)
+    {
+        if (payload[i] > RX_PARSER_MAX_PERCENT)
+        {
+            return 0;
+        }
+    }
+
+    return payload[TELEMETRY_MEASURE_VENT(length)] <= 1;
+}
+
+void RX_PARSER_Init(RX_Parser_Type* parser)
+{
+    memset(parser, 0, sizeof(*parser));
+    TELEMETRY_DecoderInit(&parser->Decoder);
+}
+
+size_t RX_PARSER_Feed(RX_Parser_Type* parser, const uint8_t* data, size_t length, uint64_t time_us,
+                      RX_Packet_Type* packets, size_t max_packets)
+{
+    TELEMETRY_Frame_Type frame;
+    size_t pos = 0;
+    size_t count = 0;
+
+    parser->Bytes += length;
+
+    // El decodificador puede entregar una trama sin consumir bytes, por eso el lazo sigue con pos == length.
+    do
+    {
+        pos += TELEMETRY_Decode(&parser->Decoder, &data[pos], (uint32_t)(length - pos), &frame);
+        if (frame.Payload == NULL)
+        {
+            continue;
+        }
+
+        if (frame.Type != TELEMETRY_TYPE_MEASURES || frame.Length < TELEMETRY_MEASURES_SIZE ||
+            frame.Length > TELEMETRY_MEASURES_MAX)
+        {
+            parser->Others++;
+            continue;
+        }
+        if (RX_PARSER_IsValid(frame.Payload, frame.Length) == 0)
+        {
+            parser->Invalid++;
+            continue;
+        }
+        if (count == max_packets)
+        {
+            continue; // Arreglo del llamador mas chico que lo pedido: el paquete se pierde
+        }
+
+        packets[count].Time_Us = time_us;
+        packets[count].Sequence = frame.Sequence;
+        packets[count].Temperature = frame.Payload[TELEMETRY_MEASURE_TEMP];
+        packets[count].Light = frame.Payload[TELEMETRY_MEASURE_LIGHT];
+        packets[count].Gas = frame.Payload[TELEMETRY_MEASURE_GAS];
+        packets[count].Vent = frame.Payload[TELEMETRY_MEASURE_VENT(frame.Length)];
+        count++;
+        parser->Packets++;
+    } while (pos < length || frame.Payload != NULL);
+
+    return count;
+}
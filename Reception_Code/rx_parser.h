@@ -0,0 +1,74 @@
+/**
+ * @file rx_parser.h
+ * @brief Separacion del flujo de bytes del UART en paquetes de medicion.
+ *
+ * El firmware envia cada medicion en una trama de telemetria (Src/telemetry.h) con sincronismo, secuencia y CRC.
+ * El parser pasa cada bloque leido por el decodificador de tramas, que se resincroniza solo ante bytes perdidos o
+ * dañados, y convierte las tramas de mediciones en paquetes. Las tramas de otros tipos y las mediciones fuera de
+ * rango (medicion mayor a 100 o ventilacion distinta de 0/1) se cuentan y se ignoran.
+ *
+ * La carga de mediciones tiene un byte por canal de la tabla de sensores del firmware y la ventilacion al final
+ * (TELEMETRY_MEASURES_SIZE a TELEMETRY_MEASURES_MAX bytes). Los paquetes guardan los tres canales de la placa base;
+ * los canales agregados se validan pero no se registran.
+ *
+ * El parser no reserva memoria ni hace llamadas al sistema: procesa un bloque leido y deja los paquetes completos en
+ * un arreglo del llamador, de modo que la misma funcion sirve para el puerto serie y para medir su rendimiento.
+ */
+
+#ifndef RX_PARSER_H
+#define RX_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "telemetry.h"
+
+// Definiciones del modulo:
+#define RX_PARSER_MIN_FRAME   (TELEMETRY_OVERHEAD + TELEMETRY_MEASURES_SIZE) /**< Trama de mediciones mas corta */
+#define RX_PARSER_MAX_PERCENT 100                                            /**< Valor maximo de una medicion */
+
+/**
+ * @brief Paquete de medicion recibido.
+ */
+typedef struct
+{
+    uint64_t Time_Us;    /**< Instante de recepcion, en microsegundos */
+    uint8_t Sequence;    /**< Numero de secuencia de la trama */
+    uint8_t Temperature; /**< Temperatura, en grados Celsius */
+    uint8_t Light;       /**< Iluminacion, en porcentaje */
+    uint8_t Gas;         /**< Concentracion de gas, en centenas de ppm */
+    uint8_t Vent;        /**< Ventilacion: 1 abierta, 0 cerrada */
+} RX_Packet_Type;
+
+/**
+ * @brief Estado del parser.
+ */
+typedef struct
+{
+    TELEMETRY_Decoder_Type Decoder; /**< Decodificador de tramas (con sus contadores de errores) */
+    uint64_t Bytes;                 /**< Bytes procesados */
+    uint64_t Packets;               /**< Paquetes de medicion entregados */
+    uint64_t Others;                /**< Tramas validas de otros tipos o con carga de tamaño invalido */
+    uint64_t Invalid;               /**< Tramas de mediciones con valores fuera de rango */
+} RX_Parser_Type;
+
+/**
+ * @brief Inicializa el parser.
+ */
+void RX_PARSER_Init(RX_Parser_Type* parser);
+
+/**
+ * @brief Procesa un bloque de bytes recibidos.
+ *
+ * @param parser Parser.
+ * @param data Bytes recibidos.
+ * @param length Cantidad de bytes.
+ * @param time_us Instante de recepcion del bloque, en microsegundos.
+ * @param packets Donde se dejan los paquetes completos.
+ * @param max_packets Capacidad de packets; debe ser al menos length / RX_PARSER_MIN_FRAME + 2.
+ * @return Cantidad de paquetes dejados en packets.
+ */
+size_t RX_PARSER_Feed(RX_Parser_Type* parser, const uint8_t* data, size_t length, uint64_t time_us,
+                      RX_Packet_Type* packets, size_t max_packets);
+
+#endif /* RX_PARSER_H */
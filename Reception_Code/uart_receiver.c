@@ -0,0 +1,733 @@
+/**
+ * @file uart_receiver.c
+ * @brief Receptor de las mediciones del sistema domotico para Linux (POSIX).
+ *
+ * Configura el puerto serie con termios en modo crudo y no bloqueante, espera datos con poll() y vacia el puerto en
+ * cada despertar con lecturas de hasta RX_READ_SIZE bytes. Cada bloque leido pasa por el parser (rx_parser.c), que
+ * decodifica las tramas de telemetria y se resincroniza ante bytes perdidos, y los paquetes completos se registran
+ * por lotes en CSV o binario (rx_output.c). Opcionalmente guarda el flujo crudo tal como llego, para reproducirlo.
+ *
+ * Modo de prueba: reproduce a maxima velocidad un flujo grabado (-p) o tramas sinteticas (-G) a traves de un
+ * pseudo-terminal (openpty), con el mismo lazo de recepcion que el puerto real, e informa el rendimiento del
+ * receptor y del parser. Con -e se eliminan bytes al azar antes de enviarlos; con tramas sinteticas se verifica
+ * ademas que se reciban exactamente las tramas que no fueron dañadas, y el programa termina con codigo 2 si no.
+ *
+ * La velocidad por defecto es la del firmware (make receiver UART_BAUD=<valor> la cambia en ambos). Al abrir el
+ * puerto se informa la velocidad real que genera el firmware para la elegida; -T verifica la busqueda de divisores
+ * del UART2 para todas las velocidades estandar y todas las CCLK posibles (rx_baud.c).
+ *
+ * Uso:
+ *     uart_receiver [-d dispositivo] [-b baudios] [-f csv|bin] [-o salida] [-w crudo]
+ *     uart_receiver -p grabacion | -G tramas [-n repeticiones] [-e tasa] [-s semilla] [-f csv|bin] [-o salida]
+ *     uart_receiver -T
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rx_baud.h"
+#include "rx_output.h"
+#include "rx_parser.h"
+
+// Definiciones del modulo:
+#define RX_DEFAULT_DEVICE "/dev/ttyUSB0" /**< Puerto serie por defecto */
+#ifndef RX_DEFAULT_BAUD
+#define RX_DEFAULT_BAUD 9600 /**< Velocidad por defecto (la del firmware) */
+#endif
+#define RX_READ_SIZE      (64 * 1024)    /**< Maximo de bytes por lectura */
+#define RX_POLL_MS        250            /**< Espera maxima de poll(); al vencer se escribe lo pendiente */
+
+/** Paquetes que puede dejar un bloque leido (mas los que quedaron acumulados del bloque anterior) */
+#define RX_MAX_PACKETS (RX_READ_SIZE / RX_PARSER_MIN_FRAME + 2)
+
+/**
+ * @brief Velocidad del puerto y su constante de termios.
+ */
+typedef struct
+{
+    unsigned long Baud; /**< Bits por segundo */
+    speed_t Speed;      /**< Constante Bxxx */
+} RX_Baud_Type;
+
+/**
+ * @brief Estado de la recepcion.
+ */
+typedef struct
+{
+    RX_Parser_Type Parser;          /**< Parser del flujo */
+    RX_Output_Type Output;          /**< Registro de los paquetes */
+    int Capture_Fd;                 /**< Archivo del flujo crudo, o -1 */
+    uint64_t Parse_Ns;              /**< Tiempo consumido por el parser */
+    const uint8_t* Reference;       /**< Tramas sinteticas originales (modo de prueba), o NULL */
+    unsigned long Reference_Frames; /**< Cantidad de tramas en Reference */
+    unsigned long Next_Frame;       /**< Indice de la proxima trama esperada en Reference */
+    unsigned long Mismatches;       /**< Paquetes que no coinciden con su trama original */
+} RX_Context_Type;
+
+/**
+ * @brief Flujo que se reproduce por el pseudo-terminal.
+ */
+typedef struct
+{
+    int Fd;              /**< Lado maestro del pseudo-terminal */
+    const uint8_t* Data; /**< Bytes a enviar */
+    size_t Length;       /**< Cantidad de bytes */
+} RX_Replay_Type;
+
+/**
+ * @brief Origen y alteraciones del flujo del modo de prueba.
+ */
+typedef struct
+{
+    const char* Path;     /**< Grabacion a reproducir, o NULL para tramas sinteticas */
+    unsigned long Frames; /**< Tramas sinteticas */
+    unsigned Repetitions; /**< Veces que se repite la grabacion */
+    double Loss;          /**< Probabilidad de eliminar cada byte */
+    uint32_t Seed;        /**< Semilla de los valores sinteticos y de los bytes eliminados */
+} RX_Test_Type;
+
+static const RX_Baud_Type Bauds[] = {
+    {1200, B1200},       {2400, B2400},       {4800, B4800},       {9600, B9600},       {19200, B19200},
+    {38400, B38400},     {57600, B57600},     {115200, B115200},   {230400, B230400},   {460800, B460800},
+    {500000, B500000},   {576000, B576000},   {921600, B921600},   {1000000, B1000000}, {1152000, B1152000},
+    {1500000, B1500000}, {2000000, B2000000}, {3000000, B3000000}, {4000000, B4000000},
+};
+
+static RX_Context_Type Context;                /**< Estado de la recepcion (grande: fuera de la pila) */
+static uint8_t Rx_Buffer[RX_READ_SIZE];        /**< Bloque leido del puerto */
+static RX_Packet_Type Packets[RX_MAX_PACKETS]; /**< Paquetes de un bloque */
+static volatile sig_atomic_t Stop = 0;         /**< Pedido de terminacion (SIGINT/SIGTERM) */
+
+/**
+ * @brief Atiende SIGINT y SIGTERM: termina la recepcion en el proximo despertar.
+ */
+static void RX_OnSignal(int signal)
+{
+    (void)signal;
+    Stop = 1;
+}
+
+/**
+ * @brief Instante de un reloj, en nanosegundos.
+ */
+static uint64_t RX_Now(clockid_t clock)
+{
+    struct timespec now;
+
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Busca la constante de termios de una velocidad.
+ *
+ * @return 0 si la velocidad existe, -1 si no.
+ */
+static int RX_GetSpeed(unsigned long baud, speed_t* speed)
+{
+    for (size_t i = 0; i < sizeof(Bauds) / sizeof(Bauds[0]); i++)
+    {
+        if (Bauds[i].Baud == baud)
+        {
+            *speed = Bauds[i].Speed;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Configura un terminal en modo crudo: 8N1, sin control de flujo, sin eco ni traduccion de caracteres.
+ *
+ * read() no espera (VMIN = VTIME = 0): la espera la hace poll().
+ *
+ * @return 0 si se pudo configurar, -1 si no.
+ */
+static int RX_ConfigureTty(int fd, speed_t speed)
+{
+    struct termios tty;
+
+    if (tcgetattr(fd, &tty) != 0)
+    {
+        return -1;
+    }
+
+    cfmakeraw(&tty);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    if (cfsetispeed(&tty, speed) != 0 || cfsetospeed(&tty, speed) != 0)
+    {
+        return -1;
+    }
+
+    tcflush(fd, TCIFLUSH);
+    return tcsetattr(fd, TCSANOW, &tty);
+}
+
+/**
+ * @brief Abre y configura el puerto serie.
+ *
+ * @return Descriptor del puerto, o -1 si no se pudo abrir.
+ */
+static int RX_OpenSerial(const char* device, unsigned long baud)
+{
+    speed_t speed;
+    int fd;
+
+    if (RX_GetSpeed(baud, &speed) != 0)
+    {
+        fprintf(stderr, "uart_receiver: velocidad no soportada: %lu\n", baud);
+        return -1;
+    }
+
+    fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        fprintf(stderr, "uart_receiver: no se puede abrir %s: %s\n", device, strerror(errno));
+        return -1;
+    }
+
+    if (RX_ConfigureTty(fd, speed) != 0)
+    {
+        fprintf(stderr, "uart_receiver: no se puede configurar %s: %s\n", device, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Compara los paquetes recibidos en el modo de prueba con las tramas sinteticas originales.
+ *
+ * Cada paquete se asocia con la primera trama posterior a la anterior recibida que tenga su misma secuencia; se
+ * supone que nunca se pierden 256 tramas seguidas.
+ */
+static void RX_Verify(RX_Context_Type* ctx, const RX_Packet_Type* packets, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned long frame = ctx->Next_Frame + (uint8_t)(packets[i].Sequence - (uint8_t)ctx->Next_Frame);
+        const uint8_t* payload;
+
+        ctx->Next_Frame = frame + 1;
+        if (frame >= ctx->Reference_Frames)
+        {
+            ctx->Mismatches++;
+            continue;
+        }
+
+        payload = TELEMETRY_PAYLOAD(&ctx->Reference[frame * RX_PARSER_MIN_FRAME]);
+        if (payload[TELEMETRY_MEASURE_TEMP] != packets[i].Temperature ||
+            payload[TELEMETRY_MEASURE_LIGHT] != packets[i].Light || payload[TELEMETRY_MEASURE_GAS] != packets[i].Gas ||
+            payload[TELEMETRY_MEASURE_VENT(TELEMETRY_MEASURES_SIZE)] != packets[i].Vent)
+        {
+            ctx->Mismatches++;
+        }
+    }
+}
+
+/**
+ * @brief Procesa un bloque leido: lo guarda crudo, lo separa en paquetes y los registra.
+ */
+static void RX_Process(RX_Context_Type* ctx, const uint8_t* data, size_t length)
+{
+    uint64_t start;
+    size_t count;
+
+    if (ctx->Capture_Fd >= 0 && write(ctx->Capture_Fd, data, length) != (ssize_t)length)
+    {
+        fprintf(stderr, "uart_receiver: error al guardar el flujo crudo: %s\n", strerror(errno));
+        close(ctx->Capture_Fd);
+        ctx->Capture_Fd = -1;
+    }
+
+    start = RX_Now(CLOCK_MONOTONIC);
+    count = RX_PARSER_Feed(&ctx->Parser, data, length, RX_Now(CLOCK_REALTIME) / 1000, Packets, RX_MAX_PACKETS);
+    ctx->Parse_Ns += RX_Now(CLOCK_MONOTONIC) - start;
+
+    if (ctx->Reference != NULL)
+    {
+        RX_Verify(ctx, Packets, count);
+    }
+
+    if (RX_OUTPUT_Write(&ctx->Output, Packets, count) != 0)
+    {
+        fprintf(stderr, "uart_receiver: error al escribir la salida: %s\n", strerror(errno));
+    }
+}
+
+/**
+ * @brief Lazo de recepcion: espera con poll() y vacia el puerto en cada despertar.
+ *
+ * @param fd Puerto (o lado esclavo del pseudo-terminal), no bloqueante.
+ * @param limit Termina al recibir esta cantidad de bytes; 0 para recibir hasta una señal.
+ * @return 0 si termino normalmente, -1 ante un error del puerto.
+ */
+static int RX_Receive(RX_Context_Type* ctx, int fd, uint64_t limit)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+
+    while (!Stop && (limit == 0 || ctx->Parser.Bytes < limit))
+    {
+        int ready = poll(&pfd, 1, RX_POLL_MS);
+
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+
+        // Puerto en silencio: se escribe lo pendiente para que la salida no quede atrasada.
+        if (ready == 0)
+        {
+            RX_OUTPUT_Flush(&ctx->Output);
+            continue;
+        }
+
+        for (;;)
+        {
+            ssize_t length = read(fd, Rx_Buffer, sizeof(Rx_Buffer));
+
+            if (length > 0)
+            {
+                RX_Process(ctx, Rx_Buffer, (size_t)length);
+                continue;
+            }
+            if (length < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            // Con VMIN = VTIME = 0 un terminal sin datos devuelve 0 en lugar de EAGAIN.
+            if (length == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                break;
+            }
+
+            fprintf(stderr, "uart_receiver: error al leer el puerto: %s\n", strerror(errno));
+            return -1;
+        }
+
+        if ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 && (pfd.revents & POLLIN) == 0)
+        {
+            fprintf(stderr, "uart_receiver: el puerto se cerro\n");
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Escribe el flujo en el lado maestro del pseudo-terminal, lo mas rapido posible.
+ */
+static void* RX_ReplayWriter(void* arg)
+{
+    const RX_Replay_Type* replay = arg;
+    size_t pos = 0;
+
+    while (pos < replay->Length)
+    {
+        ssize_t done = write(replay->Fd, &replay->Data[pos], replay->Length - pos);
+
+        if (done < 0 && errno != EINTR)
+        {
+            fprintf(stderr, "uart_receiver: error al escribir en el pseudo-terminal: %s\n", strerror(errno));
+            return NULL;
+        }
+        pos += (done > 0) ? (size_t)done : 0;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Generador pseudoaleatorio (xorshift32), reproducible entre plataformas a diferencia de rand().
+ */
+static uint32_t RX_Random(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Lee un archivo completo en memoria, repetido varias veces.
+ *
+ * @return Contenido (liberar con free), o NULL si no se pudo leer o esta vacio.
+ */
+static uint8_t* RX_LoadFile(const char* path, unsigned repetitions, size_t* length)
+{
+    struct stat info;
+    uint8_t* data = NULL;
+    size_t size;
+    size_t pos = 0;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        goto done;
+    }
+
+    size = (size_t)info.st_size;
+    data = malloc(size * repetitions);
+    while (data != NULL && pos < size)
+    {
+        ssize_t done = read(fd, &data[pos], size - pos);
+
+        if (done <= 0)
+        {
+            free(data);
+            data = NULL;
+            break;
+        }
+        pos += (size_t)done;
+    }
+
+    for (unsigned i = 1; data != NULL && i < repetitions; i++)
+    {
+        memcpy(&data[i * size], data, size);
+    }
+    *length = size * repetitions;
+
+done:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    return data;
+}
+
+/**
+ * @brief Genera tramas de mediciones con valores al azar y secuencia consecutiva, como las del firmware.
+ *
+ * @return Flujo generado (liberar con free), o NULL si no hay memoria.
+ */
+static uint8_t* RX_Synthesize(unsigned long frames, uint32_t seed, size_t* length)
+{
+    uint8_t* data = malloc(frames * RX_PARSER_MIN_FRAME);
+    uint8_t* frame = data;
+
+    for (unsigned long i = 0; data != NULL && i < frames; i++)
+    {
+        uint8_t* payload = TELEMETRY_PAYLOAD(frame);
+
+        payload[TELEMETRY_MEASURE_TEMP] = (uint8_t)(RX_Random(&seed) % 101);
+        payload[TELEMETRY_MEASURE_LIGHT] = (uint8_t)(RX_Random(&seed) % 101);
+        payload[TELEMETRY_MEASURE_GAS] = (uint8_t)(RX_Random(&seed) % 101);
+        payload[TELEMETRY_MEASURE_VENT(TELEMETRY_MEASURES_SIZE)] = (uint8_t)(RX_Random(&seed) & 1);
+        frame += TELEMETRY_Seal(frame, TELEMETRY_TYPE_MEASURES, (uint8_t)i, TELEMETRY_MEASURES_SIZE);
+    }
+    *length = frames * RX_PARSER_MIN_FRAME;
+
+    return data;
+}
+
+/**
+ * @brief Elimina bytes al azar del flujo, en el lugar.
+ *
+ * @param damaged Se suman los bloques de RX_PARSER_MIN_FRAME bytes (tramas sinteticas) que perdieron algun byte.
+ * @return Nueva longitud del flujo.
+ */
+static size_t RX_InjectLoss(uint8_t* data, size_t length, double loss, uint32_t seed, unsigned long* damaged)
+{
+    uint32_t threshold = (uint32_t)(loss * UINT32_MAX);
+    size_t last = SIZE_MAX;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (RX_Random(&seed) >= threshold)
+        {
+            data[kept++] = data[i];
+            continue;
+        }
+
+        if (i / RX_PARSER_MIN_FRAME != last)
+        {
+            last = i / RX_PARSER_MIN_FRAME;
+            (*damaged)++;
+        }
+    }
+
+    return kept;
+}
+
+/**
+ * @brief Modo de prueba: reproduce un flujo por un pseudo-terminal y mide el rendimiento.
+ *
+ * @return Codigo de salida del programa.
+ */
+static int RX_Replay(RX_Context_Type* ctx, const RX_Test_Type* test)
+{
+    const TELEMETRY_Stats_Type* stats = &ctx->Parser.Decoder.Stats;
+    RX_Replay_Type replay = {0};
+    uint8_t* data;
+    uint8_t* reference = NULL;
+    unsigned long damaged = 0;
+    size_t original;
+    pthread_t writer;
+    int slave;
+    int result;
+    uint64_t start;
+    double seconds;
+    double rate;
+
+    if (test->Path != NULL)
+    {
+        data = RX_LoadFile(test->Path, test->Repetitions, &original);
+    }
+    else
+    {
+        data = RX_Synthesize(test->Frames, test->Seed, &original);
+    }
+    if (data == NULL)
+    {
+        fprintf(stderr, "uart_receiver: no se puede leer la grabacion %s\n", (test->Path != NULL) ? test->Path : "");
+        return 1;
+    }
+
+    // Las tramas sinteticas se conservan intactas para verificar lo recibido:
+    if (test->Path == NULL)
+    {
+        reference = malloc(original);
+        if (reference == NULL)
+        {
+            free(data);
+            return 1;
+        }
+        memcpy(reference, data, original);
+        ctx->Reference = reference;
+        ctx->Reference_Frames = test->Frames;
+    }
+
+    replay.Data = data;
+    replay.Length = original;
+    if (test->Loss > 0)
+    {
+        replay.Length = RX_InjectLoss(data, original, test->Loss, test->Seed ^ 0x9E3779B9UL, &damaged);
+    }
+
+    if (openpty(&replay.Fd, &slave, NULL, NULL, NULL) != 0 || RX_ConfigureTty(slave, B4000000) != 0 ||
+        fcntl(slave, F_SETFL, fcntl(slave, F_GETFL) | O_NONBLOCK) != 0)
+    {
+        fprintf(stderr, "uart_receiver: no se puede crear el pseudo-terminal: %s\n", strerror(errno));
+        free(data);
+        return 1;
+    }
+
+    start = RX_Now(CLOCK_MONOTONIC);
+    if (pthread_create(&writer, NULL, RX_ReplayWriter, &replay) != 0)
+    {
+        fprintf(stderr, "uart_receiver: no se puede crear el hilo de reproduccion\n");
+        free(data);
+        return 1;
+    }
+    result = RX_Receive(ctx, slave, replay.Length);
+    RX_OUTPUT_Flush(&ctx->Output);
+    seconds = (double)(RX_Now(CLOCK_MONOTONIC) - start) / 1e9;
+
+    // Si la recepcion se interrumpio, cerrar el maestro desbloquea al escritor.
+    close(replay.Fd);
+    pthread_join(writer, NULL);
+    close(slave);
+    free(data);
+    free(reference);
+    ctx->Reference = NULL;
+
+    rate = (double)ctx->Parser.Bytes / seconds;
+    fprintf(stderr, "uart_receiver: %llu bytes en %.3f s: %.1f MB/s, %.0f paquetes/s (equivale a %.0f baudios)\n",
+            (unsigned long long)ctx->Parser.Bytes, seconds, rate / 1e6, (double)ctx->Parser.Packets / seconds,
+            rate * 10);
+    fprintf(stderr, "uart_receiver: parser: %.1f MB/s\n",
+            (double)ctx->Parser.Bytes / ((double)ctx->Parse_Ns / 1e9) / 1e6);
+    if (test->Loss > 0)
+    {
+        fprintf(stderr, "uart_receiver: %zu bytes eliminados\n", original - replay.Length);
+    }
+
+    if (result != 0)
+    {
+        return 1;
+    }
+
+    // Toda trama intacta tiene que llegar. De las dañadas, el CRC-16 deja pasar en promedio una de cada 65536
+    // verificaciones fallidas (y la trama falsa puede tragarse el comienzo de la siguiente, que tambien se pierde);
+    // se tolera hasta cuatro veces esa tasa antes de considerar que hay un error.
+    if (test->Path == NULL)
+    {
+        unsigned long false_accepts = ctx->Mismatches + (unsigned long)ctx->Parser.Invalid;
+        unsigned long tolerated = 1 + (stats->Crc_Errors + false_accepts) / 16384;
+        long missing = (long)(test->Frames - damaged) - (long)(ctx->Parser.Packets - ctx->Mismatches);
+
+        fprintf(stderr, "uart_receiver: %llu de %lu tramas recibidas, %lu afectadas por -e, %lu falsas\n",
+                (unsigned long long)ctx->Parser.Packets, test->Frames, damaged, false_accepts);
+        if (false_accepts > tolerated || missing > (long)false_accepts)
+        {
+            fprintf(stderr, "uart_receiver: FALLA\n");
+            return 2;
+        }
+        fprintf(stderr, "uart_receiver: OK\n");
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Muestra la ayuda.
+ */
+static void RX_Usage(const char* program)
+{
+    fprintf(stderr,
+            "Uso: %s [opciones]\n"
+            "  -d dispositivo  puerto serie (%s)\n"
+            "  -b baudios      velocidad del puerto (%d)\n"
+            "  -f csv|bin      formato de la salida (csv)\n"
+            "  -o archivo      salida de los paquetes; '-' es la salida estandar (-)\n"
+            "  -w archivo      guarda el flujo crudo recibido\n"
+            "Modo de prueba (pseudo-terminal a maxima velocidad):\n"
+            "  -p archivo      reproduce un flujo crudo grabado con -w\n"
+            "  -G tramas       reproduce tramas sinteticas y verifica que lleguen todas las intactas\n"
+            "  -n veces        repeticiones de la grabacion (1)\n"
+            "  -e tasa         probabilidad de eliminar cada byte antes de enviarlo (0)\n"
+            "  -s semilla      semilla de los valores y de los bytes eliminados (1)\n"
+            "  -T              verifica los divisores del UART2 para cada velocidad estandar y cada CCLK posible\n",
+            program, RX_DEFAULT_DEVICE, RX_DEFAULT_BAUD);
+}
+
+int main(int argc, char** argv)
+{
+    const char* device = RX_DEFAULT_DEVICE;
+    const char* output = "-";
+    const char* capture = NULL;
+    unsigned long baud = RX_DEFAULT_BAUD;
+    unsigned long repetitions = 1;
+    RX_Test_Type test = {.Seed = 1};
+    RX_OUTPUT_Format_Type format = RX_OUTPUT_CSV;
+    struct sigaction action = {.sa_handler = RX_OnSignal};
+    RX_Context_Type* ctx = &Context;
+    const TELEMETRY_Stats_Type* stats = &ctx->Parser.Decoder.Stats;
+    int result;
+    int fd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:b:f:o:w:p:G:n:e:s:Th")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            device = optarg;
+            break;
+        case 'b':
+            baud = strtoul(optarg, NULL, 10);
+            break;
+        case 'f':
+            if (strcmp(optarg, "csv") != 0 && strcmp(optarg, "bin") != 0)
+            {
+                RX_Usage(argv[0]);
+                return 1;
+            }
+            format = (strcmp(optarg, "csv") == 0) ? RX_OUTPUT_CSV : RX_OUTPUT_BINARY;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'w':
+            capture = optarg;
+            break;
+        case 'p':
+            test.Path = optarg;
+            break;
+        case 'G':
+            test.Frames = strtoul(optarg, NULL, 10);
+            break;
+        case 'n':
+            repetitions = strtoul(optarg, NULL, 10);
+            break;
+        case 'e':
+            test.Loss = strtod(optarg, NULL);
+            break;
+        case 's':
+            test.Seed = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'T':
+            return RX_BAUD_CheckTable();
+        default:
+            RX_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    test.Repetitions = (repetitions > 0) ? (unsigned)repetitions : 1;
+    test.Seed = (test.Seed != 0) ? test.Seed : 1; // xorshift no sale del cero
+
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    RX_PARSER_Init(&ctx->Parser);
+    ctx->Capture_Fd = -1;
+    if (RX_OUTPUT_Open(&ctx->Output, output, format) != 0)
+    {
+        fprintf(stderr, "uart_receiver: no se puede crear %s: %s\n", output, strerror(errno));
+        return 1;
+    }
+    if (capture != NULL)
+    {
+        ctx->Capture_Fd = open(capture, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (ctx->Capture_Fd < 0)
+        {
+            fprintf(stderr, "uart_receiver: no se puede crear %s: %s\n", capture, strerror(errno));
+            return 1;
+        }
+    }
+
+    if (test.Path != NULL || test.Frames != 0)
+    {
+        result = RX_Replay(ctx, &test);
+    }
+    else
+    {
+        fd = RX_OpenSerial(device, baud);
+        if (fd < 0)
+        {
+            return 1;
+        }
+        fprintf(stderr, "uart_receiver: %s a %lu baudios (Ctrl+C para terminar)\n", device, baud);
+        RX_BAUD_Report(baud);
+        result = (RX_Receive(ctx, fd, 0) == 0) ? 0 : 1;
+        close(fd);
+    }
+
+    RX_OUTPUT_Close(&ctx->Output);
+    if (ctx->Capture_Fd >= 0)
+    {
+        close(ctx->Capture_Fd);
+    }
+
+    fprintf(stderr, "uart_receiver: %llu bytes, %llu paquetes, %u tramas perdidas segun la secuencia\n",
+            (unsigned long long)ctx->Parser.Bytes, (unsigned long long)ctx->Parser.Packets, stats->Lost);
+    fprintf(stderr, "uart_receiver: %u resincronizaciones, %u bytes descartados, %u errores de CRC, %u de encabezado\n",
+            stats->Resyncs, stats->Discarded, stats->Crc_Errors, stats->Header_Errors);
+
+    return result;
+}
@@ -0,0 +1,22 @@
+/**
+ * @file LPC17xx.h
+ * @brief Reemplazo de LPC17xx.h para compilar el firmware en el simulador de host.
+ *
+ * Incluye el encabezado original del dispositivo, pero antes sustituye las funciones intrinsecas del Cortex-M3
+ * (core_cmInstr.h y core_cmFunc.h usan ensamblador ARM) por las del simulador. Las direcciones de los perifericos
+ * no cambian: sim_bus.c mapea las paginas de registros en sus direcciones reales, asi que los tipos, las macros de
+ * registros, las funciones inline de core_cm3.h y los drivers lpc17xx_* se compilan sin modificaciones.
+ */
+
+#ifndef SIM_LPC17XX_H
+#define SIM_LPC17XX_H
+
+#include "sim_cpu.h"
+
+// Se omiten las intrinsecas en ensamblador ARM; sim_cpu.h ya las definio.
+#define __CORE_CMINSTR_H
+#define __CORE_CMFUNC_H
+
+#include_next "LPC17xx.h"
+
+#endif /* SIM_LPC17XX_H */
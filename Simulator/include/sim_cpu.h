@@ -0,0 +1,102 @@
+/**
+ * @file sim_cpu.h
+ * @brief Funciones intrinsecas del Cortex-M3 para el simulador de host.
+ *
+ * Reemplaza a core_cmInstr.h y core_cmFunc.h. Las instrucciones que solo transforman datos se resuelven en C; las
+ * que dependen del estado del nucleo (PRIMASK, BASEPRI, WFI, numero de excepcion activa) se implementan en
+ * sim_core.c, que es el que decide cuando se atienden las interrupciones simuladas.
+ */
+
+#ifndef SIM_CPU_H
+#define SIM_CPU_H
+
+#include <stdint.h>
+
+// Estado del nucleo (sim_core.c):
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __enable_fault_irq(void);
+void __disable_fault_irq(void);
+uint32_t __get_FAULTMASK(void);
+void __set_FAULTMASK(uint32_t faultMask);
+uint32_t __get_BASEPRI(void);
+void __set_BASEPRI(uint32_t basePri);
+uint32_t __get_IPSR(void);
+void __WFI(void);
+
+/**
+ * @brief Barrera del compilador; en el host todos los accesos ya son ordenados.
+ */
+#define SIM_BARRIER() __asm volatile("" ::: "memory")
+
+#define __NOP() SIM_BARRIER()
+#define __SEV() SIM_BARRIER()
+#define __ISB() SIM_BARRIER()
+#define __DSB() SIM_BARRIER()
+#define __DMB() SIM_BARRIER()
+#define __WFE() __WFI()
+
+#define __CLREX()                 SIM_BARRIER()
+#define __LDREXB(addr)            (*(volatile uint8_t*)(addr))
+#define __LDREXH(addr)            (*(volatile uint16_t*)(addr))
+#define __LDREXW(addr)            (*(volatile uint32_t*)(addr))
+#define __STREXB(value, addr)     ((*(volatile uint8_t*)(addr) = (value)), 0U)
+#define __STREXH(value, addr)     ((*(volatile uint16_t*)(addr) = (value)), 0U)
+#define __STREXW(value, addr)     ((*(volatile uint32_t*)(addr) = (value)), 0U)
+#define __SSAT(value, bits)       SIM_Ssat((int32_t)(value), (bits))
+#define __USAT(value, bits)       SIM_Usat((int32_t)(value), (bits))
+#define __CLZ(value)              ((uint8_t)((value) ? __builtin_clz(value) : 32))
+#define __get_CONTROL()           (0U)
+#define __set_CONTROL(control)    ((void)(control))
+#define __get_APSR()              (0U)
+#define __get_xPSR()              (__get_IPSR())
+#define __get_PSP()               (0U)
+#define __set_PSP(topOfProcStack) ((void)(topOfProcStack))
+#define __get_MSP()               (0U)
+#define __set_MSP(topOfMainStack) ((void)(topOfMainStack))
+
+static inline uint32_t __REV(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+static inline uint32_t __REV16(uint32_t value)
+{
+    return ((value & 0xFF00FF00UL) >> 8) | ((value & 0x00FF00FFUL) << 8);
+}
+
+static inline int32_t __REVSH(int32_t value)
+{
+    return (int16_t)__builtin_bswap16((uint16_t)value);
+}
+
+static inline uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0;
+
+    for (uint8_t i = 0; i < 32; i++)
+    {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+
+    return result;
+}
+
+static inline int32_t SIM_Ssat(int32_t value, uint32_t bits)
+{
+    int32_t max = (int32_t)((1UL << (bits - 1)) - 1);
+
+    return (value > max) ? max : ((value < -max - 1) ? -max - 1 : value);
+}
+
+static inline uint32_t SIM_Usat(int32_t value, uint32_t bits)
+{
+    uint32_t max = (bits >= 32) ? 0xFFFFFFFFUL : ((1UL << bits) - 1);
+
+    return (value < 0) ? 0 : (((uint32_t)value > max) ? max : (uint32_t)value);
+}
+
+#endif /* SIM_CPU_H */
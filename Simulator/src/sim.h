@@ -0,0 +1,123 @@
+/**
+ * @file sim.h
+ * @brief Declaraciones internas del simulador de perifericos del LPC1769.
+ *
+ * El tiempo virtual se mide en picosegundos para que los relojes del nucleo (CCLK) y de los perifericos (PCLK)
+ * tengan periodos enteros. Cada periferico modelado es un SIM_Device_Type: atiende los accesos del firmware a su
+ * rango de direcciones y, si tiene comportamiento temporal, informa cuando ocurre su proximo evento.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+// Definiciones del simulador:
+#define SIM_PS_PER_SECOND 1000000000000ULL /**< Picosegundos por segundo */
+#define SIM_PS_PER_MS     1000000000ULL    /**< Picosegundos por milisegundo */
+#define SIM_PS_PER_NS     1000ULL          /**< Picosegundos por nanosegundo */
+#define SIM_NEVER         UINT64_MAX       /**< Tiempo de un evento que no va a ocurrir */
+#define SIM_IRQ_COUNT     35               /**< Interrupciones externas del LPC17xx */
+#define SIM_UART_COUNT    4                /**< UARTs del LPC17xx */
+
+/**
+ * @brief Tipo de acceso a un registro.
+ */
+typedef enum
+{
+    SIM_ACCESS_READ,   /**< Lectura del firmware o del GPDMA, con efectos laterales */
+    SIM_ACCESS_PREFILL /**< Valor previo a una escritura, sin efectos laterales */
+} SIM_Access_Type;
+
+/**
+ * @brief Periferico simulado.
+ *
+ * Las funciones reciben el desplazamiento de la palabra accedida dentro del periferico. Para los registros de
+ * escritura con 1 (W1C/W1S), SIM_ACCESS_PREFILL debe devolver 0 para que los bytes no escritos no tengan efecto.
+ * Update() lleva el estado hasta el instante indicado y Next() devuelve el instante del proximo evento interno.
+ */
+typedef struct
+{
+    const char* Name;                                          /**< Nombre del periferico */
+    uintptr_t Base;                                            /**< Direccion en el mapa simulado */
+    uint32_t Size;                                             /**< Tamaño del rango de direcciones */
+    uint32_t (*Read)(uint32_t offset, SIM_Access_Type access); /**< Lectura de un registro */
+    void (*Write)(uint32_t offset, uint32_t value);            /**< Escritura de un registro */
+    void (*Update)(uint64_t now);                              /**< Avance del estado interno */
+    uint64_t (*Next)(void);                                    /**< Instante del proximo evento */
+} SIM_Device_Type;
+
+// Tiempo virtual y planificador (sim_core.c):
+extern uint64_t SIM_Now;
+void SIM_CORE_Init(uint64_t end, uint32_t access_cycles);
+void SIM_CORE_Register(const SIM_Device_Type* device);
+void SIM_CORE_Advance(uint64_t target);
+void SIM_CORE_Access(void);
+void SIM_CORE_Sync(void);
+void SIM_CORE_Finish(const char* reason);
+void SIM_CORE_Fail(const char* format, ...);
+void SIM_CORE_SetIRQ(int32_t irqn, Bool level);
+void SIM_CORE_PendIRQ(int32_t irqn);
+uint64_t SIM_CORE_CyclesToPs(uint64_t cycles);
+
+// Mapa de registros (sim_bus.c):
+void SIM_BUS_Init(void);
+void SIM_BUS_Attach(const SIM_Device_Type* device);
+Bool SIM_BUS_Read(uint32_t address, uint8_t width, uint32_t* value);
+Bool SIM_BUS_Write(uint32_t address, uint8_t width, uint32_t value);
+uint32_t SIM_BUS_Peek(uintptr_t address);
+Bool SIM_BUS_IsMemory(uint32_t address, uint32_t length);
+
+// Control del sistema (sim_sc.c):
+void SIM_SC_Init(void);
+uint64_t SIM_SC_CclkPeriod(void);
+uint64_t SIM_SC_PclkPeriod(uint8_t pclksel_bit);
+
+// Puertos y entradas externas (sim_gpio.c):
+void SIM_GPIO_Init(void);
+void SIM_GPIO_SetInput(uint8_t port, uint8_t pin, uint8_t level);
+uint32_t SIM_GPIO_ExtintRead(uint32_t offset);
+void SIM_GPIO_ExtintWrite(uint32_t offset, uint32_t value);
+
+// Timers y PWM (sim_timer.c):
+void SIM_TIMER_Init(void);
+uint32_t SIM_TIMER_GetPulses(void);
+uint32_t SIM_TIMER_GetMatchPulses(void);
+
+// Conversores (sim_adc.c y sim_dac.c):
+void SIM_ADC_Init(void);
+void SIM_ADC_SetInput(uint8_t channel, uint16_t value, uint16_t noise, uint32_t seed);
+void SIM_ADC_MatchEdge(uint8_t timer, uint8_t match, uint8_t level);
+uint32_t SIM_ADC_GetConversions(void);
+void SIM_DAC_Init(void);
+uint32_t SIM_DAC_GetUpdates(void);
+
+// UARTs (sim_uart.c):
+void SIM_UART_Init(void);
+void SIM_UART_Receive(uint8_t uart, const uint8_t* data, uint32_t length);
+void SIM_UART_ServiceDMA(void);
+uint32_t SIM_UART_GetSent(uint8_t uart);
+
+// GPDMA (sim_gpdma.c):
+void SIM_GPDMA_Init(void);
+Bool SIM_GPDMA_Request(uint8_t connection);
+uint32_t SIM_GPDMA_GetTransfers(void);
+
+// Guion de estimulos (sim_script.c):
+Status SIM_SCRIPT_Load(const char* path, uint32_t seed);
+
+// Trazas (sim_trace.c):
+Status SIM_TRACE_Open(const char* directory);
+void SIM_TRACE_Close(void);
+void SIM_TRACE_Uart(uint8_t uart, uint8_t byte);
+void SIM_TRACE_Dac(uint16_t value);
+void SIM_TRACE_Pwm(uint8_t channel, uint8_t level);
+void SIM_TRACE_Match(uint8_t timer, uint8_t match, uint8_t level);
+void SIM_TRACE_Gpio(uint8_t port, uint32_t value);
+void SIM_TRACE_Summary(void);
+
+#endif /* SIM_H */
@@ -0,0 +1,317 @@
+/**
+ * @file sim_adc.c
+ * @brief Conversor A/D: conversiones de 65 ciclos de reloj del ADC, modo burst, inicio por software o por MAT.
+ *
+ * El valor de cada canal lo fija el guion (valor crudo de 12 bits y amplitud de ruido). El ruido sale de un
+ * generador congruencial con semilla fija, asi dos corridas con el mismo guion producen las mismas muestras.
+ * Cada conversion completa actualiza ADDRn y ADGDR (DONE, OVERRUN, canal y resultado), la linea de interrupcion y
+ * el pedido de DMA del ADC.
+ */
+
+#include "sim.h"
+
+#include "lpc17xx_adc.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+
+// Definiciones del modulo:
+#define ADC_CHANNELS     8           /**< Canales del ADC */
+#define ADC_CONV_CLOCKS  65          /**< Ciclos de reloj del ADC por conversion */
+#define ADC_MAX_VALUE    0xFFF       /**< Resultado maximo (12 bits) */
+#define ADC_DONE         (1UL << 31) /**< Conversion completa */
+#define ADC_OVERRUN      (1UL << 30) /**< Resultado anterior sobrescrito */
+#define ADC_GLOBAL_INTEN (1UL << 8)  /**< ADGINTEN: interrupcion por ADGDR */
+#define ADC_START_SHIFT  24          /**< Posicion del campo START */
+#define ADC_START_NOW    1           /**< START: conversion inmediata */
+#define ADC_START_MAT01  4           /**< START: primer modo por flanco de match */
+
+#define ADC_OFFSET(reg) offsetof(LPC_ADC_TypeDef, reg) /**< Desplazamiento de un registro del ADC */
+
+/**
+ * @brief Entrada analogica simulada de un canal.
+ */
+typedef struct
+{
+    uint16_t Value; /**< Valor crudo central */
+    uint16_t Noise; /**< Amplitud del ruido (+/-) */
+    uint32_t Seed;  /**< Estado del generador de ruido */
+} ADC_Input_Type;
+
+static ADC_Input_Type Inputs[ADC_CHANNELS]; /**< Entradas del guion */
+static uint32_t Adcr = 0;                   /**< ADCR */
+static uint32_t Inten = ADC_GLOBAL_INTEN;   /**< ADINTEN (valor de reset) */
+static uint32_t Data[ADC_CHANNELS];         /**< ADDR0-7 */
+static uint32_t Global = 0;                 /**< ADGDR */
+static uint32_t Trim = 0;                   /**< ADTRM */
+static Bool Converting = FALSE;             /**< Hay una conversion en curso */
+static uint8_t Channel = 0;                 /**< Canal de la conversion en curso */
+static uint64_t Conv_End = SIM_NEVER;       /**< Fin de la conversion en curso */
+static uint32_t Conversions = 0;            /**< Conversiones completadas */
+
+/**
+ * @brief Proximo canal seleccionado despues de 'from' (circular).
+ */
+static uint8_t ADC_NextChannel(uint8_t from)
+{
+    uint32_t sel = Adcr & 0xFF;
+
+    for (uint8_t i = 1; i <= ADC_CHANNELS; i++)
+    {
+        uint8_t ch = (uint8_t)((from + i) % ADC_CHANNELS);
+
+        if (sel & (1UL << ch))
+        {
+            return ch;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Comienza una conversion en el instante indicado.
+ */
+static void ADC_Start(uint64_t when, uint8_t channel)
+{
+    uint64_t clocks = (uint64_t)ADC_CONV_CLOCKS * (((Adcr >> 8) & 0xFF) + 1);
+
+    if ((Adcr & ADC_CR_PDN) == 0 || (Adcr & 0xFF) == 0)
+    {
+        return;
+    }
+
+    Converting = TRUE;
+    Channel = channel;
+    Conv_End = when + clocks * SIM_SC_PclkPeriod(CLKPWR_PCLKSEL_ADC);
+}
+
+/**
+ * @brief Valor convertido de un canal, con ruido.
+ */
+static uint16_t ADC_Sample(uint8_t channel)
+{
+    ADC_Input_Type* in = &Inputs[channel];
+    int32_t value = in->Value;
+
+    if (in->Noise != 0)
+    {
+        in->Seed = in->Seed * 1664525UL + 1013904223UL;
+        value += (int32_t)((in->Seed >> 16) % (2UL * in->Noise + 1)) - in->Noise;
+    }
+
+    return (uint16_t)((value < 0) ? 0 : ((value > ADC_MAX_VALUE) ? ADC_MAX_VALUE : value));
+}
+
+/**
+ * @brief Estado de la interrupcion del ADC (ADINT).
+ */
+static Bool ADC_Interrupt(void)
+{
+    for (uint8_t ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        if ((Inten & (1UL << ch)) && (Data[ch] & ADC_DONE))
+        {
+            return TRUE;
+        }
+    }
+
+    return ((Inten & ADC_GLOBAL_INTEN) && (Global & ADC_DONE)) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Actualiza la linea de interrupcion del ADC.
+ */
+static void ADC_UpdateLine(void)
+{
+    SIM_CORE_SetIRQ(ADC_IRQn, ADC_Interrupt());
+}
+
+/**
+ * @brief Completa la conversion en curso.
+ */
+static void ADC_Complete(void)
+{
+    uint32_t result = ((uint32_t)ADC_Sample(Channel) << 4) | ADC_DONE;
+
+    Converting = FALSE;
+    Conversions++;
+
+    Data[Channel] = result | ((Data[Channel] & ADC_DONE) ? ADC_OVERRUN : 0);
+    Global = result | ((uint32_t)Channel << 24) | ((Global & ADC_DONE) ? ADC_OVERRUN : 0);
+
+    // En burst la siguiente conversion arranca apenas termina la anterior.
+    if (Adcr & ADC_CR_BURST)
+    {
+        ADC_Start(Conv_End, ADC_NextChannel(Channel));
+    }
+
+    ADC_UpdateLine();
+    if (Inten & (ADC_GLOBAL_INTEN | (1UL << Channel)))
+    {
+        SIM_GPDMA_Request(GPDMA_CONN_ADC);
+    }
+}
+
+/**
+ * @brief Lleva el ADC hasta el instante indicado.
+ */
+static void ADC_Update(uint64_t now)
+{
+    while (Converting == TRUE && Conv_End <= now)
+    {
+        ADC_Complete();
+    }
+}
+
+/**
+ * @brief Instante en que termina la conversion en curso.
+ */
+static uint64_t ADC_Next(void)
+{
+    return (Converting == TRUE) ? Conv_End : SIM_NEVER;
+}
+
+/**
+ * @brief Construye el valor de ADSTAT.
+ */
+static uint32_t ADC_Status(void)
+{
+    uint32_t status = 0;
+
+    for (uint8_t ch = 0; ch < ADC_CHANNELS; ch++)
+    {
+        status |= (Data[ch] & ADC_DONE) ? (1UL << ch) : 0;
+        status |= (Data[ch] & ADC_OVERRUN) ? (1UL << (ch + 8)) : 0;
+    }
+
+    return status | ((ADC_Interrupt() == TRUE) ? (1UL << 16) : 0);
+}
+
+/**
+ * @brief Lectura de un registro del ADC.
+ */
+static uint32_t ADC_Read(uint32_t offset, SIM_Access_Type access)
+{
+    uint32_t value;
+
+    switch (offset)
+    {
+    case ADC_OFFSET(ADCR):
+        return Adcr;
+    case ADC_OFFSET(ADGDR):
+        value = Global;
+        if (access == SIM_ACCESS_READ)
+        {
+            Global &= ~(ADC_DONE | ADC_OVERRUN);
+            ADC_UpdateLine();
+        }
+        return value;
+    case ADC_OFFSET(ADINTEN):
+        return Inten;
+    case ADC_OFFSET(ADSTAT):
+        return ADC_Status();
+    case ADC_OFFSET(ADTRM):
+        return Trim;
+    default:
+        break;
+    }
+
+    if (offset >= ADC_OFFSET(ADDR0) && offset <= ADC_OFFSET(ADDR7))
+    {
+        uint8_t ch = (uint8_t)((offset - ADC_OFFSET(ADDR0)) / 4);
+
+        value = Data[ch];
+        if (access == SIM_ACCESS_READ)
+        {
+            Data[ch] &= ~(ADC_DONE | ADC_OVERRUN);
+            ADC_UpdateLine();
+        }
+        return value;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Escritura de un registro del ADC.
+ */
+static void ADC_Write(uint32_t offset, uint32_t value)
+{
+    uint32_t start;
+
+    switch (offset)
+    {
+    case ADC_OFFSET(ADCR):
+        Adcr = value;
+        start = (Adcr >> ADC_START_SHIFT) & 0x7;
+
+        if ((Adcr & ADC_CR_PDN) == 0)
+        {
+            Converting = FALSE;
+        }
+        else if (Converting == FALSE && ((Adcr & ADC_CR_BURST) || start == ADC_START_NOW))
+        {
+            ADC_Start(SIM_Now, ADC_NextChannel(ADC_CHANNELS - 1));
+        }
+        return;
+    case ADC_OFFSET(ADINTEN):
+        Inten = value & 0x1FF;
+        ADC_UpdateLine();
+        return;
+    case ADC_OFFSET(ADTRM):
+        Trim = value;
+        return;
+    default:
+        return;
+    }
+}
+
+static const SIM_Device_Type Adc_Device = {
+    .Name = "ADC",
+    .Base = LPC_ADC_BASE,
+    .Size = sizeof(LPC_ADC_TypeDef),
+    .Read = ADC_Read,
+    .Write = ADC_Write,
+    .Update = ADC_Update,
+    .Next = ADC_Next,
+};
+
+void SIM_ADC_Init(void)
+{
+    SIM_CORE_Register(&Adc_Device);
+}
+
+void SIM_ADC_SetInput(uint8_t channel, uint16_t value, uint16_t noise, uint32_t seed)
+{
+    if (channel >= ADC_CHANNELS)
+    {
+        return;
+    }
+
+    Inputs[channel].Value = (value > ADC_MAX_VALUE) ? ADC_MAX_VALUE : value;
+    Inputs[channel].Noise = noise;
+    Inputs[channel].Seed = seed + channel;
+}
+
+void SIM_ADC_MatchEdge(uint8_t timer, uint8_t match, uint8_t level)
+{
+    // START 100-111: MAT0.1, MAT0.3, MAT1.0 y MAT1.1; EDGE elige el flanco (0 = ascendente).
+    static const uint8_t sources[4][2] = {{0, 1}, {0, 3}, {1, 0}, {1, 1}};
+    uint32_t start = (Adcr >> ADC_START_SHIFT) & 0x7;
+    uint8_t wanted = (Adcr & ADC_CR_EDGE) ? 0 : 1;
+
+    if (start < ADC_START_MAT01 || Converting == TRUE || (Adcr & ADC_CR_BURST) || level != wanted)
+    {
+        return;
+    }
+
+    if (sources[start - ADC_START_MAT01][0] == timer && sources[start - ADC_START_MAT01][1] == match)
+    {
+        ADC_Start(SIM_Now, ADC_NextChannel(ADC_CHANNELS - 1));
+    }
+}
+
+uint32_t SIM_ADC_GetConversions(void)
+{
+    return Conversions;
+}
@@ -0,0 +1,387 @@
+/**
+ * @file sim_bus.c
+ * @brief Mapa de registros simulado y captura de los accesos del firmware.
+ *
+ * Cada bus de perifericos se mapea en su direccion real del LPC1769 (el ejecutable se enlaza sin PIE, asi que esas
+ * direcciones estan libres) y queda sin permisos de acceso. Cuando el firmware lee o escribe un registro se produce
+ * un SIGSEGV: el manejador obtiene la direccion, carga en la pagina el valor que devuelve el periferico simulado,
+ * habilita el acceso y ejecuta una sola instruccion en modo paso a paso (bandera TF). En el SIGTRAP siguiente se
+ * entrega al periferico el valor escrito y la pagina vuelve a protegerse.
+ *
+ * Asi los drivers lpc17xx_* se ejecutan sin cambios, con las semanticas reales de cada registro: escritura con 1
+ * para borrar, FIFOs que se vacian al leer, registros que comparten direccion, etc. El mecanismo depende de Linux
+ * sobre x86-64 (codigo de error del fallo de pagina y bandera de traza de EFLAGS).
+ *
+ * El alias de bit-band del GPIO (region de SRAM del Cortex-M3) se mapea igual: cada palabra del alias lee un bit de
+ * la palabra del GPIO, y escribirla lee la palabra, cambia el bit y la vuelve a escribir, como el bus del nucleo.
+ */
+
+#define _GNU_SOURCE
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "sim.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+#error "El simulador requiere Linux sobre x86-64"
+#endif
+
+// Definiciones del modulo:
+#define BUS_PAGE_SIZE   4096    /**< Tamaño de pagina del host */
+#define BUS_GPIO_SIZE   0x4000  /**< GPIO de acceso rapido (0x2009C000) */
+#define BUS_APB_SIZE    0x80000 /**< Cada bus APB (0x40000000 y 0x40080000) */
+#define BUS_AHB_SIZE    0x10000 /**< Perifericos AHB (0x50000000) */
+#define BUS_PPB_SIZE    0x3000  /**< ITM, DWT y FPB (0xE0000000) */
+#define BUS_SCS_SIZE    0x1000  /**< System Control Space (0xE000E000) */
+#define BUS_MAX_DEVICES 32      /**< Perifericos modelados */
+#define BUS_TRAP_FLAG   0x100   /**< Bandera TF de EFLAGS: excepcion tras cada instruccion */
+#define BUS_FAULT_WRITE 0x2     /**< Bit del codigo de error del fallo de pagina: acceso de escritura */
+
+#define BUS_SRAM_BASE  0x20000000UL                                             /**< Region de SRAM con bit-band */
+#define BUS_ALIAS_BASE 0x22000000UL                                             /**< Su alias de bit-band */
+#define BUS_GPIO_ALIAS (BUS_ALIAS_BASE + (LPC_GPIO_BASE - BUS_SRAM_BASE) * 32) /**< Alias del GPIO (0x23380000) */
+
+/**
+ * @brief Rango de direcciones simulado; los registros sin modelo se guardan en Store.
+ */
+typedef struct
+{
+    uintptr_t Base;  /**< Direccion de las paginas protegidas que ve el firmware */
+    uint32_t Size;   /**< Tamaño del rango */
+    uint32_t* Store; /**< Valor de los registros sin periferico modelado */
+} BUS_Region_Type;
+
+/**
+ * @brief Acceso del firmware en curso, entre el SIGSEGV y el SIGTRAP.
+ */
+typedef struct
+{
+    Bool Active;             /**< Hay una instruccion ejecutandose paso a paso */
+    Bool Write;              /**< La instruccion escribe el registro */
+    uintptr_t Word;          /**< Direccion de la palabra accedida */
+    BUS_Region_Type* Region; /**< Rango que contiene la palabra */
+} BUS_Pending_Type;
+
+static BUS_Region_Type Regions[] = {
+    {LPC_GPIO_BASE, BUS_GPIO_SIZE, NULL}, {LPC_APB0_BASE, BUS_APB_SIZE, NULL}, {LPC_APB1_BASE, BUS_APB_SIZE, NULL},
+    {LPC_AHB_BASE, BUS_AHB_SIZE, NULL},   {LPC_CM3_BASE, BUS_PPB_SIZE, NULL},  {SCS_BASE, BUS_SCS_SIZE, NULL},
+    {BUS_GPIO_ALIAS, BUS_GPIO_SIZE * 32, NULL},
+};
+
+static const SIM_Device_Type* Devices[BUS_MAX_DEVICES]; /**< Perifericos modelados */
+static uint8_t Device_Count = 0;                        /**< Cantidad de perifericos modelados */
+static BUS_Pending_Type Pending;                        /**< Acceso del firmware en curso */
+
+// Limites de la imagen del programa, provistos por el enlazador:
+extern char __executable_start[];
+extern char end[];
+
+/**
+ * @brief Busca el rango simulado que contiene una direccion.
+ *
+ * @param address Direccion a buscar.
+ * @return Rango que la contiene, o NULL si no pertenece al mapa simulado.
+ */
+static BUS_Region_Type* BUS_FindRegion(uintptr_t address)
+{
+    for (uint8_t i = 0; i < sizeof(Regions) / sizeof(Regions[0]); i++)
+    {
+        if (address >= Regions[i].Base && address < Regions[i].Base + Regions[i].Size)
+        {
+            return &Regions[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Busca el periferico modelado que contiene una direccion.
+ *
+ * @param address Direccion a buscar.
+ * @return Periferico, o NULL si la direccion no tiene modelo.
+ */
+static const SIM_Device_Type* BUS_FindDevice(uintptr_t address)
+{
+    for (uint8_t i = 0; i < Device_Count; i++)
+    {
+        if (address >= Devices[i]->Base && address < Devices[i]->Base + Devices[i]->Size)
+        {
+            return Devices[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Obtiene el valor de una palabra del mapa simulado.
+ *
+ * @param region Rango que contiene la palabra.
+ * @param word Direccion de la palabra (alineada a 4).
+ * @param access Lectura con efectos laterales o valor previo a una escritura.
+ * @return Valor de la palabra.
+ */
+static uint32_t BUS_Load(BUS_Region_Type* region, uintptr_t word, SIM_Access_Type access)
+{
+    const SIM_Device_Type* device = BUS_FindDevice(word);
+
+    if (device != NULL)
+    {
+        return device->Read((uint32_t)(word - device->Base), access);
+    }
+
+    return region->Store[(word - region->Base) / 4];
+}
+
+/**
+ * @brief Entrega una palabra escrita al periferico correspondiente.
+ *
+ * @param region Rango que contiene la palabra.
+ * @param word Direccion de la palabra (alineada a 4).
+ * @param value Valor escrito.
+ */
+static void BUS_Store(BUS_Region_Type* region, uintptr_t word, uint32_t value)
+{
+    const SIM_Device_Type* device = BUS_FindDevice(word);
+
+    if (device != NULL)
+    {
+        device->Write((uint32_t)(word - device->Base), value);
+    }
+    else
+    {
+        region->Store[(word - region->Base) / 4] = value;
+    }
+}
+
+/**
+ * @brief Lectura de una palabra del alias de bit-band del GPIO: el bit que representa.
+ */
+static uint32_t BUS_BitbandRead(uint32_t offset, SIM_Access_Type access)
+{
+    uintptr_t word = LPC_GPIO_BASE + (offset / 128) * 4;
+
+    return (BUS_Load(BUS_FindRegion(word), word, access) >> ((offset / 4) % 32)) & 1;
+}
+
+/**
+ * @brief Escritura de una palabra del alias de bit-band del GPIO: lectura, cambio del bit y escritura de la palabra.
+ */
+static void BUS_BitbandWrite(uint32_t offset, uint32_t value)
+{
+    uintptr_t word = LPC_GPIO_BASE + (offset / 128) * 4;
+    uint32_t bit = 1UL << ((offset / 4) % 32);
+    uint32_t current = BUS_Load(BUS_FindRegion(word), word, SIM_ACCESS_READ);
+
+    BUS_Store(BUS_FindRegion(word), word, (value & 1) ? (current | bit) : (current & ~bit));
+}
+
+static const SIM_Device_Type Bitband_Device = {
+    .Name = "BITBAND",
+    .Base = BUS_GPIO_ALIAS,
+    .Size = BUS_GPIO_SIZE * 32,
+    .Read = BUS_BitbandRead,
+    .Write = BUS_BitbandWrite,
+    .Update = NULL,
+    .Next = NULL,
+};
+
+/**
+ * @brief Cambia los permisos de la pagina que contiene una direccion.
+ *
+ * @param address Direccion dentro de la pagina.
+ * @param protection Permisos de mprotect().
+ */
+static void BUS_Protect(uintptr_t address, int protection)
+{
+    mprotect((void*)(address & ~(uintptr_t)(BUS_PAGE_SIZE - 1)), BUS_PAGE_SIZE, protection);
+}
+
+/**
+ * @brief Manejador de SIGSEGV: comienzo de un acceso del firmware a un registro.
+ *
+ * Una instruccion de lectura-modificacion-escritura falla primero como lectura (se habilita solo la lectura) y
+ * luego como escritura; en ese caso la instruccion se reejecuta completa sobre el valor previo a la escritura.
+ */
+static void BUS_Fault(int signal_number, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = (ucontext_t*)context;
+    uintptr_t address = (uintptr_t)info->si_addr;
+    BUS_Region_Type* region = BUS_FindRegion(address);
+    uintptr_t word = address & ~(uintptr_t)3;
+
+    (void)signal_number;
+
+    if (region == NULL)
+    {
+        // Fallo real del firmware: se restaura el comportamiento por defecto y la instruccion vuelve a fallar.
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+
+    Pending.Active = TRUE;
+    Pending.Word = word;
+    Pending.Region = region;
+
+    if (uc->uc_mcontext.gregs[REG_ERR] & BUS_FAULT_WRITE)
+    {
+        Pending.Write = TRUE;
+        BUS_Protect(word, PROT_READ | PROT_WRITE);
+        *(volatile uint32_t*)word = BUS_Load(region, word, SIM_ACCESS_PREFILL);
+    }
+    else
+    {
+        Pending.Write = FALSE;
+        BUS_Protect(word, PROT_READ | PROT_WRITE);
+        *(volatile uint32_t*)word = BUS_Load(region, word, SIM_ACCESS_READ);
+        BUS_Protect(word, PROT_READ);
+    }
+
+    uc->uc_mcontext.gregs[REG_EFL] |= BUS_TRAP_FLAG;
+}
+
+/**
+ * @brief Manejador de SIGTRAP: fin de la instruccion que accedio al registro.
+ */
+static void BUS_Step(int signal_number, siginfo_t* info, void* context)
+{
+    ucontext_t* uc = (ucontext_t*)context;
+
+    (void)signal_number;
+    (void)info;
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~BUS_TRAP_FLAG;
+
+    if (Pending.Active == FALSE)
+    {
+        return;
+    }
+
+    if (Pending.Write == TRUE)
+    {
+        BUS_Store(Pending.Region, Pending.Word, *(volatile uint32_t*)Pending.Word);
+    }
+    BUS_Protect(Pending.Word, PROT_NONE);
+    Pending.Active = FALSE;
+
+    // El acceso consume tiempo del bus; los perifericos avanzan hasta el final del acceso.
+    SIM_CORE_Access();
+}
+
+void SIM_BUS_Init(void)
+{
+    struct sigaction action;
+
+    for (uint8_t i = 0; i < sizeof(Regions) / sizeof(Regions[0]); i++)
+    {
+        void* pages = mmap((void*)Regions[i].Base, Regions[i].Size, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+        Regions[i].Store = calloc(Regions[i].Size / 4, sizeof(uint32_t));
+        if (Regions[i].Store == NULL || pages != (void*)Regions[i].Base)
+        {
+            perror("sim: mapa de registros");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+
+    action.sa_sigaction = BUS_Fault;
+    sigaction(SIGSEGV, &action, NULL);
+
+    action.sa_sigaction = BUS_Step;
+    sigaction(SIGTRAP, &action, NULL);
+
+    SIM_BUS_Attach(&Bitband_Device);
+}
+
+void SIM_BUS_Attach(const SIM_Device_Type* device)
+{
+    if (Device_Count >= BUS_MAX_DEVICES)
+    {
+        fprintf(stderr, "sim: demasiados perifericos (%s)\n", device->Name);
+        exit(EXIT_FAILURE);
+    }
+
+    Devices[Device_Count++] = device;
+}
+
+Bool SIM_BUS_Read(uint32_t address, uint8_t width, uint32_t* value)
+{
+    BUS_Region_Type* region = BUS_FindRegion(address);
+    uint32_t word;
+
+    if (region != NULL)
+    {
+        word = BUS_Load(region, address & ~3U, SIM_ACCESS_READ);
+        word >>= 8 * (address & 3);
+        *value = (width >= 4) ? word : (word & ((1UL << (8 * width)) - 1));
+        return TRUE;
+    }
+
+    if (SIM_BUS_IsMemory(address, width) == FALSE)
+    {
+        return FALSE;
+    }
+
+    *value = 0;
+    memcpy(value, (const void*)(uintptr_t)address, width);
+    return TRUE;
+}
+
+Bool SIM_BUS_Write(uint32_t address, uint8_t width, uint32_t value)
+{
+    BUS_Region_Type* region = BUS_FindRegion(address);
+    uint32_t shift = 8 * (address & 3);
+    uint32_t mask;
+    uint32_t word;
+
+    if (region != NULL)
+    {
+        mask = ((width >= 4) ? 0xFFFFFFFFUL : ((1UL << (8 * width)) - 1)) << shift;
+        word = BUS_Load(region, address & ~3U, SIM_ACCESS_PREFILL);
+        BUS_Store(region, address & ~3U, (word & ~mask) | ((value << shift) & mask));
+        return TRUE;
+    }
+
+    if (SIM_BUS_IsMemory(address, width) == FALSE)
+    {
+        return FALSE;
+    }
+
+    memcpy((void*)(uintptr_t)address, &value, width);
+    return TRUE;
+}
+
+uint32_t SIM_BUS_Peek(uintptr_t address)
+{
+    BUS_Region_Type* region = BUS_FindRegion(address);
+
+    if (region == NULL)
+    {
+        return 0;
+    }
+
+    return BUS_Load(region, address & ~(uintptr_t)3, SIM_ACCESS_PREFILL);
+}
+
+Bool SIM_BUS_IsMemory(uint32_t address, uint32_t length)
+{
+    // Solo la imagen del firmware (codigo, constantes y variables estaticas) es accesible por el GPDMA.
+    if (BUS_FindRegion(address) != NULL)
+    {
+        return FALSE;
+    }
+
+    return (address >= (uintptr_t)__executable_start && (uintptr_t)address + length <= (uintptr_t)end) ? TRUE
+                                                                                                       : FALSE;
+}
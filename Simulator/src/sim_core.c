@@ -0,0 +1,869 @@
+/**
+ * @file sim_core.c
+ * @brief Tiempo virtual, planificador de eventos y modelo del nucleo Cortex-M3 (NVIC, SCB y SysTick).
+ *
+ * El codigo del firmware no consume tiempo por si mismo: el reloj virtual avanza un costo fijo por cada acceso a
+ * un registro y salta directamente al proximo evento de los perifericos cuando el nucleo ejecuta WFI. Las
+ * interrupciones se atienden en los puntos donde el firmware podria ser interrumpido de forma observable: al
+ * despertar de WFI y al desenmascararlas (__enable_irq, __set_PRIMASK, __set_BASEPRI). La prioridad, el
+ * anidamiento y el encadenamiento siguen las reglas del NVIC.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sim.h"
+
+// Definiciones del modulo:
+#define CORE_MAX_DEVICES   32                   /**< Perifericos con comportamiento temporal */
+#define CORE_VECTORS       (16 + SIM_IRQ_COUNT) /**< Entradas de la tabla de vectores */
+#define CORE_THREAD_PRIO   0x100                /**< Prioridad de ejecucion en modo thread */
+#define CORE_PRIO_MASK     0xF8                 /**< Bits de prioridad implementados en el LPC17xx */
+#define CORE_ENTRY_CYCLES  12                   /**< Ciclos de entrada a una excepcion */
+#define CORE_EXIT_CYCLES   12                   /**< Ciclos de retorno de una excepcion */
+#define CORE_MAX_NESTING   16                   /**< Anidamiento maximo de excepciones */
+#define CORE_SYSTICK_CALIB 0x000F423FUL         /**< Valor de SysTick->CALIB del LPC17xx (10 ms a 100 MHz) */
+#define CORE_CPUID         0x412FC230UL         /**< Cortex-M3 r2p0 */
+
+// Desplazamientos dentro del SCS:
+#define SCS_SYST_CSR   0x010 /**< SysTick->CTRL */
+#define SCS_SYST_RVR   0x014 /**< SysTick->LOAD */
+#define SCS_SYST_CVR   0x018 /**< SysTick->VAL */
+#define SCS_SYST_CALIB 0x01C /**< SysTick->CALIB */
+#define SCS_ISER       0x100 /**< NVIC->ISER[0] */
+#define SCS_ICER       0x180 /**< NVIC->ICER[0] */
+#define SCS_ISPR       0x200 /**< NVIC->ISPR[0] */
+#define SCS_ICPR       0x280 /**< NVIC->ICPR[0] */
+#define SCS_IABR       0x300 /**< NVIC->IABR[0] */
+#define SCS_IP         0x400 /**< NVIC->IP[0] */
+#define SCS_CPUID      0xD00 /**< SCB->CPUID */
+#define SCS_ICSR       0xD04 /**< SCB->ICSR */
+#define SCS_AIRCR      0xD0C /**< SCB->AIRCR */
+#define SCS_SHP        0xD18 /**< SCB->SHP[0] */
+#define SCS_DEMCR      0xDFC /**< CoreDebug->DEMCR */
+#define SCS_STIR       0xF00 /**< NVIC->STIR */
+
+#define SYST_ENABLE    (1UL << 0)  /**< SysTick habilitado */
+#define SYST_TICKINT   (1UL << 1)  /**< Interrupcion al llegar a cero */
+#define SYST_COUNTFLAG (1UL << 16) /**< Llego a cero desde la ultima lectura */
+
+#define DWT_BASE       (LPC_CM3_BASE + 0x1000UL) /**< DWT dentro del bus privado */
+#define DWT_CTRL       0x000                     /**< DWT->CTRL */
+#define DWT_CYCCNT     0x004                     /**< DWT->CYCCNT */
+#define DWT_CYCCNTENA  (1UL << 0)                /**< Contador de ciclos habilitado */
+#define DWT_CTRL_RESET 0x40000000UL              /**< NUMCOMP = 4 comparadores */
+
+/** Vector de una excepcion a partir de su numero de IRQ de CMSIS */
+#define CORE_VECTOR_OF(irqn) ((uint32_t)(16 + (irqn)))
+
+/** Entrada de la tabla de vectores */
+#define CORE_HANDLER(name) {#name, name}
+
+/**
+ * @brief Entrada de la tabla de vectores.
+ */
+typedef struct
+{
+    const char* Name;      /**< Nombre del handler */
+    void (*Handler)(void); /**< Handler del firmware, NULL si no esta definido */
+} CORE_Vector_Type;
+
+// Handlers del firmware: se declaran debiles para que los no definidos resuelvan a NULL.
+#define CORE_WEAK __attribute__((weak))
+extern void PendSV_Handler(void) CORE_WEAK;
+extern void SysTick_Handler(void) CORE_WEAK;
+extern void WDT_IRQHandler(void) CORE_WEAK;
+extern void TIMER0_IRQHandler(void) CORE_WEAK;
+extern void TIMER1_IRQHandler(void) CORE_WEAK;
+extern void TIMER2_IRQHandler(void) CORE_WEAK;
+extern void TIMER3_IRQHandler(void) CORE_WEAK;
+extern void UART0_IRQHandler(void) CORE_WEAK;
+extern void UART1_IRQHandler(void) CORE_WEAK;
+extern void UART2_IRQHandler(void) CORE_WEAK;
+extern void UART3_IRQHandler(void) CORE_WEAK;
+extern void PWM1_IRQHandler(void) CORE_WEAK;
+extern void I2C0_IRQHandler(void) CORE_WEAK;
+extern void I2C1_IRQHandler(void) CORE_WEAK;
+extern void I2C2_IRQHandler(void) CORE_WEAK;
+extern void SPI_IRQHandler(void) CORE_WEAK;
+extern void SSP0_IRQHandler(void) CORE_WEAK;
+extern void SSP1_IRQHandler(void) CORE_WEAK;
+extern void PLL0_IRQHandler(void) CORE_WEAK;
+extern void RTC_IRQHandler(void) CORE_WEAK;
+extern void EINT0_IRQHandler(void) CORE_WEAK;
+extern void EINT1_IRQHandler(void) CORE_WEAK;
+extern void EINT2_IRQHandler(void) CORE_WEAK;
+extern void EINT3_IRQHandler(void) CORE_WEAK;
+extern void ADC_IRQHandler(void) CORE_WEAK;
+extern void BOD_IRQHandler(void) CORE_WEAK;
+extern void USB_IRQHandler(void) CORE_WEAK;
+extern void CAN_IRQHandler(void) CORE_WEAK;
+extern void DMA_IRQHandler(void) CORE_WEAK;
+extern void I2S_IRQHandler(void) CORE_WEAK;
+extern void ENET_IRQHandler(void) CORE_WEAK;
+extern void RIT_IRQHandler(void) CORE_WEAK;
+extern void MCPWM_IRQHandler(void) CORE_WEAK;
+extern void QEI_IRQHandler(void) CORE_WEAK;
+extern void PLL1_IRQHandler(void) CORE_WEAK;
+
+static const CORE_Vector_Type Vectors[CORE_VECTORS] = {
+    [CORE_VECTOR_OF(PendSV_IRQn)] = CORE_HANDLER(PendSV_Handler),
+    [CORE_VECTOR_OF(SysTick_IRQn)] = CORE_HANDLER(SysTick_Handler),
+    [CORE_VECTOR_OF(WDT_IRQn)] = CORE_HANDLER(WDT_IRQHandler),
+    [CORE_VECTOR_OF(TIMER0_IRQn)] = CORE_HANDLER(TIMER0_IRQHandler),
+    [CORE_VECTOR_OF(TIMER1_IRQn)] = CORE_HANDLER(TIMER1_IRQHandler),
+    [CORE_VECTOR_OF(TIMER2_IRQn)] = CORE_HANDLER(TIMER2_IRQHandler),
+    [CORE_VECTOR_OF(TIMER3_IRQn)] = CORE_HANDLER(TIMER3_IRQHandler),
+    [CORE_VECTOR_OF(UART0_IRQn)] = CORE_HANDLER(UART0_IRQHandler),
+    [CORE_VECTOR_OF(UART1_IRQn)] = CORE_HANDLER(UART1_IRQHandler),
+    [CORE_VECTOR_OF(UART2_IRQn)] = CORE_HANDLER(UART2_IRQHandler),
+    [CORE_VECTOR_OF(UART3_IRQn)] = CORE_HANDLER(UART3_IRQHandler),
+    [CORE_VECTOR_OF(PWM1_IRQn)] = CORE_HANDLER(PWM1_IRQHandler),
+    [CORE_VECTOR_OF(I2C0_IRQn)] = CORE_HANDLER(I2C0_IRQHandler),
+    [CORE_VECTOR_OF(I2C1_IRQn)] = CORE_HANDLER(I2C1_IRQHandler),
+    [CORE_VECTOR_OF(I2C2_IRQn)] = CORE_HANDLER(I2C2_IRQHandler),
+    [CORE_VECTOR_OF(SPI_IRQn)] = CORE_HANDLER(SPI_IRQHandler),
+    [CORE_VECTOR_OF(SSP0_IRQn)] = CORE_HANDLER(SSP0_IRQHandler),
+    [CORE_VECTOR_OF(SSP1_IRQn)] = CORE_HANDLER(SSP1_IRQHandler),
+    [CORE_VECTOR_OF(PLL0_IRQn)] = CORE_HANDLER(PLL0_IRQHandler),
+    [CORE_VECTOR_OF(RTC_IRQn)] = CORE_HANDLER(RTC_IRQHandler),
+    [CORE_VECTOR_OF(EINT0_IRQn)] = CORE_HANDLER(EINT0_IRQHandler),
+    [CORE_VECTOR_OF(EINT1_IRQn)] = CORE_HANDLER(EINT1_IRQHandler),
+    [CORE_VECTOR_OF(EINT2_IRQn)] = CORE_HANDLER(EINT2_IRQHandler),
+    [CORE_VECTOR_OF(EINT3_IRQn)] = CORE_HANDLER(EINT3_IRQHandler),
+    [CORE_VECTOR_OF(ADC_IRQn)] = CORE_HANDLER(ADC_IRQHandler),
+    [CORE_VECTOR_OF(BOD_IRQn)] = CORE_HANDLER(BOD_IRQHandler),
+    [CORE_VECTOR_OF(USB_IRQn)] = CORE_HANDLER(USB_IRQHandler),
+    [CORE_VECTOR_OF(CAN_IRQn)] = CORE_HANDLER(CAN_IRQHandler),
+    [CORE_VECTOR_OF(DMA_IRQn)] = CORE_HANDLER(DMA_IRQHandler),
+    [CORE_VECTOR_OF(I2S_IRQn)] = CORE_HANDLER(I2S_IRQHandler),
+    [CORE_VECTOR_OF(ENET_IRQn)] = CORE_HANDLER(ENET_IRQHandler),
+    [CORE_VECTOR_OF(RIT_IRQn)] = CORE_HANDLER(RIT_IRQHandler),
+    [CORE_VECTOR_OF(MCPWM_IRQn)] = CORE_HANDLER(MCPWM_IRQHandler),
+    [CORE_VECTOR_OF(QEI_IRQn)] = CORE_HANDLER(QEI_IRQHandler),
+    [CORE_VECTOR_OF(PLL1_IRQn)] = CORE_HANDLER(PLL1_IRQHandler),
+};
+
+uint64_t SIM_Now = 0; /**< Tiempo virtual en picosegundos */
+
+static uint64_t End_Time = SIM_NEVER;                    /**< Fin de la simulacion */
+static uint32_t Access_Cycles = 4;                       /**< Ciclos de CCLK por acceso a un registro */
+static const SIM_Device_Type* Clocked[CORE_MAX_DEVICES]; /**< Perifericos con eventos temporizados */
+static uint8_t Clocked_Count = 0;                        /**< Cantidad de perifericos temporizados */
+
+// Estado de las excepciones (un bit por numero de vector):
+static uint64_t Enabled = 0;             /**< Habilitadas en el NVIC */
+static uint64_t Latched = 0;             /**< Pendientes por flanco o por software */
+static uint64_t Line = 0;                /**< Lineas de interrupcion por nivel de los perifericos */
+static uint64_t Active = 0;              /**< En ejecucion o desalojadas */
+static uint32_t Primask = 0;             /**< PRIMASK */
+static uint32_t Faultmask = 0;           /**< FAULTMASK */
+static uint32_t Basepri = 0;             /**< BASEPRI */
+static uint32_t Stack[CORE_MAX_NESTING]; /**< Vectores en ejecucion, del mas externo al actual */
+static uint8_t Depth = 0;                /**< Nivel de anidamiento actual */
+
+// Registros del SCS sin modelo especifico (prioridades, AIRCR, SCR, etc.):
+static uint32_t Scs_Store[0x1000 / 4];
+
+// SysTick:
+static uint32_t Systick_Ctrl = 0; /**< SysTick->CTRL */
+static uint32_t Systick_Load = 0; /**< SysTick->LOAD */
+static uint32_t Systick_Val = 0;  /**< SysTick->VAL */
+static uint64_t Systick_Edge = 0; /**< Ultimo flanco de CCLK contabilizado */
+
+// DWT:
+static uint32_t Dwt_Ctrl = DWT_CTRL_RESET; /**< DWT->CTRL */
+static uint32_t Dwt_Cyccnt = 0;            /**< DWT->CYCCNT */
+static uint64_t Dwt_Edge = 0;              /**< Ultimo flanco de CCLK contabilizado */
+static Bool Sleeping = FALSE;              /**< El nucleo esta detenido en WFI */
+
+// Estadisticas:
+static uint64_t Sleep_Time = 0;      /**< Tiempo dormido en WFI */
+static uint32_t Taken[CORE_VECTORS]; /**< Veces que se atendio cada excepcion */
+static uint64_t Accesses = 0;        /**< Accesos del firmware a registros */
+
+/**
+ * @brief Mascara de un vector.
+ */
+static inline uint64_t CORE_Bit(uint32_t vector)
+{
+    return 1ULL << vector;
+}
+
+/**
+ * @brief Prioridad configurada de un vector (bits implementados).
+ */
+static uint32_t CORE_Priority(uint32_t vector)
+{
+    const uint8_t* bytes = (const uint8_t*)Scs_Store;
+
+    if (vector >= 16)
+    {
+        return bytes[SCS_IP + vector - 16];
+    }
+
+    return bytes[SCS_SHP + vector - 4];
+}
+
+/**
+ * @brief Prioridad de grupo (la que decide el desalojo) de un valor de prioridad.
+ */
+static uint32_t CORE_Group(uint32_t priority)
+{
+    uint32_t prigroup = (Scs_Store[SCS_AIRCR / 4] & SCB_AIRCR_PRIGROUP_Msk) >> SCB_AIRCR_PRIGROUP_Pos;
+
+    return priority >> (prigroup + 1);
+}
+
+/**
+ * @brief Prioridad de ejecucion actual, sin considerar PRIMASK.
+ */
+static uint32_t CORE_RunningPriority(void)
+{
+    uint32_t running = CORE_THREAD_PRIO;
+
+    for (uint8_t i = 0; i < Depth; i++)
+    {
+        if (CORE_Group(CORE_Priority(Stack[i])) < running)
+        {
+            running = CORE_Group(CORE_Priority(Stack[i]));
+        }
+    }
+
+    if (Basepri != 0 && CORE_Group(Basepri) < running)
+    {
+        running = CORE_Group(Basepri);
+    }
+
+    return running;
+}
+
+/**
+ * @brief Excepciones pendientes: las retenidas mas las lineas por nivel que no estan activas.
+ */
+static uint64_t CORE_PendingMask(void)
+{
+    return Latched | (Line & ~Active);
+}
+
+/**
+ * @brief Vector pendiente y habilitado de mayor prioridad.
+ *
+ * @return Numero de vector, o 0 si no hay ninguno.
+ */
+static uint32_t CORE_HighestPending(void)
+{
+    uint64_t pending = CORE_PendingMask() & Enabled;
+    uint32_t best = 0;
+
+    for (uint32_t vector = 0; vector < CORE_VECTORS; vector++)
+    {
+        if ((pending & CORE_Bit(vector)) && (best == 0 || CORE_Priority(vector) < CORE_Priority(best)))
+        {
+            best = vector;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Indica si la excepcion pendiente de mayor prioridad puede desalojar a la ejecucion actual.
+ *
+ * @param ignore_primask TRUE para la condicion de despertar de WFI, que no considera PRIMASK.
+ * @return Vector a atender, o 0 si no corresponde atender ninguno.
+ */
+static uint32_t CORE_Preemptor(Bool ignore_primask)
+{
+    uint32_t vector = CORE_HighestPending();
+
+    if (vector == 0 || (Primask != 0 && ignore_primask == FALSE))
+    {
+        return 0;
+    }
+
+    return (CORE_Group(CORE_Priority(vector)) < CORE_RunningPriority()) ? vector : 0;
+}
+
+/**
+ * @brief Ejecuta el handler de una excepcion con el costo de entrada y salida.
+ */
+static void CORE_Enter(uint32_t vector)
+{
+    if (Vectors[vector].Handler == NULL)
+    {
+        SIM_CORE_Fail("excepcion %u habilitada sin handler en el firmware", vector);
+    }
+    if (Depth >= CORE_MAX_NESTING)
+    {
+        SIM_CORE_Fail("anidamiento de excepciones excesivo en %s", Vectors[vector].Name);
+    }
+
+    Latched &= ~CORE_Bit(vector);
+    Active |= CORE_Bit(vector);
+    Stack[Depth++] = vector;
+    Taken[vector]++;
+
+    SIM_CORE_Advance(SIM_Now + SIM_CORE_CyclesToPs(CORE_ENTRY_CYCLES));
+    Vectors[vector].Handler();
+    SIM_CORE_Advance(SIM_Now + SIM_CORE_CyclesToPs(CORE_EXIT_CYCLES));
+
+    Depth--;
+    Active &= ~CORE_Bit(vector);
+}
+
+/**
+ * @brief Atiende todas las excepciones que corresponde (desalojo y encadenamiento).
+ */
+static void CORE_TakeInterrupts(void)
+{
+    uint32_t vector;
+
+    while ((vector = CORE_Preemptor(FALSE)) != 0)
+    {
+        CORE_Enter(vector);
+    }
+}
+
+/**
+ * @brief Lleva el SysTick hasta el instante indicado.
+ */
+static void SYSTICK_Update(uint64_t now)
+{
+    uint64_t period = SIM_SC_CclkPeriod();
+    uint64_t edges = (now - Systick_Edge) / period;
+    uint64_t events = 0;
+
+    Systick_Edge += edges * period;
+    if ((Systick_Ctrl & SYST_ENABLE) == 0 || edges == 0)
+    {
+        return;
+    }
+
+    if (Systick_Val > 0 && edges < Systick_Val)
+    {
+        Systick_Val -= (uint32_t)edges;
+        return;
+    }
+
+    if (Systick_Val > 0)
+    {
+        edges -= Systick_Val;
+        Systick_Val = 0;
+        events = 1;
+    }
+
+    // Desde cero: el primer flanco recarga LOAD y cada LOAD + 1 flancos vuelve a llegar a cero.
+    if (Systick_Load != 0 && edges > 0)
+    {
+        events += edges / ((uint64_t)Systick_Load + 1);
+        edges %= (uint64_t)Systick_Load + 1;
+        Systick_Val = (edges == 0) ? 0 : (uint32_t)(Systick_Load + 1 - edges);
+    }
+
+    if (events > 0)
+    {
+        Systick_Ctrl |= SYST_COUNTFLAG;
+        if (Systick_Ctrl & SYST_TICKINT)
+        {
+            SIM_CORE_PendIRQ(SysTick_IRQn);
+        }
+    }
+}
+
+/**
+ * @brief Instante en que el SysTick vuelve a llegar a cero.
+ */
+static uint64_t SYSTICK_Next(void)
+{
+    uint64_t edges;
+
+    if ((Systick_Ctrl & SYST_ENABLE) == 0 || (Systick_Val == 0 && Systick_Load == 0))
+    {
+        return SIM_NEVER;
+    }
+
+    edges = (Systick_Val > 0) ? Systick_Val : (uint64_t)Systick_Load + 1;
+    return Systick_Edge + edges * SIM_SC_CclkPeriod();
+}
+
+/**
+ * @brief Lleva el contador de ciclos del DWT hasta el instante indicado.
+ *
+ * Cuenta solo con TRCENA y CYCCNTENA activos y se detiene mientras el nucleo duerme, como el reloj del nucleo.
+ */
+static void DWT_Update(uint64_t now)
+{
+    uint64_t period = SIM_SC_CclkPeriod();
+    uint64_t edges = (now - Dwt_Edge) / period;
+
+    Dwt_Edge += edges * period;
+    if ((Dwt_Ctrl & DWT_CYCCNTENA) && (Scs_Store[SCS_DEMCR / 4] & CoreDebug_DEMCR_TRCENA_Msk) && Sleeping == FALSE)
+    {
+        Dwt_Cyccnt += (uint32_t)edges;
+    }
+}
+
+/**
+ * @brief Lectura de un registro del DWT.
+ */
+static uint32_t DWT_Read(uint32_t offset, SIM_Access_Type access)
+{
+    (void)access;
+
+    switch (offset)
+    {
+    case DWT_CTRL:
+        return Dwt_Ctrl;
+    case DWT_CYCCNT:
+        return Dwt_Cyccnt;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Escritura de un registro del DWT (los comparadores no se modelan).
+ */
+static void DWT_Write(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case DWT_CTRL:
+        Dwt_Ctrl = (Dwt_Ctrl & ~DWT_CYCCNTENA) | (value & DWT_CYCCNTENA);
+        return;
+    case DWT_CYCCNT:
+        Dwt_Cyccnt = value;
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * @brief Construye el valor de SCB->ICSR.
+ */
+static uint32_t SCS_ReadIcsr(void)
+{
+    uint64_t pending = CORE_PendingMask();
+    uint32_t icsr = (Depth > 0) ? Stack[Depth - 1] : 0;
+
+    icsr |= CORE_HighestPending() << SCB_ICSR_VECTPENDING_Pos;
+    if ((pending & Enabled) >> 16)
+    {
+        icsr |= SCB_ICSR_ISRPENDING_Msk;
+    }
+    if (pending & CORE_Bit(CORE_VECTOR_OF(SysTick_IRQn)))
+    {
+        icsr |= SCB_ICSR_PENDSTSET_Msk;
+    }
+    if (pending & CORE_Bit(CORE_VECTOR_OF(PendSV_IRQn)))
+    {
+        icsr |= SCB_ICSR_PENDSVSET_Msk;
+    }
+    if (Depth <= 1)
+    {
+        icsr |= SCB_ICSR_RETTOBASE_Msk;
+    }
+
+    return icsr;
+}
+
+/**
+ * @brief Lectura de un registro del SCS.
+ */
+static uint32_t SCS_Read(uint32_t offset, SIM_Access_Type access)
+{
+    uint32_t value;
+
+    switch (offset)
+    {
+    case SCS_SYST_CSR:
+        value = Systick_Ctrl;
+        if (access == SIM_ACCESS_READ)
+        {
+            Systick_Ctrl &= ~SYST_COUNTFLAG;
+        }
+        return value;
+    case SCS_SYST_RVR:
+        return Systick_Load;
+    case SCS_SYST_CVR:
+        return Systick_Val;
+    case SCS_SYST_CALIB:
+        return CORE_SYSTICK_CALIB;
+    case SCS_CPUID:
+        return CORE_CPUID;
+    case SCS_ICSR:
+        return (access == SIM_ACCESS_READ) ? SCS_ReadIcsr() : 0;
+    case SCS_STIR:
+        return 0;
+    default:
+        break;
+    }
+
+    // NVIC: registros de a 32 interrupciones; los de escritura con 1 se precargan en 0.
+    if (offset >= SCS_ISER && offset < SCS_IP)
+    {
+        uint32_t word = (offset & 0x7F) / 4;
+        uint64_t mask;
+
+        if (access == SIM_ACCESS_PREFILL || word > 1)
+        {
+            return 0;
+        }
+        if (offset < SCS_ISPR)
+        {
+            mask = Enabled;
+        }
+        else if (offset < SCS_IABR)
+        {
+            mask = CORE_PendingMask();
+        }
+        else
+        {
+            mask = Active;
+        }
+        return (uint32_t)((mask >> 16) >> (32 * word));
+    }
+
+    return Scs_Store[offset / 4];
+}
+
+/**
+ * @brief Escritura de un registro del SCS.
+ */
+static void SCS_Write(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case SCS_SYST_CSR:
+        Systick_Ctrl = (Systick_Ctrl & SYST_COUNTFLAG) | (value & 0x7);
+        return;
+    case SCS_SYST_RVR:
+        Systick_Load = value & 0x00FFFFFFUL;
+        return;
+    case SCS_SYST_CVR:
+        Systick_Val = 0;
+        Systick_Ctrl &= ~SYST_COUNTFLAG;
+        return;
+    case SCS_SYST_CALIB:
+    case SCS_CPUID:
+        return;
+    case SCS_ICSR:
+        if (value & SCB_ICSR_PENDSTSET_Msk)
+        {
+            Latched |= CORE_Bit(CORE_VECTOR_OF(SysTick_IRQn));
+        }
+        if (value & SCB_ICSR_PENDSTCLR_Msk)
+        {
+            Latched &= ~CORE_Bit(CORE_VECTOR_OF(SysTick_IRQn));
+        }
+        if (value & SCB_ICSR_PENDSVSET_Msk)
+        {
+            Latched |= CORE_Bit(CORE_VECTOR_OF(PendSV_IRQn));
+        }
+        if (value & SCB_ICSR_PENDSVCLR_Msk)
+        {
+            Latched &= ~CORE_Bit(CORE_VECTOR_OF(PendSV_IRQn));
+        }
+        return;
+    case SCS_AIRCR:
+        if ((value >> SCB_AIRCR_VECTKEY_Pos) != 0x05FA)
+        {
+            return;
+        }
+        if (value & SCB_AIRCR_SYSRESETREQ_Msk)
+        {
+            SIM_CORE_Finish("reinicio pedido por el firmware (SYSRESETREQ)");
+        }
+        Scs_Store[offset / 4] = value & SCB_AIRCR_PRIGROUP_Msk;
+        return;
+    case SCS_STIR:
+        SIM_CORE_PendIRQ((int32_t)(value & 0x1FF));
+        return;
+    default:
+        break;
+    }
+
+    if (offset >= SCS_ISER && offset < SCS_IABR)
+    {
+        uint32_t word = (offset & 0x7F) / 4;
+        uint64_t mask;
+
+        if (word > 1)
+        {
+            return;
+        }
+        mask = ((uint64_t)value << (32 * word)) << 16;
+        mask &= CORE_Bit(CORE_VECTORS) - CORE_Bit(16);
+
+        if (offset < SCS_ICER)
+        {
+            Enabled |= mask;
+        }
+        else if (offset < SCS_ISPR)
+        {
+            Enabled &= ~mask;
+        }
+        else if (offset < SCS_ICPR)
+        {
+            Latched |= mask;
+        }
+        else
+        {
+            Latched &= ~mask;
+        }
+        return;
+    }
+
+    if ((offset >= SCS_IP && offset < SCS_IP + SIM_IRQ_COUNT) || (offset >= SCS_SHP && offset < SCS_SHP + 12))
+    {
+        value &= CORE_PRIO_MASK * 0x01010101UL;
+    }
+
+    Scs_Store[offset / 4] = value;
+}
+
+static const SIM_Device_Type Scs_Device = {
+    .Name = "SCS",
+    .Base = SCS_BASE,
+    .Size = 0x1000,
+    .Read = SCS_Read,
+    .Write = SCS_Write,
+    .Update = SYSTICK_Update,
+    .Next = SYSTICK_Next,
+};
+
+static const SIM_Device_Type Dwt_Device = {
+    .Name = "DWT",
+    .Base = DWT_BASE,
+    .Size = 0x1000,
+    .Read = DWT_Read,
+    .Write = DWT_Write,
+    .Update = DWT_Update,
+    .Next = NULL,
+};
+
+void SIM_CORE_Init(uint64_t end, uint32_t access_cycles)
+{
+    End_Time = end;
+    Access_Cycles = access_cycles;
+
+    // SysTick y PendSV no tienen bit de habilitacion en el NVIC.
+    Enabled = CORE_Bit(CORE_VECTOR_OF(SysTick_IRQn)) | CORE_Bit(CORE_VECTOR_OF(PendSV_IRQn));
+
+    SIM_CORE_Register(&Scs_Device);
+    SIM_CORE_Register(&Dwt_Device);
+}
+
+void SIM_CORE_Register(const SIM_Device_Type* device)
+{
+    if (device->Size != 0)
+    {
+        SIM_BUS_Attach(device);
+    }
+
+    if (device->Update != NULL)
+    {
+        if (Clocked_Count >= CORE_MAX_DEVICES)
+        {
+            SIM_CORE_Fail("demasiados perifericos temporizados (%s)", device->Name);
+        }
+        Clocked[Clocked_Count++] = device;
+    }
+}
+
+void SIM_CORE_Advance(uint64_t target)
+{
+    uint64_t next;
+    uint64_t step;
+
+    if (target > End_Time)
+    {
+        target = End_Time;
+    }
+
+    // Al menos una pasada aunque target == SIM_Now: procesa los eventos que vencen en este instante.
+    do
+    {
+        step = target;
+        for (uint8_t i = 0; i < Clocked_Count; i++)
+        {
+            next = (Clocked[i]->Next != NULL) ? Clocked[i]->Next() : SIM_NEVER;
+            if (next < step)
+            {
+                step = (next < SIM_Now) ? SIM_Now : next;
+            }
+        }
+
+        // El reloj se mueve antes de actualizar para que las trazas registren el instante del evento.
+        SIM_Now = step;
+        for (uint8_t i = 0; i < Clocked_Count; i++)
+        {
+            Clocked[i]->Update(step);
+        }
+    } while (SIM_Now < target);
+
+    if (SIM_Now >= End_Time)
+    {
+        SIM_CORE_Finish("fin del tiempo de simulacion");
+    }
+}
+
+void SIM_CORE_Access(void)
+{
+    Accesses++;
+    SIM_CORE_Advance(SIM_Now + SIM_CORE_CyclesToPs(Access_Cycles));
+}
+
+void SIM_CORE_Sync(void)
+{
+    for (uint8_t i = 0; i < Clocked_Count; i++)
+    {
+        Clocked[i]->Update(SIM_Now);
+    }
+}
+
+void SIM_CORE_Finish(const char* reason)
+{
+    uint64_t total = (SIM_Now > 0) ? SIM_Now : 1;
+
+    printf("sim: %s\n", reason);
+    printf("sim: tiempo virtual %.3f s, dormido %.1f %%, %llu accesos a registros\n",
+           (double)SIM_Now / SIM_PS_PER_SECOND, 100.0 * (double)Sleep_Time / (double)total,
+           (unsigned long long)Accesses);
+
+    for (uint32_t vector = 0; vector < CORE_VECTORS; vector++)
+    {
+        if (Taken[vector] != 0)
+        {
+            printf("sim: %-18s %u\n", Vectors[vector].Name, Taken[vector]);
+        }
+    }
+
+    SIM_TRACE_Summary();
+    SIM_TRACE_Close();
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+void SIM_CORE_Fail(const char* format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "sim: error a los %.6f s: ", (double)SIM_Now / SIM_PS_PER_SECOND);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+
+    SIM_TRACE_Close();
+    exit(EXIT_FAILURE);
+}
+
+void SIM_CORE_SetIRQ(int32_t irqn, Bool level)
+{
+    if (level == TRUE)
+    {
+        Line |= CORE_Bit(CORE_VECTOR_OF(irqn));
+    }
+    else
+    {
+        Line &= ~CORE_Bit(CORE_VECTOR_OF(irqn));
+    }
+}
+
+void SIM_CORE_PendIRQ(int32_t irqn)
+{
+    if (irqn >= -15 && irqn < SIM_IRQ_COUNT)
+    {
+        Latched |= CORE_Bit(CORE_VECTOR_OF(irqn));
+    }
+}
+
+uint64_t SIM_CORE_CyclesToPs(uint64_t cycles)
+{
+    return cycles * SIM_SC_CclkPeriod();
+}
+
+void __enable_irq(void)
+{
+    Primask = 0;
+    CORE_TakeInterrupts();
+}
+
+void __disable_irq(void)
+{
+    Primask = 1;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return Primask;
+}
+
+void __set_PRIMASK(uint32_t priMask)
+{
+    Primask = priMask & 1;
+    CORE_TakeInterrupts();
+}
+
+void __enable_fault_irq(void)
+{
+    Faultmask = 0;
+}
+
+void __disable_fault_irq(void)
+{
+    Faultmask = 1;
+}
+
+uint32_t __get_FAULTMASK(void)
+{
+    return Faultmask;
+}
+
+void __set_FAULTMASK(uint32_t faultMask)
+{
+    Faultmask = faultMask & 1;
+}
+
+uint32_t __get_BASEPRI(void)
+{
+    return Basepri;
+}
+
+void __set_BASEPRI(uint32_t basePri)
+{
+    Basepri = basePri & CORE_PRIO_MASK;
+    CORE_TakeInterrupts();
+}
+
+uint32_t __get_IPSR(void)
+{
+    return (Depth > 0) ? Stack[Depth - 1] : 0;
+}
+
+void __WFI(void)
+{
+    uint64_t start = SIM_Now;
+    uint64_t next;
+
+    // Despierta con cualquier excepcion que podria desalojar a la ejecucion actual, aun con PRIMASK activo.
+    Sleeping = TRUE;
+    while (CORE_Preemptor(TRUE) == 0)
+    {
+        next = SIM_NEVER;
+        for (uint8_t i = 0; i < Clocked_Count; i++)
+        {
+            uint64_t event = (Clocked[i]->Next != NULL) ? Clocked[i]->Next() : SIM_NEVER;
+            next = (event < next) ? event : next;
+        }
+        SIM_CORE_Advance((next > SIM_Now) ? next : SIM_Now);
+    }
+    Sleeping = FALSE;
+
+    Sleep_Time += SIM_Now - start;
+    CORE_TakeInterrupts();
+}
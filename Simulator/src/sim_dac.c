@@ -0,0 +1,165 @@
+/**
+ * @file sim_dac.c
+ * @brief Conversor D/A: valor de salida, doble buffer y contador de timeout con pedido de DMA.
+ *
+ * Cada cambio del valor de salida se registra en la traza del DAC. Con CNT_ENA el contador decrementa a la
+ * frecuencia de PCLK_DAC; al llegar a cero recarga DACCNTVAL, activa INT_DMA_REQ, transfiere el valor del doble
+ * buffer (si DBLBUF_ENA) y, con DMA_ENA, pide una transferencia al GPDMA.
+ */
+
+#include "sim.h"
+
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+
+// Definiciones del modulo:
+#define DAC_VALUE_MASK 0x0000FFC0UL /**< Campo VALUE del DACR */
+#define DAC_INT_DMA    (1UL << 0)   /**< INT_DMA_REQ: el contador llego a cero */
+#define DAC_DBLBUF     (1UL << 1)   /**< Doble buffer habilitado */
+#define DAC_CNT_ENA    (1UL << 2)   /**< Contador de timeout habilitado */
+#define DAC_DMA_ENA    (1UL << 3)   /**< Pedidos de DMA habilitados */
+
+#define DAC_OFFSET(reg) offsetof(LPC_DAC_TypeDef, reg) /**< Desplazamiento de un registro del DAC */
+
+static uint32_t Dacr = 0;            /**< DACR visible */
+static uint32_t Buffer = 0;          /**< DACR escrito con doble buffer, pendiente de transferir */
+static uint32_t Ctrl = 0;            /**< DACCTRL */
+static uint32_t Reload = 0;          /**< DACCNTVAL */
+static uint32_t Counter = 0;         /**< Valor actual del contador */
+static uint64_t Edge = 0;            /**< Ultimo flanco de PCLK contabilizado */
+static uint32_t Output = UINT32_MAX; /**< Ultimo valor registrado en la traza */
+static uint32_t Updates = 0;         /**< Escrituras efectivas del valor de salida */
+
+/**
+ * @brief Aplica un nuevo valor al DACR y lo registra si cambia la salida.
+ */
+static void DAC_Apply(uint32_t value)
+{
+    Dacr = value;
+    Updates++;
+
+    if ((Dacr & DAC_VALUE_MASK) != Output)
+    {
+        Output = Dacr & DAC_VALUE_MASK;
+        SIM_TRACE_Dac((uint16_t)(Output >> 6));
+    }
+}
+
+/**
+ * @brief Lleva el contador de timeout hasta el instante indicado.
+ */
+static void DAC_Update(uint64_t now)
+{
+    uint64_t period = SIM_SC_PclkPeriod(CLKPWR_PCLKSEL_DAC);
+    uint64_t edges = (now - Edge) / period;
+
+    Edge += edges * period;
+    if ((Ctrl & DAC_CNT_ENA) == 0 || edges == 0)
+    {
+        return;
+    }
+
+    if (edges < Counter)
+    {
+        Counter -= (uint32_t)edges;
+        return;
+    }
+
+    // Cada timeout se atiende en su propio instante (Next), asi que a lo sumo hay uno por llamada.
+    Counter = (Reload != 0) ? Reload : 1;
+    Ctrl |= DAC_INT_DMA;
+    if (Ctrl & DAC_DBLBUF)
+    {
+        DAC_Apply(Buffer);
+    }
+    if (Ctrl & DAC_DMA_ENA)
+    {
+        SIM_GPDMA_Request(GPDMA_CONN_DAC);
+    }
+}
+
+/**
+ * @brief Instante del proximo timeout del contador.
+ */
+static uint64_t DAC_Next(void)
+{
+    if ((Ctrl & DAC_CNT_ENA) == 0)
+    {
+        return SIM_NEVER;
+    }
+
+    return Edge + (uint64_t)((Counter != 0) ? Counter : 1) * SIM_SC_PclkPeriod(CLKPWR_PCLKSEL_DAC);
+}
+
+/**
+ * @brief Lectura de un registro del DAC.
+ */
+static uint32_t DAC_Read(uint32_t offset, SIM_Access_Type access)
+{
+    (void)access;
+
+    switch (offset)
+    {
+    case DAC_OFFSET(DACR):
+        return Dacr;
+    case DAC_OFFSET(DACCTRL):
+        return Ctrl;
+    case DAC_OFFSET(DACCNTVAL):
+        return Reload;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Escritura de un registro del DAC.
+ */
+static void DAC_Write(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case DAC_OFFSET(DACR):
+        Ctrl &= ~DAC_INT_DMA;
+        if ((Ctrl & (DAC_DBLBUF | DAC_CNT_ENA)) == (DAC_DBLBUF | DAC_CNT_ENA))
+        {
+            Buffer = value;
+        }
+        else
+        {
+            DAC_Apply(value);
+        }
+        return;
+    case DAC_OFFSET(DACCTRL):
+        if ((value & DAC_CNT_ENA) && (Ctrl & DAC_CNT_ENA) == 0)
+        {
+            Counter = Reload;
+        }
+        Ctrl = (Ctrl & DAC_INT_DMA) | (value & (DAC_DBLBUF | DAC_CNT_ENA | DAC_DMA_ENA));
+        return;
+    case DAC_OFFSET(DACCNTVAL):
+        Reload = value & 0xFFFF;
+        return;
+    default:
+        return;
+    }
+}
+
+static const SIM_Device_Type Dac_Device = {
+    .Name = "DAC",
+    .Base = LPC_DAC_BASE,
+    .Size = 0x10,
+    .Read = DAC_Read,
+    .Write = DAC_Write,
+    .Update = DAC_Update,
+    .Next = DAC_Next,
+};
+
+void SIM_DAC_Init(void)
+{
+    SIM_CORE_Register(&Dac_Device);
+}
+
+uint32_t SIM_DAC_GetUpdates(void)
+{
+    return Updates;
+}
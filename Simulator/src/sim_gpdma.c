@@ -0,0 +1,422 @@
+/**
+ * @file sim_gpdma.c
+ * @brief Controlador GPDMA: 8 canales, rafagas por pedido de periferico, listas enlazadas (LLI) e interrupciones.
+ *
+ * Los perifericos llaman a SIM_GPDMA_Request() cuando activan su linea de pedido. El canal habilitado de menor
+ * numero que tenga a ese periferico como origen (P2M) o destino (M2P) mueve una rafaga de SBSize/DBSize unidades.
+ * Al llegar TransferSize a cero se carga el siguiente LLI o se deshabilita el canal, y se activa el flag de
+ * terminal count si el bit I del control lo pide. Las transferencias memoria a memoria se completan al habilitar
+ * el canal. Una direccion fuera del mapa simulado o de la memoria del proceso se reporta como error del canal.
+ */
+
+#include <stdio.h>
+
+#include "sim.h"
+
+#include "lpc17xx_gpdma.h"
+
+// Definiciones del modulo:
+#define GPDMA_CHANNELS   8           /**< Canales del controlador */
+#define GPDMA_CONFIG_E   (1UL << 0)  /**< DMACConfig: controlador habilitado */
+#define GPDMA_CH_E       (1UL << 0)  /**< Config: canal habilitado */
+#define GPDMA_CH_IE      (1UL << 14) /**< Config: interrupcion por error */
+#define GPDMA_CH_ITC     (1UL << 15) /**< Config: interrupcion por terminal count */
+#define GPDMA_CH_ACTIVE  (1UL << 17) /**< Config: hay datos en la FIFO del canal */
+#define GPDMA_CH_HALT    (1UL << 18) /**< Config: ignora pedidos nuevos */
+#define GPDMA_CTRL_SIZE  0xFFFUL     /**< Control: TransferSize */
+#define GPDMA_CTRL_SI    (1UL << 26) /**< Control: incrementa el origen */
+#define GPDMA_CTRL_DI    (1UL << 27) /**< Control: incrementa el destino */
+#define GPDMA_CTRL_I     (1UL << 31) /**< Control: terminal count al terminar */
+#define GPDMA_TYPE_M2M   0           /**< TransferType: memoria a memoria */
+#define GPDMA_TYPE_M2P   1           /**< TransferType: memoria a periferico */
+#define GPDMA_TYPE_P2M   2           /**< TransferType: periferico a memoria */
+#define GPDMA_MAX_BURSTS 4096        /**< Limite de rafagas de una transferencia M2M por cadena de LLI */
+
+#define GPDMA_OFFSET(reg)  offsetof(LPC_GPDMA_TypeDef, reg) /**< Desplazamiento de un registro global */
+#define GPDMA_CH_OFFSET    0x100                            /**< Primer registro de canal */
+#define GPDMA_CH_STRIDE    0x20                             /**< Separacion entre canales */
+#define GPDMA_CH_REG(r)    offsetof(LPC_GPDMACH_TypeDef, r) /**< Desplazamiento de un registro de canal */
+#define GPDMA_CH_TYPE(cfg) (((cfg) >> 11) & 0x7)            /**< Campo TransferType */
+#define GPDMA_CH_SRC(cfg)  (((cfg) >> 1) & 0x1F)            /**< Campo SrcPeripheral */
+#define GPDMA_CH_DEST(cfg) (((cfg) >> 6) & 0x1F)            /**< Campo DestPeripheral */
+
+/**
+ * @brief Registros de un canal.
+ */
+typedef struct
+{
+    uint32_t Src;     /**< DMACCxSrcAddr */
+    uint32_t Dest;    /**< DMACCxDestAddr */
+    uint32_t Lli;     /**< DMACCxLLI */
+    uint32_t Control; /**< DMACCxControl */
+    uint32_t Config;  /**< DMACCxConfig */
+} GPDMA_Channel_Type;
+
+static GPDMA_Channel_Type Channels[GPDMA_CHANNELS]; /**< Estado de los canales */
+static uint32_t Config = 0;                         /**< DMACConfig */
+static uint32_t Sync = 0;                           /**< DMACSync */
+static uint32_t Raw_Tc = 0;                         /**< Terminal count sin mascara */
+static uint32_t Raw_Err = 0;                        /**< Errores sin mascara */
+static uint32_t Transfers = 0;                      /**< Unidades movidas */
+
+/**
+ * @brief Unidades por rafaga segun el campo SBSize/DBSize.
+ */
+static uint32_t GPDMA_BurstLength(uint32_t field)
+{
+    static const uint16_t lengths[8] = {1, 4, 8, 16, 32, 64, 128, 256};
+
+    return lengths[field & 0x7];
+}
+
+/**
+ * @brief Interrupciones con mascara de terminal count.
+ */
+static uint32_t GPDMA_IntTc(void)
+{
+    uint32_t stat = 0;
+
+    for (uint8_t ch = 0; ch < GPDMA_CHANNELS; ch++)
+    {
+        stat |= (Channels[ch].Config & GPDMA_CH_ITC) ? (Raw_Tc & (1UL << ch)) : 0;
+    }
+
+    return stat;
+}
+
+/**
+ * @brief Interrupciones con mascara de error.
+ */
+static uint32_t GPDMA_IntErr(void)
+{
+    uint32_t stat = 0;
+
+    for (uint8_t ch = 0; ch < GPDMA_CHANNELS; ch++)
+    {
+        stat |= (Channels[ch].Config & GPDMA_CH_IE) ? (Raw_Err & (1UL << ch)) : 0;
+    }
+
+    return stat;
+}
+
+/**
+ * @brief Actualiza la linea de interrupcion del GPDMA.
+ */
+static void GPDMA_UpdateLine(void)
+{
+    SIM_CORE_SetIRQ(DMA_IRQn, ((GPDMA_IntTc() | GPDMA_IntErr()) != 0) ? TRUE : FALSE);
+}
+
+/**
+ * @brief Termina un canal con error de bus.
+ */
+static void GPDMA_Error(uint8_t ch, uint32_t address)
+{
+    fprintf(stderr, "sim: GPDMA canal %u: acceso invalido a 0x%08X\n", ch, address);
+    Channels[ch].Config &= ~(GPDMA_CH_E | GPDMA_CH_ACTIVE);
+    Raw_Err |= 1UL << ch;
+    GPDMA_UpdateLine();
+}
+
+/**
+ * @brief Cierra la transferencia actual: terminal count y carga del siguiente LLI.
+ */
+static void GPDMA_Terminal(uint8_t ch)
+{
+    GPDMA_Channel_Type* c = &Channels[ch];
+    uint32_t lli[4];
+
+    if (c->Control & GPDMA_CTRL_I)
+    {
+        Raw_Tc |= 1UL << ch;
+    }
+
+    if (c->Lli == 0)
+    {
+        c->Config &= ~(GPDMA_CH_E | GPDMA_CH_ACTIVE);
+        GPDMA_UpdateLine();
+        return;
+    }
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if (SIM_BUS_Read(c->Lli + 4 * i, 4, &lli[i]) == FALSE)
+        {
+            GPDMA_Error(ch, c->Lli + 4 * i);
+            return;
+        }
+    }
+
+    c->Src = lli[0];
+    c->Dest = lli[1];
+    c->Lli = lli[2] & ~0x3UL;
+    c->Control = lli[3];
+    GPDMA_UpdateLine();
+}
+
+/**
+ * @brief Mueve una rafaga del canal indicado.
+ *
+ * @return FALSE si el canal termino con error.
+ */
+static Bool GPDMA_Burst(uint8_t ch, uint32_t length)
+{
+    GPDMA_Channel_Type* c = &Channels[ch];
+    uint8_t src_width = (uint8_t)(1U << ((c->Control >> 18) & 0x3));
+    uint8_t dest_width = (uint8_t)(1U << ((c->Control >> 21) & 0x3));
+    uint32_t remaining = c->Control & GPDMA_CTRL_SIZE;
+    uint32_t value;
+
+    if (length > remaining)
+    {
+        length = remaining;
+    }
+
+    // TransferSize cuenta unidades del ancho de origen; el destino recibe el mismo valor con su ancho.
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (SIM_BUS_Read(c->Src, src_width, &value) == FALSE)
+        {
+            GPDMA_Error(ch, c->Src);
+            return FALSE;
+        }
+        if (SIM_BUS_Write(c->Dest, dest_width, value) == FALSE)
+        {
+            GPDMA_Error(ch, c->Dest);
+            return FALSE;
+        }
+
+        c->Src += (c->Control & GPDMA_CTRL_SI) ? src_width : 0;
+        c->Dest += (c->Control & GPDMA_CTRL_DI) ? dest_width : 0;
+        c->Control = (c->Control & ~GPDMA_CTRL_SIZE) | ((c->Control & GPDMA_CTRL_SIZE) - 1);
+        Transfers++;
+    }
+
+    if ((c->Control & GPDMA_CTRL_SIZE) == 0)
+    {
+        GPDMA_Terminal(ch);
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief Completa una transferencia memoria a memoria (incluida su cadena de LLI).
+ */
+static void GPDMA_MemoryToMemory(uint8_t ch)
+{
+    GPDMA_Channel_Type* c = &Channels[ch];
+
+    for (uint32_t n = 0; n < GPDMA_MAX_BURSTS && (c->Config & GPDMA_CH_E); n++)
+    {
+        if (GPDMA_Burst(ch, GPDMA_BurstLength(c->Control >> 12)) == FALSE)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Lectura de un registro del GPDMA.
+ */
+static uint32_t GPDMA_Read(uint32_t offset, SIM_Access_Type access)
+{
+    uint32_t enabled = 0;
+
+    // TCClear y ErrClr son de escritura con 1: el valor previo debe ser 0.
+    if (access == SIM_ACCESS_PREFILL &&
+        (offset == GPDMA_OFFSET(DMACIntTCClear) || offset == GPDMA_OFFSET(DMACIntErrClr)))
+    {
+        return 0;
+    }
+
+    if (offset >= GPDMA_CH_OFFSET && offset < GPDMA_CH_OFFSET + GPDMA_CHANNELS * GPDMA_CH_STRIDE)
+    {
+        const GPDMA_Channel_Type* c = &Channels[(offset - GPDMA_CH_OFFSET) / GPDMA_CH_STRIDE];
+
+        switch ((offset - GPDMA_CH_OFFSET) % GPDMA_CH_STRIDE)
+        {
+        case GPDMA_CH_REG(DMACCSrcAddr):
+            return c->Src;
+        case GPDMA_CH_REG(DMACCDestAddr):
+            return c->Dest;
+        case GPDMA_CH_REG(DMACCLLI):
+            return c->Lli;
+        case GPDMA_CH_REG(DMACCControl):
+            return c->Control;
+        case GPDMA_CH_REG(DMACCConfig):
+            return c->Config;
+        default:
+            return 0;
+        }
+    }
+
+    for (uint8_t ch = 0; ch < GPDMA_CHANNELS; ch++)
+    {
+        enabled |= (Channels[ch].Config & GPDMA_CH_E) ? (1UL << ch) : 0;
+    }
+
+    switch (offset)
+    {
+    case GPDMA_OFFSET(DMACIntStat):
+        return GPDMA_IntTc() | GPDMA_IntErr();
+    case GPDMA_OFFSET(DMACIntTCStat):
+        return GPDMA_IntTc();
+    case GPDMA_OFFSET(DMACIntErrStat):
+        return GPDMA_IntErr();
+    case GPDMA_OFFSET(DMACRawIntTCStat):
+        return Raw_Tc;
+    case GPDMA_OFFSET(DMACRawIntErrStat):
+        return Raw_Err;
+    case GPDMA_OFFSET(DMACEnbldChns):
+        return enabled;
+    case GPDMA_OFFSET(DMACConfig):
+        return Config;
+    case GPDMA_OFFSET(DMACSync):
+        return Sync;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Escritura de un registro de canal.
+ */
+static void GPDMA_ChannelWrite(uint8_t ch, uint32_t reg, uint32_t value)
+{
+    GPDMA_Channel_Type* c = &Channels[ch];
+    Bool enabling;
+
+    switch (reg)
+    {
+    case GPDMA_CH_REG(DMACCSrcAddr):
+        c->Src = value;
+        return;
+    case GPDMA_CH_REG(DMACCDestAddr):
+        c->Dest = value;
+        return;
+    case GPDMA_CH_REG(DMACCLLI):
+        c->Lli = value & ~0x3UL;
+        return;
+    case GPDMA_CH_REG(DMACCControl):
+        c->Control = value;
+        return;
+    case GPDMA_CH_REG(DMACCConfig):
+        enabling = ((value & GPDMA_CH_E) && (c->Config & GPDMA_CH_E) == 0) ? TRUE : FALSE;
+        c->Config = (value & ~GPDMA_CH_ACTIVE) | (c->Config & GPDMA_CH_ACTIVE);
+        GPDMA_UpdateLine();
+
+        if (enabling == TRUE && (Config & GPDMA_CONFIG_E))
+        {
+            if (GPDMA_CH_TYPE(c->Config) == GPDMA_TYPE_M2M)
+            {
+                GPDMA_MemoryToMemory(ch);
+            }
+            else
+            {
+                // Un periferico que ya tenia el pedido activo (FIFO de TX con lugar) lo atiende el canal nuevo.
+                SIM_UART_ServiceDMA();
+            }
+        }
+        return;
+    default:
+        return;
+    }
+}
+
+/**
+ * @brief Escritura de un registro del GPDMA.
+ */
+static void GPDMA_Write(uint32_t offset, uint32_t value)
+{
+    if (offset >= GPDMA_CH_OFFSET && offset < GPDMA_CH_OFFSET + GPDMA_CHANNELS * GPDMA_CH_STRIDE)
+    {
+        GPDMA_ChannelWrite((uint8_t)((offset - GPDMA_CH_OFFSET) / GPDMA_CH_STRIDE),
+                           (offset - GPDMA_CH_OFFSET) % GPDMA_CH_STRIDE, value);
+        return;
+    }
+
+    switch (offset)
+    {
+    case GPDMA_OFFSET(DMACIntTCClear):
+        Raw_Tc &= ~(value & 0xFF);
+        GPDMA_UpdateLine();
+        return;
+    case GPDMA_OFFSET(DMACIntErrClr):
+        Raw_Err &= ~(value & 0xFF);
+        GPDMA_UpdateLine();
+        return;
+    case GPDMA_OFFSET(DMACConfig):
+        Config = value & 0x3;
+        return;
+    case GPDMA_OFFSET(DMACSync):
+        Sync = value & 0xFFFF;
+        return;
+    default:
+        return;
+    }
+}
+
+static const SIM_Device_Type Gpdma_Device = {
+    .Name = "GPDMA",
+    .Base = LPC_GPDMA_BASE,
+    .Size = GPDMA_CH_OFFSET + GPDMA_CHANNELS * GPDMA_CH_STRIDE,
+    .Read = GPDMA_Read,
+    .Write = GPDMA_Write,
+    .Update = NULL,
+    .Next = NULL,
+};
+
+void SIM_GPDMA_Init(void)
+{
+    SIM_CORE_Register(&Gpdma_Device);
+}
+
+Bool SIM_GPDMA_Request(uint8_t connection)
+{
+    uint32_t dmareqsel = SIM_BUS_Peek((uintptr_t)&LPC_SC->DMAREQSEL);
+    uint8_t line = (connection >= GPDMA_CONN_MAT0_0) ? (uint8_t)(connection - 8) : connection;
+
+    if ((Config & GPDMA_CONFIG_E) == 0)
+    {
+        return FALSE;
+    }
+
+    // Las lineas 8-15 son de las UARTs o de los MAT segun DMAREQSEL.
+    if (line >= 8)
+    {
+        Bool match_selected = (dmareqsel & (1UL << (line - 8))) ? TRUE : FALSE;
+
+        if (match_selected != ((connection >= GPDMA_CONN_MAT0_0) ? TRUE : FALSE))
+        {
+            return FALSE;
+        }
+    }
+
+    for (uint8_t ch = 0; ch < GPDMA_CHANNELS; ch++)
+    {
+        GPDMA_Channel_Type* c = &Channels[ch];
+        uint32_t type = GPDMA_CH_TYPE(c->Config);
+
+        if ((c->Config & (GPDMA_CH_E | GPDMA_CH_HALT)) != GPDMA_CH_E)
+        {
+            continue;
+        }
+
+        if (type == GPDMA_TYPE_P2M && GPDMA_CH_SRC(c->Config) == line)
+        {
+            return GPDMA_Burst(ch, GPDMA_BurstLength(c->Control >> 12));
+        }
+        if (type == GPDMA_TYPE_M2P && GPDMA_CH_DEST(c->Config) == line)
+        {
+            return GPDMA_Burst(ch, GPDMA_BurstLength(c->Control >> 15));
+        }
+    }
+
+    return FALSE;
+}
+
+uint32_t SIM_GPDMA_GetTransfers(void)
+{
+    return Transfers;
+}
@@ -0,0 +1,389 @@
+/**
+ * @file sim_gpio.c
+ * @brief Puertos GPIO de acceso rapido, interrupciones por flanco de GPIO e interrupciones externas EINT0-3.
+ *
+ * El nivel de cada pin es la salida del firmware si el pin es salida, el valor impuesto por el guion si el guion
+ * lo maneja, o el que fija el resistor configurado en PINMODE. Los cambios de las salidas se registran en la traza
+ * de GPIO y los cambios de nivel alimentan la deteccion de flancos (puertos 0 y 2) y las lineas EINT0-3 (P2.10 a
+ * P2.13 en funcion 01), que comparten la interrupcion EINT3 con las de GPIO igual que en el LPC17xx.
+ */
+
+#include "sim.h"
+
+// Definiciones del modulo:
+#define GPIO_PORTS      5    /**< Puertos del LPC1769 */
+#define GPIO_PORT_SIZE  0x20 /**< Registros de cada puerto */
+#define GPIO_EINT_PORT  2    /**< Puerto de los pines EINT */
+#define GPIO_EINT_PIN   10   /**< Pin de EINT0; EINT1-3 son los siguientes */
+#define GPIO_EINT_LINES 4    /**< Lineas de interrupcion externa */
+#define GPIO_EINT_FUNC  1    /**< Funcion de PINSEL que conecta el pin a EINTn */
+
+// Desplazamientos de los registros de cada puerto:
+#define FIO_DIR  0x00 /**< FIODIR */
+#define FIO_MASK 0x10 /**< FIOMASK */
+#define FIO_PIN  0x14 /**< FIOPIN */
+#define FIO_SET  0x18 /**< FIOSET */
+#define FIO_CLR  0x1C /**< FIOCLR */
+
+#define GPIOINT_OFFSET(reg) offsetof(LPC_GPIOINT_TypeDef, reg) /**< Desplazamiento de un registro del GPIOINT */
+#define SC_OFFSET(reg)      offsetof(LPC_SC_TypeDef, reg)      /**< Desplazamiento de un registro del SC */
+
+/**
+ * @brief Estado de un puerto.
+ */
+typedef struct
+{
+    uint32_t Dir;    /**< FIODIR */
+    uint32_t Mask;   /**< FIOMASK */
+    uint32_t Out;    /**< Valor de salida escrito por el firmware */
+    uint32_t Driven; /**< Pines manejados por el guion */
+    uint32_t Input;  /**< Nivel impuesto por el guion */
+    uint32_t Level;  /**< Ultimo nivel evaluado de los pines */
+    uint32_t Traced; /**< Ultimo valor de salida registrado en la traza */
+} GPIO_Port_Type;
+
+/**
+ * @brief Interrupciones por flanco de un puerto (solo puertos 0 y 2).
+ */
+typedef struct
+{
+    uint32_t Stat_R; /**< Flancos ascendentes detectados */
+    uint32_t Stat_F; /**< Flancos descendentes detectados */
+    uint32_t En_R;   /**< Habilitacion por flanco ascendente */
+    uint32_t En_F;   /**< Habilitacion por flanco descendente */
+} GPIO_Int_Type;
+
+static GPIO_Port_Type Ports[GPIO_PORTS]; /**< Estado de los puertos */
+static GPIO_Int_Type Ints[2];            /**< Interrupciones de los puertos 0 y 2 */
+static uint32_t Extint = 0;              /**< EXTINT */
+static uint32_t Extmode = 0;             /**< EXTMODE */
+static uint32_t Extpolar = 0;            /**< EXTPOLAR */
+
+/**
+ * @brief Nivel que fijan los resistores de PINMODE en los pines no manejados.
+ */
+static uint32_t GPIO_PullLevel(uint8_t port)
+{
+    uint32_t level = 0;
+    uint32_t mode;
+
+    for (uint8_t half = 0; half < 2; half++)
+    {
+        mode = SIM_BUS_Peek(LPC_PINCON_BASE + offsetof(LPC_PINCON_TypeDef, PINMODE0) + 4 * (2 * port + half));
+        for (uint8_t i = 0; i < 16; i++)
+        {
+            // PINMODE 00: pull-up; el resto deja el pin en bajo.
+            if (((mode >> (2 * i)) & 0x3) == 0)
+            {
+                level |= 1UL << (16 * half + i);
+            }
+        }
+    }
+
+    return level;
+}
+
+/**
+ * @brief Nivel actual de los pines de un puerto.
+ */
+static uint32_t GPIO_PinLevel(uint8_t port)
+{
+    GPIO_Port_Type* p = &Ports[port];
+    uint32_t input = (p->Input & p->Driven) | (GPIO_PullLevel(port) & ~p->Driven);
+
+    return (p->Out & p->Dir) | (input & ~p->Dir);
+}
+
+/**
+ * @brief Actualiza la linea de interrupcion de EINT3, compartida con las interrupciones de GPIO.
+ */
+static void GPIO_UpdateLines(void)
+{
+    Bool gpio = FALSE;
+
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (Ints[i].Stat_R != 0 || Ints[i].Stat_F != 0)
+        {
+            gpio = TRUE;
+        }
+    }
+
+    for (uint8_t n = 0; n < GPIO_EINT_LINES; n++)
+    {
+        Bool level = (Extint & (1UL << n)) ? TRUE : FALSE;
+
+        if (n == 3 && gpio == TRUE)
+        {
+            level = TRUE;
+        }
+        SIM_CORE_SetIRQ(EINT0_IRQn + n, level);
+    }
+}
+
+/**
+ * @brief Evalua el nivel de los pines y propaga flancos, interrupciones externas y trazas.
+ */
+static void GPIO_Evaluate(void)
+{
+    uint32_t pinsel = SIM_BUS_Peek(LPC_PINCON_BASE + offsetof(LPC_PINCON_TypeDef, PINSEL4));
+
+    for (uint8_t port = 0; port < GPIO_PORTS; port++)
+    {
+        GPIO_Port_Type* p = &Ports[port];
+        uint32_t level = GPIO_PinLevel(port);
+        uint32_t rising = level & ~p->Level;
+        uint32_t falling = ~level & p->Level;
+        uint32_t output = p->Out & p->Dir;
+
+        if (port == 0 || port == 2)
+        {
+            GPIO_Int_Type* in = &Ints[port / 2];
+
+            in->Stat_R |= rising & in->En_R;
+            in->Stat_F |= falling & in->En_F;
+        }
+
+        if (port == GPIO_EINT_PORT)
+        {
+            for (uint8_t n = 0; n < GPIO_EINT_LINES; n++)
+            {
+                uint8_t pin = GPIO_EINT_PIN + n;
+                Bool high = (Extpolar & (1UL << n)) ? TRUE : FALSE;
+                uint32_t bit = 1UL << pin;
+
+                if (((pinsel >> (2 * pin)) & 0x3) != GPIO_EINT_FUNC)
+                {
+                    continue;
+                }
+
+                if (Extmode & (1UL << n))
+                {
+                    if ((high == TRUE && (rising & bit)) || (high == FALSE && (falling & bit)))
+                    {
+                        Extint |= 1UL << n;
+                    }
+                }
+                else if (((level & bit) != 0) == high)
+                {
+                    Extint |= 1UL << n;
+                }
+            }
+        }
+
+        if (output != p->Traced)
+        {
+            p->Traced = output;
+            SIM_TRACE_Gpio(port, output);
+        }
+        p->Level = level;
+    }
+
+    GPIO_UpdateLines();
+}
+
+/**
+ * @brief Lectura de un registro de los puertos.
+ */
+static uint32_t FIO_Read(uint32_t offset, SIM_Access_Type access)
+{
+    GPIO_Port_Type* p = &Ports[offset / GPIO_PORT_SIZE];
+
+    switch (offset % GPIO_PORT_SIZE)
+    {
+    case FIO_DIR:
+        return p->Dir;
+    case FIO_MASK:
+        return p->Mask;
+    case FIO_PIN:
+        return (access == SIM_ACCESS_READ) ? (GPIO_PinLevel(offset / GPIO_PORT_SIZE) & ~p->Mask) : p->Out;
+    case FIO_SET:
+        return (access == SIM_ACCESS_READ) ? p->Out : 0;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Escritura de un registro de los puertos.
+ */
+static void FIO_Write(uint32_t offset, uint32_t value)
+{
+    GPIO_Port_Type* p = &Ports[offset / GPIO_PORT_SIZE];
+
+    switch (offset % GPIO_PORT_SIZE)
+    {
+    case FIO_DIR:
+        p->Dir = value;
+        break;
+    case FIO_MASK:
+        p->Mask = value;
+        break;
+    case FIO_PIN:
+        p->Out = (p->Out & p->Mask) | (value & ~p->Mask);
+        break;
+    case FIO_SET:
+        p->Out |= value & ~p->Mask;
+        break;
+    case FIO_CLR:
+        p->Out &= ~(value & ~p->Mask);
+        break;
+    default:
+        return;
+    }
+
+    GPIO_Evaluate();
+}
+
+/**
+ * @brief Lectura de un registro del GPIOINT.
+ */
+static uint32_t GPIOINT_Read(uint32_t offset, SIM_Access_Type access)
+{
+    (void)access;
+
+    switch (offset)
+    {
+    case GPIOINT_OFFSET(IntStatus):
+        return ((Ints[0].Stat_R | Ints[0].Stat_F) ? 0x1 : 0) | ((Ints[1].Stat_R | Ints[1].Stat_F) ? 0x4 : 0);
+    case GPIOINT_OFFSET(IO0IntStatR):
+        return Ints[0].Stat_R;
+    case GPIOINT_OFFSET(IO0IntStatF):
+        return Ints[0].Stat_F;
+    case GPIOINT_OFFSET(IO0IntEnR):
+        return Ints[0].En_R;
+    case GPIOINT_OFFSET(IO0IntEnF):
+        return Ints[0].En_F;
+    case GPIOINT_OFFSET(IO2IntStatR):
+        return Ints[1].Stat_R;
+    case GPIOINT_OFFSET(IO2IntStatF):
+        return Ints[1].Stat_F;
+    case GPIOINT_OFFSET(IO2IntEnR):
+        return Ints[1].En_R;
+    case GPIOINT_OFFSET(IO2IntEnF):
+        return Ints[1].En_F;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Escritura de un registro del GPIOINT.
+ */
+static void GPIOINT_Write(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case GPIOINT_OFFSET(IO0IntClr):
+        Ints[0].Stat_R &= ~value;
+        Ints[0].Stat_F &= ~value;
+        break;
+    case GPIOINT_OFFSET(IO0IntEnR):
+        Ints[0].En_R = value;
+        break;
+    case GPIOINT_OFFSET(IO0IntEnF):
+        Ints[0].En_F = value;
+        break;
+    case GPIOINT_OFFSET(IO2IntClr):
+        Ints[1].Stat_R &= ~value;
+        Ints[1].Stat_F &= ~value;
+        break;
+    case GPIOINT_OFFSET(IO2IntEnR):
+        Ints[1].En_R = value;
+        break;
+    case GPIOINT_OFFSET(IO2IntEnF):
+        Ints[1].En_F = value;
+        break;
+    default:
+        return;
+    }
+
+    GPIO_UpdateLines();
+}
+
+static const SIM_Device_Type Fio_Device = {
+    .Name = "GPIO",
+    .Base = LPC_GPIO_BASE,
+    .Size = GPIO_PORTS * GPIO_PORT_SIZE,
+    .Read = FIO_Read,
+    .Write = FIO_Write,
+    .Update = NULL,
+    .Next = NULL,
+};
+
+static const SIM_Device_Type Gpioint_Device = {
+    .Name = "GPIOINT",
+    .Base = LPC_GPIOINT_BASE,
+    .Size = sizeof(LPC_GPIOINT_TypeDef),
+    .Read = GPIOINT_Read,
+    .Write = GPIOINT_Write,
+    .Update = NULL,
+    .Next = NULL,
+};
+
+void SIM_GPIO_Init(void)
+{
+    for (uint8_t port = 0; port < GPIO_PORTS; port++)
+    {
+        Ports[port].Level = GPIO_PinLevel(port);
+    }
+
+    SIM_CORE_Register(&Fio_Device);
+    SIM_CORE_Register(&Gpioint_Device);
+}
+
+void SIM_GPIO_SetInput(uint8_t port, uint8_t pin, uint8_t level)
+{
+    if (port >= GPIO_PORTS || pin >= 32)
+    {
+        return;
+    }
+
+    Ports[port].Driven |= 1UL << pin;
+    if (level != 0)
+    {
+        Ports[port].Input |= 1UL << pin;
+    }
+    else
+    {
+        Ports[port].Input &= ~(1UL << pin);
+    }
+
+    GPIO_Evaluate();
+}
+
+uint32_t SIM_GPIO_ExtintRead(uint32_t offset)
+{
+    switch (offset)
+    {
+    case SC_OFFSET(EXTINT):
+        return Extint;
+    case SC_OFFSET(EXTMODE):
+        return Extmode;
+    case SC_OFFSET(EXTPOLAR):
+        return Extpolar;
+    default:
+        return 0;
+    }
+}
+
+void SIM_GPIO_ExtintWrite(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case SC_OFFSET(EXTINT):
+        // En modo por nivel la bandera vuelve a activarse si el pin sigue activo (se reevalua abajo).
+        Extint &= ~(value & 0xF);
+        break;
+    case SC_OFFSET(EXTMODE):
+        Extmode = value & 0xF;
+        break;
+    case SC_OFFSET(EXTPOLAR):
+        Extpolar = value & 0xF;
+        break;
+    default:
+        return;
+    }
+
+    GPIO_Evaluate();
+}
@@ -0,0 +1,114 @@
+/**
+ * @file sim_main.c
+ * @brief Punto de entrada del simulador: opciones, armado de los perifericos y arranque del firmware.
+ *
+ * El main() del firmware se compila como SIM_Firmware_Main() y se ejecuta en el hilo principal del proceso. La
+ * simulacion termina al vencer el tiempo indicado, con el comando end del guion, si el firmware retorna de main()
+ * o si pide un reset por software.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+#include "lpc17xx_libcfg_default.h"
+
+// Definiciones del modulo:
+#define MAIN_DEFAULT_MS     10000 /**< Duracion por defecto de la simulacion */
+#define MAIN_DEFAULT_CYCLES 4     /**< Ciclos de CCLK por acceso a un registro */
+#define MAIN_DEFAULT_SEED   1     /**< Semilla por defecto del ruido del ADC */
+
+/**
+ * @brief main() del firmware (Src/main.c compilado con -Dmain=SIM_Firmware_Main).
+ */
+int SIM_Firmware_Main(void);
+
+/**
+ * @brief Muestra el uso del programa.
+ */
+static void MAIN_Usage(const char* program)
+{
+    fprintf(stderr,
+            "uso: %s [-s guion] [-t ms] [-o directorio] [-a ciclos] [-r semilla]\n"
+            "  -s guion       estimulos de ADC, pines y UART (ver README.md)\n"
+            "  -t ms          tiempo virtual a simular (por defecto %u ms)\n"
+            "  -o directorio  directorio para los archivos de traza (sin -o no se generan)\n"
+            "  -a ciclos      ciclos de CCLK por acceso a un registro (por defecto %u)\n"
+            "  -r semilla     semilla del ruido del ADC (por defecto %u)\n",
+            program, MAIN_DEFAULT_MS, MAIN_DEFAULT_CYCLES, MAIN_DEFAULT_SEED);
+}
+
+/**
+ * @brief Parametro invalido en un driver (CHECK_PARAM): en el micro queda en un lazo, aca termina con error.
+ */
+void check_failed(uint8_t* file, uint32_t line)
+{
+    SIM_CORE_Fail("parametro invalido en %s:%u", (const char*)file, line);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* script = NULL;
+    const char* directory = NULL;
+    uint64_t duration = MAIN_DEFAULT_MS;
+    uint32_t cycles = MAIN_DEFAULT_CYCLES;
+    uint32_t seed = MAIN_DEFAULT_SEED;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:t:o:a:r:h")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            script = optarg;
+            break;
+        case 't':
+            duration = strtoull(optarg, NULL, 10);
+            break;
+        case 'o':
+            directory = optarg;
+            break;
+        case 'a':
+            cycles = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'r':
+            seed = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        default:
+            MAIN_Usage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (duration == 0 || optind != argc)
+    {
+        MAIN_Usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    SIM_BUS_Init();
+    SIM_CORE_Init(duration * SIM_PS_PER_MS, cycles);
+    SIM_SC_Init();
+    SIM_GPIO_Init();
+    SIM_TIMER_Init();
+    SIM_ADC_Init();
+    SIM_DAC_Init();
+    SIM_UART_Init();
+    SIM_GPDMA_Init();
+
+    if (SIM_TRACE_Open(directory) == ERROR)
+    {
+        fprintf(stderr, "sim: no se puede escribir en el directorio de trazas %s\n", directory);
+        return EXIT_FAILURE;
+    }
+    if (SIM_SCRIPT_Load(script, seed) == ERROR)
+    {
+        return EXIT_FAILURE;
+    }
+
+    SIM_Firmware_Main();
+    SIM_CORE_Finish("el firmware retorno de main()");
+    return EXIT_SUCCESS;
+}
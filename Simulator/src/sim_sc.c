@@ -0,0 +1,210 @@
+/**
+ * @file sim_sc.c
+ * @brief Bloque de control del sistema: PLL0/PLL1, divisores de reloj y seleccion de PCLK.
+ *
+ * SystemInit() se ejecuta sin cambios: los PLL enganchan apenas se habilitan con una secuencia de feed valida y
+ * el periodo de CCLK se recalcula cada vez que cambia la fuente, el PLL conectado o el divisor. Los perifericos
+ * leen el periodo de su PCLK en cada evento, por lo que antes de un cambio de reloj se los sincroniza.
+ */
+
+#include "sim.h"
+
+#include "lpc17xx_clkpwr.h"
+
+// Definiciones del modulo:
+#define SC_IRC_HZ      4000000UL    /**< Oscilador interno RC */
+#define SC_OSC_HZ      12000000UL   /**< Cristal principal de la placa */
+#define SC_RTC_HZ      32768UL      /**< Oscilador del RTC */
+#define SC_PCONP_RESET 0x042887DEUL /**< Valor de PCONP despues del reset */
+#define SC_FEED_FIRST  0xAA         /**< Primer valor de la secuencia de feed */
+#define SC_FEED_SECOND 0x55         /**< Segundo valor de la secuencia de feed */
+
+#define SC_OFFSET(reg) offsetof(LPC_SC_TypeDef, reg) /**< Desplazamiento de un registro del SC */
+
+/**
+ * @brief Estado de un PLL: los registros escritos y los efectivos tras el ultimo feed.
+ */
+typedef struct
+{
+    uint32_t Con;       /**< PLLxCON escrito */
+    uint32_t Cfg;       /**< PLLxCFG escrito */
+    uint32_t Con_Latch; /**< PLLxCON efectivo */
+    uint32_t Cfg_Latch; /**< PLLxCFG efectivo */
+    uint8_t Feed;       /**< Primer valor de feed recibido */
+} SC_Pll_Type;
+
+static SC_Pll_Type Pll0;          /**< PLL principal */
+static SC_Pll_Type Pll1;          /**< PLL del USB */
+static uint32_t Store[0x200 / 4]; /**< Registros sin modelo especifico */
+static uint64_t Cclk_Period = 0;  /**< Periodo de CCLK en picosegundos */
+
+/**
+ * @brief Recalcula el periodo de CCLK a partir de la fuente, el PLL0 y el divisor.
+ */
+static void SC_UpdateClock(void)
+{
+    uint64_t fin;
+    uint64_t fcclk;
+    uint32_t source = Store[SC_OFFSET(CLKSRCSEL) / 4] & 0x3;
+    uint32_t divider = (Store[SC_OFFSET(CCLKCFG) / 4] & 0xFF) + 1;
+
+    fin = (source == 1) ? SC_OSC_HZ : ((source == 2) ? SC_RTC_HZ : SC_IRC_HZ);
+
+    if ((Pll0.Con_Latch & 0x3) == 0x3)
+    {
+        uint64_t m = (Pll0.Cfg_Latch & 0x7FFF) + 1;
+        uint64_t n = ((Pll0.Cfg_Latch >> 16) & 0xFF) + 1;
+
+        fcclk = 2 * m * fin / n / divider;
+    }
+    else
+    {
+        fcclk = fin / divider;
+    }
+
+    Cclk_Period = SIM_PS_PER_SECOND / fcclk;
+}
+
+/**
+ * @brief Procesa una escritura en el registro de feed de un PLL.
+ */
+static void SC_Feed(SC_Pll_Type* pll, uint32_t value)
+{
+    if (value == SC_FEED_FIRST)
+    {
+        pll->Feed = SC_FEED_FIRST;
+        return;
+    }
+
+    if (value == SC_FEED_SECOND && pll->Feed == SC_FEED_FIRST)
+    {
+        SIM_CORE_Sync();
+        pll->Con_Latch = pll->Con;
+        pll->Cfg_Latch = pll->Cfg;
+        SC_UpdateClock();
+    }
+    pll->Feed = 0;
+}
+
+/**
+ * @brief Lectura de un registro del SC.
+ */
+static uint32_t SC_Read(uint32_t offset, SIM_Access_Type access)
+{
+    uint32_t value;
+
+    switch (offset)
+    {
+    case SC_OFFSET(PLL0CON):
+        return Pll0.Con;
+    case SC_OFFSET(PLL0CFG):
+        return Pll0.Cfg;
+    case SC_OFFSET(PLL0STAT):
+        // El PLL engancha en cuanto se habilita.
+        value = Pll0.Cfg_Latch & 0x00FF7FFF;
+        value |= (Pll0.Con_Latch & 0x1) << 24;
+        value |= (Pll0.Con_Latch & 0x2) << 24;
+        value |= (Pll0.Con_Latch & 0x1) << 26;
+        return value;
+    case SC_OFFSET(PLL1CON):
+        return Pll1.Con;
+    case SC_OFFSET(PLL1CFG):
+        return Pll1.Cfg;
+    case SC_OFFSET(PLL1STAT):
+        value = Pll1.Cfg_Latch & 0x7F;
+        value |= (Pll1.Con_Latch & 0x3) << 8;
+        value |= (Pll1.Con_Latch & 0x1) << 10;
+        return value;
+    case SC_OFFSET(PLL0FEED):
+    case SC_OFFSET(PLL1FEED):
+        return 0;
+    case SC_OFFSET(SCS):
+        // OSCSTAT (bit 6) sigue a OSCEN (bit 5): el cristal arranca de inmediato.
+        value = Store[offset / 4] & ~(1UL << 6);
+        return value | ((value & (1UL << 5)) << 1);
+    case SC_OFFSET(EXTINT):
+    case SC_OFFSET(EXTMODE):
+    case SC_OFFSET(EXTPOLAR):
+        return (access == SIM_ACCESS_READ || offset != SC_OFFSET(EXTINT)) ? SIM_GPIO_ExtintRead(offset) : 0;
+    default:
+        return Store[offset / 4];
+    }
+}
+
+/**
+ * @brief Escritura de un registro del SC.
+ */
+static void SC_Write(uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case SC_OFFSET(PLL0CON):
+        Pll0.Con = value & 0x3;
+        return;
+    case SC_OFFSET(PLL0CFG):
+        Pll0.Cfg = value & 0x00FF7FFF;
+        return;
+    case SC_OFFSET(PLL0FEED):
+        SC_Feed(&Pll0, value & 0xFF);
+        return;
+    case SC_OFFSET(PLL1CON):
+        Pll1.Con = value & 0x3;
+        return;
+    case SC_OFFSET(PLL1CFG):
+        Pll1.Cfg = value & 0x7F;
+        return;
+    case SC_OFFSET(PLL1FEED):
+        SC_Feed(&Pll1, value & 0xFF);
+        return;
+    case SC_OFFSET(PLL0STAT):
+    case SC_OFFSET(PLL1STAT):
+        return;
+    case SC_OFFSET(EXTINT):
+    case SC_OFFSET(EXTMODE):
+    case SC_OFFSET(EXTPOLAR):
+        SIM_GPIO_ExtintWrite(offset, value);
+        return;
+    case SC_OFFSET(CCLKCFG):
+    case SC_OFFSET(CLKSRCSEL):
+    case SC_OFFSET(PCLKSEL0):
+    case SC_OFFSET(PCLKSEL1):
+        SIM_CORE_Sync();
+        Store[offset / 4] = value;
+        SC_UpdateClock();
+        return;
+    default:
+        Store[offset / 4] = value;
+        return;
+    }
+}
+
+static const SIM_Device_Type Sc_Device = {
+    .Name = "SC",
+    .Base = LPC_SC_BASE,
+    .Size = sizeof(Store),
+    .Read = SC_Read,
+    .Write = SC_Write,
+    .Update = NULL,
+    .Next = NULL,
+};
+
+void SIM_SC_Init(void)
+{
+    Store[SC_OFFSET(PCONP) / 4] = SC_PCONP_RESET;
+    SC_UpdateClock();
+
+    SIM_CORE_Register(&Sc_Device);
+}
+
+uint64_t SIM_SC_CclkPeriod(void)
+{
+    return Cclk_Period;
+}
+
+uint64_t SIM_SC_PclkPeriod(uint8_t pclksel_bit)
+{
+    static const uint8_t dividers[4] = {4, 1, 2, 8};
+    uint32_t pclksel = Store[(pclksel_bit < 32) ? SC_OFFSET(PCLKSEL0) / 4 : SC_OFFSET(PCLKSEL1) / 4];
+
+    return Cclk_Period * dividers[CLKPWR_PCLKSEL_GET(pclksel_bit % 32, pclksel)];
+}
@@ -0,0 +1,291 @@
+/**
+ * @file sim_script.c
+ * @brief Guion de estimulos: valores del ADC, niveles de pines y bytes recibidos por las UARTs a lo largo del tiempo.
+ *
+ * El guion es un archivo de texto con un comando por linea, precedido por el instante en milisegundos:
+ *
+ *     <ms> adc <canal> <valor 0-4095> [ruido]
+ *     <ms> pin <puerto> <bit> <0|1>
+ *     <ms> uart <n> <bytes en hexadecimal | "texto">
+ *     <ms> end
+ *
+ * Los instantes deben ser no decrecientes. Las lineas vacias y lo que sigue a '#' se ignoran. El guion entero se
+ * lee antes de arrancar el firmware y cada comando se aplica en su instante como un evento mas del planificador.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+// Definiciones del modulo:
+#define SCRIPT_LINE_SIZE 512 /**< Longitud maxima de una linea */
+
+/**
+ * @brief Tipos de comando.
+ */
+typedef enum
+{
+    SCRIPT_ADC,  /**< Valor de un canal del ADC */
+    SCRIPT_PIN,  /**< Nivel de una entrada */
+    SCRIPT_UART, /**< Bytes recibidos por una UART */
+    SCRIPT_END   /**< Fin de la simulacion */
+} SCRIPT_Kind_Type;
+
+/**
+ * @brief Comando del guion.
+ */
+typedef struct
+{
+    uint64_t Time;         /**< Instante de aplicacion */
+    SCRIPT_Kind_Type Kind; /**< Tipo de comando */
+    uint8_t Unit;          /**< Canal, puerto o UART */
+    uint8_t Pin;           /**< Bit del puerto */
+    uint16_t Value;        /**< Valor del ADC o nivel del pin */
+    uint16_t Noise;        /**< Ruido del ADC */
+    uint8_t* Data;         /**< Bytes de la UART */
+    uint32_t Length;       /**< Cantidad de bytes */
+} SCRIPT_Command_Type;
+
+static SCRIPT_Command_Type* Commands = NULL; /**< Comandos ordenados por instante */
+static uint32_t Command_Count = 0;           /**< Comandos cargados */
+static uint32_t Next_Command = 0;            /**< Proximo comando a aplicar */
+static uint32_t Seed = 1;                    /**< Semilla del ruido del ADC */
+
+/**
+ * @brief Convierte los bytes de un comando uart (hexadecimal o texto entre comillas).
+ *
+ * @return ERROR si el formato no es valido.
+ */
+static Status SCRIPT_ParseBytes(char* text, SCRIPT_Command_Type* cmd)
+{
+    char* end;
+    size_t length;
+
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+
+    length = strlen(text);
+    while (length > 0 && isspace((unsigned char)text[length - 1]))
+    {
+        text[--length] = '\0';
+    }
+
+    cmd->Data = malloc(length + 1);
+    if (cmd->Data == NULL)
+    {
+        return ERROR;
+    }
+
+    if (text[0] == '"')
+    {
+        end = strrchr(text + 1, '"');
+        if (end == NULL)
+        {
+            return ERROR;
+        }
+        for (char* c = text + 1; c < end; c++)
+        {
+            // Secuencias \n, \r y \\ para poder enviar terminadores de linea.
+            if (*c == '\\' && c + 1 < end)
+            {
+                c++;
+                cmd->Data[cmd->Length++] = (uint8_t)((*c == 'n') ? '\n' : ((*c == 'r') ? '\r' : *c));
+            }
+            else
+            {
+                cmd->Data[cmd->Length++] = (uint8_t)*c;
+            }
+        }
+        return SUCCESS;
+    }
+
+    for (char* token = strtok(text, " \t"); token != NULL; token = strtok(NULL, " \t"))
+    {
+        unsigned long byte = strtoul(token, &end, 16);
+
+        if (*end != '\0' || byte > 0xFF)
+        {
+            return ERROR;
+        }
+        cmd->Data[cmd->Length++] = (uint8_t)byte;
+    }
+
+    return (cmd->Length > 0) ? SUCCESS : ERROR;
+}
+
+/**
+ * @brief Interpreta una linea del guion.
+ *
+ * @return ERROR si la linea no es valida.
+ */
+static Status SCRIPT_ParseLine(char* line, SCRIPT_Command_Type* cmd)
+{
+    double ms;
+    char kind[8];
+    int consumed;
+    unsigned a;
+    unsigned b;
+    unsigned c;
+    int fields;
+
+    memset(cmd, 0, sizeof(*cmd));
+    if (sscanf(line, "%lf %7s %n", &ms, kind, &consumed) < 2 || ms < 0)
+    {
+        return ERROR;
+    }
+    cmd->Time = (uint64_t)(ms * SIM_PS_PER_MS);
+    line += consumed;
+
+    if (strcmp(kind, "adc") == 0)
+    {
+        c = 0;
+        fields = sscanf(line, "%u %u %u", &a, &b, &c);
+        cmd->Kind = SCRIPT_ADC;
+        cmd->Unit = (uint8_t)a;
+        cmd->Value = (uint16_t)b;
+        cmd->Noise = (uint16_t)c;
+        return (fields >= 2 && a < 8 && b <= 0xFFF) ? SUCCESS : ERROR;
+    }
+    if (strcmp(kind, "pin") == 0)
+    {
+        fields = sscanf(line, "%u %u %u", &a, &b, &c);
+        cmd->Kind = SCRIPT_PIN;
+        cmd->Unit = (uint8_t)a;
+        cmd->Pin = (uint8_t)b;
+        cmd->Value = (uint16_t)c;
+        return (fields == 3 && a < 5 && b < 32 && c <= 1) ? SUCCESS : ERROR;
+    }
+    if (strcmp(kind, "uart") == 0)
+    {
+        if (sscanf(line, "%u %n", &a, &consumed) < 1 || a >= SIM_UART_COUNT)
+        {
+            return ERROR;
+        }
+        cmd->Kind = SCRIPT_UART;
+        cmd->Unit = (uint8_t)a;
+        return SCRIPT_ParseBytes(line + consumed, cmd);
+    }
+    if (strcmp(kind, "end") == 0)
+    {
+        cmd->Kind = SCRIPT_END;
+        return SUCCESS;
+    }
+
+    return ERROR;
+}
+
+/**
+ * @brief Aplica los comandos que vencen hasta el instante indicado.
+ */
+static void SCRIPT_Update(uint64_t now)
+{
+    while (Next_Command < Command_Count && Commands[Next_Command].Time <= now)
+    {
+        const SCRIPT_Command_Type* cmd = &Commands[Next_Command++];
+
+        switch (cmd->Kind)
+        {
+        case SCRIPT_ADC:
+            SIM_ADC_SetInput(cmd->Unit, cmd->Value, cmd->Noise, Seed);
+            break;
+        case SCRIPT_PIN:
+            SIM_GPIO_SetInput(cmd->Unit, cmd->Pin, (uint8_t)cmd->Value);
+            break;
+        case SCRIPT_UART:
+            SIM_UART_Receive(cmd->Unit, cmd->Data, cmd->Length);
+            break;
+        case SCRIPT_END:
+            SIM_CORE_Finish("fin del guion");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Instante del proximo comando.
+ */
+static uint64_t SCRIPT_Next(void)
+{
+    return (Next_Command < Command_Count) ? Commands[Next_Command].Time : SIM_NEVER;
+}
+
+static const SIM_Device_Type Script_Device = {
+    .Name = "guion",
+    .Base = 0,
+    .Size = 0,
+    .Read = NULL,
+    .Write = NULL,
+    .Update = SCRIPT_Update,
+    .Next = SCRIPT_Next,
+};
+
+Status SIM_SCRIPT_Load(const char* path, uint32_t seed)
+{
+    FILE* file;
+    char line[SCRIPT_LINE_SIZE];
+    uint32_t number = 0;
+    uint32_t size = 0;
+
+    Seed = seed;
+    SIM_CORE_Register(&Script_Device);
+    if (path == NULL)
+    {
+        return SUCCESS;
+    }
+
+    file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "sim: no se puede abrir el guion %s\n", path);
+        return ERROR;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char* comment = strchr(line, '#');
+        char* text = line;
+
+        number++;
+        if (comment != NULL && strchr(line, '"') == NULL)
+        {
+            *comment = '\0';
+        }
+        while (isspace((unsigned char)*text))
+        {
+            text++;
+        }
+        if (*text == '\0')
+        {
+            continue;
+        }
+
+        if (Command_Count >= size)
+        {
+            size = (size == 0) ? 32 : size * 2;
+            Commands = realloc(Commands, size * sizeof(SCRIPT_Command_Type));
+            if (Commands == NULL)
+            {
+                SIM_CORE_Fail("sin memoria para el guion");
+            }
+        }
+
+        if (SCRIPT_ParseLine(text, &Commands[Command_Count]) == ERROR ||
+            (Command_Count > 0 && Commands[Command_Count].Time < Commands[Command_Count - 1].Time))
+        {
+            fprintf(stderr, "sim: %s:%u: comando invalido: %s", path, number, line);
+            fclose(file);
+            return ERROR;
+        }
+        Command_Count++;
+    }
+
+    fclose(file);
+    return SUCCESS;
+}
@@ -0,0 +1,535 @@
+/**
+ * @file sim_timer.c
+ * @brief Timers 0-3 y PWM1: prescaler, contador, match con interrupcion/reset/stop y salidas.
+ *
+ * Los cinco perifericos comparten el mismo contador. El estado no avanza flanco por flanco: en cada evento se calcula
+ * cuantos incrementos del TC faltan hasta el proximo match y se salta directamente hasta ahi. En los timers, los match
+ * actualizan las salidas externas (EMR), que se registran en la traza, disparan las conversiones del ADC que usan MAT
+ * como fuente y generan los pedidos de DMA de MATx.0/MATx.1. En el PWM1, los match registers escritos en modo PWM
+ * quedan en sombra hasta el siguiente reinicio de ciclo habilitado por LER, y los flancos de las salidas habilitadas en
+ * PCR se registran en la traza.
+ */
+
+#include "sim.h"
+
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+
+// Definiciones del modulo:
+#define TIMER_INSTANCES 5 /**< Timers 0-3 y PWM1 */
+#define TIMER_PWM       4 /**< Indice del PWM1 */
+#define TIMER_MATCHES   4 /**< Match registers de los timers */
+#define PWM_MATCHES     7 /**< Match registers del PWM1 */
+#define PWM_CHANNELS    6 /**< Salidas PWM1.1 a PWM1.6 */
+
+#define TCR_ENABLE    (1UL << 0) /**< Contador habilitado */
+#define TCR_RESET     (1UL << 1) /**< Contador en reset */
+#define TCR_PWM       (1UL << 3) /**< Modo PWM (solo PWM1) */
+#define MCR_INTERRUPT 0x1        /**< Interrupcion en el match */
+#define MCR_RESET     0x2        /**< Reset del TC en el match */
+#define MCR_STOP      0x4        /**< Detencion del contador en el match */
+
+#define TIMER_OFFSET(reg) offsetof(LPC_PWM_TypeDef, reg) /**< Desplazamiento de un registro */
+#define TIMER_EMR         offsetof(LPC_TIM_TypeDef, EMR) /**< Desplazamiento del EMR (solo timers) */
+
+/**
+ * @brief Estado de un timer o del PWM1.
+ */
+typedef struct
+{
+    const char* Name;             /**< Nombre del periferico */
+    uintptr_t Base;               /**< Direccion base */
+    uint8_t Pclksel;              /**< Bit de PCLKSEL */
+    IRQn_Type Irq;                /**< Interrupcion */
+    uint8_t Matches;              /**< Cantidad de match registers */
+    uint32_t Ir;                  /**< IR */
+    uint32_t Tcr;                 /**< TCR */
+    uint32_t Tc;                  /**< TC */
+    uint32_t Pr;                  /**< PR */
+    uint32_t Pc;                  /**< PC */
+    uint32_t Mcr;                 /**< MCR */
+    uint32_t Mr[PWM_MATCHES];     /**< Match registers efectivos */
+    uint32_t Shadow[PWM_MATCHES]; /**< Match registers escritos en modo PWM */
+    uint32_t Emr;                 /**< EMR (timers) */
+    uint32_t Pcr;                 /**< PCR (PWM1) */
+    uint32_t Ler;                 /**< LER (PWM1) */
+    uint32_t Outputs;             /**< Nivel de las salidas PWM1.1-6 (bit n = canal n) */
+    Bool Reset_Pending;           /**< El proximo incremento lleva el TC a cero */
+    uint64_t Edge;                /**< Ultimo flanco de PCLK contabilizado */
+    uint32_t Store[0x80 / 4];     /**< Registros sin modelo (captura, CTCR) */
+} TIMER_Counter_Type;
+
+static TIMER_Counter_Type Counters[TIMER_INSTANCES] = {
+    {.Name = "TIMER0", .Base = LPC_TIM0_BASE, .Pclksel = CLKPWR_PCLKSEL_TIMER0, .Irq = TIMER0_IRQn, .Matches = 4},
+    {.Name = "TIMER1", .Base = LPC_TIM1_BASE, .Pclksel = CLKPWR_PCLKSEL_TIMER1, .Irq = TIMER1_IRQn, .Matches = 4},
+    {.Name = "TIMER2", .Base = LPC_TIM2_BASE, .Pclksel = CLKPWR_PCLKSEL_TIMER2, .Irq = TIMER2_IRQn, .Matches = 4},
+    {.Name = "TIMER3", .Base = LPC_TIM3_BASE, .Pclksel = CLKPWR_PCLKSEL_TIMER3, .Irq = TIMER3_IRQn, .Matches = 4},
+    {.Name = "PWM1", .Base = LPC_PWM1_BASE, .Pclksel = CLKPWR_PCLKSEL_PWM1, .Irq = PWM1_IRQn, .Matches = 7},
+};
+
+static uint32_t Pulses = 0;       /**< Flancos ascendentes en las salidas PWM */
+static uint32_t Match_Pulses = 0; /**< Flancos ascendentes en las salidas MAT de los timers */
+
+/**
+ * @brief Bit del IR que corresponde a un match register.
+ */
+static uint32_t TIMER_IrBit(uint8_t match)
+{
+    return (match < TIMER_MATCHES) ? (1UL << match) : (1UL << (match + 4));
+}
+
+/**
+ * @brief Desplazamiento del registro de un match register.
+ */
+static uint32_t TIMER_MrOffset(uint8_t match)
+{
+    return (match < TIMER_MATCHES) ? TIMER_OFFSET(MR0) + 4 * match : TIMER_OFFSET(MR4) + 4 * (match - 4);
+}
+
+/**
+ * @brief Indica si el contador avanza.
+ */
+static Bool TIMER_Running(const TIMER_Counter_Type* c)
+{
+    return ((c->Tcr & (TCR_ENABLE | TCR_RESET)) == TCR_ENABLE) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Incrementos del TC hasta el proximo valor que requiere procesamiento.
+ *
+ * Cuenta los match registers y, si hay un reset pendiente, el reinicio del ciclo (las salidas del PWM cambian).
+ */
+static uint64_t TIMER_Distance(const TIMER_Counter_Type* c)
+{
+    uint64_t best;
+    uint32_t first;
+
+    if (c->Reset_Pending == TRUE)
+    {
+        return 1;
+    }
+
+    first = c->Tc + 1;
+    best = 1ULL << 32;
+    for (uint8_t m = 0; m < c->Matches; m++)
+    {
+        // Incrementos hasta que el TC valga Mr[m], contando la vuelta del contador de 32 bits.
+        uint64_t distance = (uint64_t)(uint32_t)(c->Mr[m] - first) + 1;
+
+        best = (distance < best) ? distance : best;
+    }
+
+    return best;
+}
+
+/**
+ * @brief Actualiza las salidas PWM segun el TC y registra los flancos.
+ */
+static void PWM_UpdateOutputs(TIMER_Counter_Type* c)
+{
+    uint32_t outputs = 0;
+
+    if ((c->Tcr & TCR_PWM) == 0)
+    {
+        return;
+    }
+
+    for (uint8_t ch = 1; ch <= PWM_CHANNELS; ch++)
+    {
+        Bool high;
+
+        if ((c->Pcr & (1UL << (ch + 8))) == 0)
+        {
+            continue;
+        }
+
+        if (ch >= 2 && (c->Pcr & (1UL << ch)))
+        {
+            // Doble flanco: sube en MR(n-1) y baja en MRn.
+            uint32_t rise = c->Mr[ch - 1];
+            uint32_t fall = c->Mr[ch];
+
+            high = (rise <= fall) ? ((c->Tc >= rise && c->Tc < fall) ? TRUE : FALSE)
+                                  : ((c->Tc >= rise || c->Tc < fall) ? TRUE : FALSE);
+        }
+        else
+        {
+            // Simple flanco: sube al comienzo del ciclo y baja en MRn.
+            high = (c->Tc < c->Mr[ch]) ? TRUE : FALSE;
+        }
+
+        if (high == TRUE)
+        {
+            outputs |= 1UL << ch;
+        }
+    }
+
+    for (uint8_t ch = 1; ch <= PWM_CHANNELS; ch++)
+    {
+        uint32_t bit = 1UL << ch;
+
+        if ((outputs ^ c->Outputs) & bit)
+        {
+            SIM_TRACE_Pwm(ch, (outputs & bit) ? 1 : 0);
+            if (outputs & bit)
+            {
+                Pulses++;
+            }
+        }
+    }
+    c->Outputs = outputs;
+}
+
+/**
+ * @brief Aplica la accion de un match sobre la salida externa EMn de un timer.
+ */
+static void TIMER_ExternalMatch(TIMER_Counter_Type* c, uint8_t timer, uint8_t match)
+{
+    uint32_t action = (c->Emr >> (4 + 2 * match)) & 0x3;
+    uint32_t bit = 1UL << match;
+    uint32_t before = c->Emr & bit;
+
+    switch (action)
+    {
+    case 1:
+        c->Emr &= ~bit;
+        break;
+    case 2:
+        c->Emr |= bit;
+        break;
+    case 3:
+        c->Emr ^= bit;
+        break;
+    default:
+        break;
+    }
+
+    if ((c->Emr & bit) != before)
+    {
+        SIM_TRACE_Match(timer, match, (c->Emr & bit) ? 1 : 0);
+        SIM_ADC_MatchEdge(timer, match, (c->Emr & bit) ? 1 : 0);
+        if (c->Emr & bit)
+        {
+            Match_Pulses++;
+        }
+    }
+
+    // Los pedidos de DMA de MATx.0 y MATx.1 se generan en cada match.
+    if (match < 2)
+    {
+        SIM_GPDMA_Request((uint8_t)(GPDMA_CONN_MAT0_0 + 2 * timer + match));
+    }
+}
+
+/**
+ * @brief Procesa el valor actual del TC: match registers, reinicio de ciclo y salidas.
+ */
+static void TIMER_Event(TIMER_Counter_Type* c)
+{
+    uint8_t index = (uint8_t)(c - Counters);
+
+    for (uint8_t m = 0; m < c->Matches; m++)
+    {
+        uint32_t mcr = (c->Mcr >> (3 * m)) & 0x7;
+
+        if (c->Tc != c->Mr[m])
+        {
+            continue;
+        }
+
+        if (mcr & MCR_INTERRUPT)
+        {
+            c->Ir |= TIMER_IrBit(m);
+        }
+        if (mcr & MCR_RESET)
+        {
+            c->Reset_Pending = TRUE;
+        }
+        if (mcr & MCR_STOP)
+        {
+            c->Tcr &= ~TCR_ENABLE;
+        }
+
+        if (index == TIMER_PWM)
+        {
+            // El reinicio por MR0 transfiere los match registers habilitados en LER.
+            if (m == 0 && (mcr & MCR_RESET) && (c->Tcr & TCR_PWM))
+            {
+                for (uint8_t i = 0; i < PWM_MATCHES; i++)
+                {
+                    if (c->Ler & (1UL << i))
+                    {
+                        c->Mr[i] = c->Shadow[i];
+                    }
+                }
+                c->Ler = 0;
+            }
+        }
+        else
+        {
+            TIMER_ExternalMatch(c, index, m);
+        }
+    }
+
+    if (index == TIMER_PWM)
+    {
+        PWM_UpdateOutputs(c);
+    }
+
+    SIM_CORE_SetIRQ(c->Irq, (c->Ir != 0) ? TRUE : FALSE);
+}
+
+/**
+ * @brief Lleva un contador hasta el instante indicado.
+ */
+static void TIMER_Update(TIMER_Counter_Type* c, uint64_t now)
+{
+    uint64_t period = SIM_SC_PclkPeriod(c->Pclksel);
+    uint64_t edges = (now - c->Edge) / period;
+    uint64_t ticks = (uint64_t)c->Pr + 1;
+
+    c->Edge += edges * period;
+
+    while (edges > 0 && TIMER_Running(c) == TRUE)
+    {
+        uint64_t first = (c->Pc <= c->Pr) ? (uint64_t)(c->Pr - c->Pc) + 1 : 1;
+        uint64_t increments;
+        uint64_t distance;
+        uint64_t used;
+
+        if (edges < first)
+        {
+            c->Pc += (uint32_t)edges;
+            return;
+        }
+
+        increments = 1 + (edges - first) / ticks;
+        distance = TIMER_Distance(c);
+        if (increments > distance)
+        {
+            increments = distance;
+        }
+
+        used = first + (increments - 1) * ticks;
+        edges -= used;
+        c->Pc = 0;
+        c->Tc = (c->Reset_Pending == TRUE) ? (uint32_t)(increments - 1) : c->Tc + (uint32_t)increments;
+        c->Reset_Pending = FALSE;
+
+        if (increments == distance)
+        {
+            TIMER_Event(c);
+        }
+        else
+        {
+            // Quedan menos flancos que un incremento completo.
+            c->Pc = (uint32_t)edges;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Instante del proximo evento de un contador.
+ */
+static uint64_t TIMER_Next(const TIMER_Counter_Type* c)
+{
+    uint64_t first;
+    uint64_t edges;
+    uint64_t time;
+
+    if (TIMER_Running(c) == FALSE)
+    {
+        return SIM_NEVER;
+    }
+
+    first = (c->Pc <= c->Pr) ? (uint64_t)(c->Pr - c->Pc) + 1 : 1;
+    edges = first + (TIMER_Distance(c) - 1) * ((uint64_t)c->Pr + 1);
+    if (__builtin_mul_overflow(edges, SIM_SC_PclkPeriod(c->Pclksel), &time) ||
+        __builtin_add_overflow(time, c->Edge, &time))
+    {
+        return SIM_NEVER;
+    }
+
+    return time;
+}
+
+/**
+ * @brief Lectura de un registro de un contador.
+ */
+static uint32_t TIMER_Read(TIMER_Counter_Type* c, uint32_t offset, SIM_Access_Type access)
+{
+    switch (offset)
+    {
+    case TIMER_OFFSET(IR):
+        return (access == SIM_ACCESS_READ) ? c->Ir : 0;
+    case TIMER_OFFSET(TCR):
+        return c->Tcr;
+    case TIMER_OFFSET(TC):
+        return c->Tc;
+    case TIMER_OFFSET(PR):
+        return c->Pr;
+    case TIMER_OFFSET(PC):
+        return c->Pc;
+    case TIMER_OFFSET(MCR):
+        return c->Mcr;
+    case TIMER_OFFSET(PCR):
+        return (c->Matches == PWM_MATCHES) ? c->Pcr : c->Store[offset / 4];
+    case TIMER_OFFSET(LER):
+        return (c->Matches == PWM_MATCHES) ? c->Ler : c->Store[offset / 4];
+    default:
+        break;
+    }
+
+    for (uint8_t m = 0; m < c->Matches; m++)
+    {
+        if (offset == TIMER_MrOffset(m))
+        {
+            return (c->Matches == PWM_MATCHES) ? c->Shadow[m] : c->Mr[m];
+        }
+    }
+
+    if (offset == TIMER_EMR && c->Matches == TIMER_MATCHES)
+    {
+        return c->Emr;
+    }
+
+    return c->Store[offset / 4];
+}
+
+/**
+ * @brief Escritura de un registro de un contador.
+ */
+static void TIMER_Write(TIMER_Counter_Type* c, uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case TIMER_OFFSET(IR):
+        c->Ir &= ~value;
+        SIM_CORE_SetIRQ(c->Irq, (c->Ir != 0) ? TRUE : FALSE);
+        return;
+    case TIMER_OFFSET(TCR):
+        c->Tcr = value & ((c->Matches == PWM_MATCHES) ? (TCR_ENABLE | TCR_RESET | TCR_PWM) : (TCR_ENABLE | TCR_RESET));
+        if (c->Tcr & TCR_RESET)
+        {
+            c->Tc = 0;
+            c->Pc = 0;
+            c->Reset_Pending = FALSE;
+        }
+        if (c->Matches == PWM_MATCHES)
+        {
+            PWM_UpdateOutputs(c);
+        }
+        return;
+    case TIMER_OFFSET(TC):
+        c->Tc = value;
+        c->Reset_Pending = FALSE;
+        return;
+    case TIMER_OFFSET(PR):
+        c->Pr = value;
+        return;
+    case TIMER_OFFSET(PC):
+        c->Pc = value;
+        return;
+    case TIMER_OFFSET(MCR):
+        c->Mcr = value;
+        return;
+    case TIMER_OFFSET(PCR):
+        if (c->Matches == PWM_MATCHES)
+        {
+            c->Pcr = value;
+            PWM_UpdateOutputs(c);
+            return;
+        }
+        break;
+    case TIMER_OFFSET(LER):
+        if (c->Matches == PWM_MATCHES)
+        {
+            c->Ler = value & 0x7F;
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    for (uint8_t m = 0; m < c->Matches; m++)
+    {
+        if (offset == TIMER_MrOffset(m))
+        {
+            // En modo PWM el valor queda en sombra hasta el proximo reinicio habilitado por LER.
+            c->Shadow[m] = value;
+            if ((c->Tcr & TCR_PWM) == 0)
+            {
+                c->Mr[m] = value;
+            }
+            return;
+        }
+    }
+
+    if (offset == TIMER_EMR && c->Matches == TIMER_MATCHES)
+    {
+        c->Emr = value & 0xFFF;
+        return;
+    }
+
+    c->Store[offset / 4] = value;
+}
+
+/**
+ * @brief Genera las funciones de acceso y el descriptor de una instancia.
+ */
+#define TIMER_DEVICE(n)                                                                                              \
+    static uint32_t TIMER##n##_Read(uint32_t offset, SIM_Access_Type access)                                         \
+    {                                                                                                                \
+        return TIMER_Read(&Counters[n], offset, access);                                                             \
+    }                                                                                                                \
+    static void TIMER##n##_Write(uint32_t offset, uint32_t value)                                                    \
+    {                                                                                                                \
+        TIMER_Write(&Counters[n], offset, value);                                                                    \
+    }                                                                                                                \
+    static void TIMER##n##_Update(uint64_t now)                                                                      \
+    {                                                                                                                \
+        TIMER_Update(&Counters[n], now);                                                                             \
+    }                                                                                                                \
+    static uint64_t TIMER##n##_Next(void)                                                                            \
+    {                                                                                                                \
+        return TIMER_Next(&Counters[n]);                                                                             \
+    }
+
+TIMER_DEVICE(0)
+TIMER_DEVICE(1)
+TIMER_DEVICE(2)
+TIMER_DEVICE(3)
+TIMER_DEVICE(4)
+
+/** Descriptor de una instancia */
+#define TIMER_DESCRIPTOR(n)                                                                                          \
+    {                                                                                                                \
+        .Name = NULL, .Base = 0, .Size = 0x80, .Read = TIMER##n##_Read, .Write = TIMER##n##_Write,                   \
+        .Update = TIMER##n##_Update, .Next = TIMER##n##_Next,                                                        \
+    }
+
+static SIM_Device_Type Devices[TIMER_INSTANCES] = {
+    TIMER_DESCRIPTOR(0), TIMER_DESCRIPTOR(1), TIMER_DESCRIPTOR(2), TIMER_DESCRIPTOR(3), TIMER_DESCRIPTOR(4),
+};
+
+void SIM_TIMER_Init(void)
+{
+    for (uint8_t i = 0; i < TIMER_INSTANCES; i++)
+    {
+        Devices[i].Name = Counters[i].Name;
+        Devices[i].Base = Counters[i].Base;
+        SIM_CORE_Register(&Devices[i]);
+    }
+}
+
+uint32_t SIM_TIMER_GetPulses(void)
+{
+    return Pulses;
+}
+
+uint32_t SIM_TIMER_GetMatchPulses(void)
+{
+    return Match_Pulses;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file sim_trace.c
+ * @brief Archivos de traza de las salidas del firmware: bytes de las UARTs, valores del DAC, PWM, MAT y puertos.
+ *
+ * Cada salida tiene su archivo de texto en el directorio de trazas, con una linea por evento y el instante virtual
+ * en nanosegundos como primer campo. Los archivos se crean la primera vez que hay algo para registrar, asi que la
+ * ausencia de un archivo indica que esa salida nunca cambio. Con el mismo guion y la misma semilla las trazas son
+ * identicas entre corridas y se pueden comparar contra una referencia.
+ */
+
+#include <stdio.h>
+
+#include "sim.h"
+
+// Definiciones del modulo:
+#define TRACE_PATH_SIZE 512 /**< Longitud maxima de la ruta de un archivo de traza */
+
+/**
+ * @brief Archivo de traza.
+ */
+typedef struct
+{
+    const char* Name;   /**< Nombre del archivo dentro del directorio */
+    const char* Header; /**< Primera linea (descripcion de las columnas) */
+    FILE* File;         /**< Archivo abierto, o NULL */
+    uint32_t Events;    /**< Lineas registradas */
+} TRACE_File_Type;
+
+static TRACE_File_Type Uart_Files[SIM_UART_COUNT] = {
+    {.Name = "uart0_tx.trace", .Header = "# tiempo_ns byte"},
+    {.Name = "uart1_tx.trace", .Header = "# tiempo_ns byte"},
+    {.Name = "uart2_tx.trace", .Header = "# tiempo_ns byte"},
+    {.Name = "uart3_tx.trace", .Header = "# tiempo_ns byte"},
+};
+static TRACE_File_Type Dac_File = {.Name = "dac.trace", .Header = "# tiempo_ns valor"};
+static TRACE_File_Type Pwm_File = {.Name = "pwm.trace", .Header = "# tiempo_ns canal nivel"};
+static TRACE_File_Type Match_File = {.Name = "match.trace", .Header = "# tiempo_ns timer match nivel"};
+static TRACE_File_Type Gpio_File = {.Name = "gpio.trace", .Header = "# tiempo_ns puerto salidas"};
+
+static const char* Directory = NULL; /**< Directorio de trazas, o NULL si estan deshabilitadas */
+
+/**
+ * @brief Abre el archivo de una traza si todavia no lo esta.
+ *
+ * @return NULL si las trazas estan deshabilitadas.
+ */
+static FILE* TRACE_Get(TRACE_File_Type* trace)
+{
+    char path[TRACE_PATH_SIZE];
+
+    trace->Events++;
+    if (Directory == NULL || trace->File != NULL)
+    {
+        return trace->File;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", Directory, trace->Name);
+    trace->File = fopen(path, "w");
+    if (trace->File == NULL)
+    {
+        SIM_CORE_Fail("no se puede crear %s", path);
+    }
+
+    fprintf(trace->File, "%s\n", trace->Header);
+    return trace->File;
+}
+
+/**
+ * @brief Cierra el archivo de una traza.
+ */
+static void TRACE_CloseFile(TRACE_File_Type* trace)
+{
+    if (trace->File != NULL)
+    {
+        fclose(trace->File);
+        trace->File = NULL;
+    }
+}
+
+/**
+ * @brief Instante actual en nanosegundos.
+ */
+static unsigned long long TRACE_Time(void)
+{
+    return (unsigned long long)(SIM_Now / SIM_PS_PER_NS);
+}
+
+Status SIM_TRACE_Open(const char* directory)
+{
+    FILE* probe;
+    char path[TRACE_PATH_SIZE];
+
+    Directory = directory;
+    if (directory == NULL)
+    {
+        return SUCCESS;
+    }
+
+    // Comprueba que el directorio exista y se pueda escribir antes de arrancar el firmware.
+    snprintf(path, sizeof(path), "%s/%s", directory, Uart_Files[0].Name);
+    probe = fopen(path, "w");
+    if (probe == NULL)
+    {
+        Directory = NULL;
+        return ERROR;
+    }
+    fclose(probe);
+    remove(path);
+
+    return SUCCESS;
+}
+
+void SIM_TRACE_Close(void)
+{
+    for (uint8_t i = 0; i < SIM_UART_COUNT; i++)
+    {
+        TRACE_CloseFile(&Uart_Files[i]);
+    }
+    TRACE_CloseFile(&Dac_File);
+    TRACE_CloseFile(&Pwm_File);
+    TRACE_CloseFile(&Match_File);
+    TRACE_CloseFile(&Gpio_File);
+}
+
+void SIM_TRACE_Uart(uint8_t uart, uint8_t byte)
+{
+    FILE* file;
+
+    if (uart >= SIM_UART_COUNT)
+    {
+        return;
+    }
+
+    file = TRACE_Get(&Uart_Files[uart]);
+    if (file != NULL)
+    {
+        fprintf(file, "%llu 0x%02X\n", TRACE_Time(), byte);
+    }
+}
+
+void SIM_TRACE_Dac(uint16_t value)
+{
+    FILE* file = TRACE_Get(&Dac_File);
+
+    if (file != NULL)
+    {
+        fprintf(file, "%llu %u\n", TRACE_Time(), value);
+    }
+}
+
+void SIM_TRACE_Pwm(uint8_t channel, uint8_t level)
+{
+    FILE* file = TRACE_Get(&Pwm_File);
+
+    if (file != NULL)
+    {
+        fprintf(file, "%llu %u %u\n", TRACE_Time(), channel, level);
+    }
+}
+
+void SIM_TRACE_Match(uint8_t timer, uint8_t match, uint8_t level)
+{
+    FILE* file = TRACE_Get(&Match_File);
+
+    if (file != NULL)
+    {
+        fprintf(file, "%llu %u %u %u\n", TRACE_Time(), timer, match, level);
+    }
+}
+
+void SIM_TRACE_Gpio(uint8_t port, uint32_t value)
+{
+    FILE* file = TRACE_Get(&Gpio_File);
+
+    if (file != NULL)
+    {
+        fprintf(file, "%llu %u 0x%08X\n", TRACE_Time(), port, value);
+    }
+}
+
+void SIM_TRACE_Summary(void)
+{
+    for (uint8_t i = 0; i < SIM_UART_COUNT; i++)
+    {
+        if (SIM_UART_GetSent(i) != 0)
+        {
+            printf("sim: UART%u: %u bytes transmitidos\n", i, SIM_UART_GetSent(i));
+        }
+    }
+
+    printf("sim: ADC: %u conversiones, GPDMA: %u transferencias\n", SIM_ADC_GetConversions(),
+           SIM_GPDMA_GetTransfers());
+    printf("sim: DAC: %u escrituras (%u cambios), PWM: %u pulsos, MAT: %u pulsos, GPIO: %u cambios de salida\n",
+           SIM_DAC_GetUpdates(), Dac_File.Events, SIM_TIMER_GetPulses(), SIM_TIMER_GetMatchPulses(),
+           Gpio_File.Events);
+}
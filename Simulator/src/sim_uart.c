@@ -0,0 +1,555 @@
+/**
+ * @file sim_uart.c
+ * @brief UARTs 0-3: divisores y FDR, FIFOs de 16 bytes, interrupciones del 16550 y pedidos de DMA.
+ *
+ * El tiempo de cada caracter se calcula con el divisor, el divisor fraccional y el formato de trama programados,
+ * por lo que un error de configuracion de baudios se ve en los instantes de la traza. Los bytes transmitidos se
+ * registran cuando termina de salir el bit de parada. Los bytes que inyecta el guion llegan espaciados por el
+ * tiempo de caracter y alimentan la FIFO de recepcion, el nivel de disparo y el timeout de caracter (CTI).
+ */
+
+#include <stdlib.h>
+
+#include "sim.h"
+
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+
+// Definiciones del modulo:
+#define UART_FIFO_SIZE  16   /**< Profundidad de las FIFOs */
+#define UART_CTI_CHARS  4    /**< Caracteres sin actividad para el timeout de recepcion */
+#define UART_LCR_DLAB   0x80 /**< Acceso a los divisores */
+#define UART_TER_TXEN   0x80 /**< Transmisor habilitado */
+#define UART_FCR_ENABLE 0x01 /**< FIFOs habilitadas */
+#define UART_FCR_RX_RST 0x02 /**< Reset de la FIFO de recepcion */
+#define UART_FCR_TX_RST 0x04 /**< Reset de la FIFO de transmision */
+#define UART_FCR_DMA    0x08 /**< Modo DMA */
+#define UART_IER_RBR    0x01 /**< Interrupcion de datos recibidos y timeout */
+#define UART_IER_THRE   0x02 /**< Interrupcion de THR vacio */
+#define UART_IER_RLS    0x04 /**< Interrupcion de estado de linea */
+#define UART_LSR_RDR    0x01 /**< Hay datos recibidos */
+#define UART_LSR_OE     0x02 /**< Desborde de la FIFO de recepcion */
+#define UART_LSR_THRE   0x20 /**< THR vacio */
+#define UART_LSR_TEMT   0x40 /**< Transmisor vacio */
+#define UART_IIR_NONE   0x01 /**< Sin interrupcion pendiente */
+#define UART_IIR_RLS    0x06 /**< Estado de linea */
+#define UART_IIR_RDA    0x04 /**< Datos disponibles */
+#define UART_IIR_CTI    0x0C /**< Timeout de caracter */
+#define UART_IIR_THRE   0x02 /**< THR vacio */
+#define UART_IIR_FIFO   0xC0 /**< FIFOs habilitadas */
+
+#define UART_OFFSET(reg) offsetof(LPC_UART_TypeDef, reg) /**< Desplazamiento de un registro */
+#define UART_DATA        0x00                            /**< RBR/THR/DLL */
+#define UART_DLM_IER     0x04                            /**< DLM/IER */
+#define UART_IIR_FCR     0x08                            /**< IIR/FCR */
+
+/**
+ * @brief FIFO de bytes de una UART.
+ */
+typedef struct
+{
+    uint8_t Data[UART_FIFO_SIZE]; /**< Almacenamiento */
+    uint8_t Head;                 /**< Proxima posicion a leer */
+    uint8_t Count;                /**< Bytes almacenados */
+} UART_Fifo_Type;
+
+/**
+ * @brief Byte inyectado por el guion, pendiente de llegar.
+ */
+typedef struct
+{
+    uint8_t Byte;  /**< Valor */
+    uint64_t Time; /**< Instante en que termina de recibirse */
+} UART_Arrival_Type;
+
+/**
+ * @brief Estado de una UART.
+ */
+typedef struct
+{
+    uint8_t Pclksel;             /**< Bit de PCLKSEL */
+    IRQn_Type Irq;               /**< Interrupcion */
+    uint8_t Tx_Conn;             /**< Conexion de DMA de transmision */
+    uint8_t Rx_Conn;             /**< Conexion de DMA de recepcion */
+    uint32_t Dll;                /**< DLL */
+    uint32_t Dlm;                /**< DLM */
+    uint32_t Ier;                /**< IER */
+    uint32_t Fcr;                /**< Ultimo FCR escrito */
+    uint32_t Lcr;                /**< LCR */
+    uint32_t Lsr_Errors;         /**< Errores de linea pendientes de leer */
+    uint32_t Fdr;                /**< FDR */
+    uint32_t Ter;                /**< TER */
+    uint32_t Store[0x60 / 4];    /**< Registros sin modelo (SCR, ACR, ICR, etc.) */
+    UART_Fifo_Type Tx;           /**< FIFO de transmision */
+    UART_Fifo_Type Rx;           /**< FIFO de recepcion */
+    Bool Shifting;               /**< Hay un byte en el registro de desplazamiento */
+    uint8_t Shift_Byte;          /**< Byte en transmision */
+    uint64_t Shift_End;          /**< Fin de la transmision del byte */
+    Bool Thre_Pending;           /**< Interrupcion THRE pendiente */
+    uint64_t Rx_Activity;        /**< Ultima recepcion o lectura de RBR */
+    UART_Arrival_Type* Arrivals; /**< Bytes del guion pendientes de llegar */
+    uint32_t Arrival_Head;       /**< Proximo byte a llegar */
+    uint32_t Arrival_Count;      /**< Bytes en la cola de llegada */
+    uint32_t Arrival_Size;       /**< Capacidad de la cola de llegada */
+    uint32_t Sent;               /**< Bytes transmitidos */
+} UART_Port_Type;
+
+static UART_Port_Type Ports[SIM_UART_COUNT] = {
+    {.Pclksel = CLKPWR_PCLKSEL_UART0, .Irq = UART0_IRQn, .Tx_Conn = GPDMA_CONN_UART0_Tx,
+     .Rx_Conn = GPDMA_CONN_UART0_Rx},
+    {.Pclksel = CLKPWR_PCLKSEL_UART1, .Irq = UART1_IRQn, .Tx_Conn = GPDMA_CONN_UART1_Tx,
+     .Rx_Conn = GPDMA_CONN_UART1_Rx},
+    {.Pclksel = CLKPWR_PCLKSEL_UART2, .Irq = UART2_IRQn, .Tx_Conn = GPDMA_CONN_UART2_Tx,
+     .Rx_Conn = GPDMA_CONN_UART2_Rx},
+    {.Pclksel = CLKPWR_PCLKSEL_UART3, .Irq = UART3_IRQn, .Tx_Conn = GPDMA_CONN_UART3_Tx,
+     .Rx_Conn = GPDMA_CONN_UART3_Rx},
+};
+
+static Bool Servicing = FALSE; /**< Evita la reentrada al atender pedidos de DMA */
+
+/**
+ * @brief Agrega un byte a una FIFO.
+ *
+ * @return FALSE si la FIFO estaba llena.
+ */
+static Bool FIFO_Push(UART_Fifo_Type* fifo, uint8_t byte)
+{
+    if (fifo->Count >= UART_FIFO_SIZE)
+    {
+        return FALSE;
+    }
+
+    fifo->Data[(fifo->Head + fifo->Count) % UART_FIFO_SIZE] = byte;
+    fifo->Count++;
+    return TRUE;
+}
+
+/**
+ * @brief Extrae un byte de una FIFO (0 si esta vacia).
+ */
+static uint8_t FIFO_Pop(UART_Fifo_Type* fifo)
+{
+    uint8_t byte;
+
+    if (fifo->Count == 0)
+    {
+        return 0;
+    }
+
+    byte = fifo->Data[fifo->Head];
+    fifo->Head = (uint8_t)((fifo->Head + 1) % UART_FIFO_SIZE);
+    fifo->Count--;
+    return byte;
+}
+
+/**
+ * @brief Duracion de un caracter con la configuracion actual.
+ *
+ * @return Tiempo en picosegundos, o SIM_NEVER si el divisor es cero.
+ */
+static uint64_t UART_CharTime(const UART_Port_Type* u)
+{
+    uint64_t divisor = (u->Dlm << 8) | u->Dll;
+    uint64_t mul = (u->Fdr >> 4) & 0xF;
+    uint64_t divadd = u->Fdr & 0xF;
+    uint64_t bits = 1 + 5 + (u->Lcr & 0x3) + ((u->Lcr & 0x08) ? 1 : 0) + ((u->Lcr & 0x04) ? 2 : 1);
+
+    if (divisor == 0)
+    {
+        return SIM_NEVER;
+    }
+    if (mul == 0)
+    {
+        mul = 1;
+        divadd = 0;
+    }
+
+    return SIM_SC_PclkPeriod(u->Pclksel) * 16 * divisor * (mul + divadd) * bits / mul;
+}
+
+/**
+ * @brief Nivel de disparo de la FIFO de recepcion.
+ */
+static uint8_t UART_TriggerLevel(const UART_Port_Type* u)
+{
+    static const uint8_t levels[4] = {1, 4, 8, 14};
+
+    return ((u->Fcr & UART_FCR_ENABLE) != 0) ? levels[(u->Fcr >> 6) & 0x3] : 1;
+}
+
+/**
+ * @brief Indica si vencio el timeout de caracter de la recepcion.
+ */
+static Bool UART_Timeout(const UART_Port_Type* u)
+{
+    uint64_t char_time = UART_CharTime(u);
+
+    return (u->Rx.Count > 0 && char_time != SIM_NEVER && SIM_Now >= u->Rx_Activity + UART_CTI_CHARS * char_time)
+               ? TRUE
+               : FALSE;
+}
+
+/**
+ * @brief Fuente de interrupcion de mayor prioridad (valor de IIR sin los bits de FIFO).
+ */
+static uint32_t UART_Source(const UART_Port_Type* u)
+{
+    if ((u->Ier & UART_IER_RLS) && u->Lsr_Errors != 0)
+    {
+        return UART_IIR_RLS;
+    }
+    if ((u->Ier & UART_IER_RBR) && u->Rx.Count >= UART_TriggerLevel(u))
+    {
+        return UART_IIR_RDA;
+    }
+    if ((u->Ier & UART_IER_RBR) && UART_Timeout(u) == TRUE)
+    {
+        return UART_IIR_CTI;
+    }
+    if ((u->Ier & UART_IER_THRE) && u->Thre_Pending == TRUE)
+    {
+        return UART_IIR_THRE;
+    }
+
+    return UART_IIR_NONE;
+}
+
+/**
+ * @brief Actualiza la linea de interrupcion de una UART.
+ */
+static void UART_UpdateLine(const UART_Port_Type* u)
+{
+    SIM_CORE_SetIRQ(u->Irq, (UART_Source(u) != UART_IIR_NONE) ? TRUE : FALSE);
+}
+
+/**
+ * @brief Carga el registro de desplazamiento desde la FIFO si el transmisor esta libre.
+ */
+static void UART_StartShift(UART_Port_Type* u, uint64_t when)
+{
+    uint64_t char_time = UART_CharTime(u);
+
+    if (u->Shifting == TRUE || u->Tx.Count == 0 || (u->Ter & UART_TER_TXEN) == 0 || char_time == SIM_NEVER)
+    {
+        return;
+    }
+
+    u->Shift_Byte = FIFO_Pop(&u->Tx);
+    u->Shifting = TRUE;
+    u->Shift_End = when + char_time;
+
+    if (u->Tx.Count == 0)
+    {
+        u->Thre_Pending = TRUE;
+    }
+}
+
+/**
+ * @brief Lleva una UART hasta el instante indicado.
+ */
+static void UART_Update(UART_Port_Type* u, uint64_t now)
+{
+    while (u->Shifting == TRUE && u->Shift_End <= now)
+    {
+        u->Shifting = FALSE;
+        u->Sent++;
+        SIM_TRACE_Uart((uint8_t)(u - Ports), u->Shift_Byte);
+        UART_StartShift(u, u->Shift_End);
+    }
+
+    while (u->Arrival_Head < u->Arrival_Count && u->Arrivals[u->Arrival_Head].Time <= now)
+    {
+        if (FIFO_Push(&u->Rx, u->Arrivals[u->Arrival_Head].Byte) == FALSE)
+        {
+            u->Lsr_Errors |= UART_LSR_OE;
+        }
+        u->Rx_Activity = u->Arrivals[u->Arrival_Head].Time;
+        u->Arrival_Head++;
+    }
+
+    UART_UpdateLine(u);
+    SIM_UART_ServiceDMA();
+}
+
+/**
+ * @brief Instante del proximo evento de una UART.
+ */
+static uint64_t UART_Next(const UART_Port_Type* u)
+{
+    uint64_t next = SIM_NEVER;
+    uint64_t char_time = UART_CharTime(u);
+
+    if (u->Shifting == TRUE)
+    {
+        next = u->Shift_End;
+    }
+    if (u->Arrival_Head < u->Arrival_Count && u->Arrivals[u->Arrival_Head].Time < next)
+    {
+        next = u->Arrivals[u->Arrival_Head].Time;
+    }
+
+    // El timeout de caracter es un evento solo si todavia no vencio.
+    if (u->Rx.Count > 0 && char_time != SIM_NEVER)
+    {
+        uint64_t timeout = u->Rx_Activity + UART_CTI_CHARS * char_time;
+
+        if (timeout > SIM_Now && timeout < next)
+        {
+            next = timeout;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief Lectura de un registro de una UART.
+ */
+static uint32_t UART_Read(UART_Port_Type* u, uint32_t offset, SIM_Access_Type access)
+{
+    uint32_t value;
+
+    switch (offset)
+    {
+    case UART_DATA:
+        if (u->Lcr & UART_LCR_DLAB)
+        {
+            return u->Dll;
+        }
+        if (access == SIM_ACCESS_PREFILL)
+        {
+            return 0;
+        }
+        value = FIFO_Pop(&u->Rx);
+        u->Rx_Activity = SIM_Now;
+        UART_UpdateLine(u);
+        return value;
+    case UART_DLM_IER:
+        return (u->Lcr & UART_LCR_DLAB) ? u->Dlm : u->Ier;
+    case UART_IIR_FCR:
+        if (access == SIM_ACCESS_PREFILL)
+        {
+            return 0;
+        }
+        value = UART_Source(u);
+        if (value == UART_IIR_THRE)
+        {
+            u->Thre_Pending = FALSE;
+            UART_UpdateLine(u);
+        }
+        return value | ((u->Fcr & UART_FCR_ENABLE) ? UART_IIR_FIFO : 0);
+    case UART_OFFSET(LCR):
+        return u->Lcr;
+    case UART_OFFSET(LSR):
+        value = u->Lsr_Errors;
+        value |= (u->Rx.Count > 0) ? UART_LSR_RDR : 0;
+        value |= (u->Tx.Count == 0) ? UART_LSR_THRE : 0;
+        value |= (u->Tx.Count == 0 && u->Shifting == FALSE) ? UART_LSR_TEMT : 0;
+        if (access == SIM_ACCESS_READ)
+        {
+            u->Lsr_Errors = 0;
+            UART_UpdateLine(u);
+        }
+        return value;
+    case UART_OFFSET(FDR):
+        return u->Fdr;
+    case UART_OFFSET(TER):
+        return u->Ter;
+    case UART_OFFSET(FIFOLVL):
+        return u->Rx.Count | ((uint32_t)u->Tx.Count << 8);
+    default:
+        return u->Store[offset / 4];
+    }
+}
+
+/**
+ * @brief Escritura de un registro de una UART.
+ */
+static void UART_Write(UART_Port_Type* u, uint32_t offset, uint32_t value)
+{
+    switch (offset)
+    {
+    case UART_DATA:
+        if (u->Lcr & UART_LCR_DLAB)
+        {
+            u->Dll = value & 0xFF;
+            return;
+        }
+        FIFO_Push(&u->Tx, (uint8_t)value);
+        u->Thre_Pending = FALSE;
+        UART_StartShift(u, SIM_Now);
+        break;
+    case UART_DLM_IER:
+        if (u->Lcr & UART_LCR_DLAB)
+        {
+            u->Dlm = value & 0xFF;
+            return;
+        }
+        // Como en el 16550, habilitar THRE con el THR vacio genera la interrupcion.
+        if ((value & UART_IER_THRE) && (u->Ier & UART_IER_THRE) == 0 && u->Tx.Count == 0)
+        {
+            u->Thre_Pending = TRUE;
+        }
+        u->Ier = value & 0x307;
+        break;
+    case UART_IIR_FCR:
+        u->Fcr = value & (UART_FCR_ENABLE | UART_FCR_DMA | 0xC0);
+        if (value & UART_FCR_RX_RST)
+        {
+            u->Rx.Count = 0;
+        }
+        if (value & UART_FCR_TX_RST)
+        {
+            u->Tx.Count = 0;
+        }
+        break;
+    case UART_OFFSET(LCR):
+        u->Lcr = value & 0xFF;
+        return;
+    case UART_OFFSET(FDR):
+        u->Fdr = value & 0xFF;
+        return;
+    case UART_OFFSET(TER):
+        u->Ter = value & UART_TER_TXEN;
+        UART_StartShift(u, SIM_Now);
+        break;
+    case UART_OFFSET(LSR):
+    case UART_OFFSET(FIFOLVL):
+        return;
+    default:
+        u->Store[offset / 4] = value;
+        return;
+    }
+
+    UART_UpdateLine(u);
+    SIM_UART_ServiceDMA();
+}
+
+/**
+ * @brief Genera las funciones de acceso de una instancia.
+ */
+#define UART_DEVICE(n)                                                                                               \
+    static uint32_t UART##n##_Read(uint32_t offset, SIM_Access_Type access)                                          \
+    {                                                                                                                \
+        return UART_Read(&Ports[n], offset, access);                                                                 \
+    }                                                                                                                \
+    static void UART##n##_Write(uint32_t offset, uint32_t value)                                                     \
+    {                                                                                                                \
+        UART_Write(&Ports[n], offset, value);                                                                        \
+    }                                                                                                                \
+    static void UART##n##_Update(uint64_t now)                                                                       \
+    {                                                                                                                \
+        UART_Update(&Ports[n], now);                                                                                 \
+    }                                                                                                                \
+    static uint64_t UART##n##_Next(void)                                                                             \
+    {                                                                                                                \
+        return UART_Next(&Ports[n]);                                                                                 \
+    }
+
+UART_DEVICE(0)
+UART_DEVICE(1)
+UART_DEVICE(2)
+UART_DEVICE(3)
+
+/** Descriptor de una instancia */
+#define UART_DESCRIPTOR(n, base)                                                                                     \
+    {                                                                                                                \
+        .Name = "UART" #n, .Base = (base), .Size = 0x60, .Read = UART##n##_Read, .Write = UART##n##_Write,           \
+        .Update = UART##n##_Update, .Next = UART##n##_Next,                                                          \
+    }
+
+static const SIM_Device_Type Devices[SIM_UART_COUNT] = {
+    UART_DESCRIPTOR(0, LPC_UART0_BASE),
+    UART_DESCRIPTOR(1, LPC_UART1_BASE),
+    UART_DESCRIPTOR(2, LPC_UART2_BASE),
+    UART_DESCRIPTOR(3, LPC_UART3_BASE),
+};
+
+void SIM_UART_Init(void)
+{
+    for (uint8_t i = 0; i < SIM_UART_COUNT; i++)
+    {
+        // Valores de reset: DLL = 1, FDR = 0x10 (sin division fraccional), TER con el transmisor habilitado.
+        Ports[i].Dll = 1;
+        Ports[i].Fdr = 0x10;
+        Ports[i].Ter = UART_TER_TXEN;
+        SIM_CORE_Register(&Devices[i]);
+    }
+}
+
+void SIM_UART_Receive(uint8_t uart, const uint8_t* data, uint32_t length)
+{
+    UART_Port_Type* u;
+    uint64_t char_time;
+    uint64_t time;
+
+    if (uart >= SIM_UART_COUNT)
+    {
+        return;
+    }
+
+    u = &Ports[uart];
+    char_time = UART_CharTime(u);
+    if (char_time == SIM_NEVER)
+    {
+        return;
+    }
+
+    if (u->Arrival_Count + length > u->Arrival_Size)
+    {
+        u->Arrival_Size = (u->Arrival_Count + length) * 2;
+        u->Arrivals = realloc(u->Arrivals, u->Arrival_Size * sizeof(UART_Arrival_Type));
+        if (u->Arrivals == NULL)
+        {
+            SIM_CORE_Fail("sin memoria para la recepcion de UART%u", uart);
+        }
+    }
+
+    // Los bytes llegan uno detras de otro, a continuacion de los que todavia estan en camino.
+    time = SIM_Now;
+    if (u->Arrival_Head < u->Arrival_Count && u->Arrivals[u->Arrival_Count - 1].Time > time)
+    {
+        time = u->Arrivals[u->Arrival_Count - 1].Time;
+    }
+    for (uint32_t i = 0; i < length; i++)
+    {
+        time += char_time;
+        u->Arrivals[u->Arrival_Count].Byte = data[i];
+        u->Arrivals[u->Arrival_Count].Time = time;
+        u->Arrival_Count++;
+    }
+}
+
+void SIM_UART_ServiceDMA(void)
+{
+    if (Servicing == TRUE)
+    {
+        return;
+    }
+    Servicing = TRUE;
+
+    for (uint8_t i = 0; i < SIM_UART_COUNT; i++)
+    {
+        UART_Port_Type* u = &Ports[i];
+
+        if ((u->Fcr & (UART_FCR_ENABLE | UART_FCR_DMA)) != (UART_FCR_ENABLE | UART_FCR_DMA))
+        {
+            continue;
+        }
+
+        // Cada pedido transfiere una rafaga; se repite mientras haya lugar (TX) o datos (RX).
+        while (u->Tx.Count < UART_FIFO_SIZE && SIM_GPDMA_Request(u->Tx_Conn) == TRUE)
+        {
+        }
+        while (u->Rx.Count > 0 && SIM_GPDMA_Request(u->Rx_Conn) == TRUE)
+        {
+        }
+    }
+
+    Servicing = FALSE;
+}
+
+uint32_t SIM_UART_GetSent(uint8_t uart)
+{
+    return (uart < SIM_UART_COUNT) ? Ports[uart].Sent : 0;
+}
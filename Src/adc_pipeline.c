@@ -0,0 +1,431 @@
+/**
+ * @file adc_pipeline.c
+ * @brief Adquisicion del ADC con sobremuestreo y decimacion sobre buffers ping-pong del GPDMA.
+ *
+ * Cada palabra leida del ADGDR incluye el numero de canal convertido, por lo que el promedio se arma por canal
+ * sin depender del orden de las conversiones. Promediar 4^n muestras y escalar por 2^n agrega n bits efectivos
+ * de resolucion cuando el ruido de la señal supera el escalon del ADC.
+ *
+ * Las sumas se indexan directamente con el numero de canal de la palabra (3 bits, los 8 canales del ADC), asi que
+ * el costo por muestra no depende de cuantos canales se adquieren. Solo los canales de la mascara pasan a la etapa
+ * de filtros, cada uno en su carril (en el orden de los canales).
+ *
+ * El bloque decimado es una muestra de la etapa de filtros, que corre en la misma interrupcion (unos cientos de
+ * ciclos por bloque, medidos con ISR_PROFILE_FILTER).
+ *
+ * Con disparo por MAT0.1, la rotacion de canales es una tabla de palabras del ADCR que el GPDMA recorre en anillo
+ * con los pedidos de MAT0.0, dos por conversion (MR0 coincide en cada ciclo del timer): la del ciclo en bajo y la
+ * del ciclo en alto, despues del fin de la conversion, seleccionan el mismo canal. Los bloques no cambian, asi que
+ * la decimacion no distingue el modo.
+ */
+
+#include "adc_pipeline.h"
+
+#include "LPC17xx.h"
+#include "ahbram.h"
+#include "lpc17xx_adc.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_timer.h"
+#include "isr_profile.h"
+#include "ramfunc.h"
+#include "sensor_filter.h"
+#include "text_fmt.h"
+
+#if FILTER_MAX_CHANNELS < ADC_PIPE_MAX_CHANNELS
+#error "La etapa de filtros tiene que tener un carril por canal del ADC"
+#endif
+
+// Definiciones del modulo:
+#define ADC_PIPE_NO_LANE  0xFF   /**< Carril de un canal que no se adquiere */
+#define ADC_PIPE_MIN_HALF 2      /**< Ciclo minimo del TIMER0 en ticks (MR0 en la mitad, antes que MR1) */
+#define ADC_PIPE_CR_SEL   0xFFUL /**< Campo SEL del ADCR */
+#define ADC_PIPE_CR_MODE  (ADC_PIPE_CR_SEL | ADC_CR_BURST | ADC_CR_START_MASK | ADC_CR_EDGE) /**< Bits del modo */
+#define ADC_PIPE_SCAN_CH  ((LPC_GPDMACH_TypeDef*)(LPC_GPDMACH0_BASE + 0x20 * ADC_PIPE_SCAN_DMA_CHANNEL)) /**< Canal */
+
+// Memoria que recorre el GPDMA: el flujo del ADC va en AHBRAM0, que comparte solo con el EMAC (ver ahbram.h).
+AHBRAM0_NOINIT static volatile uint32_t Blocks[2][ADC_PIPE_MAX_WORDS]; /**< Bloques ping-pong de conversiones */
+AHBRAM0_BSS static GPDMA_LLI_Type Block_LLI[2];                        /**< LLI de cada bloque, en anillo */
+AHBRAM0_BSS static uint32_t Scan_Table[2 * ADC_PIPE_MAX_CHANNELS];     /**< ADCR de cada medio periodo */
+AHBRAM0_BSS static GPDMA_LLI_Type Scan_LLI;                            /**< LLI de la rotacion, en anillo */
+
+static volatile uint8_t Ready_Block = 0;                   /**< Bloque que completa el proximo fin de transferencia */
+static uint32_t Block_Words = 0;                           /**< Palabras de cada bloque (canales por muestras) */
+static uint8_t Lane[ADC_PIPE_MAX_CHANNELS];                /**< Carril de la etapa de filtros de cada canal */
+static uint8_t Lane_Channel[ADC_PIPE_MAX_CHANNELS];        /**< Canal de cada carril */
+static uint8_t Lanes = 0;                                  /**< Canales adquiridos */
+static volatile uint16_t Filtered[ADC_PIPE_MAX_CHANNELS];  /**< Ultimo valor decimado de cada canal */
+static FILTER_State_Type Filter;                           /**< Etapa de filtros sobre los valores decimados */
+static Bool Filter_Ready = FALSE;                          /**< La etapa ya se inicializo con el primer bloque */
+static volatile uint32_t Sample_Count = 0;                 /**< Muestras adquiridas desde el inicio */
+static uint32_t Last_Count = 0;                            /**< Muestras al momento de la ultima medicion de tasa */
+static uint32_t Sample_Rate = 0;                           /**< Ultima tasa medida en muestras por segundo */
+static ADC_PIPE_Mode_Type Mode = ADC_PIPE_BURST;           /**< Origen de las conversiones */
+static uint32_t Scan_Rate = 0;                             /**< Rondas por segundo programadas con disparo */
+
+/**
+ * @brief Indica si un canal del ADC se adquiere.
+ */
+#define ADC_PIPE_ACQUIRED(channel) ((channel) < ADC_PIPE_MAX_CHANNELS && Lane[(channel)] != ADC_PIPE_NO_LANE)
+
+/**
+ * @brief Promedia por canal las muestras de un bloque completo.
+ *
+ * @param block Bloque a procesar.
+ */
+RAMFUNC static void ADC_PIPE_Decimate(const volatile uint32_t* block)
+{
+    uint32_t sum[ADC_PIPE_MAX_CHANNELS] = {0};
+    uint32_t count[ADC_PIPE_MAX_CHANNELS] = {0};
+    uint16_t values[ADC_PIPE_MAX_CHANNELS];
+    uint32_t word;
+    uint32_t channel;
+
+    // El campo de canal del ADGDR tiene 3 bits: siempre es un indice valido de sum y count.
+    for (uint32_t i = 0; i < Block_Words; i++)
+    {
+        word = block[i];
+        channel = ADC_GDR_CH(word);
+        if (word & ADC_GDR_DONE_FLAG)
+        {
+            sum[channel] += ADC_GDR_RESULT(word);
+            count[channel]++;
+        }
+    }
+
+    // Con exactamente 4^n muestras el resultado equivale a sum >> n; la division cubre bloques desparejos.
+    for (uint32_t lane = 0; lane < Lanes; lane++)
+    {
+        channel = Lane_Channel[lane];
+        if (count[channel] != 0)
+        {
+            Filtered[channel] = (uint16_t)((sum[channel] << ADC_PIPE_OVERSAMPLE_BITS) / count[channel]);
+        }
+        values[lane] = Filtered[channel];
+    }
+
+    // Etapa de filtros: el primer bloque la inicializa para que no arranque desde cero.
+    ISR_PROFILE_ENTER(ISR_PROFILE_FILTER);
+    if (Filter_Ready == FALSE)
+    {
+        FILTER_Init(&Filter, values, Lanes);
+        Filter_Ready = TRUE;
+    }
+    else
+    {
+        FILTER_Update(&Filter, values);
+    }
+    ISR_PROFILE_EXIT(ISR_PROFILE_FILTER);
+
+    Sample_Count += Block_Words;
+}
+
+/**
+ * @brief Arranca el canal del GPDMA de los bloques desde el bloque 0.
+ */
+static void ADC_PIPE_StartBlocks(void)
+{
+    // Configuración del canal DMA: la primera transferencia llena el bloque 0 y continúa con la LLI del 1.
+    GPDMA_Channel_CFG_Type DMAChannel;
+    DMAChannel.ChannelNum = ADC_PIPE_DMA_CHANNEL;     // Canal DMA del ADC
+    DMAChannel.SrcMemAddr = 0;                        // No se usa, el origen es el ADGDR
+    DMAChannel.DstMemAddr = (uint32_t)Blocks[0];      // Dirección de destino (bloque 0)
+    DMAChannel.TransferSize = Block_Words;            // Tamaño de la transferencia (un bloque)
+    DMAChannel.TransferWidth = 0;                     // Solo se usa en M2M
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_P2M; // Tipo de transferencia (periférico a memoria)
+    DMAChannel.SrcConn = GPDMA_CONN_ADC;              // Conexión del origen (ADC)
+    DMAChannel.DstConn = 0;                           // No se usa conexión para el destino
+    DMAChannel.DMALLI = (uint32_t)&Block_LLI[1];      // Continúa con el bloque 1
+
+    Ready_Block = 0;
+    GPDMA_Setup(&DMAChannel);
+    GPDMA_ChannelCmd(ADC_PIPE_DMA_CHANNEL, ENABLE);
+}
+
+/**
+ * @brief Programa el TIMER0 y el canal de rotacion para disparar las conversiones.
+ *
+ * @param half Ciclo del TIMER0 en ticks (medio periodo de conversion).
+ */
+static void ADC_PIPE_StartTrigger(uint32_t half)
+{
+    TIM_TIMERCFG_Type TimerCfg;
+    TIM_MATCHCFG_Type MatchCfg;
+    GPDMA_Channel_CFG_Type DMAChannel;
+    uint32_t adcr = LPC_ADC->ADCR & ~ADC_PIPE_CR_MODE;
+
+    // Rotación: antes del disparo de cada carril, el medio periodo en bajo y el anterior (en alto, con la conversión
+    // del carril previo ya terminada) seleccionan su canal. La primera palabra la usa el primer ciclo.
+    for (uint8_t lane = 0; lane < Lanes; lane++)
+    {
+        Scan_Table[2 * lane] = adcr | ADC_CR_START_MAT01 | ADC_CR_CH_SEL(Lane_Channel[lane]);
+        Scan_Table[(2 * lane + 2 * Lanes - 1) % (2 * Lanes)] = Scan_Table[2 * lane];
+    }
+    Scan_LLI.SrcAddr = (uint32_t)Scan_Table;
+    Scan_LLI.DstAddr = (uint32_t) & (LPC_ADC->ADCR);
+    Scan_LLI.NextLLI = (uint32_t)&Scan_LLI;
+    Scan_LLI.Control = GPDMA_DMACCxControl_TransferSize(2 * Lanes) | GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) |
+                       GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_SI;
+
+    // TIMER0 sin prescaler: un tick por ciclo de PCLK.
+    TimerCfg.PrescaleOption = TIM_PRESCALE_TICKVAL;
+    TimerCfg.PrescaleValue = 1;
+    TIM_Init(LPC_TIM0, TIM_TIMER_MODE, &TimerCfg);
+
+    // Match 1: reinicia el contador y conmuta MAT0.1 (el reset en el match agrega un tick). Sin interrupción.
+    MatchCfg.MatchChannel = 1;
+    MatchCfg.IntOnMatch = DISABLE;
+    MatchCfg.ResetOnMatch = ENABLE;
+    MatchCfg.StopOnMatch = DISABLE;
+    MatchCfg.ExtMatchOutputType = TIM_EXTMATCH_TOGGLE;
+    MatchCfg.MatchValue = half - 1;
+    TIM_ConfigMatch(LPC_TIM0, &MatchCfg);
+
+    // Match 0: en la mitad del ciclo, solo el pedido de DMA que escribe el ADCR.
+    MatchCfg.MatchChannel = 0;
+    MatchCfg.ResetOnMatch = DISABLE;
+    MatchCfg.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+    MatchCfg.MatchValue = half / 2;
+    TIM_ConfigMatch(LPC_TIM0, &MatchCfg);
+
+    // MAT0.1 arranca en bajo: el primer flanco de subida es el del fin del primer ciclo.
+    LPC_TIM0->EMR &= ~TIM_EM(1);
+    TIM_ClearIntPending(LPC_TIM0, TIM_MR0_INT);
+    TIM_ClearIntPending(LPC_TIM0, TIM_MR1_INT);
+
+    // Configuración del canal DMA de rotación: la tabla hacia el ADCR, en anillo.
+    DMAChannel.ChannelNum = ADC_PIPE_SCAN_DMA_CHANNEL; // Canal DMA de los disparos
+    DMAChannel.SrcMemAddr = (uint32_t)Scan_Table;      // Dirección de origen (tabla de rotación)
+    DMAChannel.DstMemAddr = 0;                         // No se usa, el destino es el ADCR
+    DMAChannel.TransferSize = 2 * Lanes;               // Tamaño de la transferencia (una ronda)
+    DMAChannel.TransferWidth = 0;                      // Solo se usa en M2M
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_M2P;  // Memoria a periférico
+    DMAChannel.SrcConn = 0;                            // No se usa conexión de origen
+    DMAChannel.DstConn = GPDMA_CONN_MAT0_0;            // Conexión del destino (MAT0.0)
+    DMAChannel.DMALLI = (uint32_t)&Scan_LLI;           // La ronda se repite
+    GPDMA_Setup(&DMAChannel);
+
+    // GPDMA_Setup() toma el destino de la conexión (MR0 del TIMER0) y pide terminal count: se corrigen ambos.
+    ADC_PIPE_SCAN_CH->DMACCDestAddr = Scan_LLI.DstAddr;
+    ADC_PIPE_SCAN_CH->DMACCControl = Scan_LLI.Control;
+
+    // Primer canal y disparo por flanco de subida de MAT0.1:
+    LPC_ADC->ADCR = Scan_Table[0];
+    GPDMA_ChannelCmd(ADC_PIPE_SCAN_DMA_CHANNEL, ENABLE);
+    TIM_Cmd(LPC_TIM0, ENABLE);
+}
+
+Status ADC_PIPE_Init(uint8_t mask)
+{
+    if (mask == 0)
+    {
+        return ERROR;
+    }
+
+    // Carriles de la etapa de filtros, en el orden de los canales:
+    Lanes = 0;
+    for (uint8_t ch = 0; ch < ADC_PIPE_MAX_CHANNELS; ch++)
+    {
+        Lane[ch] = ADC_PIPE_NO_LANE;
+        if (mask & (1 << ch))
+        {
+            Lane[ch] = Lanes;
+            Lane_Channel[Lanes++] = ch;
+        }
+    }
+    Block_Words = (uint32_t)Lanes * ADC_PIPE_SAMPLES;
+    Filter_Ready = FALSE;
+
+    // Configuración de las dos LLI: cada una llena un bloque y apunta a la otra.
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        Block_LLI[i].SrcAddr = (uint32_t) & (LPC_ADC->ADGDR); // Registro global de datos del ADC
+        Block_LLI[i].DstAddr = (uint32_t)Blocks[i];           // Bloque destino
+        Block_LLI[i].NextLLI = (uint32_t)&Block_LLI[i ^ 1];   // Siguiente bloque del anillo
+        Block_LLI[i].Control = GPDMA_DMACCxControl_TransferSize(Block_Words) |
+                               GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) |
+                               GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DI |
+                               GPDMA_DMACCxControl_I; // Interrupción al completar el bloque
+    }
+
+    Mode = ADC_PIPE_BURST;
+    Scan_Rate = 0;
+    ADC_PIPE_StartBlocks();
+
+    return SUCCESS;
+}
+
+Status ADC_PIPE_SetMode(ADC_PIPE_Mode_Type mode, uint32_t scan_rate)
+{
+    uint32_t half = 0;
+    uint32_t sel;
+
+    if (Lanes == 0 || mode > ADC_PIPE_TRIGGERED)
+    {
+        return ERROR;
+    }
+    if (mode == ADC_PIPE_TRIGGERED)
+    {
+        if (scan_rate == 0 || scan_rate > ADC_PIPE_MAX_TRIGGER_RATE / Lanes)
+        {
+            return ERROR;
+        }
+        // Dos ciclos del timer por conversion y Lanes conversiones por ronda:
+        half = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_TIMER0) / (2 * scan_rate * Lanes);
+        if (half < ADC_PIPE_MIN_HALF)
+        {
+            return ERROR;
+        }
+    }
+
+    // Se detiene todo: sin disparos ni ronda, y sin la conversion pendiente en el ADGDR.
+    GPDMA_ChannelCmd(ADC_PIPE_SCAN_DMA_CHANNEL, DISABLE);
+    GPDMA_ChannelCmd(ADC_PIPE_DMA_CHANNEL, DISABLE);
+    if (Mode == ADC_PIPE_TRIGGERED)
+    {
+        TIM_DeInit(LPC_TIM0);
+    }
+    LPC_ADC->ADCR &= ~(ADC_CR_BURST | ADC_CR_START_MASK);
+    (void)LPC_ADC->ADGDR;
+
+    ADC_PIPE_StartBlocks();
+    Mode = mode;
+    if (mode == ADC_PIPE_TRIGGERED)
+    {
+        Scan_Rate = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_TIMER0) / (2 * half * Lanes);
+        ADC_PIPE_StartTrigger(half);
+    }
+    else
+    {
+        // Ronda continua sobre todos los canales de la mascara:
+        Scan_Rate = 0;
+        sel = 0;
+        for (uint8_t lane = 0; lane < Lanes; lane++)
+        {
+            sel |= ADC_CR_CH_SEL(Lane_Channel[lane]);
+        }
+        LPC_ADC->ADCR = (LPC_ADC->ADCR & ~ADC_PIPE_CR_MODE) | sel | ADC_CR_BURST;
+    }
+
+    return SUCCESS;
+}
+
+ADC_PIPE_Mode_Type ADC_PIPE_GetMode(void)
+{
+    return Mode;
+}
+
+uint32_t ADC_PIPE_GetScanRate(void)
+{
+    return Scan_Rate;
+}
+
+uint16_t ADC_PIPE_GetValue(uint8_t channel)
+{
+    if (!ADC_PIPE_ACQUIRED(channel))
+    {
+        return 0;
+    }
+
+    return Filtered[channel];
+}
+
+uint16_t ADC_PIPE_GetMedian(uint8_t channel)
+{
+    if (!ADC_PIPE_ACQUIRED(channel))
+    {
+        return 0;
+    }
+
+    return FILTER_GetMedian(&Filter, Lane[channel]);
+}
+
+uint16_t ADC_PIPE_GetSmoothed(uint8_t channel)
+{
+    if (!ADC_PIPE_ACQUIRED(channel))
+    {
+        return 0;
+    }
+
+    return FILTER_GetAverage(&Filter, Lane[channel]);
+}
+
+int32_t ADC_PIPE_GetRate(uint8_t channel)
+{
+    if (!ADC_PIPE_ACQUIRED(channel))
+    {
+        return 0;
+    }
+
+    // La pendiente es el cambio en FILTER_RATE_TAPS bloques, y hay Sample_Rate / Block_Words bloques por segundo.
+    return (int32_t)(((int64_t)FILTER_GetRate(&Filter, Lane[channel]) * Sample_Rate) /
+                     (Block_Words * FILTER_RATE_TAPS));
+}
+
+void ADC_PIPE_UpdateRate(uint32_t period_ms)
+{
+    uint32_t count = Sample_Count;
+
+    if (period_ms != 0)
+    {
+        Sample_Rate = (uint32_t)(((uint64_t)(count - Last_Count) * 1000) / period_ms);
+    }
+    Last_Count = count;
+}
+
+uint32_t ADC_PIPE_GetSampleRate(void)
+{
+    return Sample_Rate;
+}
+
+uint32_t ADC_PIPE_Format(char* line)
+{
+    uint32_t pos = 0;
+    int32_t rate;
+
+    pos = TEXT_FMT_PutText(line, pos, (Mode == ADC_PIPE_BURST) ? "ADC burst sps=" : "ADC trig sps=");
+    pos = TEXT_FMT_PutNumber(line, pos, ADC_PIPE_GetSampleRate());
+    for (uint8_t channel = 0; channel < ADC_PIPE_MAX_CHANNELS; channel++)
+    {
+        if (!ADC_PIPE_ACQUIRED(channel))
+        {
+            continue;
+        }
+        rate = ADC_PIPE_GetRate(channel);
+
+        pos = TEXT_FMT_PutText(line, pos, " ch");
+        pos = TEXT_FMT_PutNumber(line, pos, channel);
+        pos = TEXT_FMT_PutText(line, pos, "=");
+        pos = TEXT_FMT_PutNumber(line, pos, ADC_PIPE_GetSmoothed(channel));
+        pos = TEXT_FMT_PutText(line, pos, " d");
+        pos = TEXT_FMT_PutNumber(line, pos, channel);
+        pos = TEXT_FMT_PutText(line, pos, (rate < 0) ? "=-" : "=");
+        pos = TEXT_FMT_PutNumber(line, pos, (rate < 0) ? 0 - (uint32_t)rate : (uint32_t)rate);
+    }
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+    line[pos] = '\0';
+
+    return pos;
+}
+
+RAMFUNC void ADC_PIPE_IRQHandler(void)
+{
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INT, ADC_PIPE_DMA_CHANNEL) == RESET)
+    {
+        return;
+    }
+
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, ADC_PIPE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, ADC_PIPE_DMA_CHANNEL);
+    }
+
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, ADC_PIPE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, ADC_PIPE_DMA_CHANNEL);
+
+        // El GPDMA ya pasó al otro bloque; se procesa el que acaba de completarse.
+        ADC_PIPE_Decimate(Blocks[Ready_Block]);
+        Ready_Block ^= 1;
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file adc_pipeline.h
+ * @brief Adquisicion del ADC con sobremuestreo y decimacion sobre buffers ping-pong del GPDMA.
+ *
+ * Dos LLI enlazadas en anillo llenan alternadamente dos bloques con las conversiones del registro global
+ * ADGDR. Al completarse cada bloque, la interrupcion del GPDMA promedia las muestras de cada canal (filtro
+ * box-car con decimacion) mientras el GPDMA llena el otro bloque. Los valores decimados pasan por la etapa de
+ * filtros (sensor_filter.h): mediana movil, media exponencial y pendiente de todos los canales juntos.
+ *
+ * Los canales adquiridos (hasta los 8 del ADC) se eligen al inicializar con una mascara, que arma la tabla de
+ * sensores (sensor_channels.h). El tamaño de los bloques acompaña a la cantidad de canales, de modo que cada canal
+ * recibe siempre ADC_PIPE_SAMPLES muestras por bloque.
+ *
+ * Las conversiones salen del modo burst (el ADC convierte en ronda sin pausa, a la tasa de su reloj) o de un
+ * disparo periodico por hardware (ADC_PIPE_SetMode()): cada flanco de subida de MAT0.1 inicia una conversion, de
+ * modo que la tasa es exacta y el ADC queda quieto entre disparos. Un solo disparo convierte un solo canal (el
+ * burst es el unico que recorre la mascara), asi que el canal de la proxima conversion lo escribe en el ADCR el
+ * GPDMA, con el pedido de MAT0.0 en la mitad de cada ciclo del TIMER0. Ninguno de los dos modos usa la CPU por
+ * conversion.
+ */
+
+#ifndef ADC_PIPELINE_H
+#define ADC_PIPELINE_H
+
+#include "lpc_types.h"
+#include "text_fmt.h"
+
+// Definiciones del modulo:
+#define ADC_PIPE_DMA_CHANNEL      0                                          /**< Canal del GPDMA usado por el ADC */
+#define ADC_PIPE_MAX_CHANNELS     8                                          /**< Canales del ADC */
+#define ADC_PIPE_OVERSAMPLE_BITS  3                                          /**< Bits extra por sobremuestreo */
+#define ADC_PIPE_SAMPLES          (1 << (2 * ADC_PIPE_OVERSAMPLE_BITS))      /**< Muestras por canal y bloque (4^n) */
+#define ADC_PIPE_MAX_WORDS        (ADC_PIPE_MAX_CHANNELS * ADC_PIPE_SAMPLES) /**< Palabras de un bloque completo */
+#define ADC_PIPE_RESOLUTION       (12 + ADC_PIPE_OVERSAMPLE_BITS)            /**< Bits de los valores filtrados */
+#define ADC_PIPE_SCAN_DMA_CHANNEL 4                                          /**< Canal del GPDMA de los disparos */
+#define ADC_PIPE_MAX_TRIGGER_RATE 50000                                      /**< Conversiones/s con disparo */
+#define ADC_PIPE_VALUE_DIGITS     5                                          /**< Digitos de un valor (uint16_t) */
+#define ADC_PIPE_REPORT_CMD       'R'                                        /**< Byte de UART2 que pide el reporte */
+
+/** Tamaño maximo de la linea del reporte: cada campo con su largo maximo y todos los canales adquiridos */
+#define ADC_PIPE_LINE_SIZE                                                                                             \
+    (sizeof("ADC burst sps=") - 1 + TEXT_FMT_MAX_DIGITS +                                                              \
+     ADC_PIPE_MAX_CHANNELS * (sizeof(" ch0= d0=-") - 1 + ADC_PIPE_VALUE_DIGITS + TEXT_FMT_MAX_DIGITS) + sizeof("\r\n"))
+
+/**
+ * @brief Origen de las conversiones del ADC.
+ */
+typedef enum
+{
+    ADC_PIPE_BURST,    /**< Modo burst: conversiones continuas a la tasa del reloj del ADC */
+    ADC_PIPE_TRIGGERED /**< Una conversion por flanco de subida de MAT0.1, a tasa fija */
+} ADC_PIPE_Mode_Type;
+
+/**
+ * @brief Configura el canal del GPDMA con las dos LLI en anillo y lo habilita.
+ *
+ * Requiere que el GPDMA ya haya sido inicializado con GPDMA_Init() y que el ADC este en modo burst con los mismos
+ * canales habilitados. La adquisicion arranca en ADC_PIPE_BURST.
+ *
+ * @param mask Canales adquiridos (bit n para AD0.n).
+ * @return SUCCESS, o ERROR si la mascara esta vacia (no se habilita el canal del GPDMA).
+ */
+Status ADC_PIPE_Init(uint8_t mask);
+
+/**
+ * @brief Cambia el origen de las conversiones del ADC.
+ *
+ * Detiene la adquisicion y la reinicia desde el bloque 0 (el bloque en curso se descarta). En ADC_PIPE_TRIGGERED
+ * toma el TIMER0: MR1 reinicia el contador y conmuta MAT0.1, que dispara una conversion en cada flanco de subida
+ * (un ciclo del timer es medio periodo de conversion), y MR0, en la mitad del ciclo, pide al GPDMA el canal de la
+ * proxima conversion. En ADC_PIPE_BURST apaga el TIMER0 y vuelve a la ronda continua.
+ *
+ * La mitad del ciclo tiene que caer despues del fin de la conversion: con el ADC a 200 kHz (5 us por conversion)
+ * el ciclo minimo es de 10 us, dos por conversion, y de ahi el limite de ADC_PIPE_MAX_TRIGGER_RATE.
+ *
+ * @param mode Origen de las conversiones.
+ * @param scan_rate Rondas por segundo en ADC_PIPE_TRIGGERED (cada ronda convierte una vez cada canal); no se usa
+ *                  en ADC_PIPE_BURST.
+ * @return SUCCESS, o ERROR si no se inicializo la adquisicion, el modo es invalido o la tasa es 0 o supera
+ *         ADC_PIPE_MAX_TRIGGER_RATE conversiones por segundo (no se cambia el modo anterior).
+ */
+Status ADC_PIPE_SetMode(ADC_PIPE_Mode_Type mode, uint32_t scan_rate);
+
+/**
+ * @brief Devuelve el origen actual de las conversiones.
+ */
+ADC_PIPE_Mode_Type ADC_PIPE_GetMode(void);
+
+/**
+ * @brief Devuelve la tasa de rondas programada en ADC_PIPE_TRIGGERED.
+ *
+ * @return Rondas por segundo que resultan del divisor del TIMER0 (puede diferir de la pedida por redondeo), o 0
+ *         en ADC_PIPE_BURST.
+ */
+uint32_t ADC_PIPE_GetScanRate(void);
+
+/**
+ * @brief Devuelve el ultimo valor decimado de un canal.
+ *
+ * @param channel Canal del ADC (AD0.n).
+ * @return Valor de ADC_PIPE_RESOLUTION bits, o 0 si el canal no se adquiere.
+ */
+uint16_t ADC_PIPE_GetValue(uint8_t channel);
+
+/**
+ * @brief Devuelve la mediana de un canal a la salida de la etapa de filtros, sin la media exponencial.
+ *
+ * Descarta lecturas aisladas pero sigue a la entrada sin retardo; sirve para los canales que cambian de golpe.
+ *
+ * @param channel Canal del ADC (AD0.n).
+ * @return Valor de ADC_PIPE_RESOLUTION bits, o 0 si el canal no se adquiere.
+ */
+uint16_t ADC_PIPE_GetMedian(uint8_t channel);
+
+/**
+ * @brief Devuelve el valor de un canal a la salida de la etapa de filtros (mediana y media exponencial).
+ *
+ * Un bloque con una lectura aislada fuera de lugar no lo mueve; es el valor que deben usar las decisiones.
+ *
+ * @param channel Canal del ADC (AD0.n).
+ * @return Valor de ADC_PIPE_RESOLUTION bits, o 0 si el canal no se adquiere.
+ */
+uint16_t ADC_PIPE_GetSmoothed(uint8_t channel);
+
+/**
+ * @brief Devuelve la pendiente de un canal a la salida de la etapa de filtros.
+ *
+ * Usa la ultima tasa medida con ADC_PIPE_UpdateRate() para pasar de bloques a segundos.
+ *
+ * @param channel Canal del ADC (AD0.n).
+ * @return Cambio del valor filtrado, en cuentas de ADC_PIPE_RESOLUTION bits por segundo (0 si el canal no se
+ *         adquiere o todavia no se midio la tasa).
+ */
+int32_t ADC_PIPE_GetRate(uint8_t channel);
+
+/**
+ * @brief Actualiza la medicion de muestras por segundo.
+ *
+ * Debe llamarse periodicamente; calcula la tasa a partir de las muestras acumuladas desde la llamada anterior.
+ *
+ * @param period_ms Tiempo transcurrido desde la llamada anterior, en milisegundos.
+ */
+void ADC_PIPE_UpdateRate(uint32_t period_ms);
+
+/**
+ * @brief Devuelve la ultima tasa de adquisicion medida.
+ *
+ * @return Muestras por segundo (todos los canales).
+ */
+uint32_t ADC_PIPE_GetSampleRate(void);
+
+/**
+ * @brief Arma la linea de texto del reporte de adquisicion, para enviar por UART.
+ *
+ * Formato: "ADC <burst|trig> sps=<muestras/s> ch<n>=<valor> d<n>=<pendiente/s> ...\r\n", con el valor filtrado y
+ * la pendiente de cada canal adquirido.
+ *
+ * @param line Donde se arma la linea (ADC_PIPE_LINE_SIZE bytes).
+ * @return Cantidad de caracteres escritos sin el terminador.
+ */
+uint32_t ADC_PIPE_Format(char* line);
+
+/**
+ * @brief Atiende la interrupcion de fin de bloque del canal del ADC.
+ *
+ * Debe llamarse desde DMA_IRQHandler. Limpia las banderas del canal y decima el bloque recien completado.
+ */
+void ADC_PIPE_IRQHandler(void);
+
+#endif /* ADC_PIPELINE_H */
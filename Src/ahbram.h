@@ -0,0 +1,30 @@
+/**
+ * @file ahbram.h
+ * @brief Ubicacion de los buffers del GPDMA en los bancos de SRAM del AHB (AHBRAM0 y AHBRAM1, 16 KB cada uno).
+ *
+ * La SRAM local (0x10000000) es la de la CPU: por ella pasan las instrucciones de las funciones RAMFUNC (ver
+ * ramfunc.h), la pila y las variables. Un buffer del GPDMA ubicado ahi hace que cada transferencia compita con esos
+ * accesos; en los bancos del AHB, cada uno esclavo propio de la matriz, el GPDMA los usa mientras la CPU trabaja en
+ * la SRAM local. El flujo del ADC, el de mayor trafico, usa AHBRAM0; el resto de los canales comparte AHBRAM1.
+ *
+ * Los descriptores y buffers del EMAC (lpc17xx_emac.c, unos 10,8 KB) tambien van en AHBRAM0, junto al ADC (unos
+ * 4,2 KB): AHBRAM1 ya tiene unos 6,6 KB ocupados y no le entran. El EMAC es otro maestro del AHB, asi que compite
+ * con el GPDMA del ADC por ese banco, pero no con la CPU.
+ *
+ * Las macros de seccion las define lpc17xx_ahbram.h, de la biblioteca de drivers, que tambien ubica asi los buffers
+ * del EMAC. lpc17xx.ld junta las secciones de cada banco sin carga desde la flash, asi que no admiten valores
+ * iniciales:
+ * - AHBRAMn_BSS: Reset_Handler (startup_LPC17xx.c) la llena de ceros, como a .bss.
+ * - AHBRAMn_NOINIT: conserva lo que tenga la memoria; para buffers que siempre se escriben antes de leerse, y
+ *   ahorra el borrado en el arranque.
+ *
+ * Con make NO_AHBRAM=1 todo queda en la SRAM local, para comparar las dos ubicaciones con el banco de prueba de
+ * isr_profile.h. En el simulador y en las herramientas del host las macros quedan vacias.
+ */
+
+#ifndef AHBRAM_H
+#define AHBRAM_H
+
+#include "lpc17xx_ahbram.h"
+
+#endif /* AHBRAM_H */
@@ -0,0 +1,250 @@
+/**
+ * @file alarm.c
+ * @brief Motor de alarmas por tabla: umbrales con histeresis, tiempos de permanencia y limite de accionamientos.
+ *
+ * Cada regla tiene un solo temporizador: mientras esta liberada mide el tiempo sobre Set y mientras esta activa el
+ * tiempo detras de Clear. Si la medicion vuelve antes de cumplirse la permanencia, el temporizador se reinicia y el
+ * cruce se cuenta como un accionamiento evitado. La regla que decide (la activa de menor indice) solo se compara
+ * con la de la evaluacion anterior: un pedido se genera cuando cambia, no en cada evaluacion.
+ *
+ * Hay a lo sumo un pedido pendiente. Uno nuevo reemplaza al que estaba diferido, que se cuenta como descartado;
+ * si ademas el nuevo repite el ultimo accionamiento entregado, la puerta nunca salio de ahi y no se pide nada.
+ */
+
+#include "alarm.h"
+
+#include "text_fmt.h"
+
+#define ALARM_NO_RULE 0xFF /**< Indice de regla que indica que ninguna esta activa */
+
+static const ALARM_Rule_Type* Rules = NULL;    /**< Tabla de reglas */
+static uint8_t Rule_Count = 0;                 /**< Cantidad de reglas */
+static uint32_t Min_Interval_Ms = 0;           /**< Tiempo minimo entre accionamientos */
+static Bool Active[ALARM_MAX_RULES];           /**< Regla activa */
+static Bool Inside[ALARM_MAX_RULES];           /**< Regla activa con la medicion entre Clear y Set */
+static uint32_t Timer_Ms[ALARM_MAX_RULES];     /**< Tiempo de permanencia acumulado de cada regla */
+static uint8_t Leader = ALARM_NO_RULE;         /**< Regla que decide la accion */
+static ALARM_Action_Type Pending = ALARM_NONE; /**< Pedido sin entregar */
+static ALARM_Action_Type Last = ALARM_NONE;    /**< Ultimo pedido entregado */
+static Bool Pending_Immediate = FALSE;         /**< El pedido no espera el intervalo minimo */
+static Bool Pending_Deferred = FALSE;          /**< El pedido ya se conto como diferido */
+static uint32_t Since_Ms = 0;                  /**< Tiempo desde el ultimo accionamiento (saturado) */
+static ALARM_Stats_Type Stats;                 /**< Contadores */
+
+/**
+ * @brief Indica si un valor esta del lado de disparo de un umbral.
+ */
+static Bool ALARM_Beyond(const ALARM_Rule_Type* rule, int32_t value, int32_t threshold)
+{
+    return (rule->Compare == ALARM_ABOVE) ? (value > threshold) : (value < threshold);
+}
+
+/**
+ * @brief Indica si un valor esta del lado seguro de un umbral.
+ */
+static Bool ALARM_Behind(const ALARM_Rule_Type* rule, int32_t value, int32_t threshold)
+{
+    return (rule->Compare == ALARM_ABOVE) ? (value < threshold) : (value > threshold);
+}
+
+/**
+ * @brief Reemplaza el pedido pendiente.
+ */
+static void ALARM_Request(ALARM_Action_Type action, Bool immediate)
+{
+    // Un pedido que sigue pendiente de una evaluacion anterior es uno diferido: nunca se va a entregar.
+    if (Pending != ALARM_NONE)
+    {
+        Stats.Dropped++;
+        if (action == Last)
+        {
+            action = ALARM_NONE;
+        }
+    }
+
+    Pending = action;
+    Pending_Immediate = immediate;
+    Pending_Deferred = FALSE;
+}
+
+/**
+ * @brief Evalua una regla y actualiza su estado.
+ */
+static void ALARM_Evaluate(uint8_t index, int32_t value, uint32_t elapsed_ms)
+{
+    const ALARM_Rule_Type* rule = &Rules[index];
+
+    if (Active[index] == FALSE)
+    {
+        if (ALARM_Beyond(rule, value, rule->Set) == TRUE)
+        {
+            Timer_Ms[index] += elapsed_ms;
+            if (Timer_Ms[index] >= rule->Set_Dwell_Ms)
+            {
+                Active[index] = TRUE;
+                Inside[index] = FALSE;
+                Timer_Ms[index] = 0;
+            }
+        }
+        else if (Timer_Ms[index] != 0)
+        {
+            Stats.Dwell++;
+            Timer_Ms[index] = 0;
+        }
+        return;
+    }
+
+    if (ALARM_Behind(rule, value, rule->Clear) == TRUE)
+    {
+        Timer_Ms[index] += elapsed_ms;
+        if (Timer_Ms[index] >= rule->Clear_Dwell_Ms)
+        {
+            Active[index] = FALSE;
+            Timer_Ms[index] = 0;
+        }
+        return;
+    }
+
+    if (Timer_Ms[index] != 0)
+    {
+        Stats.Dwell++;
+        Timer_Ms[index] = 0;
+    }
+
+    // Entre los umbrales: sin histeresis la regla se habria liberado aca (se cuenta una vez por vuelta).
+    if (ALARM_Beyond(rule, value, rule->Set) == FALSE)
+    {
+        if (Inside[index] == FALSE)
+        {
+            Stats.Hysteresis++;
+            Inside[index] = TRUE;
+        }
+    }
+    else
+    {
+        Inside[index] = FALSE;
+    }
+}
+
+Status ALARM_Init(const ALARM_Rule_Type* rules, uint8_t count, uint32_t min_interval_ms)
+{
+    Rules = NULL;
+    Rule_Count = 0;
+
+    if (count > ALARM_MAX_RULES)
+    {
+        return ERROR;
+    }
+
+    for (uint8_t r = 0; r < count; r++)
+    {
+        if (ALARM_Beyond(&rules[r], rules[r].Clear, rules[r].Set) == TRUE)
+        {
+            return ERROR;
+        }
+        Active[r] = FALSE;
+        Inside[r] = FALSE;
+        Timer_Ms[r] = 0;
+    }
+
+    Rules = rules;
+    Rule_Count = count;
+    Min_Interval_Ms = min_interval_ms;
+    Leader = ALARM_NO_RULE;
+    Pending = ALARM_NONE;
+    Last = ALARM_NONE;
+    Pending_Immediate = FALSE;
+    Pending_Deferred = FALSE;
+    Since_Ms = min_interval_ms;
+    Stats = (ALARM_Stats_Type){0};
+
+    return SUCCESS;
+}
+
+ALARM_Action_Type ALARM_Update(const int32_t* measures, uint32_t elapsed_ms)
+{
+    uint8_t leader = ALARM_NO_RULE;
+    ALARM_Action_Type action;
+
+    for (uint8_t r = 0; r < Rule_Count; r++)
+    {
+        ALARM_Evaluate(r, measures[Rules[r].Channel], elapsed_ms);
+        if (Active[r] == TRUE && leader == ALARM_NO_RULE)
+        {
+            leader = r;
+        }
+    }
+
+    // Cambio de la regla que decide: se pide su accion o, si ya no hay ninguna activa, la de liberacion de la
+    // anterior. Un relevo entre reglas con la misma accion no pide nada.
+    if (leader != Leader)
+    {
+        if (leader == ALARM_NO_RULE)
+        {
+            ALARM_Request(Rules[Leader].Clear_Action, FALSE);
+        }
+        else if (Leader == ALARM_NO_RULE || Rules[Leader].Action != Rules[leader].Action)
+        {
+            ALARM_Request(Rules[leader].Action, Rules[leader].Immediate);
+        }
+        Leader = leader;
+    }
+
+    Since_Ms = (Since_Ms + elapsed_ms < Min_Interval_Ms) ? Since_Ms + elapsed_ms : Min_Interval_Ms;
+
+    if (Pending == ALARM_NONE)
+    {
+        return ALARM_NONE;
+    }
+
+    if (Pending_Immediate == FALSE && Since_Ms < Min_Interval_Ms)
+    {
+        if (Pending_Deferred == FALSE)
+        {
+            Stats.Deferred++;
+            Pending_Deferred = TRUE;
+        }
+        return ALARM_NONE;
+    }
+
+    action = Pending;
+    Last = action;
+    Pending = ALARM_NONE;
+    Pending_Deferred = FALSE;
+    Since_Ms = 0;
+    Stats.Actuations++;
+
+    return action;
+}
+
+ALARM_Action_Type ALARM_GetActive(void)
+{
+    return (Leader == ALARM_NO_RULE) ? ALARM_NONE : Rules[Leader].Action;
+}
+
+void ALARM_GetStats(ALARM_Stats_Type* stats)
+{
+    *stats = Stats;
+}
+
+uint32_t ALARM_Format(char* line)
+{
+    uint32_t pos = 0;
+
+    pos = TEXT_FMT_PutText(line, pos, "ALARM act=");
+    pos = TEXT_FMT_PutNumber(line, pos, Stats.Actuations);
+    pos = TEXT_FMT_PutText(line, pos, " dwell=");
+    pos = TEXT_FMT_PutNumber(line, pos, Stats.Dwell);
+    pos = TEXT_FMT_PutText(line, pos, " hyst=");
+    pos = TEXT_FMT_PutNumber(line, pos, Stats.Hysteresis);
+    pos = TEXT_FMT_PutText(line, pos, " defer=");
+    pos = TEXT_FMT_PutNumber(line, pos, Stats.Deferred);
+    pos = TEXT_FMT_PutText(line, pos, " drop=");
+    pos = TEXT_FMT_PutNumber(line, pos, Stats.Dropped);
+    pos = TEXT_FMT_PutText(line, pos, " rule=");
+    pos = (Leader == ALARM_NO_RULE) ? TEXT_FMT_PutText(line, pos, "-") : TEXT_FMT_PutNumber(line, pos, Leader);
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+    line[pos] = '\0';
+
+    return pos;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file alarm.h
+ * @brief Motor de alarmas por tabla: umbrales con histeresis, tiempos de permanencia y limite de accionamientos.
+ *
+ * Cada regla de la tabla vigila un canal de mediciones con dos umbrales: el de activacion y, del lado seguro, el de
+ * liberacion. Una regla se activa cuando la medicion supera el primero durante Set_Dwell_Ms y se libera cuando
+ * vuelve detras del segundo durante Clear_Dwell_Ms; entre ambos umbrales no cambia de estado. La regla activa de
+ * menor indice decide la accion sobre la puerta (el orden de la tabla es la prioridad) y, al liberarse la ultima,
+ * se pide su accion de liberacion.
+ *
+ * Los pedidos se limitan a uno cada Min_Interval_Ms: uno que llega antes queda diferido hasta que se cumpla el
+ * intervalo, salvo el de una regla inmediata (por ejemplo, gas), que se atiende en el momento. Los contadores
+ * informan los accionamientos pedidos y los que se evitaron por permanencia, por histeresis o por el limite.
+ *
+ * El modulo no depende del hardware: las reglas y las mediciones las da quien lo usa, y agregar un sensor o una
+ * regla solo cambia la tabla.
+ */
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define ALARM_MAX_RULES  8   /**< Reglas maximas de la tabla */
+#define ALARM_LINE_SIZE  96  /**< Tamaño maximo de la linea de ALARM_Format() */
+#define ALARM_REPORT_CMD 'W' /**< Byte recibido por UART2 que pide el envio de los contadores */
+
+/**
+ * @brief Accion sobre la puerta.
+ */
+typedef enum
+{
+    ALARM_NONE,  /**< Ninguna */
+    ALARM_OPEN,  /**< Abrir */
+    ALARM_CLOSE  /**< Cerrar */
+} ALARM_Action_Type;
+
+/**
+ * @brief Sentido en el que una medicion dispara la regla.
+ */
+typedef enum
+{
+    ALARM_ABOVE, /**< Se activa por encima de Set y se libera por debajo de Clear (Clear <= Set) */
+    ALARM_BELOW  /**< Se activa por debajo de Set y se libera por encima de Clear (Clear >= Set) */
+} ALARM_Compare_Type;
+
+/**
+ * @brief Regla de la tabla.
+ */
+typedef struct
+{
+    uint8_t Channel;                /**< Indice de la medicion vigilada */
+    ALARM_Compare_Type Compare;     /**< Sentido del disparo */
+    int32_t Set;                    /**< Umbral de activacion (estricto) */
+    int32_t Clear;                  /**< Umbral de liberacion (estricto) */
+    uint32_t Set_Dwell_Ms;          /**< Tiempo sobre Set antes de activarse (0: en la primera medicion) */
+    uint32_t Clear_Dwell_Ms;        /**< Tiempo detras de Clear antes de liberarse */
+    ALARM_Action_Type Action;       /**< Accion mientras esta activa */
+    ALARM_Action_Type Clear_Action; /**< Accion al liberarse, si no queda otra regla activa */
+    Bool Immediate;                 /**< Su activacion no espera el intervalo minimo entre accionamientos */
+} ALARM_Rule_Type;
+
+/**
+ * @brief Contadores del motor de alarmas.
+ */
+typedef struct
+{
+    uint32_t Actuations; /**< Accionamientos pedidos */
+    uint32_t Dwell;      /**< Cruces de un umbral que no duraron el tiempo de permanencia */
+    uint32_t Hysteresis; /**< Vueltas de una regla activa detras de Set sin llegar a Clear */
+    uint32_t Deferred;   /**< Pedidos demorados por el intervalo minimo */
+    uint32_t Dropped;    /**< Pedidos demorados que se descartaron antes de cumplirse el intervalo */
+} ALARM_Stats_Type;
+
+/**
+ * @brief Inicializa el motor con una tabla de reglas y borra su estado y sus contadores.
+ *
+ * @param rules Reglas, en orden de prioridad (deben seguir existiendo).
+ * @param count Cantidad de reglas (hasta ALARM_MAX_RULES).
+ * @param min_interval_ms Tiempo minimo entre accionamientos de reglas no inmediatas.
+ * @return SUCCESS, o ERROR si hay demasiadas reglas o alguna tiene el umbral de liberacion del lado de disparo.
+ */
+Status ALARM_Init(const ALARM_Rule_Type* rules, uint8_t count, uint32_t min_interval_ms);
+
+/**
+ * @brief Evalua las reglas con una nueva medicion de todos los canales.
+ *
+ * @param measures Mediciones, indexadas por el Channel de las reglas.
+ * @param elapsed_ms Tiempo desde la evaluacion anterior.
+ * @return Accion a realizar ahora, o ALARM_NONE. Cada pedido se devuelve una sola vez.
+ */
+ALARM_Action_Type ALARM_Update(const int32_t* measures, uint32_t elapsed_ms);
+
+/**
+ * @brief Accion de la regla activa de mayor prioridad, o ALARM_NONE si no hay ninguna activa.
+ */
+ALARM_Action_Type ALARM_GetActive(void);
+
+/**
+ * @brief Copia los contadores.
+ *
+ * @param stats Estructura a completar.
+ */
+void ALARM_GetStats(ALARM_Stats_Type* stats);
+
+/**
+ * @brief Arma una linea de texto con los contadores.
+ *
+ * Formato: "ALARM act=<n> dwell=<n> hyst=<n> defer=<n> drop=<n> rule=<indice o ->\r\n".
+ *
+ * @param line Donde se arma la linea (ALARM_LINE_SIZE bytes).
+ * @return Cantidad de caracteres escritos, sin el terminador.
+ */
+uint32_t ALARM_Format(char* line);
+
+#endif /* ALARM_H */
@@ -0,0 +1,54 @@
+/**
+ * @file calibration.c
+ * @brief Calibracion por canal de los sensores en punto fijo (Q15/Q31), sin divisiones.
+ *
+ * La conversion anterior (valor * 100 >> bits) trataba los tres sensores como porcentajes de VREF. Ahora cada canal
+ * tiene su curva: el LM35 entrega 10 mV/°C, el LDR se deja proporcional a la tension y el MQ-2 sigue una recta en
+ * escala log-log entre Rs/R0 y la concentracion. Las curvas del LM35 y del MQ-2 se calculan en el host al compilar
+ * (sensor_tables.c) y aca solo se indexan.
+ */
+
+#include "calibration.h"
+
+#include <stddef.h>
+
+const CALIB_Channel_Type CALIB_Channels[CALIB_CHANNELS] = {
+    // LM35: 10 mV/°C desde 0 °C, saturado en 100 °C (tabla generada desde table_config.h).
+    [CALIB_TEMPERATURE] = {CALIB_LOOKUP, TABLES_Lm35, 0, 0, TABLE_LM35_MAX},
+    // LDR en divisor resistivo: porcentaje de la tension, como la conversion original.
+    [CALIB_LIGHT] = {CALIB_LINEAR, NULL, CALIB_Q15(TABLE_LDR_SPAN), CALIB_Q15(TABLE_LDR_OFFSET), TABLE_LDR_MAX},
+    // MQ-2: recta log-log del datasheet, en centenas de ppm (tabla generada desde table_config.h).
+    [CALIB_GAS] = {CALIB_LOOKUP, TABLES_Mq2, 0, 0, TABLE_MQ2_MAX},
+};
+
+uint8_t CALIB_Convert(uint8_t channel, q15_t value)
+{
+    const CALIB_Channel_Type* calib;
+    q31_t units;
+
+    if (channel >= CALIB_CHANNELS)
+    {
+        return 0;
+    }
+    calib = &CALIB_Channels[channel];
+
+    if (value < 0)
+    {
+        value = 0;
+    }
+
+    if (calib->Kind == CALIB_LOOKUP)
+    {
+        return calib->Lookup[value >> CALIB_LOOKUP_SHIFT];
+    }
+
+    // Q15 * Q15 con el producto en 64 bits (SMULL): el resultado queda en unidades Q15.
+    units = (q31_t)(((q63_t)value * calib->Gain) >> 15) + calib->Offset;
+    if (units <= 0)
+    {
+        return 0;
+    }
+
+    units = (units + (CALIB_ONE / 2)) >> 15;
+    return (uint8_t)((units > calib->Max) ? calib->Max : units);
+}
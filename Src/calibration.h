@@ -0,0 +1,81 @@
+/**
+ * @file calibration.h
+ * @brief Calibracion por canal de los sensores en punto fijo (Q15/Q31), sin divisiones.
+ *
+ * Cada canal convierte el valor filtrado del ADC, como fraccion Q15 de VREF, en la unidad de su sensor, de una de
+ * dos formas:
+ *
+ * - CALIB_LOOKUP: una tabla de TABLE_ADC_SIZE resultados indexada por los TABLE_ADC_BITS bits altos de la lectura.
+ *   Las genera Table_Generator/table_gen.c en cada compilacion (sensor_tables.h) con los modelos, ganancias y
+ *   offsets de table_config.h, de modo que la conversion es una sola lectura de flash. Es la de las respuestas no
+ *   lineales, como la logaritmica del MQ-2.
+ * - CALIB_LINEAR: unidades = fraccion * Gain + Offset, con Gain y Offset en Q15, redondeado y saturado a [0, Max].
+ *   La ganancia es el reciproco de la sensibilidad precalculado en tiempo de compilacion (CALIB_RECIPROCAL()), por lo
+ *   que la conversion solo multiplica y desplaza.
+ *
+ * Los descriptores de las curvas son constantes en flash (CALIB_Channels en calibration.c). Cada canal de la tabla
+ * de sensores (sensor_channels.h) elige una, y varios canales pueden compartirla.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "LPC17xx.h" // core_cm3.h antes que arm_math.h
+#include "arm_math.h"
+#include "sensor_tables.h"
+
+// Definiciones del modulo:
+#define CALIB_CHANNELS     3                                /**< Curvas de calibracion */
+#define CALIB_LOOKUP_SHIFT (15 - TABLE_ADC_BITS)            /**< Bits bajos de la entrada Q15 que no indexan */
+#define CALIB_ONE          32768                            /**< 1,0 en Q15 (como entero de 32 bits) */
+#define CALIB_Q15(x)       ((int32_t)((x) * 32768.0 + 0.5)) /**< Constante real a Q15, en tiempo de compilacion */
+
+/** Ganancia Q15 de un sensor lineal: unidades por escala completa = VREF / sensibilidad (mV por unidad) */
+#define CALIB_RECIPROCAL(mv_per_unit) CALIB_Q15((double)TABLE_VREF_MV / (mv_per_unit))
+
+/**
+ * @brief Curvas de calibracion (el campo Calib de los canales de sensores).
+ */
+typedef enum
+{
+    CALIB_TEMPERATURE = 0, /**< LM35: grados Celsius */
+    CALIB_LIGHT = 1,       /**< LDR: porcentaje de iluminacion */
+    CALIB_GAS = 2          /**< MQ-2: concentracion de GLP en centenas de ppm */
+} CALIB_Channel_Id_Type;
+
+/**
+ * @brief Forma de la curva de un canal.
+ */
+typedef enum
+{
+    CALIB_LINEAR, /**< Proporcional a la tension */
+    CALIB_LOOKUP  /**< Tabla generada, indexada por la lectura */
+} CALIB_Kind_Type;
+
+/**
+ * @brief Descriptor de calibracion de un canal.
+ */
+typedef struct
+{
+    CALIB_Kind_Type Kind;   /**< Forma de la curva */
+    const uint8_t* Lookup; /**< TABLE_ADC_SIZE resultados (solo CALIB_LOOKUP) */
+    q31_t Gain;            /**< Unidades por escala completa, en Q15 (solo CALIB_LINEAR) */
+    q31_t Offset;          /**< Unidades sumadas al resultado, en Q15 (solo CALIB_LINEAR) */
+    uint8_t Max;           /**< Valor maximo del resultado */
+} CALIB_Channel_Type;
+
+/**
+ * @brief Descriptores de los canales, en flash.
+ */
+extern const CALIB_Channel_Type CALIB_Channels[CALIB_CHANNELS];
+
+/**
+ * @brief Convierte una lectura del ADC a la unidad del sensor.
+ *
+ * @param channel Curva (menor a CALIB_CHANNELS).
+ * @param value Lectura como fraccion Q15 de VREF (0 a 0x7FFF).
+ * @return Valor calibrado entre 0 y el Max del canal, o 0 si el canal es invalido.
+ */
+uint8_t CALIB_Convert(uint8_t channel, q15_t value);
+
+#endif /* CALIBRATION_H */
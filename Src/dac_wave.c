@@ -0,0 +1,206 @@
+/**
+ * @file dac_wave.c
+ * @brief Salida del DAC alimentada por el GPDMA al ritmo del contador de timeout del DAC.
+ *
+ * Cada buffer tiene dos LLI: la de sus muestras y la de mantenimiento, que reescribe su ultima muestra en cada
+ * pedido del DAC y se apunta a si misma. En modo DAC_WAVE_LOOP la LLI de las muestras se apunta a si misma; en modo
+ * DAC_WAVE_ONCE apunta a la de mantenimiento. La ultima LLI de la cadena activa (la "cola") es la unica que se
+ * modifica para encadenar el otro buffer: el GPDMA vuelve a leerla de memoria al terminar la pasada en curso, de
+ * modo que el cambio ocurre en el limite de un buffer sin detener el canal ni atender interrupciones.
+ *
+ * El buffer encadenado empezo a reproducirse cuando la direccion de origen del canal cae dentro de el; recien
+ * entonces el anterior queda libre para armar la curva siguiente.
+ */
+
+#include "dac_wave.h"
+
+#include "LPC17xx.h"
+#include "ahbram.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+#include "ramfunc.h"
+
+#define DAC_WAVE_IDLE 0xFF /**< Indice que marca la ausencia de buffer pendiente o reservado */
+#define DAC_WAVE_CH   ((LPC_GPDMACH_TypeDef*)(LPC_GPDMACH0_BASE + 0x20 * DAC_WAVE_DMA_CHANNEL)) /**< Canal del DAC */
+
+/**
+ * @brief Muestras de cada buffer, en el formato del DACR.
+ *
+ * La palabra extra separa los buffers: al terminar una pasada la direccion de origen queda una palabra despues de la
+ * ultima muestra, y asi no se confunde con el comienzo del otro buffer.
+ */
+AHBRAM1_BSS static volatile uint32_t Samples[2][DAC_WAVE_SAMPLES + 1];
+AHBRAM1_BSS static volatile GPDMA_LLI_Type Wave_LLI[2]; /**< LLI de las muestras de cada buffer */
+AHBRAM1_BSS static volatile GPDMA_LLI_Type Hold_LLI[2]; /**< LLI que mantiene la ultima muestra de cada buffer */
+static DAC_WAVE_Mode_Type Mode[2];                      /**< Modo con que se encadeno cada buffer */
+static uint8_t Active = 0;                              /**< Buffer que reproduce el GPDMA */
+static uint8_t Pending = DAC_WAVE_IDLE;                 /**< Buffer encadenado que todavia no empezo */
+static uint8_t Acquired = DAC_WAVE_IDLE;                /**< Buffer reservado para armar una curva */
+
+/**
+ * @brief Arma las dos LLI de un buffer segun su modo.
+ */
+static void DAC_WAVE_Link(uint8_t buffer, DAC_WAVE_Mode_Type mode)
+{
+    uint32_t control = GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD);
+
+    Wave_LLI[buffer].SrcAddr = (uint32_t)Samples[buffer];                        // Primera muestra
+    Wave_LLI[buffer].DstAddr = (uint32_t) & (LPC_DAC->DACR);                     // Registro del DAC
+    Wave_LLI[buffer].Control = control | GPDMA_DMACCxControl_SI |                // Recorre el buffer
+                               GPDMA_DMACCxControl_TransferSize(DAC_WAVE_SAMPLES);
+    Hold_LLI[buffer].SrcAddr = (uint32_t)&Samples[buffer][DAC_WAVE_SAMPLES - 1]; // Ultima muestra
+    Hold_LLI[buffer].DstAddr = (uint32_t) & (LPC_DAC->DACR);                     // Registro del DAC
+    Hold_LLI[buffer].Control = control | GPDMA_DMACCxControl_TransferSize(1);     // Una muestra por pedido
+    Hold_LLI[buffer].NextLLI = (uint32_t)&Hold_LLI[buffer];                      // Se repite
+
+    Wave_LLI[buffer].NextLLI = (mode == DAC_WAVE_LOOP) ? (uint32_t)&Wave_LLI[buffer] : (uint32_t)&Hold_LLI[buffer];
+    Mode[buffer] = mode;
+}
+
+/**
+ * @brief Da por iniciado el buffer pendiente si el GPDMA ya esta leyendo de el.
+ */
+static void DAC_WAVE_Poll(void)
+{
+    uint32_t source;
+    uint32_t first;
+
+    if (Pending == DAC_WAVE_IDLE)
+    {
+        return;
+    }
+
+    source = DAC_WAVE_CH->DMACCSrcAddr;
+    first = (uint32_t)Samples[Pending];
+    if (source >= first && source <= first + DAC_WAVE_SAMPLES * sizeof(uint32_t))
+    {
+        Active = Pending;
+        Pending = DAC_WAVE_IDLE;
+    }
+}
+
+Status DAC_WAVE_Init(uint32_t sample_rate, uint16_t level)
+{
+    DAC_CONVERTER_CFG_Type converter;
+    GPDMA_Channel_CFG_Type DMAChannel;
+    uint32_t timeout = (sample_rate != 0) ? CLKPWR_GetPCLK(CLKPWR_PCLKSEL_DAC) / sample_rate : 0;
+
+    if (timeout == 0 || timeout > 0xFFFF)
+    {
+        return ERROR;
+    }
+
+    // Buffer 0 con el nivel inicial, que se mantiene hasta la primera curva:
+    for (uint32_t i = 0; i < DAC_WAVE_SAMPLES; i++)
+    {
+        Samples[0][i] = DAC_WAVE_WORD(level);
+    }
+    DAC_WAVE_Link(0, DAC_WAVE_ONCE);
+    Active = 0;
+    Pending = DAC_WAVE_IDLE;
+    Acquired = DAC_WAVE_IDLE;
+
+    // Configuración del canal DMA: la primera pasada del buffer 0 continúa con su LLI de mantenimiento.
+    DMAChannel.ChannelNum = DAC_WAVE_DMA_CHANNEL;     // Canal DMA del DAC
+    DMAChannel.SrcMemAddr = (uint32_t)Samples[0];     // Dirección de origen (buffer 0)
+    DMAChannel.DstMemAddr = 0;                        // No se usa, el destino es el DACR
+    DMAChannel.TransferSize = DAC_WAVE_SAMPLES;       // Tamaño de la transferencia (un buffer)
+    DMAChannel.TransferWidth = 0;                     // Solo se usa en M2M
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_M2P; // Tipo de transferencia (memoria a periférico)
+    DMAChannel.SrcConn = 0;                           // No se usa conexión para el origen
+    DMAChannel.DstConn = GPDMA_CONN_DAC;              // Conexión del destino (DAC)
+    DMAChannel.DMALLI = Wave_LLI[0].NextLLI;          // Continúa con el mantenimiento
+    GPDMA_Setup(&DMAChannel);
+    GPDMA_ChannelCmd(DAC_WAVE_DMA_CHANNEL, ENABLE);
+
+    // Contador de timeout: un pedido de DMA por muestra, aplicado por el doble buffer del DACR.
+    DAC_SetDMATimeOut(LPC_DAC, timeout);
+    converter.DBLBUF_ENA = 1;
+    converter.CNT_ENA = 1;
+    converter.DMA_ENA = 1;
+    converter.RESERVED = 0;
+    DAC_ConfigDAConverterControl(LPC_DAC, &converter);
+
+    return SUCCESS;
+}
+
+volatile uint32_t* DAC_WAVE_Acquire(void)
+{
+    DAC_WAVE_Poll();
+    if (Pending != DAC_WAVE_IDLE)
+    {
+        return NULL;
+    }
+
+    Acquired = Active ^ 1;
+    return Samples[Acquired];
+}
+
+Status DAC_WAVE_Commit(DAC_WAVE_Mode_Type mode)
+{
+    uint8_t buffer = Acquired;
+
+    Acquired = DAC_WAVE_IDLE;
+    if (buffer == DAC_WAVE_IDLE)
+    {
+        return ERROR;
+    }
+
+    DAC_WAVE_Link(buffer, mode);
+    Pending = buffer;
+
+    // Las muestras y las LLI nuevas tienen que estar en memoria antes de encadenarlas. Luego basta una sola escritura
+    // de 32 bits en la cola de la cadena activa, que el GPDMA toma al volver a cargarla.
+    __DMB();
+    if (Mode[Active] == DAC_WAVE_LOOP)
+    {
+        Wave_LLI[Active].NextLLI = (uint32_t)&Wave_LLI[buffer];
+    }
+    else
+    {
+        Hold_LLI[Active].NextLLI = (uint32_t)&Wave_LLI[buffer];
+    }
+
+    return SUCCESS;
+}
+
+Status DAC_WAVE_Ramp(uint16_t from, uint16_t to)
+{
+    volatile uint32_t* samples = DAC_WAVE_Acquire();
+    int32_t step;
+    int32_t value;
+
+    if (samples == NULL)
+    {
+        return ERROR;
+    }
+
+    // Paso en punto fijo 16.16: la division se hace una vez por rampa y no por muestra.
+    step = (((int32_t)to - (int32_t)from) * 65536) / DAC_WAVE_SAMPLES;
+    value = ((int32_t)from << 16) + (1 << 15);
+    for (uint32_t i = 0; i < DAC_WAVE_SAMPLES - 1; i++)
+    {
+        value += step;
+        samples[i] = DAC_WAVE_WORD((uint32_t)(value >> 16));
+    }
+    samples[DAC_WAVE_SAMPLES - 1] = DAC_WAVE_WORD(to);
+
+    return DAC_WAVE_Commit(DAC_WAVE_ONCE);
+}
+
+RAMFUNC void DAC_WAVE_IRQHandler(void)
+{
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INT, DAC_WAVE_DMA_CHANNEL) == RESET)
+    {
+        return;
+    }
+
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, DAC_WAVE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, DAC_WAVE_DMA_CHANNEL);
+    }
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, DAC_WAVE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, DAC_WAVE_DMA_CHANNEL);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file dac_wave.h
+ * @brief Salida del DAC alimentada por el GPDMA al ritmo del contador de timeout del DAC.
+ *
+ * El contador del DAC (DACCNTVAL) pide una transferencia al GPDMA en cada muestra y, con el doble buffer del DACR,
+ * el valor se aplica justo en el timeout, sin jitter. La CPU no interviene por muestra: solo arma curvas.
+ *
+ * Hay dos buffers (doble buffer) de DAC_WAVE_SAMPLES palabras con el formato del DACR (DAC_WAVE_WORD()). Mientras el
+ * GPDMA reproduce uno, el otro se llena con DAC_WAVE_Acquire() y se encadena con DAC_WAVE_Commit(), que lo hace
+ * sonar al terminar la pasada en curso del activo (en el limite de un buffer, sin cortar una curva a la mitad).
+ * Cada buffer se reproduce en uno de dos modos:
+ *
+ * - DAC_WAVE_LOOP: se repite hasta el proximo cambio (formas de onda periodicas).
+ * - DAC_WAVE_ONCE: se reproduce una vez y luego se mantiene su ultima muestra (rampas de brillo).
+ */
+
+#ifndef DAC_WAVE_H
+#define DAC_WAVE_H
+
+#include "lpc_types.h"
+#include "lpc17xx_dac.h"
+
+// Definiciones del modulo:
+#define DAC_WAVE_DMA_CHANNEL 2    /**< Canal del GPDMA usado por el DAC (0 es del ADC y 1 del UART2) */
+#define DAC_WAVE_SAMPLES     100  /**< Muestras de cada buffer */
+#define DAC_WAVE_MAX         1023 /**< Valor maximo del DAC (10 bits) */
+
+/** Palabra del DACR para un valor de 10 bits, con la polarizacion de 700 uA de Config_DAC() */
+#define DAC_WAVE_WORD(value) DAC_VALUE(value)
+
+/**
+ * @brief Modo de reproduccion de un buffer.
+ */
+typedef enum
+{
+    DAC_WAVE_LOOP, /**< Se repite hasta el proximo DAC_WAVE_Commit() */
+    DAC_WAVE_ONCE  /**< Se reproduce una vez y se mantiene la ultima muestra */
+} DAC_WAVE_Mode_Type;
+
+/**
+ * @brief Configura el contador del DAC y el canal del GPDMA, y comienza a reproducir un nivel constante.
+ *
+ * Requiere que el GPDMA ya haya sido inicializado con GPDMA_Init() y que el DAC este configurado.
+ *
+ * @param sample_rate Muestras por segundo; el timeout es PCLK_DAC / sample_rate y debe caber en 16 bits.
+ * @param level Valor inicial de la salida (0 a DAC_WAVE_MAX).
+ * @return SUCCESS, o ERROR si la frecuencia no se puede generar (la salida no se modifica).
+ */
+Status DAC_WAVE_Init(uint32_t sample_rate, uint16_t level);
+
+/**
+ * @brief Reserva el buffer libre para armar una curva.
+ *
+ * Debe llamarse desde un unico contexto (el bucle principal). La curva se escribe con DAC_WAVE_WORD() y se
+ * encadena con DAC_WAVE_Commit().
+ *
+ * @return Buffer de DAC_WAVE_SAMPLES palabras, o NULL si la curva encadenada anteriormente todavia no empezo.
+ */
+volatile uint32_t* DAC_WAVE_Acquire(void);
+
+/**
+ * @brief Encadena la curva armada en el buffer reservado a continuacion de la que se esta reproduciendo.
+ *
+ * @param mode Modo de reproduccion de la curva nueva.
+ * @return SUCCESS, o ERROR si no habia un buffer reservado.
+ */
+Status DAC_WAVE_Commit(DAC_WAVE_Mode_Type mode);
+
+/**
+ * @brief Arma y encadena una rampa lineal que dura un buffer y luego mantiene el valor final.
+ *
+ * @param from Valor de partida (0 a DAC_WAVE_MAX).
+ * @param to Valor final (0 a DAC_WAVE_MAX).
+ * @return SUCCESS, o ERROR si no habia buffer libre (se puede reintentar mas tarde).
+ */
+Status DAC_WAVE_Ramp(uint16_t from, uint16_t to);
+
+/**
+ * @brief Atiende la interrupcion del canal del DAC.
+ *
+ * Debe llamarse desde DMA_IRQHandler. Las LLI del DAC no generan interrupciones; solo se limpian las banderas de
+ * la primera transferencia (GPDMA_Setup() siempre pide terminal count) y las de error.
+ */
+void DAC_WAVE_IRQHandler(void);
+
+#endif /* DAC_WAVE_H */
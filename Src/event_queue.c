@@ -0,0 +1,183 @@
+/**
+ * @file event_queue.c
+ * @brief Cola de eventos y despachador para el bucle principal.
+ *
+ * Varias interrupciones pueden publicar eventos, por lo que la escritura en la cola se protege con una seccion
+ * critica de pocas instrucciones. El bucle principal es el unico consumidor y lee sin enmascarar interrupciones.
+ */
+
+#include "event_queue.h"
+
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+#include "ring_buffer.h"
+#include "scheduler.h"
+#include "text_fmt.h"
+
+#define EVENT_US_PER_MS 1000 /**< Cuentas del TIMER2 por milisegundo */
+
+static uint8_t Queue_Storage[EVENT_QUEUE_SIZE]; /**< Almacenamiento de la cola de eventos */
+static RING_Buffer_Type Queue;                  /**< Cola de eventos pendientes */
+static EVENT_Handler Handlers[EVENT_MAX];       /**< Handler asociado a cada evento */
+static uint32_t Last_Us = 0;                    /**< Instante del TIMER2 de la ultima acumulacion */
+static uint64_t Total_Us = 0;                   /**< Tiempo total acumulado */
+static uint64_t Sleep_Us = 0;                   /**< Tiempo dormido acumulado */
+static uint32_t Dispatched = 0;                 /**< Eventos despachados */
+static volatile uint32_t Dropped = 0;           /**< Eventos descartados */
+
+void EVENT_Init(void)
+{
+    RING_Init(&Queue, Queue_Storage, EVENT_QUEUE_SIZE);
+
+    for (uint8_t i = 0; i < EVENT_MAX; i++)
+    {
+        Handlers[i] = NULL;
+    }
+
+    Last_Us = SCHED_Now();
+    Total_Us = 0;
+    Sleep_Us = 0;
+    Dispatched = 0;
+    Dropped = 0;
+}
+
+Status EVENT_Register(uint8_t event, EVENT_Handler handler)
+{
+    if (event >= EVENT_MAX)
+    {
+        return ERROR;
+    }
+
+    Handlers[event] = handler;
+    return SUCCESS;
+}
+
+Status EVENT_Post(uint8_t event)
+{
+    uint32_t primask = __get_PRIMASK();
+    Bool queued;
+
+    // Seccion critica: otra interrupcion de mayor prioridad podria publicar al mismo tiempo.
+    __disable_irq();
+    queued = RING_Put(&Queue, event);
+    if (queued == FALSE)
+    {
+        Dropped++;
+    }
+    __set_PRIMASK(primask);
+
+    return (queued == TRUE) ? SUCCESS : ERROR;
+}
+
+uint32_t EVENT_Dispatch(void)
+{
+    uint32_t count = 0;
+    uint8_t event;
+
+    while (RING_Get(&Queue, &event) == TRUE)
+    {
+        if (event < EVENT_MAX && Handlers[event] != NULL)
+        {
+            Handlers[event]();
+        }
+        count++;
+    }
+
+    Dispatched += count;
+    return count;
+}
+
+/**
+ * @brief Suma al tiempo total lo transcurrido desde la ultima acumulacion.
+ *
+ * La diferencia de 32 bits es correcta mientras se llame al menos una vez por vuelta del TIMER2 (71 minutos).
+ *
+ * @param now Instante actual del TIMER2.
+ */
+static void EVENT_Advance(uint32_t now)
+{
+    Total_Us += now - Last_Us;
+    Last_Us = now;
+}
+
+void EVENT_Sleep(void)
+{
+    uint32_t before;
+    uint32_t after;
+
+    __disable_irq();
+
+    if (RING_Count(&Queue) == 0)
+    {
+        before = SCHED_Now();
+        CLKPWR_Sleep(); // WFI: despierta con la primera interrupcion pendiente
+        after = SCHED_Now();
+
+        Sleep_Us += after - before;
+        EVENT_Advance(after);
+    }
+
+    __enable_irq();
+}
+
+void EVENT_GetStats(EVENT_Stats_Type* stats)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    EVENT_Advance(SCHED_Now());
+    stats->Sleep_Us = Sleep_Us;
+    stats->Total_Us = Total_Us;
+    stats->Dispatched = Dispatched;
+    stats->Dropped = Dropped;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Calcula el porcentaje del tiempo despierto a partir de unas estadisticas.
+ *
+ * @param stats Estadisticas de uso del nucleo.
+ * @return Carga de CPU en porcentaje (0 a 100).
+ */
+static uint8_t EVENT_LoadOf(const EVENT_Stats_Type* stats)
+{
+    if (stats->Total_Us == 0)
+    {
+        return 0;
+    }
+
+    return (uint8_t)(100 - (stats->Sleep_Us * 100) / stats->Total_Us);
+}
+
+uint8_t EVENT_GetLoad(void)
+{
+    EVENT_Stats_Type stats;
+
+    EVENT_GetStats(&stats);
+
+    return EVENT_LoadOf(&stats);
+}
+
+uint32_t EVENT_Format(char* line)
+{
+    EVENT_Stats_Type stats;
+    uint32_t pos = 0;
+
+    // Una sola copia de los contadores, para que la carga y los tiempos de la linea sean coherentes:
+    EVENT_GetStats(&stats);
+
+    pos = TEXT_FMT_PutText(line, pos, "EVENT load=");
+    pos = TEXT_FMT_PutNumber(line, pos, EVENT_LoadOf(&stats));
+    pos = TEXT_FMT_PutText(line, pos, " sleep=");
+    pos = TEXT_FMT_PutNumber(line, pos, (uint32_t)(stats.Sleep_Us / EVENT_US_PER_MS));
+    pos = TEXT_FMT_PutText(line, pos, " total=");
+    pos = TEXT_FMT_PutNumber(line, pos, (uint32_t)(stats.Total_Us / EVENT_US_PER_MS));
+    pos = TEXT_FMT_PutText(line, pos, " n=");
+    pos = TEXT_FMT_PutNumber(line, pos, stats.Dispatched);
+    pos = TEXT_FMT_PutText(line, pos, " drop=");
+    pos = TEXT_FMT_PutNumber(line, pos, stats.Dropped);
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+    line[pos] = '\0';
+
+    return pos;
+}
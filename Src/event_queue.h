@@ -0,0 +1,101 @@
+/**
+ * @file event_queue.h
+ * @brief Cola de eventos y despachador para el bucle principal.
+ *
+ * Las interrupciones publican eventos de un byte y retornan; el bucle principal los despacha a los handlers
+ * registrados y duerme el nucleo (WFI) cuando la cola queda vacia. El tiempo dormido y el tiempo total se miden
+ * en microsegundos con el contador libre del TIMER2 del planificador (SCHED_Now()), que no interrumpe: solo el
+ * proximo vencimiento despierta al nucleo.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define EVENT_QUEUE_SIZE 16 /**< Cantidad maxima de eventos pendientes (potencia de dos) */
+#define EVENT_MAX        8  /**< Cantidad de identificadores de evento distintos */
+#define EVENT_LINE_SIZE  96 /**< Tamaño maximo de la linea del reporte */
+
+/**
+ * @brief Tipo de los handlers de evento; se ejecutan en el bucle principal.
+ */
+typedef void (*EVENT_Handler)(void);
+
+/**
+ * @brief Estadisticas de uso del nucleo.
+ */
+typedef struct
+{
+    uint64_t Sleep_Us; /**< Microsegundos pasados en modo Sleep */
+    uint64_t Total_Us; /**< Microsegundos transcurridos desde el arranque del planificador */
+    uint32_t Dispatched; /**< Eventos despachados */
+    uint32_t Dropped;    /**< Eventos descartados por cola llena */
+} EVENT_Stats_Type;
+
+/**
+ * @brief Inicializa la cola y borra los handlers y las estadisticas.
+ */
+void EVENT_Init(void);
+
+/**
+ * @brief Asocia un handler a un identificador de evento.
+ *
+ * @param event Identificador del evento (menor a EVENT_MAX).
+ * @param handler Funcion a ejecutar al despachar el evento.
+ * @return SUCCESS si se registro, ERROR si el identificador es invalido.
+ */
+Status EVENT_Register(uint8_t event, EVENT_Handler handler);
+
+/**
+ * @brief Publica un evento. Se puede llamar desde cualquier interrupcion.
+ *
+ * @param event Identificador del evento.
+ * @return SUCCESS si se encolo, ERROR si la cola estaba llena.
+ */
+Status EVENT_Post(uint8_t event);
+
+/**
+ * @brief Despacha todos los eventos pendientes.
+ *
+ * @return Cantidad de eventos despachados.
+ */
+uint32_t EVENT_Dispatch(void);
+
+/**
+ * @brief Duerme el nucleo hasta la proxima interrupcion si la cola esta vacia.
+ *
+ * La comprobacion y la instruccion WFI se hacen con las interrupciones enmascaradas para no perder un evento
+ * publicado entre ambas; WFI despierta igual con la interrupcion pendiente. El planificador siempre tiene un
+ * vencimiento a menos de media vuelta del TIMER2, asi que el tiempo se acumula antes de que el contador complete
+ * una vuelta.
+ */
+void EVENT_Sleep(void);
+
+/**
+ * @brief Copia las estadisticas de uso del nucleo.
+ *
+ * @param stats Donde se copian las estadisticas.
+ */
+void EVENT_GetStats(EVENT_Stats_Type* stats);
+
+/**
+ * @brief Devuelve el porcentaje del tiempo en que el nucleo estuvo despierto.
+ *
+ * @return Carga de CPU en porcentaje (0 a 100).
+ */
+uint8_t EVENT_GetLoad(void);
+
+/**
+ * @brief Arma la linea de texto del reporte de uso del nucleo, para enviar por UART junto al del planificador.
+ *
+ * Formato: "EVENT load=<%> sleep=<ms> total=<ms> n=<despachados> drop=<descartados>\r\n". La carga y los tiempos
+ * salen de una misma lectura del TIMER2; los tiempos se truncan a milisegundos.
+ *
+ * @param line Donde se arma la linea (EVENT_LINE_SIZE bytes).
+ * @return Cantidad de caracteres escritos sin el terminador.
+ */
+uint32_t EVENT_Format(char* line);
+
+#endif /* EVENT_QUEUE_H */
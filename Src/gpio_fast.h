@@ -0,0 +1,105 @@
+/**
+ * @file gpio_fast.h
+ * @brief Acceso rapido a los pines de GPIO: funciones inline sobre los registros FIO y alias de bit-band.
+ *
+ * GPIO_SetValue() y GPIO_ClearValue() de lpc17xx_gpio.c son llamadas que buscan el puerto con un switch en cada
+ * acceso. Aca el puerto y el pin son constantes: GPIO_FAST_PORT() y GPIO_FAST_BIT() se resuelven al compilar, aun
+ * con -O0, y las funciones se insertan siempre en el lugar de la llamada (always_inline), asi que cada escritura es
+ * un solo acceso al registro.
+ *
+ * - GPIO_FAST_Set() y GPIO_FAST_Clear() escriben FIOSET y FIOCLR: varios pines del mismo puerto a la vez.
+ * - GPIO_FAST_Write() y GPIO_FAST_Read() usan el alias de bit-band de FIOPIN (el GPIO esta en la region de SRAM del
+ *   Cortex-M3): un pin por palabra, sin lectura-modificacion-escritura en software. El bus lee FIOPIN, cambia el bit
+ *   y escribe la palabra sin que una interrupcion pueda meterse en el medio; los otros pines de salida reciben el
+ *   nivel que tienen, asi que no conviene para salidas que una carga externa pueda forzar al nivel contrario.
+ * - GPIO_FAST_WritePort() escribe varios pines con valores distintos en un solo acceso, con FIOMASK.
+ *
+ * Los pines se configuran como antes (PINSEL y GPIO_SetDir()); este modulo solo reemplaza las escrituras.
+ */
+
+#ifndef GPIO_FAST_H
+#define GPIO_FAST_H
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define GPIO_FAST_SRAM_BASE  0x20000000UL /**< Region de SRAM con bit-band (incluye el GPIO, 0x2009C000) */
+#define GPIO_FAST_ALIAS_BASE 0x22000000UL /**< Alias de bit-band de la region de SRAM */
+
+#define GPIO_FAST_INLINE static inline __attribute__((always_inline)) /**< Funcion insertada aun con -O0 */
+
+/** Registros de un puerto (0 a 4) */
+#define GPIO_FAST_PORT(port) ((LPC_GPIO_TypeDef*)(LPC_GPIO0_BASE + 0x20 * (port)))
+
+/** Alias de bit-band del pin de un puerto en FIOPIN: se lee 0 o 1 y se escribe el nivel del pin */
+#define GPIO_FAST_BIT(port, pin)                                                                                  \
+    ((volatile uint32_t*)(GPIO_FAST_ALIAS_BASE +                                                                  \
+                          (((uint32_t)&GPIO_FAST_PORT(port)->FIOPIN - GPIO_FAST_SRAM_BASE) << 5) + ((pin) << 2)))
+
+/**
+ * @brief Pone en alto los pines de un puerto.
+ *
+ * @param gpio Puerto (GPIO_FAST_PORT() o LPC_GPIOn).
+ * @param mask Pines a poner en alto.
+ */
+GPIO_FAST_INLINE void GPIO_FAST_Set(LPC_GPIO_TypeDef* gpio, uint32_t mask)
+{
+    gpio->FIOSET = mask;
+}
+
+/**
+ * @brief Pone en bajo los pines de un puerto.
+ *
+ * @param gpio Puerto (GPIO_FAST_PORT() o LPC_GPIOn).
+ * @param mask Pines a poner en bajo.
+ */
+GPIO_FAST_INLINE void GPIO_FAST_Clear(LPC_GPIO_TypeDef* gpio, uint32_t mask)
+{
+    gpio->FIOCLR = mask;
+}
+
+/**
+ * @brief Fija el nivel de un pin por su alias de bit-band.
+ *
+ * @param bit Alias del pin (GPIO_FAST_BIT()).
+ * @param value 0 para bajo; cualquier otro valor con el bit 0 en 1 para alto.
+ */
+GPIO_FAST_INLINE void GPIO_FAST_Write(volatile uint32_t* bit, uint32_t value)
+{
+    *bit = value;
+}
+
+/**
+ * @brief Lee el nivel de un pin por su alias de bit-band.
+ *
+ * @param bit Alias del pin (GPIO_FAST_BIT()).
+ * @return 0 o 1.
+ */
+GPIO_FAST_INLINE uint32_t GPIO_FAST_Read(volatile uint32_t* bit)
+{
+    return *bit;
+}
+
+/**
+ * @brief Escribe varios pines de un puerto a la vez; el resto no cambia.
+ *
+ * FIOMASK tambien enmascara a FIOSET y FIOCLR, asi que la escritura corre con las interrupciones deshabilitadas y
+ * deja FIOMASK en 0, su valor en todo el firmware.
+ *
+ * @param gpio Puerto (GPIO_FAST_PORT() o LPC_GPIOn).
+ * @param mask Pines a escribir.
+ * @param value Nivel de cada pin de la mascara.
+ */
+GPIO_FAST_INLINE void GPIO_FAST_WritePort(LPC_GPIO_TypeDef* gpio, uint32_t mask, uint32_t value)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    gpio->FIOMASK = ~mask;
+    gpio->FIOPIN = value;
+    gpio->FIOMASK = 0;
+    __set_PRIMASK(primask);
+}
+
+#endif /* GPIO_FAST_H */
@@ -0,0 +1,27 @@
+/**
+ * @file irq_priority.c
+ * @brief Tabla central de prioridades de las interrupciones, con agrupamiento para el desalojo anidado.
+ */
+
+#include "irq_priority.h"
+
+Status IRQ_PRIO_Init(const IRQ_PRIO_Entry_Type* table, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        // De las excepciones del nucleo, solo las de MemoryManagement en adelante tienen prioridad configurable.
+        if (table[i].Irq < MemoryManagement_IRQn || table[i].Preempt == IRQ_PRIO_RESERVED ||
+            table[i].Preempt >= IRQ_PRIO_LEVELS || table[i].Sub >= IRQ_PRIO_SUBLEVELS)
+        {
+            return ERROR;
+        }
+    }
+
+    NVIC_SetPriorityGrouping(IRQ_PRIO_GROUPING);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        NVIC_SetPriority(table[i].Irq, NVIC_EncodePriority(IRQ_PRIO_GROUPING, table[i].Preempt, table[i].Sub));
+    }
+
+    return SUCCESS;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file irq_priority.h
+ * @brief Tabla central de prioridades de las interrupciones, con agrupamiento para el desalojo anidado.
+ *
+ * El LPC17xx implementa 5 bits de prioridad. Con IRQ_PRIO_GROUPING, los 3 bits altos son la prioridad de grupo,
+ * la unica que decide el desalojo (un handler solo interrumpe a otro de grupo mayor), y los 2 bajos la
+ * subprioridad, que solo ordena a las pendientes de un mismo grupo. Asi los handlers cortos y urgentes desalojan
+ * a los largos, y los de un mismo grupo se atienden de a uno sin anidarse.
+ *
+ * El grupo IRQ_PRIO_RESERVED queda fuera de la tabla: lo usa la sonda de latencia de isr_profile.c, que tiene que
+ * poder interrumpir a cualquier handler de la aplicacion.
+ */
+
+#ifndef IRQ_PRIORITY_H
+#define IRQ_PRIORITY_H
+
+#include "LPC17xx.h"
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define IRQ_PRIO_GROUPING  4 /**< PRIGROUP del AIRCR: 3 bits de grupo y 2 de subprioridad */
+#define IRQ_PRIO_LEVELS    8 /**< Prioridades de grupo (0 es la mas urgente) */
+#define IRQ_PRIO_SUBLEVELS 4 /**< Subprioridades dentro de un grupo */
+#define IRQ_PRIO_RESERVED  0 /**< Grupo reservado para la instrumentacion */
+
+/**
+ * @brief Prioridad de una interrupcion.
+ */
+typedef struct
+{
+    IRQn_Type Irq;   /**< Interrupcion (negativa para las excepciones del nucleo, por ejemplo SysTick_IRQn) */
+    uint8_t Preempt; /**< Prioridad de grupo (1 a IRQ_PRIO_LEVELS - 1) */
+    uint8_t Sub;     /**< Subprioridad (0 a IRQ_PRIO_SUBLEVELS - 1) */
+} IRQ_PRIO_Entry_Type;
+
+/**
+ * @brief Configura el agrupamiento y la prioridad de cada interrupcion de la tabla.
+ *
+ * Se valida toda la tabla antes de escribir el NVIC: si hay un error no se cambia ninguna prioridad. Debe llamarse
+ * antes de habilitar las interrupciones; las que no estan en la tabla quedan en el grupo 0.
+ *
+ * @param table Prioridades.
+ * @param count Cantidad de entradas.
+ * @return SUCCESS, o ERROR si alguna entrada usa el grupo reservado, un nivel fuera de rango o una excepcion del
+ *         nucleo sin prioridad configurable.
+ */
+Status IRQ_PRIO_Init(const IRQ_PRIO_Entry_Type* table, uint8_t count);
+
+#endif /* IRQ_PRIORITY_H */
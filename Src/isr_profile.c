@@ -0,0 +1,581 @@
+/**
+ * @file isr_profile.c
+ * @brief Medicion de la duracion y la latencia de las interrupciones con el contador de ciclos del DWT.
+ *
+ * El core_cm3.h de CMSIS 2.0 no define el DWT, por lo que sus registros se declaran aqui. Las marcas de entrada
+ * se apilan para restar a cada handler el tiempo de los handlers que lo desalojaron; la pila y la tabla se
+ * actualizan en secciones criticas de pocas instrucciones porque cualquier handler medido puede anidarse.
+ *
+ * La sonda de latencia usa el TIMER3, en el grupo reservado de irq_priority.h, como fuente de eventos asincronos:
+ * en cada match toma CYCCNT y deja pendiente la interrupcion del RIT (que la aplicacion no usa) con la prioridad
+ * del handler sondeado, por turnos. El RIT se atiende cuando lo haria un evento real de ese handler, detras de los
+ * handlers de su grupo o de grupos mas urgentes que esten en curso, y registra la espera como su latencia. El
+ * tiempo del TIMER3 se descuenta del handler que desaloja; el del RIT (unas pocas instrucciones) no.
+ *
+ * El banco de prueba del bus genera el trafico con una copia memoria a memoria en anillo (una LLI que apunta a si
+ * misma, sin terminal count), asi que el GPDMA compite con el lazo durante toda la medicion. El del GPIO repite el
+ * mismo lazo de pulsos con cada metodo; el lazo vacio da el costo que comparten. La configuracion de los pines
+ * solo puede medirse en el arranque, antes que los perifericos: ISR_PROFILE_Pins() la cronometra ahi y el banco de
+ * prueba envia el resultado.
+ */
+
+#ifdef ISR_PROFILE
+
+#include "isr_profile.h"
+
+#include "LPC17xx.h"
+#include "ahbram.h"
+#include "gpio_fast.h"
+#include "irq_priority.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_gpio.h"
+#include "lpc17xx_timer.h"
+#include "text_fmt.h"
+#include "uart_ring.h"
+
+// Registros del DWT (Data Watchpoint and Trace), no definidos en core_cm3.h:
+#define DWT_CTRL           (*(volatile uint32_t*)0xE0001000UL) /**< Control del DWT */
+#define DWT_CYCCNT         (*(volatile uint32_t*)0xE0001004UL) /**< Contador de ciclos de CPU */
+#define DWT_CTRL_CYCCNTENA (1UL << 0)                          /**< Habilita el contador de ciclos */
+
+#define ISR_PROFILE_LINE_SIZE 160  /**< Tamaño maximo de una linea del reporte */
+#define ISR_PROFILE_IDLE      0xFF /**< Indice que marca que no hay envio en curso */
+
+#define ISR_PROFILE_PROBE_MIN  2500                /**< Intervalo minimo de la sonda (100 us a 25 MHz) */
+#define ISR_PROFILE_PROBE_SPAN 0x3FFF              /**< Mascara del intervalo seudoaleatorio que se le suma */
+#define ISR_PROFILE_NO_IRQ     NonMaskableInt_IRQn /**< Medicion sin interrupcion propia (no se sondea) */
+
+#define ISR_PROFILE_BENCH_WORDS 256 /**< Palabras del arreglo del lazo y de cada buffer de la copia */
+#define ISR_PROFILE_BENCH_CH    ((LPC_GPDMACH_TypeDef*)(LPC_GPDMACH0_BASE + 0x20 * ISR_PROFILE_BENCH_CHANNEL))
+
+#define ISR_PROFILE_PINSEL_WORDS  10 /**< PINSEL0 a PINSEL9 */
+#define ISR_PROFILE_PINMODE_WORDS 15 /**< PINMODE0 a PINMODE9 y PINMODE_OD0 a PINMODE_OD4 (contiguos) */
+#define ISR_PROFILE_PIN_WORDS     (ISR_PROFILE_PINSEL_WORDS + ISR_PROFILE_PINMODE_WORDS) /**< Palabras comparadas */
+
+/**
+ * @brief Marca de entrada de un handler en ejecucion.
+ */
+typedef struct
+{
+    uint32_t Start;  /**< CYCCNT al entrar */
+    uint32_t Nested; /**< Ciclos consumidos por los handlers que lo desalojaron */
+} ISR_PROFILE_Frame_Type;
+
+static ISR_PROFILE_Stats_Type Stats[ISR_PROFILE_COUNT];    /**< Estadisticas por handler */
+static ISR_PROFILE_Frame_Type Stack[ISR_PROFILE_DEPTH];    /**< Handlers en ejecucion (anidados) */
+static volatile uint8_t Depth = 0;                         /**< Cantidad de handlers en ejecucion */
+static ISR_PROFILE_Stats_Type Snapshot[ISR_PROFILE_COUNT]; /**< Copia de la tabla para el envio en curso */
+static uint8_t Dump_Line = ISR_PROFILE_IDLE;               /**< Proxima linea a enviar */
+
+static uint32_t Probe_Start = 0;          /**< CYCCNT al dejar pendiente la sonda */
+static uint8_t Probe_Target = 0;          /**< Handler sondeado */
+static volatile Bool Probe_Armed = FALSE; /**< Sonda pendiente de atencion */
+static uint32_t Probe_Seed = 1;           /**< Estado del generador del intervalo */
+
+static uint32_t Bench_Work[ISR_PROFILE_BENCH_WORDS];                  /**< Arreglo del lazo (SRAM local) */
+static uint32_t Bench_Sram[2][ISR_PROFILE_BENCH_WORDS];               /**< Copia en la SRAM local: origen y destino */
+AHBRAM1_NOINIT static uint32_t Bench_Ahb[2][ISR_PROFILE_BENCH_WORDS]; /**< Copia en AHBRAM1: origen y destino */
+AHBRAM1_BSS static GPDMA_LLI_Type Bench_LLI;                          /**< LLI de la copia, en anillo */
+
+static uint32_t Pins_Calls = 0;     /**< Ciclos de la configuracion de los pines con llamadas al driver */
+static uint32_t Pins_Image = 0;     /**< Ciclos de la configuracion de los pines con la imagen */
+static Bool Pins_Has_Image = FALSE; /**< Se midio la imagen */
+static Bool Pins_Match = FALSE;     /**< La imagen deja los registros iguales que las llamadas */
+
+static const char* const Names[ISR_PROFILE_COUNT] = {"EINT3", "TIMER2", "UART2", "DMA", "FILTER"};
+
+/** Interrupcion de cada handler medido, de la que la sonda copia la prioridad */
+static const IRQn_Type Irqs[ISR_PROFILE_COUNT] = {EINT3_IRQn, TIMER2_IRQn, UART2_IRQn, DMA_IRQn, ISR_PROFILE_NO_IRQ};
+
+/**
+ * @brief Indice del histograma para una duracion.
+ *
+ * @param cycles Duracion en ciclos.
+ * @return Intervalo [2^(i+4), 2^(i+5)) ciclos; el primero y el ultimo quedan abiertos.
+ */
+static uint8_t ISR_PROFILE_Bucket(uint32_t cycles)
+{
+    uint32_t log2 = 31 - __CLZ(cycles | 1);
+
+    if (log2 < ISR_PROFILE_FIRST_SHIFT)
+    {
+        return 0;
+    }
+
+    log2 -= ISR_PROFILE_FIRST_SHIFT - 1;
+    return (uint8_t)((log2 < ISR_PROFILE_BUCKETS) ? log2 : (ISR_PROFILE_BUCKETS - 1));
+}
+
+/**
+ * @brief Arma la linea del reporte de un handler.
+ *
+ * Formato: "ISR <nombre> n=<ejecuciones> min=<> avg=<> max=<> pre=<> lat=<> h=<i0>,...,<i7>\r\n" (ciclos).
+ *
+ * @param line Donde se arma la linea (ISR_PROFILE_LINE_SIZE bytes).
+ * @param id Handler del reporte.
+ * @return Longitud de la linea.
+ */
+static uint32_t ISR_PROFILE_FormatLine(char* line, uint8_t id)
+{
+    const ISR_PROFILE_Stats_Type* s = &Snapshot[id];
+    uint32_t pos = 0;
+
+    pos = TEXT_FMT_PutText(line, pos, "ISR ");
+    pos = TEXT_FMT_PutText(line, pos, Names[id]);
+    pos = TEXT_FMT_PutText(line, pos, " n=");
+    pos = TEXT_FMT_PutNumber(line, pos, s->Count);
+    pos = TEXT_FMT_PutText(line, pos, " min=");
+    pos = TEXT_FMT_PutNumber(line, pos, (s->Count != 0) ? s->Min : 0);
+    pos = TEXT_FMT_PutText(line, pos, " avg=");
+    pos = TEXT_FMT_PutNumber(line, pos, (s->Count != 0) ? (uint32_t)(s->Sum / s->Count) : 0);
+    pos = TEXT_FMT_PutText(line, pos, " max=");
+    pos = TEXT_FMT_PutNumber(line, pos, s->Max);
+    pos = TEXT_FMT_PutText(line, pos, " pre=");
+    pos = TEXT_FMT_PutNumber(line, pos, s->Preempted_Max);
+    pos = TEXT_FMT_PutText(line, pos, " lat=");
+    pos = TEXT_FMT_PutNumber(line, pos, s->Latency_Max);
+    pos = TEXT_FMT_PutText(line, pos, " h=");
+    for (uint8_t i = 0; i < ISR_PROFILE_BUCKETS; i++)
+    {
+        pos = TEXT_FMT_PutNumber(line, pos, s->Histogram[i]);
+        line[pos++] = (i + 1 < ISR_PROFILE_BUCKETS) ? ',' : '\r';
+    }
+    line[pos++] = '\n';
+
+    return pos;
+}
+
+/**
+ * @brief Inicia la sonda de latencia: TIMER3 con una cuenta por ciclo de PCLK e interrupcion en el match 0.
+ */
+static void ISR_PROFILE_ProbeInit(void)
+{
+    TIM_TIMERCFG_Type TimerCfg;
+    TIM_MATCHCFG_Type MatchCfg;
+
+    TimerCfg.PrescaleOption = TIM_PRESCALE_TICKVAL;
+    TimerCfg.PrescaleValue = 1;
+    TIM_Init(LPC_TIM3, TIM_TIMER_MODE, &TimerCfg);
+
+    MatchCfg.MatchChannel = 0;
+    MatchCfg.IntOnMatch = ENABLE;
+    MatchCfg.ResetOnMatch = ENABLE;
+    MatchCfg.StopOnMatch = DISABLE;
+    MatchCfg.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+    MatchCfg.MatchValue = ISR_PROFILE_PROBE_MIN;
+    TIM_ConfigMatch(LPC_TIM3, &MatchCfg);
+
+    Probe_Target = 0;
+    Probe_Armed = FALSE;
+    NVIC_SetPriority(TIMER3_IRQn, NVIC_EncodePriority(IRQ_PRIO_GROUPING, IRQ_PRIO_RESERVED, 0));
+    NVIC_EnableIRQ(TIMER3_IRQn);
+    NVIC_EnableIRQ(RIT_IRQn);
+    TIM_Cmd(LPC_TIM3, ENABLE);
+}
+
+void ISR_PROFILE_Init(void)
+{
+    // El DWT solo funciona con el bloque de trazas habilitado (TRCENA):
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+
+    Depth = 0;
+    Dump_Line = ISR_PROFILE_IDLE;
+    ISR_PROFILE_Reset();
+    ISR_PROFILE_ProbeInit();
+}
+
+void ISR_PROFILE_Enter(ISR_PROFILE_Id_Type id)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    (void)id;
+
+    __disable_irq();
+    if (Depth < ISR_PROFILE_DEPTH)
+    {
+        Stack[Depth].Start = DWT_CYCCNT;
+        Stack[Depth].Nested = 0;
+    }
+    Depth++;
+    __set_PRIMASK(primask);
+}
+
+void ISR_PROFILE_Exit(ISR_PROFILE_Id_Type id)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now;
+    uint32_t total;
+    uint32_t self;
+    ISR_PROFILE_Stats_Type* s = &Stats[id];
+
+    __disable_irq();
+    now = DWT_CYCCNT;
+    Depth--;
+
+    if (Depth < ISR_PROFILE_DEPTH)
+    {
+        // La resta en 32 bits es correcta aunque CYCCNT haya dado la vuelta durante el handler.
+        total = now - Stack[Depth].Start;
+        self = total - Stack[Depth].Nested;
+        if (Depth > 0)
+        {
+            Stack[Depth - 1].Nested += total;
+        }
+
+        s->Count++;
+        s->Sum += self;
+        s->Min = (self < s->Min) ? self : s->Min;
+        s->Max = (self > s->Max) ? self : s->Max;
+        s->Preempted_Max = (total - self > s->Preempted_Max) ? (total - self) : s->Preempted_Max;
+        if (s->Histogram[ISR_PROFILE_Bucket(self)] != UINT16_MAX)
+        {
+            s->Histogram[ISR_PROFILE_Bucket(self)]++;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+void ISR_PROFILE_Latency(ISR_PROFILE_Id_Type id, uint32_t cycles)
+{
+    // Solo la llaman el propio handler y la sonda, que tiene su misma prioridad: no se anidan entre si.
+    if (cycles > Stats[id].Latency_Max)
+    {
+        Stats[id].Latency_Max = cycles;
+    }
+}
+
+void ISR_PROFILE_GetStats(ISR_PROFILE_Id_Type id, ISR_PROFILE_Stats_Type* stats)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *stats = Stats[id];
+    __set_PRIMASK(primask);
+}
+
+void ISR_PROFILE_Reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (uint8_t id = 0; id < ISR_PROFILE_COUNT; id++)
+    {
+        Stats[id] = (ISR_PROFILE_Stats_Type){0};
+        Stats[id].Min = UINT32_MAX;
+    }
+    __set_PRIMASK(primask);
+}
+
+void ISR_PROFILE_Dump(void)
+{
+    for (uint8_t id = 0; id < ISR_PROFILE_COUNT; id++)
+    {
+        ISR_PROFILE_GetStats((ISR_PROFILE_Id_Type)id, &Snapshot[id]);
+    }
+
+    Dump_Line = 0;
+    ISR_PROFILE_Poll();
+}
+
+void ISR_PROFILE_Poll(void)
+{
+    char line[ISR_PROFILE_LINE_SIZE];
+    uint32_t length;
+
+    while (Dump_Line < ISR_PROFILE_COUNT)
+    {
+        length = ISR_PROFILE_FormatLine(line, Dump_Line);
+
+        // Solo se encolan lineas completas; la que no entra espera a que se vacie el buffer.
+        if (UART_Ring_Free() < length)
+        {
+            return;
+        }
+
+        UART_Ring_Write((const uint8_t*)line, length);
+        Dump_Line++;
+    }
+
+    Dump_Line = ISR_PROFILE_IDLE;
+}
+
+/**
+ * @brief Lazo del banco de prueba: lecturas y escrituras sobre la SRAM local.
+ *
+ * @return Ciclos de CPU del lazo.
+ */
+static uint32_t ISR_PROFILE_BenchLoop(void)
+{
+    uint32_t start = DWT_CYCCNT;
+
+    for (uint32_t pass = 0; pass < ISR_PROFILE_BENCH_PASSES; pass++)
+    {
+        for (uint32_t i = 0; i < ISR_PROFILE_BENCH_WORDS; i++)
+        {
+            Bench_Work[i] = Bench_Work[i] * 3 + pass;
+        }
+    }
+
+    return DWT_CYCCNT - start;
+}
+
+/**
+ * @brief Cronometra el lazo del banco de prueba mientras el GPDMA copia en anillo entre dos buffers.
+ *
+ * @param buffers Origen (el primero) y destino de la copia.
+ * @return Ciclos de CPU del lazo.
+ */
+static uint32_t ISR_PROFILE_BenchCopy(uint32_t (*buffers)[ISR_PROFILE_BENCH_WORDS])
+{
+    GPDMA_Channel_CFG_Type DMAChannel;
+    uint32_t cycles;
+
+    Bench_LLI.SrcAddr = (uint32_t)buffers[0];
+    Bench_LLI.DstAddr = (uint32_t)buffers[1];
+    Bench_LLI.NextLLI = (uint32_t)&Bench_LLI;
+    Bench_LLI.Control = GPDMA_DMACCxControl_TransferSize(ISR_PROFILE_BENCH_WORDS) |
+                        GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_32) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_32) |
+                        GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) |
+                        GPDMA_DMACCxControl_SI | GPDMA_DMACCxControl_DI;
+
+    DMAChannel.ChannelNum = ISR_PROFILE_BENCH_CHANNEL; // Canal DMA del banco de prueba
+    DMAChannel.SrcMemAddr = Bench_LLI.SrcAddr;         // Dirección de origen
+    DMAChannel.DstMemAddr = Bench_LLI.DstAddr;         // Dirección de destino
+    DMAChannel.TransferSize = ISR_PROFILE_BENCH_WORDS; // Tamaño de la transferencia (un buffer)
+    DMAChannel.TransferWidth = GPDMA_WIDTH_WORD;       // Palabras de 32 bits
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_M2M;  // Memoria a memoria
+    DMAChannel.SrcConn = 0;                            // No se usa conexión de origen
+    DMAChannel.DstConn = 0;                            // No se usa conexión de destino
+    DMAChannel.DMALLI = (uint32_t)&Bench_LLI;          // La copia se repite
+    GPDMA_Setup(&DMAChannel);
+
+    // GPDMA_Setup() pide terminal count al final de la primera vuelta: se quita para que la copia no interrumpa.
+    ISR_PROFILE_BENCH_CH->DMACCControl = Bench_LLI.Control;
+
+    GPDMA_ChannelCmd(ISR_PROFILE_BENCH_CHANNEL, ENABLE);
+    cycles = ISR_PROFILE_BenchLoop();
+    GPDMA_ChannelCmd(ISR_PROFILE_BENCH_CHANNEL, DISABLE);
+
+    return cycles;
+}
+
+/**
+ * @brief Cronometra los pulsos del pin de prueba con cada metodo de escritura.
+ *
+ * @param cycles Ciclos de CPU del lazo vacio, del driver, de FIOSET/FIOCLR y del bit-band, en ese orden.
+ */
+static void ISR_PROFILE_BenchGpio(uint32_t* cycles)
+{
+    uint32_t level = GPIO_FAST_Read(GPIO_FAST_BIT(ISR_PROFILE_BENCH_PORT, ISR_PROFILE_BENCH_PIN));
+    uint32_t start;
+
+    start = DWT_CYCCNT;
+    for (uint32_t n = 0; n < ISR_PROFILE_BENCH_TOGGLES; n++)
+    {
+        __NOP();
+    }
+    cycles[0] = DWT_CYCCNT - start;
+
+    start = DWT_CYCCNT;
+    for (uint32_t n = 0; n < ISR_PROFILE_BENCH_TOGGLES; n++)
+    {
+        GPIO_SetValue(ISR_PROFILE_BENCH_PORT, 1UL << ISR_PROFILE_BENCH_PIN);
+        GPIO_ClearValue(ISR_PROFILE_BENCH_PORT, 1UL << ISR_PROFILE_BENCH_PIN);
+    }
+    cycles[1] = DWT_CYCCNT - start;
+
+    start = DWT_CYCCNT;
+    for (uint32_t n = 0; n < ISR_PROFILE_BENCH_TOGGLES; n++)
+    {
+        GPIO_FAST_Set(GPIO_FAST_PORT(ISR_PROFILE_BENCH_PORT), 1UL << ISR_PROFILE_BENCH_PIN);
+        GPIO_FAST_Clear(GPIO_FAST_PORT(ISR_PROFILE_BENCH_PORT), 1UL << ISR_PROFILE_BENCH_PIN);
+    }
+    cycles[2] = DWT_CYCCNT - start;
+
+    start = DWT_CYCCNT;
+    for (uint32_t n = 0; n < ISR_PROFILE_BENCH_TOGGLES; n++)
+    {
+        GPIO_FAST_Write(GPIO_FAST_BIT(ISR_PROFILE_BENCH_PORT, ISR_PROFILE_BENCH_PIN), 1);
+        GPIO_FAST_Write(GPIO_FAST_BIT(ISR_PROFILE_BENCH_PORT, ISR_PROFILE_BENCH_PIN), 0);
+    }
+    cycles[3] = DWT_CYCCNT - start;
+
+    GPIO_FAST_Write(GPIO_FAST_BIT(ISR_PROFILE_BENCH_PORT, ISR_PROFILE_BENCH_PIN), level);
+}
+
+/**
+ * @brief Copia PINSEL0..9, PINMODE0..9 y PINMODE_OD0..4.
+ *
+ * @param words Donde se copian (ISR_PROFILE_PIN_WORDS palabras).
+ */
+static void ISR_PROFILE_PinsRead(uint32_t* words)
+{
+    for (uint32_t i = 0; i < ISR_PROFILE_PINSEL_WORDS; i++)
+    {
+        words[i] = (&LPC_PINCON->PINSEL0)[i];
+    }
+    for (uint32_t i = 0; i < ISR_PROFILE_PINMODE_WORDS; i++)
+    {
+        words[ISR_PROFILE_PINSEL_WORDS + i] = (&LPC_PINCON->PINMODE0)[i];
+    }
+}
+
+/**
+ * @brief Escribe PINSEL0..9, PINMODE0..9 y PINMODE_OD0..4.
+ *
+ * @param words Valores (ISR_PROFILE_PIN_WORDS palabras, en el orden de ISR_PROFILE_PinsRead()).
+ */
+static void ISR_PROFILE_PinsWrite(const uint32_t* words)
+{
+    for (uint32_t i = 0; i < ISR_PROFILE_PINSEL_WORDS; i++)
+    {
+        (&LPC_PINCON->PINSEL0)[i] = words[i];
+    }
+    for (uint32_t i = 0; i < ISR_PROFILE_PINMODE_WORDS; i++)
+    {
+        (&LPC_PINCON->PINMODE0)[i] = words[ISR_PROFILE_PINSEL_WORDS + i];
+    }
+}
+
+void ISR_PROFILE_Pins(void (*calls)(void), void (*image)(void))
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t before[ISR_PROFILE_PIN_WORDS];
+    uint32_t after[ISR_PROFILE_PIN_WORDS];
+    uint32_t start;
+
+    // Sin interrupciones, para que ningun handler se cuente en la medicion:
+    __disable_irq();
+    ISR_PROFILE_PinsRead(before);
+    start = DWT_CYCCNT;
+    calls();
+    Pins_Calls = DWT_CYCCNT - start;
+
+    Pins_Has_Image = (image != NULL) ? TRUE : FALSE;
+    Pins_Match = FALSE;
+    if (image != NULL)
+    {
+        // La imagen parte de los mismos registros que las llamadas: un pin que le falte queda a la vista.
+        ISR_PROFILE_PinsRead(after);
+        ISR_PROFILE_PinsWrite(before);
+        start = DWT_CYCCNT;
+        image();
+        Pins_Image = DWT_CYCCNT - start;
+
+        ISR_PROFILE_PinsRead(before);
+        Pins_Match = TRUE;
+        for (uint32_t i = 0; i < ISR_PROFILE_PIN_WORDS; i++)
+        {
+            if (before[i] != after[i])
+            {
+                Pins_Match = FALSE;
+            }
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+void ISR_PROFILE_Bench(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t idle;
+    uint32_t sram;
+    uint32_t ahb;
+    uint32_t gpio[4];
+    char line[ISR_PROFILE_LINE_SIZE];
+    uint32_t pos = 0;
+
+    // Sin interrupciones, para que solo el GPDMA compita con el lazo y ningun handler toque el pin de prueba:
+    __disable_irq();
+    idle = ISR_PROFILE_BenchLoop();
+    sram = ISR_PROFILE_BenchCopy(Bench_Sram);
+    ahb = ISR_PROFILE_BenchCopy(Bench_Ahb);
+    ISR_PROFILE_BenchGpio(gpio);
+    __set_PRIMASK(primask);
+
+    pos = TEXT_FMT_PutText(line, pos, "BENCH idle=");
+    pos = TEXT_FMT_PutNumber(line, pos, idle);
+    pos = TEXT_FMT_PutText(line, pos, " sram=");
+    pos = TEXT_FMT_PutNumber(line, pos, sram);
+    pos = TEXT_FMT_PutText(line, pos, " ahb=");
+    pos = TEXT_FMT_PutNumber(line, pos, ahb);
+    pos = TEXT_FMT_PutText(line, pos, "\r\nGPIO n=");
+    pos = TEXT_FMT_PutNumber(line, pos, ISR_PROFILE_BENCH_TOGGLES);
+    pos = TEXT_FMT_PutText(line, pos, " loop=");
+    pos = TEXT_FMT_PutNumber(line, pos, gpio[0]);
+    pos = TEXT_FMT_PutText(line, pos, " driver=");
+    pos = TEXT_FMT_PutNumber(line, pos, gpio[1]);
+    pos = TEXT_FMT_PutText(line, pos, " fast=");
+    pos = TEXT_FMT_PutNumber(line, pos, gpio[2]);
+    pos = TEXT_FMT_PutText(line, pos, " bitband=");
+    pos = TEXT_FMT_PutNumber(line, pos, gpio[3]);
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+
+    if (UART_Ring_Free() >= pos)
+    {
+        UART_Ring_Write((const uint8_t*)line, pos);
+    }
+
+    pos = TEXT_FMT_PutText(line, 0, "PINS calls=");
+    pos = TEXT_FMT_PutNumber(line, pos, Pins_Calls);
+    if (Pins_Has_Image == TRUE)
+    {
+        pos = TEXT_FMT_PutText(line, pos, " image=");
+        pos = TEXT_FMT_PutNumber(line, pos, Pins_Image);
+        pos = TEXT_FMT_PutText(line, pos, " match=");
+        pos = TEXT_FMT_PutNumber(line, pos, (Pins_Match == TRUE) ? 1 : 0);
+    }
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+
+    if (UART_Ring_Free() >= pos)
+    {
+        UART_Ring_Write((const uint8_t*)line, pos);
+    }
+}
+
+/**
+ * @brief Disparo de la sonda de latencia: deja pendiente el RIT con la prioridad del proximo handler sondeado.
+ */
+void TIMER3_IRQHandler(void)
+{
+    uint32_t start = DWT_CYCCNT;
+
+    TIM_ClearIntPending(LPC_TIM3, TIM_MR0_INT);
+
+    // Proximo disparo en un instante seudoaleatorio, para no quedar en fase con los handlers periodicos:
+    Probe_Seed = Probe_Seed * 1664525UL + 1013904223UL;
+    TIM_UpdateMatchValue(LPC_TIM3, 0, ISR_PROFILE_PROBE_MIN + ((Probe_Seed >> 16) & ISR_PROFILE_PROBE_SPAN));
+
+    // Si la sonda anterior todavia espera, su handler sigue bloqueado: se deja correr su medicion.
+    if (Probe_Armed == FALSE)
+    {
+        do
+        {
+            Probe_Target = (uint8_t)((Probe_Target + 1) % ISR_PROFILE_COUNT);
+        } while (Irqs[Probe_Target] == ISR_PROFILE_NO_IRQ);
+
+        NVIC_SetPriority(RIT_IRQn, NVIC_GetPriority(Irqs[Probe_Target]));
+        Probe_Armed = TRUE;
+        Probe_Start = DWT_CYCCNT;
+        NVIC_SetPendingIRQ(RIT_IRQn);
+    }
+
+    // Nada desaloja al grupo reservado: el tiempo de la sonda se descuenta entero del handler interrumpido.
+    if (Depth > 0 && Depth <= ISR_PROFILE_DEPTH)
+    {
+        Stack[Depth - 1].Nested += DWT_CYCCNT - start;
+    }
+}
+
+/**
+ * @brief Atencion de la sonda: la espera desde el disparo es la latencia del handler sondeado.
+ */
+void RIT_IRQHandler(void)
+{
+    ISR_PROFILE_Latency((ISR_PROFILE_Id_Type)Probe_Target, DWT_CYCCNT - Probe_Start);
+    Probe_Armed = FALSE;
+}
+
+#endif /* ISR_PROFILE */
@@ -0,0 +1,175 @@
+/**
+ * @file isr_profile.h
+ * @brief Medicion de la duracion y la latencia de las interrupciones con el contador de ciclos del DWT.
+ *
+ * Cada handler marca su entrada y su salida con ISR_PROFILE_ENTER()/ISR_PROFILE_EXIT(). Se acumulan, por handler,
+ * la cantidad de ejecuciones, la duracion minima, maxima y media en ciclos de CPU (sin contar el tiempo de las
+ * interrupciones que lo desalojaron), el maximo tiempo desalojado y un histograma logaritmico de duraciones.
+ * La peor latencia de respuesta de cada handler la mide una sonda: desde el grupo de prioridad reservado (ver
+ * irq_priority.h) genera, en instantes seudoaleatorios, un evento con la prioridad de cada handler por turnos y
+ * cuenta los ciclos hasta que se atiende. Las estadisticas se envian como texto por UART2 a pedido.
+ *
+ * Un banco de prueba mide la competencia por el bus entre la CPU y el GPDMA (ver ahbram.h): el mismo lazo sobre la
+ * SRAM local se cronometra sin trafico del GPDMA, con una copia continua entre buffers de la SRAM local y con la
+ * misma copia entre buffers de AHBRAM1. Tambien compara la conmutacion de un pin con el driver lpc17xx_gpio y con
+ * gpio_fast.h, y la configuracion de los pines del arranque con PINSEL_ConfigPin() y con la imagen de pin_map.h.
+ *
+ * Todo el modulo se compila solo si se define ISR_PROFILE (make ISR_PROFILE=1); si no, las macros quedan vacias
+ * y la imagen de produccion no tiene codigo, datos ni accesos al DWT de la instrumentacion.
+ */
+
+#ifndef ISR_PROFILE_H
+#define ISR_PROFILE_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define ISR_PROFILE_BUCKETS       8   /**< Cantidad de intervalos del histograma */
+#define ISR_PROFILE_FIRST_SHIFT   5   /**< El primer intervalo cuenta las duraciones menores a 2^5 ciclos */
+#define ISR_PROFILE_DEPTH         8   /**< Maximo anidamiento de handlers medidos */
+#define ISR_PROFILE_BENCH_CHANNEL 5   /**< Canal del GPDMA que genera el trafico del banco de prueba (libre) */
+#define ISR_PROFILE_BENCH_PASSES  16  /**< Pasadas del lazo del banco de prueba sobre su arreglo */
+#define ISR_PROFILE_BENCH_TOGGLES 64  /**< Pulsos del banco de prueba del GPIO con cada metodo */
+#define ISR_PROFILE_BENCH_PORT    2   /**< Puerto del pin que conmuta el banco de prueba (P2.3, LED 4 de main.c) */
+#define ISR_PROFILE_BENCH_PIN     3   /**< Pin que conmuta el banco de prueba */
+#define ISR_PROFILE_DUMP_CMD      'P' /**< Byte recibido por UART2 que pide el envio de las estadisticas */
+#define ISR_PROFILE_RESET_CMD     'Z' /**< Byte recibido por UART2 que borra las estadisticas */
+#define ISR_PROFILE_BENCH_CMD     'K' /**< Byte recibido por UART2 que corre los bancos de prueba */
+
+/**
+ * @brief Handlers medidos.
+ */
+typedef enum
+{
+    ISR_PROFILE_EINT3,  /**< EINT3_IRQHandler */
+    ISR_PROFILE_TIMER2, /**< TIMER2_IRQHandler */
+    ISR_PROFILE_UART2,  /**< UART2_IRQHandler */
+    ISR_PROFILE_DMA,    /**< DMA_IRQHandler */
+    ISR_PROFILE_FILTER, /**< Etapa de filtros del ADC (anidada en DMA_IRQHandler, que no la cuenta) */
+    ISR_PROFILE_COUNT   /**< Cantidad de handlers medidos */
+} ISR_PROFILE_Id_Type;
+
+/**
+ * @brief Estadisticas de un handler, en ciclos de CPU.
+ */
+typedef struct
+{
+    uint32_t Count;                          /**< Ejecuciones medidas */
+    uint32_t Min;                            /**< Duracion minima */
+    uint32_t Max;                            /**< Duracion maxima */
+    uint64_t Sum;                            /**< Suma de las duraciones (para la media) */
+    uint32_t Preempted_Max;                  /**< Maximo tiempo desalojado por otros handlers */
+    uint32_t Latency_Max;                    /**< Maxima latencia de entrada registrada */
+    uint16_t Histogram[ISR_PROFILE_BUCKETS]; /**< Duraciones por intervalo (saturan en 0xFFFF) */
+} ISR_PROFILE_Stats_Type;
+
+#ifdef ISR_PROFILE
+
+/**
+ * @brief Habilita el contador de ciclos del DWT, borra las estadisticas y arranca la sonda de latencia.
+ *
+ * La sonda ocupa el TIMER3 y la interrupcion del RIT. Debe llamarse despues de IRQ_PRIO_Init() y antes de
+ * habilitar las interrupciones medidas.
+ */
+void ISR_PROFILE_Init(void);
+
+/**
+ * @brief Marca la entrada a un handler. Debe ser lo primero que ejecuta el handler.
+ *
+ * @param id Handler medido.
+ */
+void ISR_PROFILE_Enter(ISR_PROFILE_Id_Type id);
+
+/**
+ * @brief Marca la salida de un handler y acumula su duracion. Debe ser lo ultimo que ejecuta el handler.
+ *
+ * @param id Handler medido (el mismo de ISR_PROFILE_Enter).
+ */
+void ISR_PROFILE_Exit(ISR_PROFILE_Id_Type id);
+
+/**
+ * @brief Registra la latencia de entrada de un handler, cuando el periferico permite conocerla (ademas de la sonda).
+ *
+ * @param id Handler medido.
+ * @param cycles Ciclos de CPU entre el evento del periferico y la entrada al handler.
+ */
+void ISR_PROFILE_Latency(ISR_PROFILE_Id_Type id, uint32_t cycles);
+
+/**
+ * @brief Copia las estadisticas de un handler.
+ *
+ * @param id Handler medido.
+ * @param stats Donde se copian las estadisticas.
+ */
+void ISR_PROFILE_GetStats(ISR_PROFILE_Id_Type id, ISR_PROFILE_Stats_Type* stats);
+
+/**
+ * @brief Borra las estadisticas de todos los handlers.
+ */
+void ISR_PROFILE_Reset(void);
+
+/**
+ * @brief Comienza el envio de las estadisticas por UART2.
+ *
+ * Solo toma una copia de la tabla; las lineas se encolan en el buffer de transmision con ISR_PROFILE_Poll().
+ */
+void ISR_PROFILE_Dump(void);
+
+/**
+ * @brief Encola las lineas pendientes del envio en curso mientras entren en el buffer de transmision del UART2.
+ *
+ * Debe llamarse periodicamente desde el bucle principal.
+ */
+void ISR_PROFILE_Poll(void);
+
+/**
+ * @brief Corre los bancos de prueba y envia los resultados por UART2, con las interrupciones deshabilitadas.
+ *
+ * - Bus: cronometra ISR_PROFILE_BENCH_PASSES pasadas de lectura y escritura sobre un arreglo de la SRAM local tres
+ *   veces: sin trafico del GPDMA y con el canal ISR_PROFILE_BENCH_CHANNEL copiando en anillo, primero entre buffers
+ *   de la SRAM local y despues entre buffers de AHBRAM1. Linea: "BENCH idle=<> sram=<> ahb=<>\r\n".
+ * - GPIO: cronometra ISR_PROFILE_BENCH_TOGGLES pulsos del pin de prueba con un lazo vacio, con GPIO_SetValue() y
+ *   GPIO_ClearValue(), con GPIO_FAST_Set() y GPIO_FAST_Clear() y con GPIO_FAST_Write() (bit-band). El pin vuelve a
+ *   su nivel anterior. Linea: "GPIO n=<pulsos> loop=<> driver=<> fast=<> bitband=<>\r\n".
+ * - Pines: envia lo medido en el arranque por ISR_PROFILE_Pins(). Linea: "PINS calls=<> image=<> match=<>\r\n",
+ *   o "PINS calls=<>\r\n" si no se compilo la imagen (make PIN_MAP=1).
+ *
+ * Todos los tiempos son en ciclos de CPU. Bloquea la CPU unos pocos milisegundos.
+ */
+void ISR_PROFILE_Bench(void);
+
+/**
+ * @brief Configura los pines del arranque cronometrando cada configuracion, con las interrupciones deshabilitadas.
+ *
+ * Corre calls y, si image no es NULL, vuelve PINSEL0..9, PINMODE0..9 y PINMODE_OD0..4 a los valores que tenian,
+ * corre image (que queda como configuracion final) y compara los registros que dejan las dos: match es 1 si son
+ * iguales. Los resultados los envia ISR_PROFILE_Bench(). Debe llamarse despues de ISR_PROFILE_Init().
+ *
+ * @param calls Configuracion con una llamada a PINSEL_ConfigPin() por pin.
+ * @param image Configuracion con la imagen precalculada (PIN_MAP_APPLY de pin_map.h), o NULL.
+ */
+void ISR_PROFILE_Pins(void (*calls)(void), void (*image)(void));
+
+#define ISR_PROFILE_INIT()              ISR_PROFILE_Init()              /**< Inicializacion */
+#define ISR_PROFILE_ENTER(id)           ISR_PROFILE_Enter(id)           /**< Entrada a un handler */
+#define ISR_PROFILE_EXIT(id)            ISR_PROFILE_Exit(id)            /**< Salida de un handler */
+#define ISR_PROFILE_LATENCY(id, cycles) ISR_PROFILE_Latency(id, cycles) /**< Latencia de entrada */
+#define ISR_PROFILE_DUMP()              ISR_PROFILE_Dump()              /**< Pedido de envio */
+#define ISR_PROFILE_RESET()             ISR_PROFILE_Reset()             /**< Borrado de las estadisticas */
+#define ISR_PROFILE_POLL()              ISR_PROFILE_Poll()              /**< Envio de lineas pendientes */
+#define ISR_PROFILE_BENCH()             ISR_PROFILE_Bench()             /**< Banco de prueba del bus */
+
+#else
+
+#define ISR_PROFILE_INIT()              ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_ENTER(id)           ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_EXIT(id)            ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_LATENCY(id, cycles) ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_DUMP()              ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_RESET()             ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_POLL()              ((void)0) /**< Sin instrumentacion */
+#define ISR_PROFILE_BENCH()             ((void)0) /**< Sin instrumentacion */
+
+#endif /* ISR_PROFILE */
+
+#endif /* ISR_PROFILE_H */
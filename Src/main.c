@@ -14,6 +14,10 @@
 #endif
 
 // Librerias:
+#include "adc_pipeline.h"
+#include "alarm.h"
+#include "calibration.h"
+#include "dac_wave.h"
 #include "lpc17xx_adc.h"
 #include "lpc17xx_dac.h"
 #include "lpc17xx_exti.h"
@@ -21,47 +25,69 @@
 #include "lpc17xx_gpio.h"
 #include "lpc17xx_nvic.h"
 #include "lpc17xx_pinsel.h"
-#include "lpc17xx_pwm.h"
-#include "lpc17xx_systick.h"
 #include "lpc17xx_timer.h"
 #include "lpc17xx_uart.h"
 #include "stdio.h"
+#include "event_queue.h"
+#include "gpio_fast.h"
+#include "irq_priority.h"
+#include "isr_profile.h"
+#include "motor.h"
+#include "pin_map.h"
+#include "ramfunc.h"
+#include "scheduler.h"
+#include "sensor_channels.h"
+#include "sensor_tables.h"
+#include "step_engine.h"
 #include "system_LPC17xx.h"
+#include "table_config.h"
+#include "telemetry.h"
+#include "uart_dma.h"
+#include "uart_ring.h"
 
 // Definicionde de pines:
-#define LED_CONTROL_1  ((uint32_t)(1 << 0))  /**< P2.00 LED 1 PARA CONTROL DE SYSTICK */
-#define PIN_PWM        ((uint32_t)(1 << 1))  /**< P2.01 SALIDA PWM CANAL 2 */
-#define LED_CONTROL_3  ((uint32_t)(1 << 2))  /**< P2.02 LED 3 PARA CONTROL DEL TIMER 0 */
-#define LED_CONTROL_4  ((uint32_t)(1 << 3))  /**< P2.03 LED 4 PARA CONTROL DEL UART2 */
-#define LED_CONTROL_5  ((uint32_t)(1 << 4))  /**< P2.04 LED 5 PARA CONTROL DE LA VENTILACION */
+#define LED_PORT       PINSEL_PORT_2         /**< PUERTO DE LOS LEDS Y DE LA DIRRECCION DEL MOTOR */
+#define LED_CONTROL_1  0                     /**< P2.00 LED 1 PARA CONTROL DEL DAC */
+#define LED_CONTROL_3  2                     /**< P2.02 LED 3 PARA CONTROL DE LA TELEMETRIA */
+#define LED_CONTROL_4  3                     /**< P2.03 LED 4 PARA CONTROL DEL UART2 */
+#define LED_CONTROL_5  4                     /**< P2.04 LED 5 PARA CONTROL DE LA VENTILACION */
 #define PIN_BOTON      ((uint32_t)(1 << 13)) /**< P2.10 BOTON */
-#define PIN_ADC_C0     ((uint32_t)(1 << 23)) /**< P0.23 ADC CANAL 0 */
-#define PIN_ADC_C1     ((uint32_t)(1 << 24)) /**< P0.24 ADC CANAL 1 */
-#define PIN_ADC_C2     ((uint32_t)(1 << 25)) /**< P0.25 ADC CANAL 2 */
 #define PIN_DAC        ((uint32_t)(1 << 26)) /**< P0.26 DAC */
-#define PIN_DIRRECCION ((uint32_t)(1 << 5))  /**< P2.05 OIN DIRRECCION MOTOR */
+#define PIN_DIRRECCION 5                     /**< P2.05 OIN DIRRECCION MOTOR */
 
-// Definiciones Systick:
-#define SYSTICK_TIME 100 /**< Tiempo del Systick en ms */
+/** Máscara de los LEDs de control en LED_PORT */
+#define LED_MASK ((1UL << LED_CONTROL_1) | (1UL << LED_CONTROL_3) | (1UL << LED_CONTROL_4) | (1UL << LED_CONTROL_5))
 
-// Definiciones Timer:
-#define TIMER0_PRESCALE_VALUE 100   /**< Valor del prescaler del timer en us */
-#define TIMER0_MATCH0_VALUE   20000 /**< Valor del match 0 del timer en cantidad de veces */
+// Definiciones de las tareas periódicas (planificador sobre el match 0 del TIMER2, ver scheduler.h):
+#define TASK_DAC       0 /**< Rampa del DAC y LED 1 */
+#define TASK_MEASURE   1 /**< Mediciones y alarmas */
+#define TASK_TELEMETRY 2 /**< Trama de telemetría y LED 3 */
+
+#define DAC_PERIOD_MS         100  /**< Periodo de la tarea del DAC */
+#define DAC_DEADLINE_MS       20   /**< Plazo de la tarea del DAC */
+#define MEASURE_DEADLINE_MS   100  /**< Plazo de la tarea de mediciones */
+#define TELEMETRY_DEADLINE_MS 100  /**< Plazo de la tarea de telemetría */
+#define MEASURE_RATE_CMD      'M'  /**< Byte recibido por UART2 que pasa al siguiente periodo de mediciones */
+#define TELEMETRY_RATE_CMD    'T'  /**< Byte recibido por UART2 que pasa al siguiente periodo de telemetría */
+#define RATE_STEPS            4    /**< Periodos seleccionables de las mediciones y de la telemetría */
 
 // Definiciones ADC:
-#define ADC_FREQ 200000 /**< Valor de la frecuencia de conversion del ADC en Hz */
+#define ADC_FREQ       200000 /**< Valor de la frecuencia de conversion del ADC en Hz */
+#define ADC_MODE_CMD   'C'    /**< Byte recibido por UART2 que pasa al siguiente modo de conversión del ADC */
+#define ADC_MODE_STEPS 4      /**< Modos de conversión seleccionables (burst y disparo por MAT0.1) */
 
 // Definiciones DAC:
-#define DAC_FREQ 25000000 /**< Valor de la frecuencia de conversion del DAC en Hz */
+#define DAC_FREQ 1000 /**< Muestras por segundo que el GPDMA entrega al DAC (una rampa dura DAC_PERIOD_MS) */
 
 // Definiciones UART:
-#define UART_BAUDIOS 9600 /**< Valor de la velocidad de transmision de UART en BAUDIOS */
+#ifndef UART_BAUDIOS
+#define UART_BAUDIOS 9600 /**< Valor de la velocidad de transmision de UART en BAUDIOS (make UART_BAUD=<valor>) */
+#endif
 
-// Definiciones PWM:
-#define PWM_PRESC          100 /**< PWM valor de prescaler */
-#define PWM_MATCH_0_VALUE  10  /**< PWM valor del match 0 */
-#define PWM_MATCH_2_VALUE  5   /**< PWM valor del match 2 */
-#define PWM_PULSE_QUANTITY 49  /**< PWM catidad de ciclos */
+// Definiciones de la puerta (el pin de STEP es MAT1.0 en P1.22, ver step_engine.h):
+#define DOOR_SHAPE  (TABLE_MOTOR_SCURVE ? STEP_PROFILE_SCURVE : STEP_PROFILE_TRAPEZOID) /**< Forma de las rampas */
+#define DOOR_CLOSED 0                                                                 /**< Posicion cerrada, en pasos */
+#define DOOR_OPENED TABLE_MOTOR_STEPS                                                 /**< Posicion abierta, en pasos */
 
 // Definiciones de estados:
 #define ON    1 /**< Estado del led - prender */
@@ -70,91 +96,229 @@
 #define CLOSE 0 /**< Accion de puerta - Cerrar */
 
 // Definiciones de mediciones de alerta
-#define MAX_GAS_CONCENTRATION 50 /**< Limite de concentracion de gas */
-#define MAX_TEMPERATURE       50 /**< Limite de temperatura */
-#define MIN_TEMPERATURE       5  /**< Minimo de temperatura */
+#define MAX_GAS_CONCENTRATION 50 /**< Limite de concentracion de gas, en centenas de ppm */
+#define MAX_TEMPERATURE       50 /**< Limite de temperatura, en grados Celsius */
+#define MIN_TEMPERATURE       5  /**< Minimo de temperatura, en grados Celsius */
+#define GAS_HYSTERESIS        5  /**< Centenas de ppm bajo el limite para liberar la alarma de gas */
+#define TEMP_HYSTERESIS       2  /**< Grados entre cada limite de temperatura y la liberacion de su alarma */
+
+// Tiempos de las alarmas (independientes del periodo de las mediciones):
+#define ALARM_SET_DWELL_MS    4000  /**< Permanencia sobre un limite de temperatura */
+#define ALARM_CLEAR_DWELL_MS  6000  /**< Permanencia dentro de los limites para liberar */
+#define ALARM_MIN_INTERVAL_MS 30000 /**< Minimo entre accionamientos por temperatura */
 
 // Definiciones de alerta:
 #define WARNING 1 /**< Estado de advertencia */
 #define SAFE    0 /**< Estado seguro */
 
+// Definiciones de eventos:
+#define EVENT_SCHED 0 /**< Evento del planificador: hay tareas periodicas vencidas */
+#define EVENT_BOTON 1 /**< Evento de pulsacion del boton */
+#define EVENT_UART  2 /**< Evento de bytes recibidos por UART2 */
+#define EVENT_MOTOR 3 /**< Evento de fin de maniobra del motor */
+
 // Declaracion de variables:
-volatile uint32_t DAC_Value = 0;  /**< Valor que va a ser transferido por el DAC */
-volatile uint32_t ADC_Results[3]; /**< Valores obtenidos de las convversiones del ADC */
-volatile uint8_t Data[4];         /**< Arreglo para almacenar datos a enviar por UART */
-volatile uint8_t PWM_count = 0;   /**< Contador de pulsos de PWM */
-GPDMA_LLI_Type ADCList;           /**< Declaracion lista del GPDMA */
+volatile uint32_t DAC_Value = 0;                /**< Valor final de la última rampa del DAC */
+volatile uint8_t Data[SENSOR_MAX_CHANNELS + 1]; /**< Mediciones de SENSOR_Table y, al final, la ventilación */
+volatile uint32_t UART_count = 0;               /**< Contador de tramas enviadas por UART2 mediante DMA */
+uint8_t TELEMETRY_Sequence = 0;                 /**< Numero de secuencia de la proxima trama de telemetria */
+UART_BAUD_Config_Type UART_Baud;                /**< Divisores del UART2, velocidad obtenida y su error */
+
+/** Periodos seleccionables de las mediciones, en ms (el primero es el inicial) */
+const uint32_t MEASURE_Periods[RATE_STEPS] = {2000, 1000, 500, 250};
+
+/** Periodos seleccionables de la telemetría, en ms (el primero es el inicial) */
+const uint32_t TELEMETRY_Periods[RATE_STEPS] = {2000, 1000, 500, 5000};
+
+/** Rondas por segundo seleccionables del ADC con disparo por MAT0.1 (0 es el modo burst, el inicial) */
+const uint32_t ADC_Scan_Rates[ADC_MODE_STEPS] = {0, 4000, 1000, 250};
+
+uint8_t MEASURE_Rate = 0;   /**< Índice del periodo actual de las mediciones */
+uint8_t TELEMETRY_Rate = 0; /**< Índice del periodo actual de la telemetría */
+uint8_t ADC_Mode = 0;       /**< Índice del modo actual de conversión del ADC */
+
+/** Perfil de las maniobras de la ventilacion (Tick_Rate lo fija el generador de pasos) */
+const STEP_PROFILE_Config_Type DOOR_Profile = {
+    DOOR_SHAPE, TABLE_MOTOR_START_SPEED, TABLE_MOTOR_MAX_SPEED, TABLE_MOTOR_ACCEL, 0};
+
+/**
+ * Reglas de las alarmas de temperatura, en orden de prioridad: el frio cierra la ventilacion y el calor la abre
+ * recien despues de ALARM_SET_DWELL_MS. Al despejarse el calor la ventilacion vuelve a cerrarse.
+ */
+const ALARM_Rule_Type TEMP_Alarms[] = {
+    {0, ALARM_BELOW, MIN_TEMPERATURE, MIN_TEMPERATURE + TEMP_HYSTERESIS, ALARM_SET_DWELL_MS, ALARM_CLEAR_DWELL_MS,
+     ALARM_CLOSE, ALARM_NONE, FALSE},
+    {0, ALARM_ABOVE, MAX_TEMPERATURE, MAX_TEMPERATURE - TEMP_HYSTERESIS, ALARM_SET_DWELL_MS, ALARM_CLEAR_DWELL_MS,
+     ALARM_OPEN, ALARM_CLOSE, FALSE},
+};
+
+/**
+ * Regla de la alarma de gas: abre la ventilacion en la primera medicion sobre el limite, sin esperar el intervalo
+ * entre accionamientos (es inmediata, asi que tiene prioridad sobre las de temperatura), y la cierra al despejarse.
+ */
+const ALARM_Rule_Type GAS_Alarms[] = {
+    {0, ALARM_ABOVE, MAX_GAS_CONCENTRATION, MAX_GAS_CONCENTRATION - GAS_HYSTERESIS, 0, ALARM_CLEAR_DWELL_MS,
+     ALARM_OPEN, ALARM_CLOSE, TRUE},
+};
+
+/**
+ * Canales de sensores (ver sensor_channels.h). El orden es el de las mediciones en Data y en la trama de
+ * telemetría: los tres de la placa base son TELEMETRY_MEASURE_TEMP, _LIGHT y _GAS. Un sensor nuevo agrega su línea
+ * con la entrada del ADC, la curva de calibración y sus reglas; los pines, los canales del ADC, el bloque del
+ * GPDMA y la trama salen de esta tabla.
+ */
+const SENSOR_Channel_Type SENSOR_Table[] = {
+    {ADC_CHANNEL_0, PINSEL_PINMODE_PULLDOWN, CALIB_TEMPERATURE, SENSOR_SMOOTHED, TEMP_Alarms,
+     sizeof(TEMP_Alarms) / sizeof(TEMP_Alarms[0])}, // LM35 en P0.23
+    {ADC_CHANNEL_1, PINSEL_PINMODE_PULLDOWN, CALIB_LIGHT, SENSOR_SMOOTHED, NULL, 0}, // LDR en P0.24
+    {ADC_CHANNEL_2, PINSEL_PINMODE_PULLDOWN, CALIB_GAS, SENSOR_SMOOTHED, GAS_Alarms,
+     sizeof(GAS_Alarms) / sizeof(GAS_Alarms[0])}, // MQ-2 en P0.25
+};
+
+/**
+ * Prioridades de las interrupciones (grupo, subprioridad; el grupo 0 es de la instrumentación, ver irq_priority.h).
+ * El GPDMA desaloja a todos: el bloque del ADC tiene que atenderse antes de que se llene el otro y el fin de trama
+ * o de maniobra libera el canal. Le sigue la recepción del UART2, con 16 bytes de FIFO. El TIMER2 solo publica el
+ * vencimiento del planificador. El EINT3 es por nivel y se repite mientras el botón está apretado: va en el último
+ * grupo para no tapar a nadie.
+ */
+const IRQ_PRIO_Entry_Type IRQ_Priorities[] = {
+    {DMA_IRQn, 1, 0},
+    {UART2_IRQn, 2, 0},
+    {TIMER2_IRQn, 3, 0},
+    {EINT3_IRQn, 4, 0},
+};
 
 // Declaracion de banderas:
 volatile uint8_t DOOR_Flag = 0;          /**< Bandera de la ventilacion */
-volatile uint8_t SYSTICK_Flag = 0;       /**< Bandera del SYSTICK */
-volatile uint8_t TIMER0_Flag = 0;        /**< Bandera del TIMER 0 */
+volatile uint8_t DAC_Flag = 0;           /**< Bandera del LED de la tarea del DAC */
+volatile uint8_t TELEMETRY_Flag = 0;     /**< Bandera del LED de la tarea de telemetría */
 volatile uint8_t ADC_Flag = 0;           /**< Bandera del ADC */
 volatile uint8_t UART_Flag = 0;          /**< Bandera del UART2 */
 volatile uint8_t WARNING_Open_Flag = 0;  /**< Bandera de apertura de ventilacion */
 volatile uint8_t WARNING_Close_Flag = 0; /**< Bandera de cierre de ventilacion */
 
 // Declaración de funciones de configuración de los periféricos y control
-void Config_GPIO();                                 // Configuración de GPIO
-void Config_EINT();                                 // Configuración de interrupciones externas
-void Config_PWM();                                  // Configuración del PWM
-void Config_SYSTICK();                              // Configuración del Systick
-void Config_TIMER0();                               // Configuración del Timer 0
-void Config_ADC();                                  // Configuración del ADC
-void Config_DAC();                                  // Configuración del DAC
-void Config_UART();                                 // Configuración del UART
-void Config_GPDMA();                                // Configuración del GPDMA (DMA de datos)
-void Led_Control(uint8_t estado, uint32_t PIN_led); // Función para controlar los LEDs
-void Motor_Activate(uint8_t action);                // Función para activar el motor (abrir/cerrar puerta)
-void Check_Measures();                              // Función para verificar las mediciones y condiciones de alerta
+void Config_NVIC();                  // Configuración de las prioridades de las interrupciones
+void Config_PINS();                  // Configuración de los pines de todos los periféricos
+void Config_PINSEL();                // Configuración de los pines con PINSEL_ConfigPin()
+void Config_GPIO();                  // Configuración de GPIO
+void Config_EINT();                  // Configuración de interrupciones externas
+void Config_SCHED();                 // Configuración del planificador de tareas (TIMER2)
+void Config_ADC();                   // Configuración del ADC
+void Config_DAC();                   // Configuración del DAC
+void Config_UART();                  // Configuración del UART
+void Config_GPDMA();                 // Configuración del GPDMA (DMA de datos)
+void Config_MOTOR();                 // Configuración del control de posición del motor
+void Config_SENSOR();                // Configuración de la tabla de sensores
+void Config_ALARM();                 // Configuración de las reglas de alarma
+void Config_EVENT();                 // Configuración de la cola de eventos
+void Motor_Activate(uint8_t action); // Función para activar el motor (abrir/cerrar puerta)
+void Check_Measures();               // Función para verificar las mediciones y condiciones de alerta
+void UART_Frame_Sent();              // Callback de fin de envio de trama por DMA
+void MOTOR_Move_Done();              // Callback de fin de maniobra del motor
+void SCHED_Wakeup();                 // Callback de vencimiento del planificador
+void DAC_Task();                     // Tarea periódica del DAC
+void MEASURE_Task();                 // Tarea periódica de mediciones y alarmas
+void TELEMETRY_Task();               // Tarea periódica de telemetría
+void BOTON_Task();                   // Tarea del evento del boton
+void MOTOR_Task();                   // Tarea del evento de fin de maniobra
+void UART_Task();                    // Tarea del evento de recepcion del UART2
 
 /**
  * @brief Funcion principal.
  *
- * Llama a la configuracion de perifericos y ejecucion continua.
+ * Llama a la configuracion de perifericos y ejecucion continua. Las interrupciones publican eventos
+ * y el bucle principal los despacha; cuando no hay eventos pendientes el nucleo duerme hasta la
+ * siguiente interrupcion.
  */
 int main(void)
 {
     SystemInit(); // Inicialización del sistema (frecuencia del reloj y demás configuraciones)
 
+    // Prioridades de las interrupciones (antes de habilitar cualquiera)
+    Config_NVIC();
+
+    // Instrumentación de las interrupciones (vacía si no se compila con ISR_PROFILE)
+    ISR_PROFILE_INIT();
+
+    // Configuración de la cola de eventos (antes de habilitar interrupciones)
+    Config_EVENT();
+
+    // Configuración de la tabla de sensores (antes de las alarmas, del ADC y del GPDMA, que salen de ella)
+    Config_SENSOR();
+
+    // Configuración de las reglas de alarma (antes del primer chequeo de las mediciones)
+    Config_ALARM();
+
+    // Configuración de los pines (después de la tabla de sensores, que define los del ADC)
+    Config_PINS();
+
     // Configuración de periféricos
     Config_GPIO();    // Configura los pines GPIO
     Config_EINT();    // Configura las interrupciones externas
     Config_ADC();     // Configura el ADC
     Config_DAC();     // Configura el DAC
     Config_UART();    // Configura la UART
-    Config_SYSTICK(); // Configura el Systick
-    Config_TIMER0();  // Configura el Timer 0
+    Config_SCHED();   // Configura el planificador de tareas sobre el Timer 2
 
     // Apagar los LEDs de control al inicio
-    Led_Control(OFF, LED_CONTROL_1);
-    Led_Control(OFF, LED_CONTROL_3);
-    Led_Control(OFF, LED_CONTROL_4);
-    Led_Control(OFF, LED_CONTROL_5);
+    GPIO_FAST_Clear(GPIO_FAST_PORT(LED_PORT), LED_MASK);
 
-    // Habilitar el Timer 0 y Systick para su ejecución
-    TIM_Cmd(LPC_TIM0, ENABLE);
-    SYSTICK_Cmd(ENABLE);
+    // Arrancar el planificador (su TIMER2 es también la base de tiempo de la carga del núcleo)
+    SCHED_Start();
 
     // Configurar el GPDMA (DMA para ADC)
     Config_GPDMA();
 
-    // Bucle principal: ejecuta el sistema de forma continua
+    // Configurar el generador de pasos del motor (usa un canal del GPDMA)
+    Config_MOTOR();
+
+    // Bucle principal: despacha los eventos pendientes y duerme hasta la siguiente interrupción
     while (TRUE)
     {
+        EVENT_Dispatch();
+        EVENT_Sleep();
     }
 
     return 0;
 }
 
 /**
- * @brief Configura los pines GPIO para los LEDs y la dirección del motor.
+ * @brief Configura el agrupamiento y las prioridades de las interrupciones.
  *
- * Configura los pines del puerto 2 para el control de los LEDs y la señal de dirección
- * del motor como salidas. Establece la configuración del PINSEL para seleccionar el
- * modo adecuado de los pines.
+ * Las prioridades viven en IRQ_Priorities: un handler nuevo solo agrega su línea a esa tabla.
  */
-void Config_GPIO(void)
+void Config_NVIC(void)
+{
+    IRQ_PRIO_Init(IRQ_Priorities, sizeof(IRQ_Priorities) / sizeof(IRQ_Priorities[0]));
+}
+
+/**
+ * @brief Configura los pines de todos los periféricos.
+ *
+ * Por defecto llama a Config_PINSEL(). Con PIN_MAP escribe la imagen precalculada de pin_map.cpp, con una lectura y
+ * una escritura por registro en lugar de las de cada pin. Con ISR_PROFILE corre las dos (si la imagen existe) y
+ * cronometra cada una; el resultado se envía con ISR_PROFILE_BENCH_CMD.
+ */
+void Config_PINS(void)
+{
+#if defined(ISR_PROFILE)
+    ISR_PROFILE_Pins(Config_PINSEL, PIN_MAP_APPLY);
+#elif defined(PIN_MAP)
+    PIN_MAP_Apply();
+#else
+    Config_PINSEL();
+#endif
+}
+
+/**
+ * @brief Configura los pines de todos los periféricos con una llamada a PINSEL_ConfigPin() por pin.
+ *
+ * Selecciona la función de GPIO para los LEDs y la dirección del motor, EINT3 para el botón, las entradas del ADC
+ * de SENSOR_Table, la salida del DAC, los pines del UART2 y MAT1.0 para el STEP del motor.
+ */
+void Config_PINSEL(void)
 {
     PINSEL_CFG_Type Pincfg;
 
@@ -184,30 +348,61 @@ void Config_GPIO(void)
     Pincfg.Pinnum = PINSEL_PIN_5;
     PINSEL_ConfigPin(&Pincfg);
 
+    // Configuración PINSEL para la interrupción externa en P2.10 (función 1 = EINT3):
+    Pincfg.Portnum = PINSEL_PORT_2;
+    Pincfg.Pinnum = PINSEL_PIN_13;
+    Pincfg.Funcnum = PINSEL_FUNC_1;
+    Pincfg.Pinmode = PINSEL_PINMODE_PULLUP;
+    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+    PINSEL_ConfigPin(&Pincfg);
+
+    // Configuración de los pines de los canales del ADC (función y resistencia de cada entrada de la tabla):
+    SENSOR_ConfigPins();
+
+    // Configuración del PINSEL para el DAC (P0.26, función 2):
+    Pincfg.Portnum = PINSEL_PORT_0;
+    Pincfg.Pinnum = PINSEL_PIN_26;
+    Pincfg.Funcnum = PINSEL_FUNC_2;
+    Pincfg.Pinmode = PINSEL_PINMODE_PULLDOWN;
+    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+    PINSEL_ConfigPin(&Pincfg);
+
+    // Configuración de los pines de UART2 (P0.10, P0.11):
+    Pincfg.Portnum = PINSEL_PORT_0;
+    Pincfg.Pinnum = PINSEL_PIN_10;
+    Pincfg.Funcnum = PINSEL_FUNC_1;
+    Pincfg.Pinmode = PINSEL_PINMODE_PULLDOWN;
+    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+    PINSEL_ConfigPin(&Pincfg);
+
+    Pincfg.Pinnum = PINSEL_PIN_11;
+    PINSEL_ConfigPin(&Pincfg);
+
+    // Pin de STEP del motor (P1.22, MAT1.0):
+    STEP_ENGINE_ConfigPin();
+}
+
+/**
+ * @brief Configura los pines GPIO para los LEDs y la dirección del motor.
+ *
+ * Configura los pines del puerto 2 para el control de los LEDs y la señal de dirección
+ * del motor como salidas (el PINSEL lo configura Config_PINS()).
+ */
+void Config_GPIO(void)
+{
     // Configuración GPIO para los LEDs y la salida de dirección del motor:
-    GPIO_SetDir(
-        PINSEL_PORT_2, LED_CONTROL_1 | LED_CONTROL_3 | LED_CONTROL_4 | LED_CONTROL_5 | PIN_DIRRECCION, GPIO_DIR_OUTPUT);
+    GPIO_SetDir(LED_PORT, LED_MASK | (1UL << PIN_DIRRECCION), GPIO_DIR_OUTPUT);
 }
 
 /**
  * @brief Configura la interrupción externa para el botón (P2.10).
  *
  * Configura el pin 2.10 para generar una interrupción externa por flanco ascendente
- * cuando se presiona el botón. Además, se configuran los pines para la interrupción
- * y se inicializa el NVIC para manejarla.
+ * cuando se presiona el botón (el PINSEL lo configura Config_PINS()) y se inicializa
+ * el NVIC para manejarla.
  */
 void Config_EINT(void)
 {
-    PINSEL_CFG_Type Pincfg;
-
-    // Configuración PINSEL para la interrupción externa en P2.10 (función 1 = EINT3):
-    Pincfg.Portnum = PINSEL_PORT_2;
-    Pincfg.Pinnum = PINSEL_PIN_13;
-    Pincfg.Funcnum = PINSEL_FUNC_1;
-    Pincfg.Pinmode = PINSEL_PINMODE_PULLUP;
-    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
-    PINSEL_ConfigPin(&Pincfg);
-
     // Configuramos el pin como entrada:
     GPIO_SetDir(PINSEL_PORT_0, PIN_BOTON, GPIO_DIR_INPUT);
 
@@ -229,94 +424,44 @@ void Config_EINT(void)
 }
 
 /**
- * @brief Configura el temporizador SYSTICK.
+ * @brief Configura el planificador de tareas periódicas sobre el TIMER2.
  *
- * Esta función inicializa el temporizador SYSTICK con un período de tiempo
- * predefinido, habilita la interrupción del SYSTICK para generar interrupciones
- * periódicas según el valor definido.
+ * El TIMER2 cuenta microsegundos y el match 0 del TIMER2 se reprograma con el próximo vencimiento (sin tick fijo).
+ * Cada tarea tiene su periodo y su plazo; los de las mediciones y la telemetría se cambian en ejecución con
+ * MEASURE_RATE_CMD y TELEMETRY_RATE_CMD. A igual vencimiento corre antes la de menor identificador, así que las
+ * mediciones se actualizan antes de armar la trama.
  */
-void Config_SYSTICK(void)
+void Config_SCHED(void)
 {
-
-    // Inicializa el SYSTICK con el valor de tiempo especificado (en ms)
-    SYSTICK_InternalInit(SYSTICK_TIME);
-
-    // Habilita las interrupciones del SYSTICK, lo que permitirá que se ejecute la rutina de interrupción cuando el
-    // temporizador se agote.
-    SYSTICK_IntCmd(ENABLE);
+    SCHED_Init(SCHED_Wakeup);
+    SCHED_Register(TASK_DAC, "DAC", DAC_Task, DAC_PERIOD_MS, DAC_DEADLINE_MS);
+    SCHED_Register(TASK_MEASURE, "MEASURE", MEASURE_Task, MEASURE_Periods[MEASURE_Rate], MEASURE_DEADLINE_MS);
+    SCHED_Register(TASK_TELEMETRY, "TELEMETRY", TELEMETRY_Task, TELEMETRY_Periods[TELEMETRY_Rate],
+                   TELEMETRY_DEADLINE_MS);
 }
 
 /**
- * @brief Configura el Timer 0 del LPC1769.
+ * @brief Configura el ADC para leer los canales de SENSOR_Table.
  *
- * Esta función configura el Timer 0 para que funcione con un prescaler dado
- * y un valor de match0, lo que generará una interrupción cuando el temporizador
- * alcance el valor especificado. Además, habilita la interrupción de Timer 0
- * en el NVIC.
- */
-void Config_TIMER0(void)
-{
-
-    // Configuración del Timer 0
-    TIM_TIMERCFG_Type TIM0;
-
-    TIM0.PrescaleOption =
-        TIM_PRESCALE_USVAL; // Se configura el prescaler del Timer 0 para que el conteo se realice en microsegundos
-    TIM0.PrescaleValue = TIMER0_PRESCALE_VALUE; // El valor del prescaler se toma de una constante predefinida
-    TIM_Init(LPC_TIM0, TIM_TIMER_MODE, &TIM0);  // Inicializa el Timer 0 en modo de temporizador
-
-    // Configuración de la coincidencia (match) del Timer 0
-    TIM_MATCHCFG_Type Match0;
-
-    Match0.MatchChannel = 0;      // Se configura el canal de match en el canal 0
-    Match0.IntOnMatch = ENABLE;   // Se habilita la interrupción cuando el contador del Timer alcance el valor de match
-    Match0.ResetOnMatch = ENABLE; // Se reinicia el temporizador cuando se alcanza el valor de match
-    Match0.ExtMatchOutputType =
-        TIM_EXTMATCH_NOTHING;     // No se genera una salida de coincidencia (no se conecta a un pin de salida)
-    Match0.StopOnMatch = DISABLE; // El temporizador no se detendrá automáticamente al alcanzar el valor de match
-    Match0.MatchValue = TIMER0_MATCH0_VALUE; // Se establece el valor de match en una constante predefinida (el valor
-                                             // con el que el temporizador genera una interrupción)
-
-    // Configura el match del Timer 0 con los parámetros definidos
-    TIM_ConfigMatch(LPC_TIM0, &Match0);
-
-    // Habilita la interrupción del Timer 0 en el NVIC (manejador de interrupciones)
-    NVIC_EnableIRQ(TIMER0_IRQn);
-}
-
-/**
- * @brief Configura el ADC para leer los canales 0, 1 y 2.
- *
- * Configura los pines de los canales del ADC, habilita los canales, y configura el ADC
+ * Habilita los canales del ADC (sus pines los configura Config_PINS()) y configura el ADC
  * para operar con una frecuencia especificada. Se habilitan las interrupciones y se configura
- * el modo de conversión en burst.
+ * el modo de conversión en burst (el inicial; ADC_MODE_CMD pasa al disparo periódico por MAT0.1).
  */
 void Config_ADC(void)
 {
-    // Configuración de los pines para los canales del ADC (función 1):
-    PINSEL_CFG_Type Pincfg;
-    Pincfg.Portnum = PINSEL_PORT_0;
-    Pincfg.Funcnum = PINSEL_FUNC_1;
-    Pincfg.Pinmode = PINSEL_PINMODE_PULLDOWN;
-    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
-
-    // Configuración de los pines para los canales 0, 1 y 2:
-    Pincfg.Pinnum = PINSEL_PIN_23; // Canal 0
-    PINSEL_ConfigPin(&Pincfg);
-
-    Pincfg.Pinnum = PINSEL_PIN_24; // Canal 1
-    PINSEL_ConfigPin(&Pincfg);
-
-    Pincfg.Pinnum = PINSEL_PIN_25; // Canal 2
-    PINSEL_ConfigPin(&Pincfg);
+    uint8_t mask = SENSOR_GetMask();
 
     // Inicialización del ADC con la frecuencia especificada:
     ADC_Init(LPC_ADC, ADC_FREQ);
 
-    // Habilitación de los canales del ADC:
-    ADC_ChannelCmd(LPC_ADC, ADC_CHANNEL_0, ENABLE);
-    ADC_ChannelCmd(LPC_ADC, ADC_CHANNEL_1, ENABLE);
-    ADC_ChannelCmd(LPC_ADC, ADC_CHANNEL_2, ENABLE);
+    // Habilitación de los canales del ADC (en burst se convierten todos en ronda, a ADC_FREQ por conversión):
+    for (uint8_t ch = 0; ch < SENSOR_MAX_CHANNELS; ch++)
+    {
+        if (mask & (1 << ch))
+        {
+            ADC_ChannelCmd(LPC_ADC, ch, ENABLE);
+        }
+    }
 
     // Habilitación de las interrupciones del ADC:
     ADC_IntConfig(LPC_ADC, ADC_ADGINTEN, ENABLE);
@@ -328,20 +473,11 @@ void Config_ADC(void)
 /**
  * @brief Configura el DAC para la salida de señal analógica.
  *
- * Configura el pin del DAC (P0.26), establece la corriente de salida a 700uA y
- * inicializa el DAC para la conversión digital-analógica.
+ * Establece la corriente de salida a 700uA e inicializa el DAC para la conversión
+ * digital-analógica. Su pin (P0.26) lo configura Config_PINS().
  */
 void Config_DAC(void)
 {
-    // Configuración del PINSEL para el DAC (P0.26, función 2):
-    PINSEL_CFG_Type Pincfg;
-    Pincfg.Portnum = PINSEL_PORT_0;
-    Pincfg.Pinnum = PINSEL_PIN_26;
-    Pincfg.Funcnum = PINSEL_FUNC_2;
-    Pincfg.Pinmode = PINSEL_PINMODE_PULLDOWN;
-    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
-    PINSEL_ConfigPin(&Pincfg);
-
     // Configuración de la corriente de salida del DAC (700uA):
     DAC_SetBias(LPC_DAC, DAC_MAX_CURRENT_700uA);
 
@@ -352,24 +488,12 @@ void Config_DAC(void)
 /**
  * @brief Configura el UART2 para la comunicación serial.
  *
- * Configura los pines de UART2 (P0.10 y P0.11) y la configuración del UART2
+ * Configura el UART2 (sus pines, P0.10 y P0.11, los configura Config_PINS())
  * con una tasa de baudios, bits de datos, paridad y bits de parada definidos.
- * Configura los buffers FIFO y habilita las interrupciones.
+ * Configura los buffers FIFO, los buffers circulares de transmisión y recepción y habilita las interrupciones.
  */
 void Config_UART(void)
 {
-    // Configuración de los pines de UART2 (P0.10, P0.11):
-    PINSEL_CFG_Type PinCfg;
-    PinCfg.Portnum = PINSEL_PORT_0;
-    PinCfg.Pinnum = PINSEL_PIN_10;
-    PinCfg.Funcnum = PINSEL_FUNC_1;
-    PinCfg.Pinmode = PINSEL_PINMODE_PULLDOWN;
-    PinCfg.OpenDrain = PINSEL_PINMODE_NORMAL;
-    PINSEL_ConfigPin(&PinCfg);
-
-    PinCfg.Pinnum = PINSEL_PIN_11;
-    PINSEL_ConfigPin(&PinCfg);
-
     // Configuración del UART2:
     UART_CFG_Type uart;
     uart.Baud_rate = UART_BAUDIOS;  // Configuración de la tasa de baudios
@@ -378,10 +502,13 @@ void Config_UART(void)
     uart.Stopbits = UART_STOPBIT_1; // 1 bit de parada
     UART_Init(LPC_UART2, &uart);
 
+    // Ajuste fino de la velocidad: divisores de menor error, cambiando la PCLK del UART2 si hace falta.
+    UART_Ring_SetBaud(UART_BAUDIOS, &UART_Baud);
+
     // Configuración de los FIFO de UART2:
     UART_FIFO_CFG_Type fifo;
-    fifo.FIFO_DMAMode = DISABLE;
-    fifo.FIFO_Level = UART_FIFO_TRGLEV0;
+    fifo.FIFO_DMAMode = ENABLE; // Las FIFOs generan pedidos de DMA para el envio de tramas
+    fifo.FIFO_Level = UART_FIFO_TRGLEV2; // Interrupción de recepción cada 8 caracteres (o por timeout)
     fifo.FIFO_ResetTxBuf = ENABLE;
     fifo.FIFO_ResetRxBuf = ENABLE;
     UART_FIFOConfig(LPC_UART2, &fifo);
@@ -392,176 +519,171 @@ void Config_UART(void)
     // Habilitación de interrupciones por THRE (transmisión completada):
     UART_IntConfig(LPC_UART2, UART_INTCFG_THRE, ENABLE);
 
+    // Buffers circulares de transmisión y recepción (habilita también la interrupción de recepción):
+    UART_Ring_Init();
+
     // Habilitación de la interrupción UART2 en el NVIC:
     NVIC_EnableIRQ(UART2_IRQn);
 }
 
 /**
- * @brief Configura el PWM para la señal de control.
+ * @brief Configura el control de posición del motor.
  *
- * Configura el pin de PWM (P2.1), inicializa el temporizador PWM, establece los valores de
- * los canales PWM y habilita las interrupciones para la actualización de los valores de PWM.
+ * El TIMER1 y el canal del GPDMA se configuran una sola vez; cada maniobra solo arma su tabla de intervalos
+ * y arranca (ver Motor_Activate). La puerta arranca cerrada (posición DOOR_CLOSED).
  */
-void Config_PWM(void)
+void Config_MOTOR(void)
 {
-    // Configuración del pin de PWM (P2.1, función 1):
-    PINSEL_CFG_Type PinCfg;
-    PinCfg.Portnum = PINSEL_PORT_2;
-    PinCfg.Pinnum = PINSEL_PIN_1;
-    PinCfg.Pinmode = PINSEL_PINMODE_TRISTATE;
-    PinCfg.Funcnum = PINSEL_FUNC_1;
-    PinCfg.OpenDrain = PINSEL_PINMODE_NORMAL;
-    PINSEL_ConfigPin(&PinCfg);
-
-    // Inicialización del PWM:
-    PWM_TIMERCFG_Type PwmCfg;
-    PwmCfg.PrescaleOption = PWM_TIMER_PRESCALE_USVAL; // Preescala en microsegundos
-    PwmCfg.PrescaleValue = PWM_PRESC;                 // Valor de prescaler
-    PWM_Init(LPC_PWM1, PWM_MODE_TIMER, (void*)&PwmCfg);
-
-    // Configuración de los matchs:
-    PWM_MATCHCFG_Type PwmMatch0;
-    PwmMatch0.IntOnMatch = ENABLE;   // Interrupción en coincidencia
-    PwmMatch0.MatchChannel = 0;      // Canal 0
-    PwmMatch0.ResetOnMatch = ENABLE; // Reset al alcanzar la coincidencia
-    PwmMatch0.StopOnMatch = DISABLE; // No detener el PWM al alcanzar la coincidencia
-    PWM_ConfigMatch(LPC_PWM1, &PwmMatch0);
-
-    PWM_MATCHCFG_Type PwmMatch2;
-    PwmMatch2.IntOnMatch = DISABLE;   // No interrupción en coincidencia
-    PwmMatch2.MatchChannel = 2;       // Canal 2
-    PwmMatch2.ResetOnMatch = DISABLE; // No reset al alcanzar la coincidencia
-    PwmMatch2.StopOnMatch = DISABLE;  // No detener el PWM
-    PWM_ConfigMatch(LPC_PWM1, &PwmMatch2);
-    PWM_ChannelCmd(LPC_PWM1, 2, ENABLE);
-
-    PWM_ChannelConfig(LPC_PWM1, 2, PWM_CHANNEL_SINGLE_EDGE);               // Configuración de canal de un solo borde
-    PWM_MatchUpdate(LPC_PWM1, 0, PWM_MATCH_0_VALUE, PWM_MATCH_UPDATE_NOW); // Actualización inmediata del valor
-    PWM_MatchUpdate(LPC_PWM1, 2, PWM_MATCH_2_VALUE, PWM_MATCH_UPDATE_NOW); // Actualización inmediata del valor
-    PWM_ResetCounter(LPC_PWM1);                                            // Reseteo del contador PWM
-    PWM_CounterCmd(LPC_PWM1, ENABLE);                                      // Habilitación del contador PWM
-    NVIC_EnableIRQ(PWM1_IRQn);                                             // Habilitación de la interrupción del PWM1
-    PWM_Cmd(LPC_PWM1, ENABLE);                                             // Habilitación del PWM
+    MOTOR_Init(&DOOR_Profile, GPIO_FAST_BIT(LED_PORT, PIN_DIRRECCION), MOTOR_Move_Done);
 }
 
 /**
- * @brief Configura el GPDMA para la transferencia de datos del ADC a un buffer en memoria.
+ * @brief Valida la tabla de sensores.
  *
- * Inicializa el GPDMA y configura una lista enlazada de interrupción (LLI) para realizar
- * la transferencia de los resultados del ADC (canales 0, 1 y 2) hacia la memoria. Además, configura
- * el canal DMA para transferir datos desde el ADC hacia un arreglo de resultados.
+ * Los canales viven en SENSOR_Table: agregar un sensor solo cambia esa tabla.
+ */
+void Config_SENSOR(void)
+{
+    SENSOR_Init(SENSOR_Table, sizeof(SENSOR_Table) / sizeof(SENSOR_Table[0]));
+}
+
+/**
+ * @brief Configura el motor de alarmas con las reglas de los canales de SENSOR_Table.
+ *
+ * Las reglas de cada sensor viven junto a su canal: agregar un sensor o una condición solo cambia esas tablas.
+ */
+void Config_ALARM(void)
+{
+    SENSOR_InitAlarms(ALARM_MIN_INTERVAL_MS);
+}
+
+/**
+ * @brief Configura el GPDMA para la adquisición del ADC y el envío de tramas por UART2.
+ *
+ * Inicializa el GPDMA y arma la adquisición del ADC (los canales de SENSOR_Table) sobre dos bloques
+ * ping-pong con sobremuestreo y decimación. Además, prepara el canal de envío de tramas por UART2 y el que
+ * alimenta al DAC.
  */
 void Config_GPDMA(void)
 {
     // Inicialización del GPDMA:
     GPDMA_Init();
 
-    // Configuración de la lista de enlaces (LLI) para la transferencia de datos:
-    ADCList.SrcAddr = (uint32_t) & (LPC_ADC->ADDR0); // Dirección de origen (registro ADDR0 del ADC)
-    ADCList.DstAddr = (uint32_t)&ADC_Results[0];     // Dirección de destino (buffer de resultados)
-    ADCList.NextLLI = (uint32_t)&ADCList;            // Apuntador al siguiente LLI (autocontinuación)
-    ADCList.Control = (3 << 0) | (2 << 18) | (2 << 21) | (1 << 26) | (1 << 27); // Control de transferencia
-
-    // Configuración del canal DMA:
-    GPDMA_Channel_CFG_Type DMAChannel0;
-    DMAChannel0.ChannelNum = 0;                             // Canal DMA 0
-    DMAChannel0.SrcMemAddr = (uint32_t) & (LPC_ADC->ADDR0); // Dirección de origen del ADC
-    DMAChannel0.DstMemAddr = (uint32_t)&ADC_Results[0];     // Dirección de destino (buffer de resultados)
-    DMAChannel0.TransferSize = 3;                           // Tamaño de la transferencia (3 canales del ADC)
-    DMAChannel0.TransferWidth = 0;                          // Ancho de datos (8 bits por defecto)
-    DMAChannel0.TransferType = GPDMA_TRANSFERTYPE_P2M;      // Tipo de transferencia (periférico a memoria)
-    DMAChannel0.SrcConn = GPDMA_CONN_ADC;                   // Conexión del origen (ADC)
-    DMAChannel0.DstConn = 0;                                // No se usa conexión para el destino
-    DMAChannel0.DMALLI = &ADCList;                          // Apunta a la lista de interrupciones (LLI)
-
-    // Configura el canal DMA con los parámetros definidos:
-    GPDMA_Setup(&DMAChannel0);
-
-    // Habilita el canal DMA 0:
-    GPDMA_ChannelCmd(0, ENABLE);
+    // Adquisición del ADC en bloques ping-pong (canal DMA 0):
+    ADC_PIPE_Init(SENSOR_GetMask());
+
+    // Preparación del canal DMA de transmisión del UART2:
+    UART_DMA_Init(UART_Frame_Sent);
+
+    // Salida del DAC por DMA al ritmo de su contador de timeout (canal DMA 2):
+    DAC_WAVE_Init(DAC_FREQ, DAC_Value);
+
+    // Habilitación de la interrupción del GPDMA en el NVIC:
+    NVIC_EnableIRQ(DMA_IRQn);
 }
 
 /**
- * @brief Controla el estado de un LED.
- *
- * Enciende o apaga el LED dependiendo del estado proporcionado.
+ * @brief Configura la cola de eventos del bucle principal.
  *
- * @param estado Estado del LED (ON o OFF).
- * @param PIN_led El pin específico para controlar el LED.
+ * Inicializa la cola y asocia cada evento publicado por las interrupciones con la tarea
+ * que lo atiende fuera del contexto de interrupción.
  */
-void Led_Control(uint8_t estado, uint32_t PIN_led)
+void Config_EVENT(void)
 {
-    if (estado == ON)
-    {
-        // Enciende el LED al ponerlo en alto:
-        GPIO_SetValue(PINSEL_PORT_2, PIN_led);
-    }
-    else
-    {
-        // Apaga el LED al ponerlo en bajo:
-        GPIO_ClearValue(PINSEL_PORT_2, PIN_led);
-    }
+    EVENT_Init();
+    EVENT_Register(EVENT_SCHED, SCHED_Dispatch);
+    EVENT_Register(EVENT_BOTON, BOTON_Task);
+    EVENT_Register(EVENT_UART, UART_Task);
+    EVENT_Register(EVENT_MOTOR, MOTOR_Task);
 }
 
 /**
  * @brief Activa el motor y gestiona el control de la puerta.
  *
- * Dependiendo de la acción (OPEN o CLOSE), activa el motor de acuerdo con las señales
- * de dirección y controla el LED de estado. También cambia el estado de la puerta.
+ * Dependiendo de la acción (OPEN o CLOSE), encola el destino de la puerta y controla el LED de estado.
+ * Si la puerta ya va hacia ese destino no se hace nada; si va en sentido contrario, la maniobra en curso
+ * frena con su rampa y la nueva arranca a continuación desde donde quedó.
  *
  * @param action Acción a realizar (OPEN o CLOSE).
  */
 void Motor_Activate(uint8_t action)
 {
-    if (action == OPEN && WARNING_Close_Flag == 0)
+    int32_t target;
+
+    if ((action == OPEN && WARNING_Close_Flag != 0) || (action == CLOSE && WARNING_Open_Flag != 0))
+    {
+        return;
+    }
+
+    target = (action == OPEN) ? DOOR_OPENED : DOOR_CLOSED;
+    if (MOTOR_GetTarget() == target)
     {
-        // Configura el pin de dirección y habilita el motor para abrir la puerta:
-        GPIO_SetValue(PINSEL_PORT_2, PIN_DIRRECCION); // Dirección de apertura
-        Config_PWM();                                 // Configuración del PWM para control del motor
-        Led_Control(ON, LED_CONTROL_5);               // Enciende el LED de control
-        DOOR_Flag = !DOOR_Flag;                       // Cambia el estado de la puerta
+        return;
     }
-    else if (action == CLOSE && WARNING_Open_Flag == 0)
+
+    MOTOR_Stop();
+    if (MOTOR_MoveTo(target) == SUCCESS)
     {
-        // Configura el pin de dirección y habilita el motor para cerrar la puerta:
-        GPIO_ClearValue(PINSEL_PORT_2, PIN_DIRRECCION); // Dirección de cierre
-        Config_PWM();                                   // Configuración del PWM para control del motor
-        Led_Control(OFF, LED_CONTROL_5);                // Apaga el LED de control
-        DOOR_Flag = !DOOR_Flag;                         // Cambia el estado de la puerta
+        // LED de control encendido con la puerta abierta:
+        GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_5), (action == OPEN) ? ON : OFF);
+        DOOR_Flag = action; // Estado de la puerta
     }
 }
 
+/**
+ * @brief Callback de fin de maniobra del motor.
+ *
+ * Se ejecuta en el contexto de la interrupción del GPDMA; publica el evento para armar la maniobra siguiente.
+ */
+void MOTOR_Move_Done(void)
+{
+    EVENT_Post(EVENT_MOTOR);
+}
+
+/**
+ * @brief Tarea del evento de fin de maniobra.
+ *
+ * Se ejecuta en el bucle principal. Arma la próxima maniobra de la cola del motor, si la hay.
+ */
+void MOTOR_Task(void)
+{
+    MOTOR_Poll();
+}
+
 /**
  * @brief Realiza el chequeo de las mediciones obtenidas de los sensores.
  *
- * Verifica si las mediciones de temperatura y concentración de gas se encuentran dentro de los
- * límites de seguridad. Si no es así, activa las advertencias correspondientes para abrir o cerrar la puerta.
+ * Evalúa las reglas de los canales de SENSOR_Table (temperatura y concentración de gas). Mientras una
+ * alarma está activa, su advertencia impide que el botón mueva la puerta en sentido contrario; cuando el motor
+ * de alarmas pide un accionamiento (una sola vez por cambio, respetando histéresis, permanencias e intervalo
+ * mínimo), se abre o se cierra la puerta.
  */
 void Check_Measures(void)
 {
-    if (Data[2] > MAX_GAS_CONCENTRATION)
-    {
-        // Si la concentración de gas excede el límite, establece la advertencia de cierre:
-        WARNING_Close_Flag = SAFE;
-        WARNING_Open_Flag = WARNING;
-    }
-    else if (Data[0] < MIN_TEMPERATURE)
+    int32_t measures[SENSOR_MAX_CHANNELS];
+    ALARM_Action_Type action;
+    ALARM_Action_Type active;
+
+    for (int i = 0; i < SENSOR_GetCount(); i++)
     {
-        // Si la temperatura está por debajo del límite mínimo, establece la advertencia de apertura:
-        WARNING_Close_Flag = WARNING;
-        WARNING_Open_Flag = SAFE;
+        measures[i] = Data[i];
     }
-    else if (Data[0] > MAX_TEMPERATURE)
+
+    action = ALARM_Update(measures, SCHED_GetPeriod(TASK_MEASURE));
+
+    // Advertencias de la alarma activa (bloquean el botón en el sentido contrario):
+    active = ALARM_GetActive();
+    WARNING_Open_Flag = (active == ALARM_OPEN) ? WARNING : SAFE;
+    WARNING_Close_Flag = (active == ALARM_CLOSE) ? WARNING : SAFE;
+
+    // Accionamiento pedido por las alarmas:
+    if (action == ALARM_OPEN)
     {
-        // Si la temperatura está por encima del límite máximo, establece la advertencia de cierre:
-        WARNING_Close_Flag = SAFE;
-        WARNING_Open_Flag = WARNING;
+        Motor_Activate(OPEN);
     }
-    else
+    else if (action == ALARM_CLOSE)
     {
-        // Si todo está dentro de los límites, establece ambos flags como seguros:
-        WARNING_Close_Flag = SAFE;
-        WARNING_Open_Flag = SAFE;
+        Motor_Activate(CLOSE);
     }
 }
 
@@ -569,173 +691,340 @@ void Check_Measures(void)
  * @brief Handler de la interrupción externa EINT3.
  *
  * Este handler se ejecuta cuando se detecta un evento en el pin asociado con la interrupción externa (EINT3).
- * Se comprueba el estado del botón y, dependiendo del estado de la puerta, se activa o desactiva el motor.
+ * Si el botón está presionado publica el evento del botón; el motor se acciona desde BOTON_Task.
  *
  * @note Se limpia la bandera de la interrupción después de procesar el evento.
  */
 void EINT3_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_EINT3);
+
     // Comprobación del estado del botón (si está presionado):
     if (GPIO_ReadValue(PINSEL_PORT_2) & PIN_BOTON)
     {
-        // Si la puerta está cerrada, se abre, y viceversa
-        if (DOOR_Flag == 0)
-        {
-            Motor_Activate(OPEN); // Abrir la puerta
-        }
-        else
-        {
-            Motor_Activate(CLOSE); // Cerrar la puerta
-        }
+        EVENT_Post(EVENT_BOTON);
     }
 
     // Limpiamos la bandera de la interrupción externa EINT3:
     EXTI_ClearEXTIFlag(EXTI_EINT3);
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_EINT3);
 }
 
 /**
- * @brief Handler del temporizador SysTick.
+ * @brief Tarea del evento del botón.
  *
- * Este handler se ejecuta cuando el temporizador SysTick alcanza el valor configurado.
- * Realiza el procesamiento de los resultados del ADC y actualiza el DAC con el valor calculado.
- * También gestiona el encendido y apagado del LED asociado al SysTick.
+ * Se ejecuta en el bucle principal. Dependiendo del estado de la puerta, se activa o desactiva el motor.
+ */
+void BOTON_Task(void)
+{
+    // Si la puerta está cerrada, se abre, y viceversa
+    if (DOOR_Flag == 0)
+    {
+        Motor_Activate(OPEN); // Abrir la puerta
+    }
+    else
+    {
+        Motor_Activate(CLOSE); // Cerrar la puerta
+    }
+}
+
+/**
+ * @brief Tarea periódica del DAC (cada DAC_PERIOD_MS).
  *
- * @note Se limpia la bandera de la interrupción del SysTick después de procesar el evento.
+ * Se ejecuta en el bucle principal. Lleva el DAC con una rampa al valor calculado a partir de la
+ * medición de luz y gestiona el encendido y apagado del LED asociado.
  */
-void SysTick_Handler(void)
+void DAC_Task(void)
 {
+    uint16_t value;
 
-    // Se calcula el valor a enviar al DAC:
-    DAC_Value = (100 - Data[1]) * 10;
+    // Se calcula el nuevo valor del DAC (brillo inverso a la luz, con corrección gamma precalculada):
+    value = TABLES_Dac_Gamma[Data[TELEMETRY_MEASURE_LIGHT]];
 
-    // Envío del valor calculado al DAC:
-    DAC_UpdateValue(LPC_DAC, DAC_Value);
+    // Rampa hacia el nuevo valor, que el GPDMA recorre sin intervención de la CPU. Si la rampa anterior
+    // todavía no empezó, se reintenta en el próximo periodo:
+    if (value != DAC_Value && DAC_WAVE_Ramp((uint16_t)DAC_Value, value) == SUCCESS)
+    {
+        DAC_Value = value;
+    }
 
-    // Control del LED asociado al SysTick:
-    if (SYSTICK_Flag == 0)
+    // Control del LED asociado a la tarea:
+    if (DAC_Flag == 0)
     {
-        Led_Control(ON, LED_CONTROL_1); // Enciende el LED
-        SYSTICK_Flag = !SYSTICK_Flag;
+        GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_1), ON); // Enciende el LED
+        DAC_Flag = !DAC_Flag;
     }
     else
     {
-        Led_Control(OFF, LED_CONTROL_1); // Apaga el LED
-        SYSTICK_Flag = !SYSTICK_Flag;
+        GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_1), OFF); // Apaga el LED
+        DAC_Flag = !DAC_Flag;
     }
 
-    // Limpiamos la bandera del SysTick:
-    SYSTICK_ClearCounterFlag();
+    // Continuación del envío de las estadísticas de interrupciones, si hay uno en curso:
+    ISR_PROFILE_POLL();
 }
 
 /**
- * @brief Handler de la interrupción del temporizador TIMER0.
+ * @brief Handler de la interrupción del temporizador TIMER2.
  *
- * Este handler se ejecuta cuando el temporizador TIMER0 alcanza el valor configurado.
- * Realiza la conversión de los datos del ADC y los envía por UART. También gestiona los LEDs asociados
- * al temporizador y verifica las condiciones de advertencia para la puerta.
+ * Este handler se ejecuta cuando el temporizador TIMER2 llega al próximo vencimiento del planificador.
+ * Solo publica su evento; las tareas se ejecutan en SCHED_Dispatch.
  *
- * @note Se limpia la bandera de la interrupción del temporizador después de procesar el evento.
+ * @note La bandera de la interrupción se limpia dentro de SCHED_IRQHandler.
  */
-void TIMER0_IRQHandler(void)
+void TIMER2_IRQHandler(void)
 {
-    uint32_t temp;
+    ISR_PROFILE_ENTER(ISR_PROFILE_TIMER2);
+
+    SCHED_IRQHandler();
 
-    // Procesamiento de los resultados del ADC para los tres canales:
-    for (int i = 0; i < 3; i++)
+    ISR_PROFILE_EXIT(ISR_PROFILE_TIMER2);
+}
+
+/**
+ * @brief Callback de vencimiento del planificador.
+ *
+ * Se ejecuta en el contexto de la interrupción del TIMER2; publica el evento que despacha las tareas vencidas.
+ */
+void SCHED_Wakeup(void)
+{
+    EVENT_Post(EVENT_SCHED);
+}
+
+/**
+ * @brief Tarea periódica de mediciones y alarmas (periodo seleccionable con MEASURE_RATE_CMD).
+ *
+ * Se ejecuta en el bucle principal. Realiza la conversión de los datos del ADC y verifica las condiciones de
+ * advertencia para la puerta.
+ */
+void MEASURE_Task(void)
+{
+    uint8_t count = SENSOR_GetCount();
+
+    // Calibración de los valores filtrados de cada canal (temperatura en °C, luz en %, gas en centenas de ppm). Se
+    // usa la salida de la etapa de filtros: una lectura ruidosa aislada no llega a Check_Measures:
+    for (uint8_t i = 0; i < count; i++)
     {
-        temp = ((0xFFF0) & ADC_Results[i]) >> 4;
-        Data[i] = (temp * 100) / 4096; // Conversión del valor ADC a un porcentaje
+        Data[i] = SENSOR_Read(i);
     }
 
+    // Medición de la tasa de adquisición del ADC (las liberaciones están separadas exactamente un periodo):
+    ADC_PIPE_UpdateRate(SCHED_GetPeriod(TASK_MEASURE));
+
     // Ajuste del valor de la puerta:
-    Data[3] = DOOR_Flag;
+    Data[count] = DOOR_Flag;
 
-    // Verificación de las mediciones de los sensores:
+    // Verificación de las mediciones de los sensores y control de la puerta por las alarmas:
     Check_Measures();
+}
 
-    // Verificación de las banderas de advertencia y control de la puerta:
-    if (WARNING_Close_Flag == WARNING)
-    {
-        Motor_Activate(CLOSE); // Cerrar la puerta si se detecta advertencia
-    }
-    if (WARNING_Open_Flag == WARNING)
+/**
+ * @brief Tarea periódica de telemetría (periodo seleccionable con TELEMETRY_RATE_CMD).
+ *
+ * Se ejecuta en el bucle principal. Envía las últimas mediciones por UART en una trama de telemetría (ver
+ * telemetry.h) y gestiona el LED asociado.
+ */
+void TELEMETRY_Task(void)
+{
+    uint8_t sequence;
+    uint8_t* frame;
+    uint8_t* payload;
+    uint8_t length = SENSOR_GetCount() + 1;
+
+    // Armado de la trama de telemetría directamente en el buffer que transmite el GPDMA. La secuencia avanza
+    // aunque no haya buffer libre, para que el receptor cuente la trama perdida:
+    sequence = TELEMETRY_Sequence++;
+    frame = UART_DMA_Acquire();
+    if (frame != NULL)
     {
-        Motor_Activate(OPEN); // Abrir la puerta si se detecta advertencia
+        payload = TELEMETRY_PAYLOAD(frame);
+        for (uint8_t i = 0; i < length; i++)
+        {
+            payload[i] = Data[i]; // Un byte por canal y la ventilación en TELEMETRY_MEASURE_VENT(length)
+        }
+        UART_DMA_Commit(TELEMETRY_Seal(frame, TELEMETRY_TYPE_MEASURES, sequence, length));
     }
 
-    // Enviar los datos por UART:
-    UART_Send(LPC_UART2, Data, 4, BLOCKING);
-
-    // Control de LED asociado al TIMER0:
-    if (TIMER0_Flag == 0)
+    // Control de LED asociado a la telemetría:
+    if (TELEMETRY_Flag == 0)
     {
-        Led_Control(ON, LED_CONTROL_3); // Enciende el LED
-        TIMER0_Flag = !TIMER0_Flag;
+        GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_3), ON); // Enciende el LED
+        TELEMETRY_Flag = !TELEMETRY_Flag;
     }
     else
     {
-        Led_Control(OFF, LED_CONTROL_3); // Apaga el LED
-        TIMER0_Flag = !TIMER0_Flag;
+        GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_3), OFF); // Apaga el LED
+        TELEMETRY_Flag = !TELEMETRY_Flag;
     }
-
-    // Limpiamos la bandera del temporizador TIMER0:
-    TIM_ClearIntPending(LPC_TIM0, TIM_MR0_INT);
 }
 
 /**
  * @brief Handler de la interrupción del UART2.
  *
- * Este handler se ejecuta cuando se recibe un dato a través del UART2.
- * Controla el estado de un LED en función de la recepción de datos.
+ * Este handler se ejecuta cuando se recibe un dato a través del UART2 o se vacía la FIFO de transmisión.
+ * Vacía la FIFO de recepción, carga la de transmisión desde los buffers circulares, publica el evento
+ * de recepción y controla el estado de un LED en función de la recepción de datos.
  *
- * @note Se limpia la bandera de la interrupción del UART2 después de procesar el evento.
+ * @note Las banderas de la interrupción se limpian al leer el IIR y el LSR dentro de UART_Ring_IRQHandler.
  */
-void UART2_IRQHandler(void)
+RAMFUNC void UART2_IRQHandler(void)
 {
+    ISR_PROFILE_ENTER(ISR_PROFILE_UART2);
+
     // Verificación de si se ha recibido un dato:
-    if (UART_GetIntId(LPC_UART2) & (1 << 1))
+    if (UART_Ring_IRQHandler() > 0)
     {
+        EVENT_Post(EVENT_UART);
+
         // Control de LED dependiendo de la bandera UART:
         if (UART_Flag == 0)
         {
-            Led_Control(ON, LED_CONTROL_4); // Enciende el LED
+            GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_4), ON); // Enciende el LED
             UART_Flag = !UART_Flag;
         }
         else
         {
-            Led_Control(OFF, LED_CONTROL_4); // Apaga el LED
+            GPIO_FAST_Write(GPIO_FAST_BIT(LED_PORT, LED_CONTROL_4), OFF); // Apaga el LED
             UART_Flag = !UART_Flag;
         }
     }
+
+    ISR_PROFILE_EXIT(ISR_PROFILE_UART2);
 }
 
 /**
- * @brief Handler de la interrupción del PWM1.
- *
- * Este handler se ejecuta cuando el PWM alcanza un valor de coincidencia especificado.
- * Se realiza el conteo de los pulsos y se ajusta el comportamiento del PWM cuando se alcanzan ciertos valores.
+ * @brief Tarea del evento de recepción del UART2.
  *
- * @note Se limpia la bandera de la interrupción del PWM1 después de procesar el evento.
+ * Se ejecuta en el bucle principal. Consume los bytes recibidos e interpreta los comandos de un byte:
+ * ISR_PROFILE_DUMP_CMD envía las estadísticas de las interrupciones, ISR_PROFILE_RESET_CMD las borra,
+ * ISR_PROFILE_BENCH_CMD corre el banco de prueba de competencia por el bus entre la CPU y el GPDMA,
+ * UART_BAUD_REPORT_CMD envía la velocidad obtenida del UART2 con su error, ALARM_REPORT_CMD los contadores
+ * de las alarmas (accionamientos pedidos y evitados) y SCHED_REPORT_CMD una línea por tarea del planificador
+ * (ejecuciones, plazos perdidos, jitter y duración) seguida de la carga de CPU de la cola de eventos (tiempo
+ * dormido y total medidos con el TIMER2 del planificador, eventos despachados y descartados). MEASURE_RATE_CMD y
+ * TELEMETRY_RATE_CMD pasan al siguiente periodo de las tareas de mediciones y de telemetría, y ADC_MODE_CMD al
+ * siguiente modo de conversión del ADC (burst o disparo periódico, ver adc_pipeline.h). ADC_PIPE_REPORT_CMD envía
+ * el modo, las muestras por segundo medidas por la tarea de mediciones y el valor filtrado y la pendiente por
+ * segundo de cada canal.
  */
-void PWM1_IRQHandler(void)
+void UART_Task(void)
 {
-    if (PWM_GetIntStatus(LPC_PWM1, PWM_INTSTAT_MR0) == SET)
-    {
-        PWM_count++; // Incrementar el contador de pulsos
+    char line[MAX(MAX(MAX(UART_BAUD_LINE_SIZE, ALARM_LINE_SIZE), MAX(SCHED_LINE_SIZE, EVENT_LINE_SIZE)),
+                  ADC_PIPE_LINE_SIZE)];
+    uint32_t length;
+    uint8_t command;
 
-        // Si se alcanza la cantidad de pulsos esperada, se configura el PWM para detenerse:
-        if (PWM_count == PWM_PULSE_QUANTITY)
+    while (UART_Ring_Read(&command, 1) > 0)
+    {
+        if (command == ISR_PROFILE_DUMP_CMD)
+        {
+            ISR_PROFILE_DUMP();
+        }
+        else if (command == ISR_PROFILE_RESET_CMD)
         {
-            PWM_count = 0; // Reinicia el contador de pulsos
-            PWM_MATCHCFG_Type PwmMatch0;
-            PwmMatch0.IntOnMatch = ENABLE;         // Habilita la interrupción en la coincidencia
-            PwmMatch0.MatchChannel = 0;            // Canal de coincidencia
-            PwmMatch0.ResetOnMatch = DISABLE;      // No se reinicia el PWM en la coincidencia
-            PwmMatch0.StopOnMatch = ENABLE;        // Detiene el PWM en la coincidencia
-            PWM_ConfigMatch(LPC_PWM1, &PwmMatch0); // Configura el PWM con la nueva configuración
+            ISR_PROFILE_RESET();
+        }
+        else if (command == ISR_PROFILE_BENCH_CMD)
+        {
+            ISR_PROFILE_BENCH();
+        }
+        else if (command == UART_BAUD_REPORT_CMD)
+        {
+            // La línea sale entera o no sale, para no cortarla en medio de otro reporte:
+            length = UART_BAUD_Format(line, &UART_Baud);
+            if (UART_Ring_Free() >= length)
+            {
+                UART_Ring_Write((const uint8_t*)line, length);
+            }
+        }
+        else if (command == ALARM_REPORT_CMD)
+        {
+            length = ALARM_Format(line);
+            if (UART_Ring_Free() >= length)
+            {
+                UART_Ring_Write((const uint8_t*)line, length);
+            }
+        }
+        else if (command == SCHED_REPORT_CMD)
+        {
+            // Una línea por tarea, mientras entren enteras en el buffer de transmisión:
+            for (uint8_t id = 0; id < SCHED_MAX_TASKS; id++)
+            {
+                length = SCHED_Format(line, id);
+                if (length > 0 && UART_Ring_Free() >= length)
+                {
+                    UART_Ring_Write((const uint8_t*)line, length);
+                }
+            }
+
+            // Carga de CPU medida por la cola de eventos:
+            length = EVENT_Format(line);
+            if (UART_Ring_Free() >= length)
+            {
+                UART_Ring_Write((const uint8_t*)line, length);
+            }
+        }
+        else if (command == MEASURE_RATE_CMD)
+        {
+            MEASURE_Rate = (MEASURE_Rate + 1) % RATE_STEPS;
+            SCHED_SetPeriod(TASK_MEASURE, MEASURE_Periods[MEASURE_Rate]);
+        }
+        else if (command == TELEMETRY_RATE_CMD)
+        {
+            TELEMETRY_Rate = (TELEMETRY_Rate + 1) % RATE_STEPS;
+            SCHED_SetPeriod(TASK_TELEMETRY, TELEMETRY_Periods[TELEMETRY_Rate]);
+        }
+        else if (command == ADC_MODE_CMD)
+        {
+            ADC_Mode = (ADC_Mode + 1) % ADC_MODE_STEPS;
+            ADC_PIPE_SetMode((ADC_Scan_Rates[ADC_Mode] == 0) ? ADC_PIPE_BURST : ADC_PIPE_TRIGGERED,
+                             ADC_Scan_Rates[ADC_Mode]);
+        }
+        else if (command == ADC_PIPE_REPORT_CMD)
+        {
+            length = ADC_PIPE_Format(line);
+            if (UART_Ring_Free() >= length)
+            {
+                UART_Ring_Write((const uint8_t*)line, length);
+            }
         }
     }
+}
+
+/**
+ * @brief Callback de fin de envio de una trama por UART2.
+ *
+ * Se invoca desde la interrupción del GPDMA cada vez que se termina de transmitir una trama.
+ * Reactiva la transmisión de los buffers circulares, que espera mientras el GPDMA usa el UART2.
+ */
+void UART_Frame_Sent(void)
+{
+    UART_count++;
+    UART_Ring_Kick();
+}
+
+/**
+ * @brief Handler de la interrupción del GPDMA.
+ *
+ * Atiende el fin de bloque del canal del ADC, el fin de transferencia del canal de transmisión
+ * del UART2, el canal del DAC y el fin de maniobra del motor. Cada módulo limpia las banderas de su canal.
+ */
+RAMFUNC void DMA_IRQHandler(void)
+{
+    ISR_PROFILE_ENTER(ISR_PROFILE_DMA);
+
+    // Fin de bloque del ADC:
+    ADC_PIPE_IRQHandler();
+
+    // Fin de trama del UART2:
+    UART_DMA_IRQHandler();
+
+    // Banderas del canal del DAC:
+    DAC_WAVE_IRQHandler();
+
+    // Fin de maniobra del motor:
+    STEP_ENGINE_IRQHandler();
 
-    // Limpiamos la bandera de interrupción del PWM:
-    PWM_ClearIntPending(LPC_PWM1, PWM_INTSTAT_MR0);
+    ISR_PROFILE_EXIT(ISR_PROFILE_DMA);
 }
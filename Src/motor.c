@@ -0,0 +1,247 @@
+/**
+ * @file motor.c
+ * @brief Control de posicion del motor paso a paso: maquina de estados, cola de maniobras y posicion actual.
+ *
+ * La posicion se lleva al comienzo de la maniobra en curso y se actualiza en su interrupcion de fin con los pasos
+ * efectivamente dados (menos que los de la tabla si se freno). Mientras tanto, la posicion actual suma el avance
+ * que informa el generador. La posicion "planificada" (la de la maniobra en curso y la preparada ya terminadas) no
+ * cambia con esa interrupcion, asi que la proxima maniobra se calcula sin competir con ella.
+ *
+ * Las funciones publicas corren fuera de interrupciones; las secciones criticas solo cubren lecturas y el arranque,
+ * nunca el calculo de una tabla.
+ */
+
+#include "motor.h"
+
+#include "LPC17xx.h"
+#include "gpio_fast.h"
+
+static const STEP_PROFILE_Config_Type* Profile = NULL; /**< Perfil de velocidad de las maniobras */
+static volatile uint32_t* Dir_Pin = NULL;             /**< Alias de bit-band del pin de direccion */
+static MOTOR_Callback Done_Callback = NULL;            /**< Callback de fin de maniobra */
+static int32_t Queue[MOTOR_QUEUE_SIZE];                /**< Destinos pendientes */
+static uint32_t Queue_Head = 0;                        /**< Indice del proximo destino */
+static uint32_t Queue_Count = 0;                       /**< Destinos pendientes */
+static int32_t Target = 0;                             /**< Posicion al completar la cola */
+static volatile int32_t Position = 0;                  /**< Posicion al comienzo de la maniobra en curso */
+static volatile int32_t Direction = 1;                 /**< Sentido de la maniobra en curso (1 o -1) */
+static volatile int32_t Next_Direction = 1;            /**< Sentido de la maniobra preparada */
+static volatile uint32_t Next_Steps = 0;               /**< Pasos de la maniobra preparada (0 si no hay) */
+static volatile MOTOR_State_Type State = MOTOR_IDLE;   /**< Estado del motor */
+
+/**
+ * @brief Fija la direccion y arranca la maniobra preparada.
+ *
+ * Se llama desde la interrupcion de fin de maniobra o con las interrupciones deshabilitadas.
+ */
+static void MOTOR_StartNext(void)
+{
+    GPIO_FAST_Write(Dir_Pin, (Next_Direction > 0) ? 1 : 0);
+
+    Direction = Next_Direction;
+    Next_Steps = 0;
+    State = (STEP_ENGINE_Start() == SUCCESS) ? MOTOR_ACCEL : MOTOR_IDLE;
+}
+
+/**
+ * @brief Fin de maniobra del generador: acumula la posicion y encadena la maniobra preparada.
+ */
+static void MOTOR_Done(void)
+{
+    STEP_ENGINE_Progress_Type progress;
+
+    STEP_ENGINE_GetProgress(&progress);
+    Position += Direction * (int32_t)progress.Done;
+
+    if (Next_Steps != 0)
+    {
+        MOTOR_StartNext();
+    }
+    else
+    {
+        State = MOTOR_IDLE;
+    }
+
+    if (Done_Callback != NULL)
+    {
+        Done_Callback();
+    }
+}
+
+/**
+ * @brief Posicion al terminar la maniobra en curso y la preparada. Requiere las interrupciones deshabilitadas.
+ */
+static int32_t MOTOR_Planned(void)
+{
+    STEP_ENGINE_Progress_Type progress;
+    int32_t planned = Position;
+
+    if (STEP_ENGINE_Busy() == TRUE)
+    {
+        STEP_ENGINE_GetProgress(&progress);
+        planned += Direction * (int32_t)progress.Total;
+    }
+
+    return planned + Next_Direction * (int32_t)Next_Steps;
+}
+
+void MOTOR_Init(const STEP_PROFILE_Config_Type* profile, volatile uint32_t* dir_pin, MOTOR_Callback callback)
+{
+    Profile = profile;
+    Dir_Pin = dir_pin;
+    Done_Callback = callback;
+    Queue_Head = 0;
+    Queue_Count = 0;
+    Target = 0;
+    Position = 0;
+    Next_Steps = 0;
+    State = MOTOR_IDLE;
+
+    STEP_ENGINE_Init(MOTOR_Done);
+}
+
+Status MOTOR_MoveTo(int32_t position)
+{
+    if (Queue_Count == MOTOR_QUEUE_SIZE)
+    {
+        return ERROR;
+    }
+
+    Queue[(Queue_Head + Queue_Count) % MOTOR_QUEUE_SIZE] = position;
+    Queue_Count++;
+    Target = position;
+
+    MOTOR_Poll();
+    return SUCCESS;
+}
+
+void MOTOR_Stop(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    // Seccion critica: la maniobra preparada no debe arrancar mientras se la descarta y se redirige la actual.
+    __disable_irq();
+    Queue_Count = 0;
+    Next_Steps = 0;
+    if (STEP_ENGINE_Busy() == TRUE)
+    {
+        STEP_ENGINE_Stop();
+        State = MOTOR_STOPPING;
+    }
+    Target = MOTOR_Planned();
+    __set_PRIMASK(primask);
+}
+
+void MOTOR_Poll(void)
+{
+    uint32_t primask;
+    int32_t delta;
+    int32_t direction;
+    uint32_t steps;
+
+    // Una sola maniobra preparada por vez: el generador tiene un unico buffer libre.
+    while (Next_Steps == 0 && Queue_Count > 0)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        delta = Queue[Queue_Head] - MOTOR_Planned();
+        __set_PRIMASK(primask);
+
+        // Los destinos lejanos se reparten en maniobras de STEP_ENGINE_MAX_STEPS pasos; el destino sale de la cola
+        // con su ultima maniobra.
+        direction = (delta < 0) ? -1 : 1;
+        steps = (uint32_t)(delta * direction);
+        if (steps > STEP_ENGINE_MAX_STEPS)
+        {
+            steps = STEP_ENGINE_MAX_STEPS;
+        }
+        else
+        {
+            Queue_Head = (Queue_Head + 1) % MOTOR_QUEUE_SIZE;
+            Queue_Count--;
+        }
+
+        if (steps == 0)
+        {
+            continue;
+        }
+
+        // Perfil invalido: no hay maniobra posible, se descarta la cola.
+        if (STEP_ENGINE_Prepare(Profile, steps) == ERROR)
+        {
+            primask = __get_PRIMASK();
+            __disable_irq();
+            Queue_Count = 0;
+            Target = MOTOR_Planned();
+            __set_PRIMASK(primask);
+            break;
+        }
+
+        // La direccion tiene que estar escrita antes de que la interrupcion vea la maniobra preparada.
+        Next_Direction = direction;
+        __DMB();
+        Next_Steps = steps;
+    }
+
+    // Con el motor detenido nadie la va a encadenar: arranca ahora.
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (Next_Steps != 0 && STEP_ENGINE_Busy() == FALSE)
+    {
+        MOTOR_StartNext();
+    }
+    __set_PRIMASK(primask);
+}
+
+MOTOR_State_Type MOTOR_GetState(void)
+{
+    STEP_ENGINE_Progress_Type progress;
+    uint32_t primask = __get_PRIMASK();
+    MOTOR_State_Type state;
+
+    // Los tramos del perfil se deducen del avance de la maniobra frente al largo de sus rampas.
+    __disable_irq();
+    if (State == MOTOR_ACCEL || State == MOTOR_CRUISE || State == MOTOR_DECEL)
+    {
+        STEP_ENGINE_GetProgress(&progress);
+        if (progress.Done < progress.Ramp)
+        {
+            State = MOTOR_ACCEL;
+        }
+        else if (progress.Done + progress.Ramp < progress.Total)
+        {
+            State = MOTOR_CRUISE;
+        }
+        else
+        {
+            State = MOTOR_DECEL;
+        }
+    }
+    state = State;
+    __set_PRIMASK(primask);
+
+    return state;
+}
+
+int32_t MOTOR_GetPosition(void)
+{
+    STEP_ENGINE_Progress_Type progress;
+    uint32_t primask = __get_PRIMASK();
+    int32_t position;
+
+    __disable_irq();
+    position = Position;
+    if (STEP_ENGINE_Busy() == TRUE)
+    {
+        STEP_ENGINE_GetProgress(&progress);
+        position += Direction * (int32_t)progress.Done;
+    }
+    __set_PRIMASK(primask);
+
+    return position;
+}
+
+int32_t MOTOR_GetTarget(void)
+{
+    return Target;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file motor.h
+ * @brief Control de posicion del motor paso a paso: maquina de estados, cola de maniobras y posicion actual.
+ *
+ * El modulo se configura una sola vez y mantiene su estado entre maniobras. Los destinos se encolan como
+ * posiciones absolutas (en pasos); cada uno se reparte en maniobras de hasta STEP_ENGINE_MAX_STEPS pasos con su
+ * direccion. La siguiente maniobra se arma en el buffer libre del generador mientras la actual se ejecuta
+ * (MOTOR_Poll()) y arranca desde la interrupcion de fin de la anterior, sin recalcular nada en ese momento.
+ *
+ * Estados:
+ *
+ * - MOTOR_IDLE: detenido, sin maniobras pendientes.
+ * - MOTOR_ACCEL, MOTOR_CRUISE, MOTOR_DECEL: tramo del perfil en el que va la maniobra en curso.
+ * - MOTOR_STOPPING: se pidio frenar (MOTOR_Stop()) y la maniobra termina con su rampa.
+ */
+
+#ifndef MOTOR_H
+#define MOTOR_H
+
+#include "lpc_types.h"
+#include "step_engine.h"
+
+// Definiciones del modulo:
+#define MOTOR_QUEUE_SIZE 4 /**< Destinos pendientes maximos */
+
+/**
+ * @brief Estado del motor.
+ */
+typedef enum
+{
+    MOTOR_IDLE,    /**< Detenido */
+    MOTOR_ACCEL,   /**< Acelerando */
+    MOTOR_CRUISE,  /**< A velocidad de crucero */
+    MOTOR_DECEL,   /**< Desacelerando al final de la maniobra */
+    MOTOR_STOPPING /**< Frenando por un pedido de parada */
+} MOTOR_State_Type;
+
+/**
+ * @brief Callback de fin de maniobra, invocado desde la interrupcion del GPDMA.
+ *
+ * Tipicamente publica un evento cuya tarea llama a MOTOR_Poll() para armar la maniobra siguiente.
+ */
+typedef void (*MOTOR_Callback)(void);
+
+/**
+ * @brief Inicializa el modulo y el generador de pasos.
+ *
+ * El pin de direccion ya debe estar configurado como salida y el de STEP con STEP_ENGINE_ConfigPin(). La posicion
+ * inicial es 0.
+ *
+ * @param profile Perfil de velocidad de todas las maniobras (debe seguir existiendo).
+ * @param dir_pin Alias de bit-band del pin de direccion del driver (GPIO_FAST_BIT(); en alto, la posicion crece).
+ * @param callback Funcion a llamar al terminar cada maniobra (puede ser NULL).
+ */
+void MOTOR_Init(const STEP_PROFILE_Config_Type* profile, volatile uint32_t* dir_pin, MOTOR_Callback callback);
+
+/**
+ * @brief Encola un destino absoluto.
+ *
+ * @param position Posicion a alcanzar, en pasos.
+ * @return SUCCESS, o ERROR si la cola esta llena.
+ */
+Status MOTOR_MoveTo(int32_t position);
+
+/**
+ * @brief Descarta los destinos pendientes y frena la maniobra en curso con su rampa.
+ *
+ * La posicion final queda en MOTOR_GetTarget(); un MOTOR_MoveTo() posterior arranca desde ahi, a continuacion de
+ * la frenada.
+ */
+void MOTOR_Stop(void);
+
+/**
+ * @brief Arma la proxima maniobra de la cola y la arranca si el motor esta detenido.
+ *
+ * Se llama fuera de interrupciones, despues de cada fin de maniobra. Calcular una tabla lleva del orden de
+ * milisegundos.
+ */
+void MOTOR_Poll(void);
+
+/**
+ * @brief Estado actual del motor.
+ */
+MOTOR_State_Type MOTOR_GetState(void);
+
+/**
+ * @brief Posicion actual, en pasos, contando los de la maniobra en curso.
+ */
+int32_t MOTOR_GetPosition(void);
+
+/**
+ * @brief Posicion en la que queda el motor al completar la cola.
+ */
+int32_t MOTOR_GetTarget(void);
+
+#endif /* MOTOR_H */
@@ -0,0 +1,42 @@
+/**
+ * @file pin_map.cpp
+ * @brief Mapa de pines de la placa, resuelto al compilar (ver pin_map.hpp).
+ *
+ * Tiene los mismos pines y configuraciones que Config_PINSEL() (main.c). Los de los sensores repiten las entradas
+ * de SENSOR_Table, que se arma en ejecucion: un sensor nuevo agrega su pin en las dos tablas (el pin de cada
+ * entrada del ADC esta en SENSOR_Pins de sensor_channels.c). Con ISR_PROFILE, el banco de prueba compara los
+ * registros que dejan las dos configuraciones y avisa si difieren.
+ *
+ * Solo se compila con make PIN_MAP=1.
+ */
+
+#include "pin_map.h"
+
+#include "pin_map.hpp"
+
+/** Pines de la placa */
+using Board_Pins = PIN_MAP_Table<
+    // LEDs de control (P2.0, P2.2, P2.3, P2.4) y salida de direccion del motor (P2.5): GPIO con pull-down
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_0, PINSEL_FUNC_0, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_2, PINSEL_FUNC_0, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_3, PINSEL_FUNC_0, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_4, PINSEL_FUNC_0, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_5, PINSEL_FUNC_0, PINSEL_PINMODE_PULLDOWN>,
+    // Boton (P2.13, funcion 1 = EINT3) con pull-up
+    PIN_MAP_Pin<PINSEL_PORT_2, PINSEL_PIN_13, PINSEL_FUNC_1, PINSEL_PINMODE_PULLUP>,
+    // Sensores de SENSOR_Table: AD0.0 (P0.23), AD0.1 (P0.24) y AD0.2 (P0.25), con pull-down
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_23, PINSEL_FUNC_1, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_24, PINSEL_FUNC_1, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_25, PINSEL_FUNC_1, PINSEL_PINMODE_PULLDOWN>,
+    // Salida del DAC (P0.26, funcion 2 = AOUT): excluye a AD0.3, que usa el mismo pin
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_26, PINSEL_FUNC_2, PINSEL_PINMODE_PULLDOWN>,
+    // UART2: TXD2 (P0.10) y RXD2 (P0.11), funcion 1
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_10, PINSEL_FUNC_1, PINSEL_PINMODE_PULLDOWN>,
+    PIN_MAP_Pin<PINSEL_PORT_0, PINSEL_PIN_11, PINSEL_FUNC_1, PINSEL_PINMODE_PULLDOWN>,
+    // STEP del A4988 (P1.22, funcion 3 = MAT1.0), sin resistencia
+    PIN_MAP_Pin<PINSEL_PORT_1, PINSEL_PIN_22, PINSEL_FUNC_3, PINSEL_PINMODE_TRISTATE>>;
+
+void PIN_MAP_Apply(void)
+{
+    Board_Pins::Apply();
+}
@@ -0,0 +1,38 @@
+/**
+ * @file pin_map.h
+ * @brief Configuracion de los pines de la placa con la imagen precalculada de pin_map.cpp.
+ *
+ * Con make PIN_MAP=1, Config_PINS() (main.c) escribe los pines con PIN_MAP_Apply() en lugar de la secuencia de
+ * llamadas a PINSEL_ConfigPin(). El mapa esta en C++17 (pin_map.hpp) para resolverlo y verificarlo al compilar; esta
+ * interfaz es C para que el resto del firmware no cambie. Con ISR_PROFILE, el banco de prueba de isr_profile.h
+ * cronometra las dos configuraciones y verifica que dejen los registros iguales.
+ */
+
+#ifndef PIN_MAP_H
+#define PIN_MAP_H
+
+#include "lpc_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef PIN_MAP
+#define PIN_MAP_APPLY PIN_MAP_Apply /**< Configuracion de los pines con la imagen */
+#else
+#define PIN_MAP_APPLY NULL          /**< Sin imagen: los pines se configuran con PINSEL_ConfigPin() */
+#endif
+
+/**
+ * @brief Escribe la imagen del mapa de pines en PINSEL, PINMODE y PINMODE_OD, en una sola pasada.
+ *
+ * Solo existe si se compila con PIN_MAP.
+ */
+void PIN_MAP_Apply(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIN_MAP_H */
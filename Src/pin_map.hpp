@@ -0,0 +1,217 @@
+/**
+ * @file pin_map.hpp
+ * @brief Mapa de pines resuelto al compilar (C++17): chequeo de conflictos e imagen de PINSEL y PINMODE.
+ *
+ * PINSEL_ConfigPin() lee y reescribe PINSEL, PINMODE y PINMODE_OD una vez por pin, a traves de un switch por
+ * puerto; configurar los pines de la placa repite esas lecturas y escrituras sobre las mismas palabras. Aca cada pin
+ * es un tipo (PIN_MAP_Pin) con los mismos parametros que PINSEL_CFG_Type y las constantes de lpc17xx_pinsel.h, y el
+ * mapa de la placa es la lista de esos tipos (PIN_MAP_Table). Al compilar:
+ *
+ * - static_assert rechaza un pin que no existe en el LPC1769, una funcion o un modo fuera de rango, y un pin que
+ *   aparece dos veces con configuraciones distintas (dos perifericos sobre el mismo pin, o el mismo pin con dos
+ *   resistencias). El mismo pin repetido con la misma configuracion se acepta.
+ * - Las configuraciones se funden en una imagen: valor y mascara de cada palabra de PINSEL0..9, PINMODE0..9 y
+ *   PINMODE_OD0..4.
+ *
+ * PIN_MAP_Table::Apply() escribe la imagen en una sola pasada: una lectura y una escritura por palabra tocada, una
+ * escritura sin lectura si el mapa fija la palabra completa y nada en las que no toca. Los valores, las mascaras y
+ * las direcciones son parametros de plantilla, asi que aun con -O0 cada palabra se reduce a constantes inmediatas.
+ *
+ * Solo se compila con make PIN_MAP=1 (ver pin_map.cpp); el resto del firmware sigue en C y llama a PIN_MAP_Apply().
+ */
+
+#ifndef PIN_MAP_HPP
+#define PIN_MAP_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+#include "LPC17xx.h"
+#include "lpc17xx_pinsel.h"
+
+// Definiciones del modulo:
+#define PIN_MAP_PORTS         5  /**< Puertos del LPC1769 (P0 a P4) */
+#define PIN_MAP_PINSEL_WORDS  10 /**< Palabras de PINSEL con pines (PINSEL10 es del puerto de trazas) */
+#define PIN_MAP_PINMODE_WORDS 10 /**< Palabras de PINMODE */
+#define PIN_MAP_OD_WORDS      5  /**< Palabras de PINMODE_OD (una por puerto) */
+
+#define PIN_MAP_INLINE static inline __attribute__((always_inline)) /**< Funcion insertada aun con -O0 */
+
+/** Pines de cada puerto que existen en el encapsulado LQFP100 del LPC1769 */
+static constexpr uint32_t PIN_MAP_Exists[PIN_MAP_PORTS] = {
+    0x7FFF8FFFUL, // P0.0 a P0.11 y P0.15 a P0.30
+    0xFFFFC713UL, // P1.0, P1.1, P1.4, P1.8 a P1.10 y P1.14 a P1.31
+    0x00003FFFUL, // P2.0 a P2.13
+    0x06000000UL, // P3.25 y P3.26
+    0x30000000UL, // P4.28 y P4.29
+};
+
+/**
+ * @brief Configuracion de un pin, con los campos de PINSEL_CFG_Type.
+ */
+struct PIN_MAP_Cfg_Type
+{
+    uint8_t Portnum;   /**< Puerto (PINSEL_PORT_x) */
+    uint8_t Pinnum;    /**< Pin (PINSEL_PIN_x) */
+    uint8_t Funcnum;   /**< Funcion (PINSEL_FUNC_x) */
+    uint8_t Pinmode;   /**< Resistencia (PINSEL_PINMODE_PULLUP, _TRISTATE o _PULLDOWN) */
+    uint8_t OpenDrain; /**< PINSEL_PINMODE_NORMAL o PINSEL_PINMODE_OPENDRAIN */
+};
+
+/**
+ * @brief Valor y mascara de cada palabra de los registros del PINCON.
+ */
+struct PIN_MAP_Image_Type
+{
+    uint32_t Pinsel[PIN_MAP_PINSEL_WORDS];        /**< Valor de PINSELn */
+    uint32_t Pinsel_Mask[PIN_MAP_PINSEL_WORDS];   /**< Bits de PINSELn que fija el mapa */
+    uint32_t Pinmode[PIN_MAP_PINMODE_WORDS];      /**< Valor de PINMODEn */
+    uint32_t Pinmode_Mask[PIN_MAP_PINMODE_WORDS]; /**< Bits de PINMODEn que fija el mapa */
+    uint32_t Od[PIN_MAP_OD_WORDS];                /**< Valor de PINMODE_ODn */
+    uint32_t Od_Mask[PIN_MAP_OD_WORDS];           /**< Bits de PINMODE_ODn que fija el mapa */
+};
+
+/**
+ * @brief Indica si un pin existe en el LPC1769.
+ */
+constexpr bool PIN_MAP_PinExists(uint32_t port, uint32_t pin)
+{
+    return port < PIN_MAP_PORTS && pin < 32 && ((PIN_MAP_Exists[port] >> pin) & 1) != 0;
+}
+
+/**
+ * @brief Un pin del mapa. Los parametros son los de PINSEL_CFG_Type.
+ *
+ * @tparam Port Puerto (PINSEL_PORT_x).
+ * @tparam Pin Pin (PINSEL_PIN_x).
+ * @tparam Func Funcion (PINSEL_FUNC_x).
+ * @tparam Mode Resistencia (PINSEL_PINMODE_PULLUP, _TRISTATE o _PULLDOWN).
+ * @tparam OpenDrain PINSEL_PINMODE_NORMAL (por defecto) o PINSEL_PINMODE_OPENDRAIN.
+ */
+template <uint8_t Port, uint8_t Pin, uint8_t Func, uint8_t Mode, uint8_t OpenDrain = PINSEL_PINMODE_NORMAL>
+struct PIN_MAP_Pin
+{
+    static_assert(PIN_MAP_PinExists(Port, Pin), "el pin no existe en el LPC1769");
+    static_assert(Func <= PINSEL_FUNC_3, "funcion fuera de rango");
+    static_assert(Mode <= PINSEL_PINMODE_PULLDOWN, "modo fuera de rango");
+    static_assert(OpenDrain <= PINSEL_PINMODE_OPENDRAIN, "modo de drenador abierto fuera de rango");
+
+    static constexpr PIN_MAP_Cfg_Type Cfg = {Port, Pin, Func, Mode, OpenDrain}; /**< Configuracion del pin */
+};
+
+/**
+ * @brief Escribe una palabra de la imagen.
+ *
+ * @tparam Address Direccion del registro.
+ * @tparam Value Valor de los bits que fija el mapa.
+ * @tparam Mask Bits que fija el mapa (0: no se toca el registro).
+ */
+template <uintptr_t Address, uint32_t Value, uint32_t Mask>
+PIN_MAP_INLINE void PIN_MAP_Write()
+{
+    if constexpr (Mask == 0xFFFFFFFFUL)
+    {
+        *reinterpret_cast<volatile uint32_t*>(Address) = Value;
+    }
+    else if constexpr (Mask != 0)
+    {
+        volatile uint32_t* reg = reinterpret_cast<volatile uint32_t*>(Address);
+
+        *reg = (*reg & ~Mask) | Value;
+    }
+}
+
+/**
+ * @brief Mapa de pines: la lista de PIN_MAP_Pin de la placa.
+ *
+ * @tparam Pins Pines del mapa (PIN_MAP_Pin), en cualquier orden.
+ */
+template <typename... Pins>
+struct PIN_MAP_Table
+{
+    static_assert(sizeof...(Pins) > 0, "mapa de pines vacio");
+
+    static constexpr size_t Count = sizeof...(Pins);              /**< Cantidad de pines */
+    static constexpr PIN_MAP_Cfg_Type Cfgs[Count] = {Pins::Cfg...}; /**< Configuracion de cada pin */
+
+    /**
+     * @brief Indica si algun pin aparece dos veces con configuraciones distintas.
+     */
+    static constexpr bool HasConflict()
+    {
+        for (size_t i = 0; i < Count; i++)
+        {
+            for (size_t j = i + 1; j < Count; j++)
+            {
+                const PIN_MAP_Cfg_Type& a = Cfgs[i];
+                const PIN_MAP_Cfg_Type& b = Cfgs[j];
+
+                if (a.Portnum == b.Portnum && a.Pinnum == b.Pinnum &&
+                    (a.Funcnum != b.Funcnum || a.Pinmode != b.Pinmode || a.OpenDrain != b.OpenDrain))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    static_assert(!HasConflict(), "un pin del mapa tiene dos configuraciones distintas");
+
+    /**
+     * @brief Funde las configuraciones de los pines en la imagen de los registros.
+     */
+    static constexpr PIN_MAP_Image_Type Build()
+    {
+        PIN_MAP_Image_Type image = {};
+
+        for (size_t i = 0; i < Count; i++)
+        {
+            const PIN_MAP_Cfg_Type& cfg = Cfgs[i];
+            // Dos bits por pin en PINSEL y PINMODE: dos palabras por puerto, de 16 pines cada una.
+            uint32_t word = 2 * cfg.Portnum + cfg.Pinnum / 16;
+            uint32_t shift = 2 * (cfg.Pinnum % 16);
+
+            image.Pinsel[word] |= (uint32_t)cfg.Funcnum << shift;
+            image.Pinsel_Mask[word] |= 3UL << shift;
+            image.Pinmode[word] |= (uint32_t)cfg.Pinmode << shift;
+            image.Pinmode_Mask[word] |= 3UL << shift;
+            image.Od[cfg.Portnum] |= (uint32_t)cfg.OpenDrain << cfg.Pinnum;
+            image.Od_Mask[cfg.Portnum] |= 1UL << cfg.Pinnum;
+        }
+
+        return image;
+    }
+
+    static constexpr PIN_MAP_Image_Type Image = Build(); /**< Imagen de los registros */
+
+    /**
+     * @brief Escribe la imagen en el PINCON, palabra por palabra.
+     */
+    static void Apply()
+    {
+        ApplyWords(std::make_index_sequence<PIN_MAP_PINSEL_WORDS>(), std::make_index_sequence<PIN_MAP_OD_WORDS>());
+    }
+
+private:
+    /**
+     * @brief Escribe las palabras de PINSEL y PINMODE (indices P) y de PINMODE_OD (indices D).
+     */
+    template <size_t... P, size_t... D>
+    PIN_MAP_INLINE void ApplyWords(std::index_sequence<P...>, std::index_sequence<D...>)
+    {
+        (PIN_MAP_Write<LPC_PINCON_BASE + offsetof(LPC_PINCON_TypeDef, PINSEL0) + 4 * P, Image.Pinsel[P],
+                       Image.Pinsel_Mask[P]>(),
+         ...);
+        (PIN_MAP_Write<LPC_PINCON_BASE + offsetof(LPC_PINCON_TypeDef, PINMODE0) + 4 * P, Image.Pinmode[P],
+                       Image.Pinmode_Mask[P]>(),
+         ...);
+        (PIN_MAP_Write<LPC_PINCON_BASE + offsetof(LPC_PINCON_TypeDef, PINMODE_OD0) + 4 * D, Image.Od[D],
+                       Image.Od_Mask[D]>(),
+         ...);
+    }
+};
+
+#endif /* PIN_MAP_HPP */
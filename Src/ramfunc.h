@@ -0,0 +1,30 @@
+/**
+ * @file ramfunc.h
+ * @brief Funciones que se ejecutan desde la SRAM local en lugar de la flash.
+ *
+ * La flash del LPC1769 tarda 4 ciclos de CCLK por acceso (FLASHCFG de system_LPC17xx.c); el acelerador los oculta
+ * en el codigo lineal pero no en los saltos, que abundan en los handlers compilados con -O0. La SRAM local de 32 KB
+ * (0x10000000) esta en la region de codigo del Cortex-M3 y responde sin espera por el bus I-Code.
+ *
+ * Una funcion marcada con RAMFUNC va a la seccion .ramfunc, que lpc17xx.ld ubica en la SRAM detras de .data y
+ * carga en la flash detras de sus valores iniciales; Reset_Handler (startup_LPC17xx.c) la copia junto con .data,
+ * antes de SystemInit(). Las llamadas entre la SRAM y la flash quedan fuera del alcance de BL y el enlazador
+ * agrega los saltos largos: conviene marcar tambien las funciones que el handler llama en cada ejecucion.
+ *
+ * La seccion se llama igual que la de __RAMFUNC de cr_section_macros.h: los scripts que genera MCUXpresso tambien la
+ * copian con .data.
+ *
+ * Con make NO_RAMFUNC=1 todo queda en la flash, para comparar la duracion de los handlers con ISR_PROFILE. En el
+ * simulador y en las herramientas del host la macro queda vacia.
+ */
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#if defined(__arm__) && !defined(NO_RAMFUNC)
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline)) /**< Ejecuta la funcion desde la SRAM local */
+#else
+#define RAMFUNC /**< Sin reubicacion: la funcion queda en .text */
+#endif
+
+#endif /* RAMFUNC_H */
@@ -0,0 +1,111 @@
+/**
+ * @file ring_buffer.c
+ * @brief Buffer circular sin bloqueos para un productor y un consumidor (SPSC).
+ *
+ * Los indices Head y Tail se incrementan sin limite y se reducen con la mascara solo al acceder al
+ * almacenamiento. La diferencia Head - Tail es la cantidad de bytes ocupados aun despues del desborde de los
+ * enteros de 32 bits, por lo que no hace falta reservar una posicion vacia.
+ */
+
+#include "ring_buffer.h"
+
+#include "ramfunc.h"
+
+Status RING_Init(RING_Buffer_Type* ring, uint8_t* storage, uint32_t size)
+{
+    if (size == 0 || (size & (size - 1)) != 0)
+    {
+        return ERROR;
+    }
+
+    ring->Buffer = storage;
+    ring->Mask = size - 1;
+    ring->Head = 0;
+    ring->Tail = 0;
+
+    return SUCCESS;
+}
+
+uint32_t RING_Count(const RING_Buffer_Type* ring)
+{
+    return ring->Head - ring->Tail;
+}
+
+uint32_t RING_Free(const RING_Buffer_Type* ring)
+{
+    return (ring->Mask + 1) - (ring->Head - ring->Tail);
+}
+
+RAMFUNC Bool RING_Put(RING_Buffer_Type* ring, uint8_t value)
+{
+    uint32_t head = ring->Head;
+
+    if ((head - ring->Tail) > ring->Mask)
+    {
+        return FALSE;
+    }
+
+    ring->Buffer[head & ring->Mask] = value;
+    RING_BARRIER(); // El dato debe quedar escrito antes de publicar el indice
+    ring->Head = head + 1;
+
+    return TRUE;
+}
+
+Bool RING_Get(RING_Buffer_Type* ring, uint8_t* value)
+{
+    uint32_t tail = ring->Tail;
+
+    if (ring->Head == tail)
+    {
+        return FALSE;
+    }
+
+    *value = ring->Buffer[tail & ring->Mask];
+    RING_BARRIER(); // El dato debe quedar leido antes de liberar la posicion
+    ring->Tail = tail + 1;
+
+    return TRUE;
+}
+
+uint32_t RING_Write(RING_Buffer_Type* ring, const uint8_t* data, uint32_t length)
+{
+    uint32_t head = ring->Head;
+    uint32_t space = (ring->Mask + 1) - (head - ring->Tail);
+
+    if (length > space)
+    {
+        length = space;
+    }
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        ring->Buffer[(head + i) & ring->Mask] = data[i];
+    }
+
+    RING_BARRIER();
+    ring->Head = head + length;
+
+    return length;
+}
+
+RAMFUNC uint32_t RING_Read(RING_Buffer_Type* ring, uint8_t* data, uint32_t length)
+{
+    uint32_t tail = ring->Tail;
+    uint32_t count = ring->Head - tail;
+
+    if (length > count)
+    {
+        length = count;
+    }
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        data[i] = ring->Buffer[(tail + i) & ring->Mask];
+    }
+
+    RING_BARRIER();
+    ring->Tail = tail + length;
+
+    return length;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file ring_buffer.h
+ * @brief Buffer circular sin bloqueos para un productor y un consumidor (SPSC).
+ *
+ * Pensado para compartir datos entre una interrupcion y el bucle principal sin deshabilitar interrupciones:
+ * el productor solo escribe la cabeza (head) y el consumidor solo escribe la cola (tail). Ambos indices corren
+ * libremente y se reducen con una mascara, por lo que el tamaño debe ser potencia de dos.
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "lpc_types.h"
+
+/**
+ * @brief Barrera de compilador.
+ *
+ * Asegura que los datos se escriban en el buffer antes de publicar el nuevo indice. En el Cortex-M3 (un solo
+ * nucleo, sin cache de datos) no hace falta una barrera de hardware.
+ */
+#define RING_BARRIER() __asm volatile("" ::: "memory")
+
+/**
+ * @brief Estructura de control del buffer circular.
+ */
+typedef struct
+{
+    uint8_t* Buffer;        /**< Almacenamiento provisto por el usuario */
+    uint32_t Mask;          /**< Tamaño del almacenamiento menos uno */
+    volatile uint32_t Head; /**< Indice de escritura, solo lo modifica el productor */
+    volatile uint32_t Tail; /**< Indice de lectura, solo lo modifica el consumidor */
+} RING_Buffer_Type;
+
+/**
+ * @brief Inicializa un buffer circular sobre un almacenamiento dado.
+ *
+ * @param ring Buffer a inicializar.
+ * @param storage Arreglo de bytes a usar como almacenamiento.
+ * @param size Tamaño del arreglo, debe ser potencia de dos.
+ * @return SUCCESS si se inicializo, ERROR si el tamaño no es potencia de dos.
+ */
+Status RING_Init(RING_Buffer_Type* ring, uint8_t* storage, uint32_t size);
+
+/**
+ * @brief Devuelve la cantidad de bytes almacenados.
+ *
+ * @param ring Buffer a consultar.
+ * @return Bytes disponibles para leer.
+ */
+uint32_t RING_Count(const RING_Buffer_Type* ring);
+
+/**
+ * @brief Devuelve el espacio libre.
+ *
+ * @param ring Buffer a consultar.
+ * @return Bytes que se pueden escribir.
+ */
+uint32_t RING_Free(const RING_Buffer_Type* ring);
+
+/**
+ * @brief Agrega un byte (lado productor).
+ *
+ * @param ring Buffer destino.
+ * @param value Byte a agregar.
+ * @return TRUE si se agrego, FALSE si el buffer estaba lleno.
+ */
+Bool RING_Put(RING_Buffer_Type* ring, uint8_t value);
+
+/**
+ * @brief Extrae un byte (lado consumidor).
+ *
+ * @param ring Buffer origen.
+ * @param value Donde se guarda el byte extraido.
+ * @return TRUE si se extrajo, FALSE si el buffer estaba vacio.
+ */
+Bool RING_Get(RING_Buffer_Type* ring, uint8_t* value);
+
+/**
+ * @brief Agrega un bloque de bytes (lado productor).
+ *
+ * Escribe tantos bytes como entren y publica el indice una sola vez.
+ *
+ * @param ring Buffer destino.
+ * @param data Datos a agregar.
+ * @param length Cantidad de bytes pedida.
+ * @return Cantidad de bytes efectivamente agregados.
+ */
+uint32_t RING_Write(RING_Buffer_Type* ring, const uint8_t* data, uint32_t length);
+
+/**
+ * @brief Extrae un bloque de bytes (lado consumidor).
+ *
+ * Lee tantos bytes como haya disponibles y libera las posiciones una sola vez.
+ *
+ * @param ring Buffer origen.
+ * @param data Donde se guardan los bytes extraidos.
+ * @param length Cantidad maxima de bytes a extraer.
+ * @return Cantidad de bytes efectivamente extraidos.
+ */
+uint32_t RING_Read(RING_Buffer_Type* ring, uint8_t* data, uint32_t length);
+
+#endif /* RING_BUFFER_H */
@@ -0,0 +1,275 @@
+/**
+ * @file scheduler.c
+ * @brief Planificador cooperativo de tareas periodicas sin tick fijo, sobre el match 0 del TIMER2.
+ *
+ * Los tiempos son instantes del TC en microsegundos y se comparan por la diferencia con signo de 32 bits, asi que
+ * la vuelta del contador (cada 71 minutos) no afecta mientras los periodos no superen SCHED_MAX_PERIOD_MS.
+ *
+ * Todo el estado de las tareas se usa solo desde el bucle principal; la interrupcion solo limpia su bandera y avisa.
+ * Escribir el MR0 con un instante que el TC ya paso no genera el match hasta la vuelta del contador, por eso despues
+ * de reprogramarlo se relee el tiempo y un vencimiento inminente se atiende sin esperar la interrupcion.
+ */
+
+#include "scheduler.h"
+
+#include "LPC17xx.h"
+#include "lpc17xx_timer.h"
+#include "text_fmt.h"
+
+#define SCHED_US_PER_MS 1000 /**< Cuentas del TC por milisegundo */
+
+/**
+ * @brief Tarea registrada.
+ */
+typedef struct
+{
+    const char* Name;       /**< Nombre para el reporte (NULL si no hay tarea) */
+    SCHED_Task Task;        /**< Funcion de la tarea */
+    uint32_t Period_Us;     /**< Periodo */
+    uint32_t Deadline_Us;   /**< Plazo desde cada liberacion */
+    uint32_t Release;       /**< Proxima liberacion */
+    SCHED_Stats_Type Stats; /**< Estadisticas */
+} SCHED_Entry_Type;
+
+static SCHED_Entry_Type Tasks[SCHED_MAX_TASKS]; /**< Tareas, por identificador */
+static SCHED_Callback Wakeup = NULL;            /**< Aviso de vencimiento */
+static Bool Started = FALSE;                    /**< El TIMER2 ya arranco */
+static Bool Dispatching = FALSE;                /**< SCHED_Dispatch() en curso (una tarea llama al modulo) */
+
+/**
+ * @brief Diferencia con signo entre dos instantes (positiva si a es posterior a b).
+ */
+static int32_t SCHED_Diff(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b);
+}
+
+/**
+ * @brief Ejecuta una tarea vencida y calcula su proxima liberacion.
+ */
+static void SCHED_Run(SCHED_Entry_Type* entry, uint32_t start)
+{
+    uint32_t jitter = start - entry->Release;
+    uint32_t end;
+
+    entry->Task();
+    end = SCHED_Now();
+
+    entry->Stats.Runs++;
+    if (jitter > entry->Stats.Max_Jitter_Us)
+    {
+        entry->Stats.Max_Jitter_Us = jitter;
+    }
+    if (end - start > entry->Stats.Max_Run_Us)
+    {
+        entry->Stats.Max_Run_Us = end - start;
+    }
+    if (end - entry->Release > entry->Deadline_Us)
+    {
+        entry->Stats.Misses++;
+    }
+
+    // Liberaciones sin deriva; si la tarea se atraso mas de un periodo, las que quedaron atras se saltean.
+    entry->Release += entry->Period_Us;
+    while (SCHED_Diff(end, entry->Release) >= (int32_t)entry->Period_Us)
+    {
+        entry->Release += entry->Period_Us;
+        entry->Stats.Misses++;
+    }
+}
+
+void SCHED_Init(SCHED_Callback callback)
+{
+    TIM_TIMERCFG_Type TimerCfg;
+    TIM_MATCHCFG_Type MatchCfg;
+
+    for (uint8_t id = 0; id < SCHED_MAX_TASKS; id++)
+    {
+        Tasks[id] = (SCHED_Entry_Type){0};
+    }
+    Wakeup = callback;
+    Started = FALSE;
+
+    // TIMER2 con una cuenta por microsegundo, libre: da la vuelta en 2^32 us.
+    TimerCfg.PrescaleOption = TIM_PRESCALE_USVAL;
+    TimerCfg.PrescaleValue = 1;
+    TIM_Init(LPC_TIM2, TIM_TIMER_MODE, &TimerCfg);
+
+    // Match 0: solo interrumpe; el planificador lo mueve al proximo vencimiento.
+    MatchCfg.MatchChannel = 0;
+    MatchCfg.IntOnMatch = ENABLE;
+    MatchCfg.ResetOnMatch = DISABLE;
+    MatchCfg.StopOnMatch = DISABLE;
+    MatchCfg.ExtMatchOutputType = TIM_EXTMATCH_NOTHING;
+    MatchCfg.MatchValue = 0xFFFFFFFF;
+    TIM_ConfigMatch(LPC_TIM2, &MatchCfg);
+
+    NVIC_EnableIRQ(TIMER2_IRQn);
+}
+
+Status SCHED_Register(uint8_t id, const char* name, SCHED_Task task, uint32_t period_ms, uint32_t deadline_ms)
+{
+    SCHED_Entry_Type* entry;
+
+    if (id >= SCHED_MAX_TASKS || name == NULL || task == NULL || period_ms == 0 || period_ms > SCHED_MAX_PERIOD_MS ||
+        deadline_ms > SCHED_MAX_PERIOD_MS)
+    {
+        return ERROR;
+    }
+
+    entry = &Tasks[id];
+    entry->Name = name;
+    entry->Task = task;
+    entry->Period_Us = period_ms * SCHED_US_PER_MS;
+    entry->Deadline_Us = ((deadline_ms == 0) ? period_ms : deadline_ms) * SCHED_US_PER_MS;
+    entry->Release = SCHED_Now() + entry->Period_Us;
+    entry->Stats = (SCHED_Stats_Type){0};
+
+    // Con el planificador en marcha, el match puede estar programado mas lejos que esta liberacion (dentro de una
+    // tarea lo reprograma la pasada en curso).
+    if (Started == TRUE && Dispatching == FALSE)
+    {
+        SCHED_Dispatch();
+    }
+
+    return SUCCESS;
+}
+
+Status SCHED_SetPeriod(uint8_t id, uint32_t period_ms)
+{
+    SCHED_Entry_Type* entry;
+    uint32_t last;
+
+    if (id >= SCHED_MAX_TASKS || Tasks[id].Name == NULL || period_ms == 0 || period_ms > SCHED_MAX_PERIOD_MS)
+    {
+        return ERROR;
+    }
+
+    entry = &Tasks[id];
+    last = entry->Release - entry->Period_Us;
+    entry->Period_Us = period_ms * SCHED_US_PER_MS;
+    entry->Release = last + entry->Period_Us;
+    if (SCHED_Diff(entry->Release, SCHED_Now()) < 0)
+    {
+        entry->Release = SCHED_Now();
+    }
+
+    if (Started == TRUE && Dispatching == FALSE)
+    {
+        SCHED_Dispatch();
+    }
+
+    return SUCCESS;
+}
+
+uint32_t SCHED_GetPeriod(uint8_t id)
+{
+    if (id >= SCHED_MAX_TASKS || Tasks[id].Name == NULL)
+    {
+        return 0;
+    }
+
+    return Tasks[id].Period_Us / SCHED_US_PER_MS;
+}
+
+void SCHED_Start(void)
+{
+    // Las liberaciones se registraron con el timer detenido en cero: el primer periodo empieza ahora.
+    Started = TRUE;
+    TIM_Cmd(LPC_TIM2, ENABLE);
+    SCHED_Dispatch();
+}
+
+void SCHED_Dispatch(void)
+{
+    uint32_t now;
+    uint32_t next;
+    Bool found;
+
+    Dispatching = TRUE;
+    do
+    {
+        for (uint8_t id = 0; id < SCHED_MAX_TASKS; id++)
+        {
+            now = SCHED_Now();
+            if (Tasks[id].Name != NULL && SCHED_Diff(now, Tasks[id].Release) >= 0)
+            {
+                SCHED_Run(&Tasks[id], now);
+            }
+        }
+
+        // Proximo vencimiento: el mas cercano de las tareas, o media vuelta del contador si no hay ninguna.
+        now = SCHED_Now();
+        next = now + INT32_MAX;
+        found = FALSE;
+        for (uint8_t id = 0; id < SCHED_MAX_TASKS; id++)
+        {
+            if (Tasks[id].Name != NULL && (found == FALSE || SCHED_Diff(Tasks[id].Release, next) < 0))
+            {
+                next = Tasks[id].Release;
+                found = TRUE;
+            }
+        }
+
+        TIM_UpdateMatchValue(LPC_TIM2, 0, next);
+    } while (found == TRUE && SCHED_Diff(next, SCHED_Now()) <= SCHED_MARGIN_US);
+    Dispatching = FALSE;
+}
+
+uint32_t SCHED_Now(void)
+{
+    return LPC_TIM2->TC;
+}
+
+void SCHED_GetStats(uint8_t id, SCHED_Stats_Type* stats)
+{
+    if (id >= SCHED_MAX_TASKS || Tasks[id].Name == NULL)
+    {
+        *stats = (SCHED_Stats_Type){0};
+        return;
+    }
+
+    *stats = Tasks[id].Stats;
+}
+
+uint32_t SCHED_Format(char* line, uint8_t id)
+{
+    const SCHED_Entry_Type* entry;
+    uint32_t pos = 0;
+
+    if (id >= SCHED_MAX_TASKS || Tasks[id].Name == NULL)
+    {
+        line[0] = '\0';
+        return 0;
+    }
+    entry = &Tasks[id];
+
+    pos = TEXT_FMT_PutText(line, pos, "SCHED ");
+    pos = TEXT_FMT_PutText(line, pos, entry->Name);
+    pos = TEXT_FMT_PutText(line, pos, " T=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Period_Us / SCHED_US_PER_MS);
+    pos = TEXT_FMT_PutText(line, pos, " D=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Deadline_Us / SCHED_US_PER_MS);
+    pos = TEXT_FMT_PutText(line, pos, " n=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Stats.Runs);
+    pos = TEXT_FMT_PutText(line, pos, " miss=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Stats.Misses);
+    pos = TEXT_FMT_PutText(line, pos, " jit=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Stats.Max_Jitter_Us);
+    pos = TEXT_FMT_PutText(line, pos, " run=");
+    pos = TEXT_FMT_PutNumber(line, pos, entry->Stats.Max_Run_Us);
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+    line[pos] = '\0';
+
+    return pos;
+}
+
+void SCHED_IRQHandler(void)
+{
+    TIM_ClearIntPending(LPC_TIM2, TIM_MR0_INT);
+
+    if (Wakeup != NULL)
+    {
+        Wakeup();
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file scheduler.h
+ * @brief Planificador cooperativo de tareas periodicas sin tick fijo, sobre el match 0 del TIMER2.
+ *
+ * El TIMER2 cuenta microsegundos libremente (sin reset en el match) y en cada pasada el MR0 se reprograma con el
+ * proximo vencimiento, asi que el timer solo interrumpe cuando hay una tarea para correr. La interrupcion avisa al
+ * bucle principal (callback, tipicamente un evento) y SCHED_Dispatch() ejecuta ahi las tareas vencidas por orden de
+ * identificador, cada una hasta terminar: ninguna interrumpe a otra. Es el TIMER2 porque los match del TIMER0 y del
+ * TIMER1 son los unicos que pueden iniciar conversiones del ADC (disparo de adc_pipeline.h y pasos del motor).
+ *
+ * Cada tarea tiene su periodo, modificable en ejecucion, y un plazo relativo a su liberacion. Las liberaciones
+ * avanzan de a un periodo desde la anterior, sin deriva; si una tarea se atrasa mas de un periodo, las liberaciones
+ * que quedaron atras se saltean. Por tarea se cuentan las ejecuciones, las perdidas de plazo (un fin despues del
+ * plazo o una liberacion salteada) y el peor jitter (atraso del inicio respecto de la liberacion).
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define SCHED_MAX_TASKS     8      /**< Tareas maximas */
+#define SCHED_MAX_PERIOD_MS 600000 /**< Periodo maximo (los tiempos se comparan en 31 bits de microsegundos) */
+#define SCHED_MARGIN_US     20     /**< Un vencimiento mas cercano que esto se atiende sin esperar el match */
+#define SCHED_LINE_SIZE     96     /**< Tamaño maximo de una linea del reporte */
+#define SCHED_REPORT_CMD    'S'    /**< Byte recibido por UART2 que pide el envio de las estadisticas */
+
+/**
+ * @brief Tarea periodica; se ejecuta en el bucle principal.
+ */
+typedef void (*SCHED_Task)(void);
+
+/**
+ * @brief Aviso de vencimiento, invocado desde la interrupcion del TIMER2.
+ */
+typedef void (*SCHED_Callback)(void);
+
+/**
+ * @brief Estadisticas de una tarea.
+ */
+typedef struct
+{
+    uint32_t Runs;          /**< Ejecuciones */
+    uint32_t Misses;        /**< Ejecuciones terminadas despues del plazo y liberaciones salteadas */
+    uint32_t Max_Jitter_Us; /**< Mayor atraso del inicio respecto de la liberacion */
+    uint32_t Max_Run_Us;    /**< Mayor duracion de una ejecucion */
+} SCHED_Stats_Type;
+
+/**
+ * @brief Configura el TIMER2 (1 us por cuenta, interrupcion en MR0 sin reset) y borra las tareas.
+ *
+ * El timer queda detenido hasta SCHED_Start().
+ *
+ * @param callback Funcion a llamar desde la interrupcion cuando vence una tarea (no puede ser NULL).
+ */
+void SCHED_Init(SCHED_Callback callback);
+
+/**
+ * @brief Registra una tarea; su primera liberacion es un periodo despues del arranque (o de ahora, si ya arranco).
+ *
+ * @param id Identificador (menor a SCHED_MAX_TASKS); a igual vencimiento corre antes el menor.
+ * @param name Nombre para el reporte (debe seguir existiendo).
+ * @param task Funcion de la tarea.
+ * @param period_ms Periodo (1 a SCHED_MAX_PERIOD_MS).
+ * @param deadline_ms Plazo desde cada liberacion hasta el fin de la ejecucion (0: el periodo).
+ * @return SUCCESS, o ERROR si algun parametro es invalido.
+ */
+Status SCHED_Register(uint8_t id, const char* name, SCHED_Task task, uint32_t period_ms, uint32_t deadline_ms);
+
+/**
+ * @brief Cambia el periodo de una tarea desde su proxima liberacion.
+ *
+ * La proxima liberacion queda un periodo nuevo despues de la ultima (o ahora, si eso ya paso). Se llama desde el
+ * bucle principal.
+ *
+ * @param id Identificador de la tarea.
+ * @param period_ms Periodo nuevo (1 a SCHED_MAX_PERIOD_MS).
+ * @return SUCCESS, o ERROR si la tarea no existe o el periodo es invalido.
+ */
+Status SCHED_SetPeriod(uint8_t id, uint32_t period_ms);
+
+/**
+ * @brief Periodo actual de una tarea, en ms (0 si no existe).
+ */
+uint32_t SCHED_GetPeriod(uint8_t id);
+
+/**
+ * @brief Arranca el TIMER2 y programa el primer vencimiento.
+ */
+void SCHED_Start(void);
+
+/**
+ * @brief Ejecuta las tareas vencidas y reprograma el match con el proximo vencimiento.
+ *
+ * Se llama desde el bucle principal cada vez que avisa el callback. Si el proximo vencimiento ya esta a menos de
+ * SCHED_MARGIN_US, se atiende en la misma llamada.
+ */
+void SCHED_Dispatch(void);
+
+/**
+ * @brief Tiempo del planificador, en microsegundos (da la vuelta cada 2^32 us).
+ */
+uint32_t SCHED_Now(void);
+
+/**
+ * @brief Copia las estadisticas de una tarea (en cero si no existe).
+ *
+ * @param id Identificador de la tarea.
+ * @param stats Estructura a completar.
+ */
+void SCHED_GetStats(uint8_t id, SCHED_Stats_Type* stats);
+
+/**
+ * @brief Arma la linea del reporte de una tarea.
+ *
+ * Formato: "SCHED <nombre> T=<ms> D=<ms> n=<ejecuciones> miss=<> jit=<us> run=<us>\r\n".
+ *
+ * @param line Donde se arma la linea (SCHED_LINE_SIZE bytes).
+ * @param id Identificador de la tarea.
+ * @return Cantidad de caracteres escritos sin el terminador, o 0 si la tarea no existe.
+ */
+uint32_t SCHED_Format(char* line, uint8_t id);
+
+/**
+ * @brief Atiende la interrupcion del TIMER2. Debe llamarse desde TIMER2_IRQHandler.
+ */
+void SCHED_IRQHandler(void);
+
+#endif /* SCHEDULER_H */
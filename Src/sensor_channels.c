@@ -0,0 +1,155 @@
+/**
+ * @file sensor_channels.c
+ * @brief Tabla de canales de sensores: de ella salen los pines, la mascara del ADC, el bloque del GPDMA, la
+ *        calibracion, las alarmas y la carga de telemetria.
+ */
+
+#include "sensor_channels.h"
+
+#include "adc_pipeline.h"
+#include "lpc17xx_pinsel.h"
+#include "telemetry.h"
+
+#if SENSOR_MAX_CHANNELS != ADC_PIPE_MAX_CHANNELS || SENSOR_MAX_CHANNELS > TELEMETRY_MEASURE_CHANNELS
+#error "La tabla de sensores tiene que cubrir las entradas del ADC y caber en la carga de telemetria"
+#endif
+
+#if TELEMETRY_MEASURES_MAX > TELEMETRY_MAX_PAYLOAD
+#error "La carga de mediciones no entra en una trama de telemetria"
+#endif
+
+/**
+ * @brief Pin de una entrada del ADC.
+ */
+typedef struct
+{
+    uint8_t Port;     /**< Puerto */
+    uint8_t Pin;      /**< Pin */
+    uint8_t Function; /**< Funcion del PINSEL que lo conecta al ADC */
+} SENSOR_Pin_Type;
+
+/** Pin de cada entrada del ADC del LPC1769 (AD0.0 a AD0.7) */
+static const SENSOR_Pin_Type SENSOR_Pins[SENSOR_MAX_CHANNELS] = {
+    {PINSEL_PORT_0, PINSEL_PIN_23, PINSEL_FUNC_1}, {PINSEL_PORT_0, PINSEL_PIN_24, PINSEL_FUNC_1},
+    {PINSEL_PORT_0, PINSEL_PIN_25, PINSEL_FUNC_1}, {PINSEL_PORT_0, PINSEL_PIN_26, PINSEL_FUNC_1},
+    {PINSEL_PORT_1, PINSEL_PIN_30, PINSEL_FUNC_3}, {PINSEL_PORT_1, PINSEL_PIN_31, PINSEL_FUNC_3},
+    {PINSEL_PORT_0, PINSEL_PIN_3, PINSEL_FUNC_2},  {PINSEL_PORT_0, PINSEL_PIN_2, PINSEL_FUNC_2},
+};
+
+static const SENSOR_Channel_Type* Table = NULL; /**< Canales */
+static uint8_t Count = 0;                       /**< Cantidad de canales */
+static uint8_t Mask = 0;                        /**< Entradas del ADC de la tabla */
+static ALARM_Rule_Type Rules[ALARM_MAX_RULES];  /**< Reglas de todos los canales, con Channel en la posicion */
+static uint8_t Rule_Count = 0;                  /**< Cantidad de reglas */
+
+/**
+ * @brief Agrega a Rules las reglas de la tabla inmediatas o no, en el orden de la tabla.
+ */
+static void SENSOR_AddRules(const SENSOR_Channel_Type* table, uint8_t count, Bool immediate)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        for (uint8_t r = 0; r < table[i].Alarm_Count; r++)
+        {
+            if (table[i].Alarms[r].Immediate == immediate)
+            {
+                Rules[Rule_Count] = table[i].Alarms[r];
+                Rules[Rule_Count++].Channel = i;
+            }
+        }
+    }
+}
+
+Status SENSOR_Init(const SENSOR_Channel_Type* table, uint8_t count)
+{
+    uint8_t mask = 0;
+    uint32_t rules = 0;
+
+    if (count == 0 || count > SENSOR_MAX_CHANNELS)
+    {
+        return ERROR;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (table[i].Adc_Channel >= SENSOR_MAX_CHANNELS || (mask & (1 << table[i].Adc_Channel)) ||
+            (SENSOR_RESERVED & (1 << table[i].Adc_Channel)) || table[i].Calib >= CALIB_CHANNELS ||
+            table[i].Output > SENSOR_DECIMATED || (table[i].Alarms == NULL && table[i].Alarm_Count != 0))
+        {
+            return ERROR;
+        }
+        mask |= (uint8_t)(1 << table[i].Adc_Channel);
+        rules += table[i].Alarm_Count;
+    }
+    if (rules > ALARM_MAX_RULES)
+    {
+        return ERROR;
+    }
+
+    Table = table;
+    Count = count;
+    Mask = mask;
+    Rule_Count = 0;
+    SENSOR_AddRules(table, count, TRUE);
+    SENSOR_AddRules(table, count, FALSE);
+
+    return SUCCESS;
+}
+
+void SENSOR_ConfigPins(void)
+{
+    PINSEL_CFG_Type Pincfg;
+    const SENSOR_Pin_Type* pin;
+
+    Pincfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+    for (uint8_t i = 0; i < Count; i++)
+    {
+        pin = &SENSOR_Pins[Table[i].Adc_Channel];
+        Pincfg.Portnum = pin->Port;
+        Pincfg.Pinnum = pin->Pin;
+        Pincfg.Funcnum = pin->Function;
+        Pincfg.Pinmode = Table[i].Pin_Mode;
+        PINSEL_ConfigPin(&Pincfg);
+    }
+}
+
+uint8_t SENSOR_GetMask(void)
+{
+    return Mask;
+}
+
+uint8_t SENSOR_GetCount(void)
+{
+    return Count;
+}
+
+Status SENSOR_InitAlarms(uint32_t min_interval_ms)
+{
+    return ALARM_Init(Rules, Rule_Count, min_interval_ms);
+}
+
+uint8_t SENSOR_Read(uint8_t index)
+{
+    uint16_t value;
+
+    if (index >= Count)
+    {
+        return 0;
+    }
+
+    switch (Table[index].Output)
+    {
+        case SENSOR_MEDIAN:
+            value = ADC_PIPE_GetMedian(Table[index].Adc_Channel);
+            break;
+        case SENSOR_DECIMATED:
+            value = ADC_PIPE_GetValue(Table[index].Adc_Channel);
+            break;
+        default:
+            value = ADC_PIPE_GetSmoothed(Table[index].Adc_Channel);
+            break;
+    }
+
+    // La calibracion recibe la lectura como fraccion Q15 de VREF:
+    return CALIB_Convert(Table[index].Calib, (q15_t)(value << (15 - ADC_PIPE_RESOLUTION)));
+}
@@ -0,0 +1,103 @@
+/**
+ * @file sensor_channels.h
+ * @brief Tabla de canales de sensores: de ella salen los pines, la mascara del ADC, el bloque del GPDMA, la
+ *        calibracion, las alarmas y la carga de telemetria.
+ *
+ * Cada entrada describe un sensor conectado a una entrada del ADC (AD0.0 a AD0.7): la resistencia del pin, la
+ * curva de calibracion, la salida de la etapa de filtros que se calibra y sus reglas de alarma. El pin y su funcion
+ * salen de la entrada del ADC (cada una tiene un solo pin posible en el LPC1769), de modo que agregar un sensor es
+ * agregar una linea a la tabla:
+ *
+ * - SENSOR_ConfigPins() configura el PINSEL de cada entrada.
+ * - SENSOR_GetMask() da los canales a habilitar en el ADC y a adquirir con ADC_PIPE_Init(), que dimensiona el
+ *   bloque del GPDMA (ADC_PIPE_SAMPLES palabras por canal).
+ * - SENSOR_Read() convierte la salida filtrada de un canal con su curva.
+ * - SENSOR_InitAlarms() arma la tabla del motor de alarmas con las reglas de todos los canales.
+ * - La posicion en la tabla es el indice de la medicion en la carga de telemetria (TELEMETRY_TYPE_MEASURES) y en
+ *   las reglas de alarma.
+ *
+ * Las reglas inmediatas (por ejemplo, gas) van primero, porque son las que no pueden esperar; el resto sigue el
+ * orden de la tabla.
+ */
+
+#ifndef SENSOR_CHANNELS_H
+#define SENSOR_CHANNELS_H
+
+#include "alarm.h"
+#include "calibration.h"
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define SENSOR_MAX_CHANNELS 8        /**< Entradas del ADC */
+#define SENSOR_RESERVED     (1 << 3) /**< Entradas ocupadas: AD0.3 esta en P0.26, la salida del DAC */
+
+/**
+ * @brief Salida de la etapa de filtros que se calibra.
+ */
+typedef enum
+{
+    SENSOR_SMOOTHED,  /**< Mediana y media exponencial: la de las decisiones (ADC_PIPE_GetSmoothed) */
+    SENSOR_MEDIAN,    /**< Solo la mediana: sigue los cambios bruscos sin retardo (ADC_PIPE_GetMedian) */
+    SENSOR_DECIMATED  /**< El promedio del ultimo bloque, sin filtrar (ADC_PIPE_GetValue) */
+} SENSOR_Output_Type;
+
+/**
+ * @brief Descriptor de un canal de sensor.
+ */
+typedef struct
+{
+    uint8_t Adc_Channel;           /**< Entrada del ADC (AD0.n); define el pin */
+    uint8_t Pin_Mode;              /**< Resistencia del pin (PINSEL_PINMODE_PULLUP, _TRISTATE o _PULLDOWN) */
+    CALIB_Channel_Id_Type Calib;   /**< Curva de calibracion */
+    SENSOR_Output_Type Output;     /**< Salida de la etapa de filtros */
+    const ALARM_Rule_Type* Alarms; /**< Reglas sobre el canal (su Channel no se usa), o NULL */
+    uint8_t Alarm_Count;           /**< Cantidad de reglas */
+} SENSOR_Channel_Type;
+
+/**
+ * @brief Valida la tabla de canales y arma la mascara del ADC y las reglas de alarma.
+ *
+ * No configura el hardware: se llama antes que SENSOR_ConfigPins() y que las configuraciones del ADC, del GPDMA y de
+ * las alarmas.
+ *
+ * @param table Canales, en el orden de las mediciones (debe seguir existiendo).
+ * @param count Cantidad de canales (1 a SENSOR_MAX_CHANNELS).
+ * @return SUCCESS, o ERROR si hay una entrada del ADC invalida, repetida o reservada, una curva o salida invalida,
+ *         o mas de ALARM_MAX_RULES reglas en total. Con error no se cambia la tabla anterior.
+ */
+Status SENSOR_Init(const SENSOR_Channel_Type* table, uint8_t count);
+
+/**
+ * @brief Configura el PINSEL y la resistencia del pin de cada canal.
+ */
+void SENSOR_ConfigPins(void);
+
+/**
+ * @brief Devuelve las entradas del ADC de la tabla.
+ *
+ * @return Mascara con el bit n para AD0.n.
+ */
+uint8_t SENSOR_GetMask(void);
+
+/**
+ * @brief Devuelve la cantidad de canales de la tabla.
+ */
+uint8_t SENSOR_GetCount(void);
+
+/**
+ * @brief Inicializa el motor de alarmas con las reglas de todos los canales.
+ *
+ * @param min_interval_ms Tiempo minimo entre accionamientos de reglas no inmediatas.
+ * @return El resultado de ALARM_Init().
+ */
+Status SENSOR_InitAlarms(uint32_t min_interval_ms);
+
+/**
+ * @brief Convierte la salida filtrada de un canal a la unidad de su sensor.
+ *
+ * @param index Posicion del canal en la tabla.
+ * @return Valor calibrado, o 0 si la posicion es invalida.
+ */
+uint8_t SENSOR_Read(uint8_t index);
+
+#endif /* SENSOR_CHANNELS_H */
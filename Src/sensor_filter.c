@@ -0,0 +1,153 @@
+/**
+ * @file sensor_filter.c
+ * @brief Etapa de filtros de los sensores: mediana movil, media exponencial y pendiente, en carriles de 16 bits.
+ *
+ * Operaciones sobre dos carriles de 15 bits con guarda (a y b de 0 a 0x7FFF en cada carril):
+ *
+ * - (a | 0x8000) - b deja en cada carril 0x8000 + a - b, entre 1 y 0xFFFF: nunca pide prestado al carril de arriba,
+ *   y su bit 15 indica a >= b. Multiplicar ese bit (llevado al bit 0 del carril) por 0xFFFF da una mascara por
+ *   carril, con la que un intercambio condicional ordena el par sin saltos (FILTER_SORT).
+ * - La mediana de 5 es la mediana de 3 entre la quinta entrada, el mayor de los minimos de dos pares y el menor de
+ *   sus maximos: siete comparaciones para los dos carriles a la vez.
+ * - En la media exponencial, 0x8000 + x - y desplazado n bits es 0x8000 / 2^n + floor((x - y) / 2^n) (0x8000 es
+ *   multiplo de 2^n), y el bit n - 1 redondea; ninguna suma intermedia supera 0xFFFF por carril.
+ *
+ * El firmware se compila sin optimizar, asi que las operaciones por carril son macros y no funciones.
+ */
+
+#include "sensor_filter.h"
+
+#include "ramfunc.h"
+
+#define FILTER_GUARD 0x80008000UL /**< Bit de guarda (15) de cada carril */
+#define FILTER_LSB   0x00010001UL /**< Bit 0 de cada carril */
+
+/** Mascara con los bits de los carriles en los que a >= b (a y b sin guarda) */
+#define FILTER_GE(a, b) (((((a) | FILTER_GUARD) - (b)) >> 15 & FILTER_LSB) * 0xFFFFUL)
+
+/** Ordena dos palabras carril a carril: el menor queda en lo y el mayor en hi */
+#define FILTER_SORT(lo, hi)                                  \
+    do                                                       \
+    {                                                        \
+        uint32_t swap_ = ((lo) ^ (hi)) & FILTER_GE(lo, hi); \
+        (lo) ^= swap_;                                       \
+        (hi) ^= swap_;                                       \
+    } while (0)
+
+/** Mascara de un valor desplazado n bits en cada carril */
+#define FILTER_SHIFT_MASK ((0xFFFFUL >> FILTER_EMA_SHIFT) * FILTER_LSB)
+
+/** Sesgo 0x8000 / 2^n que deja en cada carril el desplazamiento de la diferencia */
+#define FILTER_SHIFT_BIAS ((0x8000UL >> FILTER_EMA_SHIFT) * FILTER_LSB)
+
+/**
+ * @brief Empaqueta un valor por canal en carriles, recortados a FILTER_MAX_VALUE.
+ */
+RAMFUNC static void FILTER_Pack(const FILTER_State_Type* state, const uint16_t* values, uint32_t* words)
+{
+    uint32_t value;
+
+    for (uint32_t w = 0; w < state->Words; w++)
+    {
+        words[w] = 0;
+    }
+
+    for (uint32_t ch = 0; ch < state->Channels; ch++)
+    {
+        value = (values[ch] > FILTER_MAX_VALUE) ? FILTER_MAX_VALUE : values[ch];
+        words[ch / 2] |= value << (16 * (ch % 2));
+    }
+}
+
+/**
+ * @brief Valor de un carril.
+ */
+static uint16_t FILTER_Lane(const uint32_t* words, uint8_t channel)
+{
+    return (uint16_t)(words[channel / 2] >> (16 * (channel % 2)));
+}
+
+void FILTER_Init(FILTER_State_Type* state, const uint16_t* values, uint8_t channels)
+{
+    uint32_t words[FILTER_WORDS];
+
+    state->Channels = (channels < 1) ? 1 : ((channels > FILTER_MAX_CHANNELS) ? FILTER_MAX_CHANNELS : channels);
+    state->Words = (uint8_t)((state->Channels + 1) / 2);
+
+    FILTER_Pack(state, values, words);
+    for (uint32_t w = 0; w < state->Words; w++)
+    {
+        for (uint32_t i = 0; i < FILTER_MEDIAN_TAPS; i++)
+        {
+            state->History[i][w] = words[w];
+        }
+        for (uint32_t i = 0; i < FILTER_RATE_TAPS; i++)
+        {
+            state->Past[i][w] = words[w];
+        }
+        state->Median[w] = words[w];
+        state->Average[w] = words[w];
+        state->Rate[w] = 0x8000UL * FILTER_LSB;
+    }
+    state->History_Index = 0;
+    state->Past_Index = 0;
+}
+
+RAMFUNC void FILTER_Update(FILTER_State_Type* state, const uint16_t* values)
+{
+    uint32_t words[FILTER_WORDS];
+    uint32_t a, b, c, d, e;
+    uint32_t diff;
+    uint32_t average;
+
+    FILTER_Pack(state, values, words);
+
+    for (uint32_t w = 0; w < state->Words; w++)
+    {
+        state->History[state->History_Index][w] = words[w];
+
+        // Mediana de 5: mediana de 3 entre e, f y g.
+        a = state->History[0][w];
+        b = state->History[1][w];
+        c = state->History[2][w];
+        d = state->History[3][w];
+        e = state->History[4][w];
+        FILTER_SORT(a, b);
+        FILTER_SORT(c, d);
+        FILTER_SORT(a, c); // c = f = max(min(a, b), min(c, d))
+        FILTER_SORT(b, d); // b = g = min(max(a, b), max(c, d))
+        FILTER_SORT(c, b); // c = min(f, g), b = max(f, g)
+        FILTER_SORT(b, e); // b = min(max(f, g), e)
+        FILTER_SORT(c, b); // b = max(min(f, g), min(max(f, g), e)): la mediana
+        state->Median[w] = b;
+
+        // Media exponencial redondeada: y + floor((x - y) / 2^n) + bit n - 1 de (x - y).
+        average = state->Average[w];
+        diff = (b | FILTER_GUARD) - average;
+        average += ((diff >> FILTER_EMA_SHIFT) & FILTER_SHIFT_MASK) + ((diff >> (FILTER_EMA_SHIFT - 1)) & FILTER_LSB);
+        average -= FILTER_SHIFT_BIAS;
+        state->Average[w] = average;
+
+        // Pendiente con sesgo: 0x8000 + media actual - media de hace FILTER_RATE_TAPS muestras.
+        state->Rate[w] = (average | FILTER_GUARD) - state->Past[state->Past_Index][w];
+        state->Past[state->Past_Index][w] = average;
+    }
+
+    state->History_Index = (state->History_Index + 1) % FILTER_MEDIAN_TAPS;
+    state->Past_Index = (state->Past_Index + 1) % FILTER_RATE_TAPS;
+}
+
+uint16_t FILTER_GetMedian(const FILTER_State_Type* state, uint8_t channel)
+{
+    return (channel < state->Channels) ? FILTER_Lane(state->Median, channel) : 0;
+}
+
+uint16_t FILTER_GetAverage(const FILTER_State_Type* state, uint8_t channel)
+{
+    return (channel < state->Channels) ? FILTER_Lane(state->Average, channel) : 0;
+}
+
+int32_t FILTER_GetRate(const FILTER_State_Type* state, uint8_t channel)
+{
+    return (channel < state->Channels) ? (int32_t)FILTER_Lane(state->Rate, channel) - 0x8000 : 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file sensor_filter.h
+ * @brief Etapa de filtros de los sensores: mediana movil, media exponencial y pendiente, en carriles de 16 bits.
+ *
+ * Cada muestra de la etapa es un valor decimado por canal (un bloque del ADC). Los canales (hasta
+ * FILTER_MAX_CHANNELS, los que se indiquen al inicializar) se procesan juntos,
+ * empaquetados de a dos por palabra de 32 bits (carriles de 16 bits, el canal par en la mitad baja), con
+ * aritmetica SWAR: el Cortex-M3 no tiene instrucciones SIMD, pero los valores de 15 bits dejan libre el bit 15 de
+ * cada carril como guarda, y una resta o una comparacion de 32 bits opera sobre los dos carriles sin que el
+ * acarreo pase de uno a otro. Por muestra:
+ *
+ * 1. Mediana de las ultimas FILTER_MEDIAN_TAPS entradas (descarta lecturas aisladas, por ejemplo un pico de ruido).
+ * 2. Media exponencial de la mediana: y += (x - y) / 2^FILTER_EMA_SHIFT, redondeada.
+ * 3. Pendiente: diferencia entre la media actual y la de FILTER_RATE_TAPS muestras atras.
+ *
+ * El modulo no depende del hardware y lo comparte el generador de host (table_gen -f), que lo compara con una
+ * implementacion escalar y mide su costo por muestra.
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+
+// Definiciones del modulo:
+#define FILTER_MAX_CHANNELS 8                               /**< Canales filtrados como maximo (entradas del ADC) */
+#define FILTER_WORDS        ((FILTER_MAX_CHANNELS + 1) / 2) /**< Palabras de 32 bits por muestra (dos carriles) */
+#define FILTER_MAX_VALUE    0x7FFF                          /**< Entrada maxima (15 bits, el 15 es la guarda) */
+#define FILTER_MEDIAN_TAPS  5                               /**< Entradas de la mediana (red de comparaciones de 5) */
+#define FILTER_EMA_SHIFT    4                               /**< Peso de la entrada en la media: 1 / 2^n (1 a 15) */
+#define FILTER_RATE_TAPS    16                              /**< Muestras entre los extremos de la pendiente */
+
+/**
+ * @brief Estado de la etapa (todos los campos son palabras con dos carriles).
+ */
+typedef struct
+{
+    uint32_t History[FILTER_MEDIAN_TAPS][FILTER_WORDS]; /**< Ultimas entradas, en anillo */
+    uint32_t Past[FILTER_RATE_TAPS][FILTER_WORDS];      /**< Ultimas medias, en anillo */
+    uint32_t Median[FILTER_WORDS];                      /**< Mediana de la ultima muestra */
+    uint32_t Average[FILTER_WORDS];                     /**< Media exponencial */
+    uint32_t Rate[FILTER_WORDS];                        /**< Pendiente mas 0x8000 en cada carril */
+    uint8_t History_Index;                              /**< Proxima posicion de History */
+    uint8_t Past_Index;                                 /**< Proxima posicion de Past */
+    uint8_t Channels;                                   /**< Canales filtrados */
+    uint8_t Words;                                      /**< Palabras en uso (las de los canales filtrados) */
+} FILTER_State_Type;
+
+/**
+ * @brief Inicializa la etapa como si la entrada hubiera estado siempre en los valores dados.
+ *
+ * El costo de FILTER_Update() es proporcional a las palabras en uso: un canal impar comparte la ultima palabra con
+ * un carril vacio.
+ *
+ * @param state Estado a inicializar.
+ * @param values Un valor por canal (se recortan a FILTER_MAX_VALUE).
+ * @param channels Canales filtrados (1 a FILTER_MAX_CHANNELS; se recorta).
+ */
+void FILTER_Init(FILTER_State_Type* state, const uint16_t* values, uint8_t channels);
+
+/**
+ * @brief Procesa una muestra de todos los canales.
+ *
+ * @param state Estado de la etapa.
+ * @param values Un valor por canal filtrado (se recortan a FILTER_MAX_VALUE).
+ */
+void FILTER_Update(FILTER_State_Type* state, const uint16_t* values);
+
+/**
+ * @brief Mediana de la ultima muestra de un canal (0 si el canal no se filtra).
+ */
+uint16_t FILTER_GetMedian(const FILTER_State_Type* state, uint8_t channel);
+
+/**
+ * @brief Media exponencial de un canal.
+ */
+uint16_t FILTER_GetAverage(const FILTER_State_Type* state, uint8_t channel);
+
+/**
+ * @brief Pendiente de un canal: cambio de la media en las ultimas FILTER_RATE_TAPS muestras.
+ */
+int32_t FILTER_GetRate(const FILTER_State_Type* state, uint8_t channel);
+
+#endif /* SENSOR_FILTER_H */
@@ -0,0 +1,349 @@
+/**
+ * @file step_engine.c
+ * @brief Generacion por hardware de los pasos del motor (NEMA17 con driver A4988) con rampas de aceleracion.
+ *
+ * Cada paso son dos matches del TIMER1 (subida y bajada de MAT1.0), asi que la tabla tiene dos medios periodos por
+ * paso, ya restados en uno porque el reset en el match agrega un tick. La CPU carga el primero en MR0 y el GPDMA
+ * los siguientes, uno por cada pedido de MAT1.0: el valor llega a MR0 mientras el contador recien vuelve a cero.
+ * El pedido del ultimo match lo atiende la LLI de parada, que escribe 0 en el TCR con el contador ya reiniciado:
+ * la salida queda en bajo despues de un numero par de flancos.
+ *
+ * La tabla se recorre en tramos de STEP_ENGINE_CHUNK_STEPS pasos encadenados por LLI (el primero lo carga
+ * GPDMA_Setup()). El GPDMA lee el enlace de un tramo al cargarlo, cuando termina el anterior: cambiar el enlace de
+ * un tramo todavia no cargado es una sola escritura de 32 bits que toma efecto en ese limite, igual que la cola de
+ * dac_wave.c. Para frenar, el enlace pasa a la LLI de desaceleracion, seguida de la de parada.
+ */
+
+#include "step_engine.h"
+
+#include "LPC17xx.h"
+#include "ahbram.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_gpdma.h"
+#include "lpc17xx_pinsel.h"
+#include "lpc17xx_timer.h"
+#include "ramfunc.h"
+
+#define STEP_ENGINE_MIN_HALF 25 /**< Medio periodo minimo en ticks (1 us): tiempo del GPDMA para actualizar MR0 */
+#define STEP_ENGINE_CH       ((LPC_GPDMACH_TypeDef*)(LPC_GPDMACH0_BASE + 0x20 * STEP_ENGINE_DMA_CHANNEL)) /**< Canal */
+#define STEP_ENGINE_CHUNKS   (STEP_ENGINE_MAX_STEPS / STEP_ENGINE_CHUNK_STEPS) /**< Tramos maximos de una tabla */
+#define STEP_ENGINE_SIZE     0xFFF /**< Campo TransferSize del registro de control del canal */
+
+/** Control de las LLI hacia MR0: palabras, sin pedido de interrupcion */
+#define STEP_ENGINE_CONTROL \
+    (GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD))
+
+/**
+ * @brief Medios periodos de cada buffer, en el formato de MR0.
+ *
+ * STEP_PROFILE_Build() deja los intervalos en la primera mitad y se expanden en el lugar, de atras hacia adelante.
+ */
+AHBRAM1_NOINIT static uint32_t Table[2][2 * STEP_ENGINE_MAX_STEPS];
+AHBRAM1_BSS static volatile GPDMA_LLI_Type Chunk_LLI[2][STEP_ENGINE_CHUNKS]; /**< LLI de los tramos de cada buffer */
+AHBRAM1_NOINIT static uint32_t Decel[STEP_ENGINE_MAX_STEPS]; /**< Desaceleracion anticipada (media tabla) */
+AHBRAM1_BSS static volatile GPDMA_LLI_Type Decel_LLI;        /**< LLI de la desaceleracion anticipada */
+AHBRAM1_BSS static GPDMA_LLI_Type Stop_LLI;                  /**< LLI que detiene el timer con el ultimo pedido */
+
+static uint32_t Steps[2];                                        /**< Pasos de la tabla de cada buffer */
+static uint32_t Ramp[2];                                         /**< Pasos de cada rampa de cada buffer */
+static const uint32_t Stop_Word = 0;                             /**< Valor del TCR que detiene el timer */
+static STEP_ENGINE_Callback Done_Callback = NULL;                /**< Callback de fin de maniobra */
+static volatile Bool Moving = FALSE;                             /**< Hay una maniobra en curso */
+static volatile Bool Prepared = FALSE;                           /**< El buffer libre tiene una maniobra lista */
+static volatile uint8_t Active = 0;                              /**< Buffer de la maniobra en curso o la ultima */
+static volatile uint32_t Total = 0;                              /**< Pasos de la maniobra, con la desaceleracion */
+static volatile uint32_t Stop_At = 0;                            /**< Paso donde empieza la desaceleracion anticipada */
+static volatile Bool Stopping = FALSE;                           /**< La maniobra en curso termina con Decel */
+
+/**
+ * @brief Pasos completos de la maniobra en curso, segun la direccion de origen del canal.
+ *
+ * La LLI de cada tabla arranca en el medio periodo 1 y el GPDMA lee el medio periodo k en el flanco k, asi que el
+ * indice de la proxima lectura es la cantidad de flancos mas uno. Fuera de las tablas el canal ya esta en la LLI
+ * de parada.
+ */
+static uint32_t STEP_ENGINE_Done(void)
+{
+    uint32_t src = STEP_ENGINE_CH->DMACCSrcAddr;
+    uint32_t table = (uint32_t)Table[Active];
+    uint32_t decel = (uint32_t)Decel;
+
+    if (src > table && src <= (uint32_t)&Table[Active][2 * Steps[Active]])
+    {
+        return ((src - table) / sizeof(uint32_t) - 1) / 2;
+    }
+    if (Stopping == TRUE && src >= decel && src <= (uint32_t)&Decel[2 * (Total - Stop_At)])
+    {
+        // El primer medio periodo de Decel se lee en el flanco 2 * Stop_At.
+        return (2 * Stop_At - 1 + (src - decel) / sizeof(uint32_t)) / 2;
+    }
+
+    return Total;
+}
+
+void STEP_ENGINE_ConfigPin(void)
+{
+    PINSEL_CFG_Type PinCfg;
+
+    // Pin de STEP del A4988 (P1.22, función 3 = MAT1.0):
+    PinCfg.Portnum = PINSEL_PORT_1;
+    PinCfg.Pinnum = PINSEL_PIN_22;
+    PinCfg.Funcnum = PINSEL_FUNC_3;
+    PinCfg.Pinmode = PINSEL_PINMODE_TRISTATE;
+    PinCfg.OpenDrain = PINSEL_PINMODE_NORMAL;
+    PINSEL_ConfigPin(&PinCfg);
+}
+
+void STEP_ENGINE_Init(STEP_ENGINE_Callback callback)
+{
+    TIM_TIMERCFG_Type TimerCfg;
+    TIM_MATCHCFG_Type MatchCfg;
+
+    Done_Callback = callback;
+    Moving = FALSE;
+    Prepared = FALSE;
+
+    // TIMER1 sin prescaler: un tick por ciclo de PCLK.
+    TimerCfg.PrescaleOption = TIM_PRESCALE_TICKVAL;
+    TimerCfg.PrescaleValue = 1;
+    TIM_Init(LPC_TIM1, TIM_TIMER_MODE, &TimerCfg);
+
+    // Match 0: reinicia el contador y conmuta MAT1.0. Sin interrupción: cada match es un pedido de DMA.
+    MatchCfg.MatchChannel = 0;
+    MatchCfg.IntOnMatch = DISABLE;
+    MatchCfg.ResetOnMatch = ENABLE;
+    MatchCfg.StopOnMatch = DISABLE;
+    MatchCfg.ExtMatchOutputType = TIM_EXTMATCH_TOGGLE;
+    MatchCfg.MatchValue = 0xFFFFFFFF;
+    TIM_ConfigMatch(LPC_TIM1, &MatchCfg);
+
+    // La línea 10 del GPDMA es de MAT1.0 y no del UART1 (GPDMA_Setup() la vuelve a seleccionar en cada maniobra).
+    LPC_SC->DMAREQSEL |= (1UL << (GPDMA_CONN_MAT1_0 - 16));
+
+    // LLI de parada: una palabra al TCR, con la interrupción de fin de maniobra.
+    Stop_LLI.SrcAddr = (uint32_t)&Stop_Word;
+    Stop_LLI.DstAddr = (uint32_t) & (LPC_TIM1->TCR);
+    Stop_LLI.NextLLI = 0;
+    Stop_LLI.Control = GPDMA_DMACCxControl_TransferSize(1) | GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_WORD) |
+                       GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_WORD) | GPDMA_DMACCxControl_I;
+
+    // LLI de desaceleracion: su tamaño se fija al frenar, siempre termina en la parada.
+    Decel_LLI.SrcAddr = (uint32_t)Decel;
+    Decel_LLI.DstAddr = (uint32_t) & (LPC_TIM1->MR0);
+    Decel_LLI.NextLLI = (uint32_t)&Stop_LLI;
+}
+
+Status STEP_ENGINE_Prepare(const STEP_PROFILE_Config_Type* config, uint32_t steps)
+{
+    STEP_PROFILE_Config_Type profile = *config;
+    uint8_t buffer = Active ^ 1;
+    uint32_t* table = Table[buffer];
+    uint32_t interval;
+    uint32_t first;
+    uint32_t end;
+
+    Prepared = FALSE;
+    if (steps == 0 || steps > STEP_ENGINE_MAX_STEPS)
+    {
+        return ERROR;
+    }
+
+    profile.Tick_Rate = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_TIMER1);
+    if (STEP_PROFILE_Build(&profile, steps, table) == 0)
+    {
+        return ERROR;
+    }
+
+    // Dos medios periodos por paso (el segundo se lleva el tick impar):
+    for (uint32_t k = steps; k-- > 0;)
+    {
+        interval = table[k];
+        if (interval / 2 < STEP_ENGINE_MIN_HALF)
+        {
+            return ERROR;
+        }
+        table[2 * k] = interval / 2 - 1;
+        table[2 * k + 1] = interval - interval / 2 - 1;
+    }
+
+    // Tramos de la tabla hacia MR0; el primero empieza en el medio periodo 1 (el 0 lo carga la CPU) y el ultimo
+    // sigue con la LLI de parada.
+    for (uint32_t c = 0; c * STEP_ENGINE_CHUNK_STEPS < steps; c++)
+    {
+        first = (c == 0) ? 1 : 2 * STEP_ENGINE_CHUNK_STEPS * c;
+        end = 2 * STEP_ENGINE_CHUNK_STEPS * (c + 1);
+        if (end > 2 * steps)
+        {
+            end = 2 * steps;
+        }
+
+        Chunk_LLI[buffer][c].SrcAddr = (uint32_t)&table[first];
+        Chunk_LLI[buffer][c].DstAddr = (uint32_t) & (LPC_TIM1->MR0);
+        Chunk_LLI[buffer][c].NextLLI = (end == 2 * steps) ? (uint32_t)&Stop_LLI : (uint32_t)&Chunk_LLI[buffer][c + 1];
+        Chunk_LLI[buffer][c].Control =
+            STEP_ENGINE_CONTROL | GPDMA_DMACCxControl_SI | GPDMA_DMACCxControl_TransferSize((end - first));
+    }
+
+    Steps[buffer] = steps;
+    Ramp[buffer] = STEP_PROFILE_Ramp(&profile, steps);
+    Prepared = TRUE;
+
+    return SUCCESS;
+}
+
+Status STEP_ENGINE_Start(void)
+{
+    uint8_t buffer = Active ^ 1;
+    GPDMA_Channel_CFG_Type DMAChannel;
+
+    if (Moving == TRUE || Prepared == FALSE)
+    {
+        return ERROR;
+    }
+
+    // Timer detenido en cero con la salida en bajo. Escribir MR0 descarta el pedido de DMA del último match de la
+    // maniobra anterior, que atendió la LLI de parada.
+    TIM_Cmd(LPC_TIM1, DISABLE);
+    TIM_ResetCounter(LPC_TIM1);
+    LPC_TIM1->EMR &= ~TIM_EM(0);
+    LPC_TIM1->MR0 = Table[buffer][0];
+    TIM_ClearIntPending(LPC_TIM1, TIM_MR0_INT);
+
+    // Configuración del canal DMA: el primer tramo hacia MR0 y luego su cadena de LLI.
+    DMAChannel.ChannelNum = STEP_ENGINE_DMA_CHANNEL;                           // Canal DMA de los pasos
+    DMAChannel.SrcMemAddr = Chunk_LLI[buffer][0].SrcAddr;                      // Segundo medio periodo
+    DMAChannel.DstMemAddr = 0;                                                 // No se usa, el destino es MR0
+    DMAChannel.TransferSize = Chunk_LLI[buffer][0].Control & STEP_ENGINE_SIZE; // Tamaño del primer tramo
+    DMAChannel.TransferWidth = 0;                                              // Solo se usa en M2M
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_M2P;                          // Memoria a periférico
+    DMAChannel.SrcConn = 0;                                                    // No se usa conexión de origen
+    DMAChannel.DstConn = GPDMA_CONN_MAT1_0;                                    // Conexión del destino (MAT1.0)
+    DMAChannel.DMALLI = Chunk_LLI[buffer][0].NextLLI;                          // Continúa con el segundo tramo
+    if (GPDMA_Setup(&DMAChannel) == ERROR)
+    {
+        return ERROR;
+    }
+
+    // Solo interrumpe la LLI de parada: GPDMA_Setup() siempre pide terminal count en la primera transferencia.
+    STEP_ENGINE_CH->DMACCControl = Chunk_LLI[buffer][0].Control;
+
+    Active = buffer;
+    Prepared = FALSE;
+    Total = Steps[buffer];
+    Stopping = FALSE;
+    Moving = TRUE;
+    __DMB();
+    GPDMA_ChannelCmd(STEP_ENGINE_DMA_CHANNEL, ENABLE);
+    TIM_Cmd(LPC_TIM1, ENABLE);
+
+    return SUCCESS;
+}
+
+Status STEP_ENGINE_Stop(void)
+{
+    volatile GPDMA_LLI_Type* chunks = Chunk_LLI[Active];
+    uint32_t* table = Table[Active];
+    uint32_t next;
+    uint32_t chunk;
+    uint32_t boundary;
+    uint32_t decel;
+    uint32_t link;
+
+    if (Moving == FALSE)
+    {
+        return ERROR;
+    }
+
+    while (Stopping == FALSE)
+    {
+        // Proximo tramo que cargara el GPDMA; si ya va por la parada (o por el ultimo tramo) termina solo.
+        next = STEP_ENGINE_CH->DMACCLLI;
+        if (next < (uint32_t)&chunks[1] || next >= (uint32_t)&chunks[STEP_ENGINE_CHUNKS])
+        {
+            return SUCCESS;
+        }
+        chunk = (next - (uint32_t)chunks) / sizeof(GPDMA_LLI_Type);
+
+        // La desaceleracion empezaria al terminar ese tramo. Si la propia tabla ya desacelera antes, no se toca.
+        boundary = STEP_ENGINE_CHUNK_STEPS * (chunk + 1);
+        if (boundary + Ramp[Active] >= Steps[Active])
+        {
+            return SUCCESS;
+        }
+
+        // El perfil es simetrico: la desaceleracion desde el paso boundary es el espejo de los primeros, hasta la
+        // rampa completa si ya se la recorrio (el resto del crucero se saltea). Sin rampa se para en el limite.
+        decel = (boundary < Ramp[Active]) ? boundary : Ramp[Active];
+        for (uint32_t i = 0; i < 2 * decel; i++)
+        {
+            Decel[i] = table[2 * decel - 1 - i];
+        }
+        Decel_LLI.Control = STEP_ENGINE_CONTROL | GPDMA_DMACCxControl_SI | GPDMA_DMACCxControl_TransferSize(2 * decel);
+        link = (decel != 0) ? (uint32_t)&Decel_LLI : (uint32_t)&Stop_LLI;
+
+        __DMB();
+        chunks[chunk].NextLLI = link;
+        __DMB();
+
+        // Si el GPDMA cargo el tramo antes de la escritura se reintenta con el siguiente.
+        next = STEP_ENGINE_CH->DMACCLLI;
+        if (next == (uint32_t)&chunks[chunk] || next == link)
+        {
+            Stop_At = boundary;
+            Total = boundary + decel;
+            Stopping = TRUE;
+        }
+    }
+
+    return SUCCESS;
+}
+
+Bool STEP_ENGINE_Busy(void)
+{
+    return Moving;
+}
+
+void STEP_ENGINE_GetProgress(STEP_ENGINE_Progress_Type* progress)
+{
+    progress->Total = Total;
+    progress->Ramp = Ramp[Active];
+    progress->Stopping = Stopping;
+    progress->Done = (Moving == TRUE) ? STEP_ENGINE_Done() : Total;
+}
+
+RAMFUNC void STEP_ENGINE_IRQHandler(void)
+{
+    Bool done = FALSE;
+
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INT, STEP_ENGINE_DMA_CHANNEL) == RESET)
+    {
+        return;
+    }
+
+    // Fin de la LLI de parada: el timer ya está detenido.
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, STEP_ENGINE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, STEP_ENGINE_DMA_CHANNEL);
+        done = TRUE;
+    }
+
+    // Error del GPDMA: se detiene el timer para no seguir dando pasos con un medio periodo viejo. La maniobra queda
+    // en los pasos ya dados.
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, STEP_ENGINE_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, STEP_ENGINE_DMA_CHANNEL);
+        GPDMA_ChannelCmd(STEP_ENGINE_DMA_CHANNEL, DISABLE);
+        TIM_Cmd(LPC_TIM1, DISABLE);
+        Total = STEP_ENGINE_Done();
+        done = TRUE;
+    }
+
+    if (done == TRUE)
+    {
+        Moving = FALSE;
+        if (Done_Callback != NULL)
+        {
+            Done_Callback();
+        }
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file step_engine.h
+ * @brief Generacion por hardware de los pasos del motor (NEMA17 con driver A4988) con rampas de aceleracion.
+ *
+ * Los pulsos de STEP los genera la salida MAT1.0 (P1.22) del TIMER1 en modo toggle, con reset en el match 0. Cada
+ * match pide una transferencia al GPDMA, que escribe en MR0 el medio periodo siguiente desde la tabla de la
+ * maniobra (STEP_PROFILE_Build()). Al terminar la tabla, una ultima LLI escribe en el TCR y detiene el timer en el
+ * ultimo flanco. La CPU no interviene por paso: solo arma la tabla antes de arrancar y atiende una interrupcion
+ * del GPDMA al final de la maniobra.
+ *
+ * El timer, el pin y el canal se configuran una sola vez. Las tablas tienen doble buffer: mientras el GPDMA recorre
+ * la de la maniobra en curso, la siguiente se arma en la otra (STEP_ENGINE_Prepare()) y se arranca con
+ * STEP_ENGINE_Start(), tipicamente desde el callback de fin de la anterior. La tabla se recorre en tramos de
+ * STEP_ENGINE_CHUNK_STEPS pasos, uno por LLI: para frenar antes de tiempo basta redirigir el enlace de un tramo que
+ * el GPDMA todavia no cargo hacia una desaceleracion, que toma efecto en el limite entre tramos.
+ */
+
+#ifndef STEP_ENGINE_H
+#define STEP_ENGINE_H
+
+#include "lpc_types.h"
+#include "step_profile.h"
+
+// Definiciones del modulo:
+#define STEP_ENGINE_DMA_CHANNEL 3   /**< Canal del GPDMA (0 es del ADC, 1 del UART2 y 2 del DAC) */
+#define STEP_ENGINE_MAX_STEPS   128 /**< Pasos maximos de una maniobra (la tabla tiene dos palabras por paso) */
+#define STEP_ENGINE_CHUNK_STEPS 4   /**< Pasos de cada LLI de la tabla (granularidad de STEP_ENGINE_Stop()) */
+
+/**
+ * @brief Callback de fin de maniobra, invocado desde la interrupcion del GPDMA.
+ */
+typedef void (*STEP_ENGINE_Callback)(void);
+
+/**
+ * @brief Avance de la maniobra en curso (o de la ultima, si no hay ninguna en curso).
+ */
+typedef struct
+{
+    uint32_t Done;  /**< Pasos completos dados */
+    uint32_t Total; /**< Pasos de la maniobra (ya recortados si se pidio frenar) */
+    uint32_t Ramp;  /**< Pasos de cada rampa de la tabla (ver STEP_PROFILE_Ramp()) */
+    Bool Stopping;  /**< La maniobra se redirigio a una desaceleracion anticipada */
+} STEP_ENGINE_Progress_Type;
+
+/**
+ * @brief Configura el pin de STEP (P1.22) como MAT1.0, sin resistencia.
+ *
+ * Es parte de la configuracion de los pines del arranque (Config_PINS() en main.c); con make PIN_MAP=1 la reemplaza
+ * el mapa de pin_map.cpp.
+ */
+void STEP_ENGINE_ConfigPin(void);
+
+/**
+ * @brief Configura el TIMER1 y la seleccion del pedido de DMA de MAT1.0.
+ *
+ * Se llama una sola vez, con el GPDMA ya inicializado con GPDMA_Init() y el pin configurado con
+ * STEP_ENGINE_ConfigPin(). El timer queda detenido y la salida en bajo.
+ *
+ * @param callback Funcion a llamar al terminar cada maniobra (puede ser NULL).
+ */
+void STEP_ENGINE_Init(STEP_ENGINE_Callback callback);
+
+/**
+ * @brief Calcula la tabla de la proxima maniobra en el buffer libre, sin arrancarla.
+ *
+ * Puede llamarse con una maniobra en curso. Una tabla preparada y todavia no arrancada se reemplaza. Tick_Rate de
+ * la configuracion se ignora: los intervalos se calculan en ticks del TIMER1 (PCLK sin prescaler). No debe
+ * competir con STEP_ENGINE_Start(): quien llame a ambas desde contextos distintos tiene que excluirlas.
+ *
+ * @param config Perfil de velocidad.
+ * @param steps Pasos a dar (1 a STEP_ENGINE_MAX_STEPS).
+ * @return SUCCESS, o ERROR si el perfil no es valido (no queda nada preparado).
+ */
+Status STEP_ENGINE_Prepare(const STEP_PROFILE_Config_Type* config, uint32_t steps);
+
+/**
+ * @brief Arranca la maniobra preparada.
+ *
+ * Es breve y puede llamarse desde el callback de fin de maniobra. El pin de direccion del driver debe fijarse
+ * antes: el primer flanco de STEP llega un medio periodo despues.
+ *
+ * @return SUCCESS, o ERROR si hay una maniobra en curso o ninguna preparada.
+ */
+Status STEP_ENGINE_Start(void);
+
+/**
+ * @brief Frena la maniobra en curso lo antes posible, con la rampa de desaceleracion.
+ *
+ * La desaceleracion empieza al terminar el proximo tramo de STEP_ENGINE_CHUNK_STEPS pasos que el GPDMA todavia no
+ * cargo, y es el espejo de los pasos dados hasta ahi. Si la tabla ya desacelera antes de ese punto la maniobra
+ * sigue igual. Debe llamarse con las interrupciones deshabilitadas si compite con STEP_ENGINE_Start().
+ *
+ * @return SUCCESS, o ERROR si no hay una maniobra en curso.
+ */
+Status STEP_ENGINE_Stop(void);
+
+/**
+ * @brief Indica si hay una maniobra en curso.
+ */
+Bool STEP_ENGINE_Busy(void);
+
+/**
+ * @brief Informa el avance de la maniobra, leido de la direccion de origen del canal.
+ *
+ * @param progress Estructura a completar.
+ */
+void STEP_ENGINE_GetProgress(STEP_ENGINE_Progress_Type* progress);
+
+/**
+ * @brief Atiende la interrupcion del canal de los pasos.
+ *
+ * Debe llamarse desde DMA_IRQHandler. La unica interrupcion de una maniobra es la de la LLI que detiene el timer.
+ */
+void STEP_ENGINE_IRQHandler(void);
+
+#endif /* STEP_ENGINE_H */
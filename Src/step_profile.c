@@ -0,0 +1,237 @@
+/**
+ * @file step_profile.c
+ * @brief Perfiles de velocidad del motor paso a paso: intervalos entre pasos de una maniobra con rampas.
+ *
+ * El perfil se define por v^2 en funcion de la posicion, que en una rampa de aceleracion constante es lineal
+ * (v^2 = v0^2 + 2 * a * x). Con v^2 lineal la velocidad crece linealmente con el tiempo, y el tiempo de un tramo es
+ * exactamente su largo sobre el promedio de las velocidades de los extremos: medio paso dura 1 / (va + vb). En el
+ * trapecio el resultado es exacto; en la curva S v^2 es un polinomio suave y medio paso es un tramo lo bastante
+ * corto como para tomarlo lineal, salvo si la velocidad cambia mucho dentro de el (arranques muy lentos frente a la
+ * aceleracion): esos medios pasos se parten en STEP_PROFILE_SPLIT tramos. Integrar 1 / v (por ejemplo con Simpson
+ * sobre cada paso) falla en cambio cerca de velocidades bajas, donde 1 / v cambia mucho dentro de un paso.
+ *
+ * La posicion se mide en fracciones de medio paso (STEP_PROFILE_SPLIT por medio paso), v^2 se calcula en Q16 (a
+ * velocidades bajas su parte fraccionaria pesa), la velocidad se obtiene con una raiz cuadrada entera en Q8 y los
+ * tiempos se acumulan en ticks Q8, de modo que el error de redondeo queda muy por debajo de un tick. En un Cortex-M3
+ * cada paso cuesta normalmente dos raices y dos divisiones de 64 bits (el extremo de un paso es el comienzo del
+ * siguiente).
+ */
+
+#include "step_profile.h"
+
+// Definiciones del modulo:
+#define STEP_PROFILE_ONE       (1ULL << 30)  /**< 1.0 en la fraccion Q30 de la rampa */
+#define STEP_PROFILE_SPLIT     8             /**< Tramos de un medio paso en el que la velocidad cambia mucho */
+#define STEP_PROFILE_MAX_STEPS (1UL << 24)   /**< Pasos maximos de una maniobra (posicion Q30 en 64 bits) */
+#define STEP_PROFILE_MAX_SPEED (1UL << 20)   /**< Velocidad maxima, en pasos/s (v^2 en Q16 cabe en 64 bits) */
+#define STEP_PROFILE_MAX_RATE  (1UL << 27)   /**< Frecuencia maxima de los ticks, en Hz (PCLK de 100 MHz) */
+#define STEP_PROFILE_MAX_TICKS 0xFFFFFFFFULL /**< Duracion maxima de una maniobra, en ticks */
+
+/**
+ * @brief Rampa de una maniobra, ya resuelta para su cantidad de pasos.
+ */
+typedef struct
+{
+    STEP_PROFILE_Shape_Type Shape; /**< Forma de las rampas */
+    uint64_t Accel;                /**< Crecimiento de v^2 por medio paso en el trapecio */
+    uint64_t Start_Square;         /**< v0^2, en Q16 */
+    uint64_t Peak_Square;          /**< v^2 en el crucero (o en el pico del triangulo), en Q16 */
+    uint64_t Ramp;                 /**< Largo de cada rampa, en fracciones de medio paso */
+    uint64_t Total;                /**< Largo de la maniobra, en fracciones de medio paso */
+    uint64_t Tick_Rate;            /**< Frecuencia de los ticks */
+} STEP_PROFILE_Plan_Type;
+
+/**
+ * @brief Raiz cuadrada entera (redondeada hacia abajo) de un valor de 64 bits.
+ */
+static uint32_t STEP_PROFILE_Sqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Velocidad al cuadrado en una posicion de la maniobra, en Q16.
+ *
+ * @param position Posicion en fracciones de medio paso.
+ */
+static uint64_t STEP_PROFILE_Square(const STEP_PROFILE_Plan_Type* plan, uint64_t position)
+{
+    uint64_t distance = plan->Total - position;
+    uint64_t square;
+    uint64_t delta;
+    uint64_t u;
+
+    // La desaceleracion es el espejo de la aceleracion: cuenta la distancia al extremo mas cercano.
+    if (position < distance)
+    {
+        distance = position;
+    }
+    if (distance >= plan->Ramp)
+    {
+        return plan->Peak_Square;
+    }
+
+    if (plan->Shape == STEP_PROFILE_TRAPEZOID)
+    {
+        square = plan->Start_Square + ((plan->Accel * distance) << 16) / STEP_PROFILE_SPLIT;
+        return (square < plan->Peak_Square) ? square : plan->Peak_Square;
+    }
+
+    // Curva S: smoothstep de la fraccion de la rampa en Q30. El producto por la diferencia de v^2 (hasta 56 bits en
+    // Q16) se hace con la diferencia entera y la fraccion partida en dos mitades de 15 bits, sin desbordar 64 bits.
+    u = (distance << 30) / plan->Ramp;
+    u = (((u * u) >> 30) * (3 * STEP_PROFILE_ONE - 2 * u)) >> 30;
+    delta = (plan->Peak_Square - plan->Start_Square) >> 16;
+
+    return plan->Start_Square + ((delta * (u >> 15)) << 1) + ((delta * (u & 0x7FFF)) >> 14);
+}
+
+/**
+ * @brief Velocidad en una posicion (en fracciones de medio paso), en pasos/s Q8.
+ */
+static uint64_t STEP_PROFILE_Speed(const STEP_PROFILE_Plan_Type* plan, uint64_t position)
+{
+    return STEP_PROFILE_Sqrt(STEP_PROFILE_Square(plan, position));
+}
+
+/**
+ * @brief Duracion de un medio paso, en ticks Q8.
+ *
+ * @param half Medio paso (0 a 2 * pasos - 1).
+ * @param begin Velocidad al comienzo, en Q8.
+ * @param end Velocidad al final, en Q8.
+ */
+static uint64_t STEP_PROFILE_Half(const STEP_PROFILE_Plan_Type* plan, uint64_t half, uint64_t begin, uint64_t end)
+{
+    uint64_t ticks = 0;
+    uint64_t next;
+
+    // Con las velocidades en Q8, Tick_Rate / (va + vb) queda en ticks Q8.
+    if (end * 8 <= begin * 9 && begin * 8 <= end * 9)
+    {
+        return (plan->Tick_Rate << 16) / (begin + end);
+    }
+
+    // La velocidad cambia mas de un 12,5 %: tramos mas cortos, cada uno de 1 / STEP_PROFILE_SPLIT del medio paso.
+    for (uint64_t i = 1; i <= STEP_PROFILE_SPLIT; i++)
+    {
+        next = (i == STEP_PROFILE_SPLIT) ? end : STEP_PROFILE_Speed(plan, half * STEP_PROFILE_SPLIT + i);
+        ticks += (plan->Tick_Rate << 16) / (STEP_PROFILE_SPLIT * (begin + next));
+        begin = next;
+    }
+
+    return ticks;
+}
+
+/**
+ * @brief Resuelve la rampa de una maniobra.
+ *
+ * @return 0 si los parametros no son validos, 1 si el plan quedo armado.
+ */
+static int STEP_PROFILE_Plan(const STEP_PROFILE_Config_Type* config, uint32_t steps, STEP_PROFILE_Plan_Type* plan)
+{
+    uint64_t max_square;
+    uint64_t needed;
+
+    if (steps == 0 || steps > STEP_PROFILE_MAX_STEPS || config->Accel == 0 || config->Tick_Rate == 0 ||
+        config->Tick_Rate > STEP_PROFILE_MAX_RATE || config->Start_Speed == 0 ||
+        config->Start_Speed > config->Max_Speed || config->Max_Speed > STEP_PROFILE_MAX_SPEED)
+    {
+        return 0;
+    }
+
+    plan->Shape = config->Shape;
+    plan->Accel = config->Accel;
+    plan->Start_Square = ((uint64_t)config->Start_Speed * config->Start_Speed) << 16;
+    plan->Total = 2 * (uint64_t)steps * STEP_PROFILE_SPLIT;
+    plan->Tick_Rate = config->Tick_Rate;
+    max_square = ((uint64_t)config->Max_Speed * config->Max_Speed) << 16;
+
+    // Medios pasos para llegar a la velocidad maxima (v^2 crece Accel por medio paso). Si no alcanzan las dos
+    // rampas, el perfil es triangular: cada rampa ocupa la mitad de la maniobra y el pico queda por debajo.
+    needed = (((max_square - plan->Start_Square) >> 16) + config->Accel - 1) / config->Accel;
+    if (needed >= steps)
+    {
+        plan->Ramp = (uint64_t)steps * STEP_PROFILE_SPLIT;
+        plan->Peak_Square = plan->Start_Square + (((uint64_t)config->Accel * steps) << 16);
+        if (plan->Peak_Square > max_square)
+        {
+            plan->Peak_Square = max_square;
+        }
+    }
+    else
+    {
+        plan->Ramp = needed * STEP_PROFILE_SPLIT;
+        plan->Peak_Square = max_square;
+    }
+
+    return 1;
+}
+
+uint32_t STEP_PROFILE_Build(const STEP_PROFILE_Config_Type* config, uint32_t steps, uint32_t* intervals)
+{
+    STEP_PROFILE_Plan_Type plan;
+    uint64_t total = 0;
+    uint64_t begin;
+    uint64_t middle;
+    uint64_t end;
+    uint64_t ticks;
+    uint64_t half;
+
+    if (STEP_PROFILE_Plan(config, steps, &plan) == 0)
+    {
+        return 0;
+    }
+
+    // Dos medios pasos por paso, con las velocidades del comienzo, el centro y el final (que se reutiliza en el paso
+    // siguiente).
+    end = STEP_PROFILE_Speed(&plan, 0);
+    for (uint32_t k = 0; k < steps; k++)
+    {
+        half = 2 * (uint64_t)k;
+        begin = end;
+        middle = STEP_PROFILE_Speed(&plan, (half + 1) * STEP_PROFILE_SPLIT);
+        end = STEP_PROFILE_Speed(&plan, (half + 2) * STEP_PROFILE_SPLIT);
+
+        ticks = STEP_PROFILE_Half(&plan, half, begin, middle) + STEP_PROFILE_Half(&plan, half + 1, middle, end);
+        intervals[k] = (uint32_t)((ticks + 128) >> 8);
+        total += intervals[k];
+    }
+
+    return (total > STEP_PROFILE_MAX_TICKS) ? 0 : (uint32_t)total;
+}
+
+uint32_t STEP_PROFILE_Ramp(const STEP_PROFILE_Config_Type* config, uint32_t steps)
+{
+    STEP_PROFILE_Plan_Type plan;
+
+    if (STEP_PROFILE_Plan(config, steps, &plan) == 0)
+    {
+        return 0;
+    }
+
+    // Rampa en fracciones de medio paso, redondeada hacia arriba a pasos enteros.
+    return (uint32_t)((plan.Ramp + 2 * STEP_PROFILE_SPLIT - 1) / (2 * STEP_PROFILE_SPLIT));
+}
@@ -0,0 +1,66 @@
+/**
+ * @file step_profile.h
+ * @brief Perfiles de velocidad del motor paso a paso: intervalos entre pasos de una maniobra con rampas.
+ *
+ * Un perfil acelera desde la velocidad de arranque hasta la maxima, la mantiene y desacelera simetricamente hasta
+ * la de arranque en el ultimo paso. Si la maniobra es corta para llegar a la maxima, el perfil es triangular y el
+ * pico queda en la mitad. La aceleracion se reparte de dos formas:
+ *
+ * - STEP_PROFILE_TRAPEZOID: aceleracion constante (v^2 lineal con la posicion).
+ * - STEP_PROFILE_SCURVE: la misma aceleracion media, pero v^2 sigue un smoothstep (3u^2 - 2u^3) de la posicion
+ *   dentro de la rampa, de modo que la aceleracion nace y muere en cero y se limita el tiron.
+ *
+ * La tabla se calcula una vez por maniobra, antes de moverse, con aritmetica entera (sin punto flotante ni tablas
+ * de raices): cada intervalo es el tiempo que lleva recorrer el paso con ese perfil, en ticks del timer que genera
+ * los pasos. El modulo no depende del hardware y lo comparte el generador de host (table_gen -p), que compara las
+ * tablas con el perfil ideal integrado en punto flotante.
+ */
+
+#ifndef STEP_PROFILE_H
+#define STEP_PROFILE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Forma de las rampas.
+ */
+typedef enum
+{
+    STEP_PROFILE_TRAPEZOID, /**< Aceleracion constante */
+    STEP_PROFILE_SCURVE     /**< Aceleracion suavizada (tiron limitado) */
+} STEP_PROFILE_Shape_Type;
+
+/**
+ * @brief Parametros de un perfil.
+ */
+typedef struct
+{
+    STEP_PROFILE_Shape_Type Shape; /**< Forma de las rampas */
+    uint32_t Start_Speed;          /**< Velocidad de arranque y de llegada, en pasos/s (sin perder pasos) */
+    uint32_t Max_Speed;            /**< Velocidad de crucero, en pasos/s */
+    uint32_t Accel;                /**< Aceleracion media de las rampas, en pasos/s^2 */
+    uint32_t Tick_Rate;            /**< Frecuencia de los ticks de los intervalos, en Hz */
+} STEP_PROFILE_Config_Type;
+
+/**
+ * @brief Calcula los intervalos entre pasos de una maniobra.
+ *
+ * @param config Parametros del perfil; Start_Speed debe ser mayor que cero y no superar a Max_Speed.
+ * @param steps Pasos de la maniobra.
+ * @param intervals Intervalo de cada paso en ticks, desde un flanco de paso hasta el siguiente (steps valores).
+ * @return Duracion total de la maniobra en ticks, o 0 si los parametros no son validos.
+ */
+uint32_t STEP_PROFILE_Build(const STEP_PROFILE_Config_Type* config, uint32_t steps, uint32_t* intervals);
+
+/**
+ * @brief Largo de cada rampa de una maniobra, en pasos enteros.
+ *
+ * Los pasos desde este hasta el simetrico del final son de crucero. Como el perfil es simetrico, la desaceleracion
+ * desde cualquier paso k no mayor que la rampa es el espejo de los k primeros intervalos.
+ *
+ * @return Pasos de la rampa (la mitad, redondeada hacia arriba, si el perfil es triangular), o 0 si no hay rampa
+ *         (Start_Speed igual a Max_Speed) o los parametros no son validos.
+ */
+uint32_t STEP_PROFILE_Ramp(const STEP_PROFILE_Config_Type* config, uint32_t steps);
+
+#endif /* STEP_PROFILE_H */
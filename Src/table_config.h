@@ -0,0 +1,51 @@
+/**
+ * @file table_config.h
+ * @brief Parametros de los modelos de los sensores, del DAC y del motor a partir de los que se generan las tablas.
+ *
+ * Lo incluyen el firmware (calibration.c, main.c) y el generador de tablas de host (Table_Generator/table_gen.c),
+ * que escribe build/generated/sensor_tables.{c,h} a partir de estos valores. Al cambiar una ganancia o un offset el
+ * Makefile vuelve a generar las tablas antes de compilar. La tabla de pasos del motor se calcula en el firmware
+ * antes de cada maniobra, y table_gen -p la compara con el perfil ideal. Solo contiene macros: no depende de CMSIS.
+ */
+
+#ifndef TABLE_CONFIG_H
+#define TABLE_CONFIG_H
+
+// Entrada de las tablas del ADC:
+#define TABLE_ADC_BITS 12                    /**< Bits de la lectura que indexan las tablas de los sensores */
+#define TABLE_ADC_SIZE (1 << TABLE_ADC_BITS) /**< Entradas de cada tabla de un sensor */
+#define TABLE_VREF_MV  3300                  /**< Tension de referencia del ADC, en mV */
+
+// LM35 (canal 0): grados Celsius.
+#define TABLE_LM35_MV_PER_C 10.0 /**< Sensibilidad, en mV/°C */
+#define TABLE_LM35_OFFSET   0.0  /**< Grados sumados al resultado (ajuste de cada placa) */
+#define TABLE_LM35_MAX      100  /**< Temperatura maxima informada */
+
+// LDR (canal 1): porcentaje de la tension.
+#define TABLE_LDR_SPAN   100.0 /**< Porcentaje a escala completa */
+#define TABLE_LDR_OFFSET 0.0   /**< Porcentaje sumado al resultado */
+#define TABLE_LDR_MAX    100   /**< Valor maximo */
+
+// MQ-2 (canal 2): GLP en centenas de ppm, segun la recta log10(Rs / R0) = A + B * (log10(ppm) - C) del datasheet.
+#define TABLE_MQ2_RL_R0     1.0     /**< RL / R0: resistencia de carga sobre la del sensor en 1000 ppm de H2 */
+#define TABLE_MQ2_LOG_RATIO 0.21    /**< A: log10(Rs / R0) en el punto de referencia */
+#define TABLE_MQ2_SLOPE     (-0.47) /**< B: pendiente de la recta */
+#define TABLE_MQ2_LOG_PPM   2.3     /**< C: log10(ppm) del punto de referencia (200 ppm) */
+#define TABLE_MQ2_MAX_PPM   10000.0 /**< Concentracion a la que se satura la curva */
+#define TABLE_MQ2_GAIN      1.0     /**< Ganancia sobre la curva (ajuste de cada sensor) */
+#define TABLE_MQ2_OFFSET    0.0     /**< Centenas de ppm sumadas al resultado */
+#define TABLE_MQ2_MAX       100     /**< Valor maximo */
+
+// DAC del LED de iluminacion: brillo = (100 - luz) %, corregido por la gamma de la percepcion.
+#define TABLE_DAC_GAMMA 2.2                 /**< Exponente de la correccion */
+#define TABLE_DAC_MAX   1023                /**< Valor maximo del DAC (10 bits) */
+#define TABLE_DAC_SIZE  (TABLE_LDR_MAX + 1) /**< Entradas: una por porcentaje de luz */
+
+// Motor paso a paso de la ventilacion (NEMA17 con A4988): perfil de la maniobra de apertura y cierre.
+#define TABLE_MOTOR_STEPS       49    /**< Pasos de una maniobra */
+#define TABLE_MOTOR_START_SPEED 900   /**< Velocidad de arranque y de llegada, en pasos/s (sin perder pasos) */
+#define TABLE_MOTOR_MAX_SPEED   4000  /**< Velocidad de crucero, en pasos/s */
+#define TABLE_MOTOR_ACCEL       40000 /**< Aceleracion media de las rampas, en pasos/s^2 */
+#define TABLE_MOTOR_SCURVE      1     /**< 1: rampas en S (tiron limitado), 0: trapecio */
+
+#endif /* TABLE_CONFIG_H */
@@ -0,0 +1,206 @@
+/**
+ * @file telemetry.c
+ * @brief Protocolo de tramas de telemetria: codificacion en el lugar y decodificacion incremental.
+ *
+ * El decodificador tiene un camino rapido para el caso normal: si una trama entera y valida esta dentro del bloque
+ * recibido se entrega apuntando al bloque, sin copiarla. Solo las tramas partidas entre dos bloques y los bytes que
+ * siguen a una perdida de sincronismo se acumulan de a uno en el buffer del decodificador. Al fallar una trama no se
+ * descartan todos sus bytes: se vuelve a buscar el sincronismo dentro de ellos, porque si el byte perdido era el de
+ * longitud, la trama falsa puede haberse tragado el comienzo de la siguiente.
+ */
+
+#include "telemetry.h"
+
+#include <string.h>
+
+#include "crc16.h"
+
+/**
+ * @brief Indica si el encabezado de una trama tiene una version y una longitud aceptables.
+ */
+static Bool TELEMETRY_HeaderValid(const uint8_t* frame)
+{
+    return (frame[TELEMETRY_OFFSET_VERSION] == TELEMETRY_VERSION &&
+            frame[TELEMETRY_OFFSET_LENGTH] <= TELEMETRY_MAX_PAYLOAD)
+               ? TRUE
+               : FALSE;
+}
+
+/**
+ * @brief Verifica el CRC de una trama completa.
+ *
+ * Como el CRC se agrega con el byte mas significativo primero, el CRC del encabezado, la carga y el propio CRC
+ * da cero si la trama esta intacta.
+ */
+static Bool TELEMETRY_CrcValid(const uint8_t* frame, uint32_t total)
+{
+    return (CRC16_Update(CRC16_INIT, &frame[TELEMETRY_OFFSET_VERSION], total - TELEMETRY_OFFSET_VERSION) == 0)
+               ? TRUE
+               : FALSE;
+}
+
+/**
+ * @brief Entrega una trama valida y actualiza el seguimiento de la secuencia.
+ */
+static void TELEMETRY_Accept(TELEMETRY_Decoder_Type* decoder, const uint8_t* data, TELEMETRY_Frame_Type* frame)
+{
+    frame->Type = data[TELEMETRY_OFFSET_TYPE];
+    frame->Sequence = data[TELEMETRY_OFFSET_SEQUENCE];
+    frame->Length = data[TELEMETRY_OFFSET_LENGTH];
+    frame->Payload = TELEMETRY_PAYLOAD(data);
+
+    if (decoder->Started)
+    {
+        decoder->Stats.Lost += (uint8_t)(frame->Sequence - decoder->Next_Sequence);
+    }
+    decoder->Next_Sequence = (uint8_t)(frame->Sequence + 1);
+    decoder->Started = 1;
+    decoder->Synced = 1;
+    decoder->Stats.Frames++;
+}
+
+/**
+ * @brief Descarta el primer byte de la trama en curso y los que siguen hasta el proximo posible sincronismo.
+ */
+static void TELEMETRY_Drop(TELEMETRY_Decoder_Type* decoder)
+{
+    uint8_t skip = 1;
+
+    while (skip < decoder->Count && decoder->Frame[skip] != TELEMETRY_SYNC0)
+    {
+        skip++;
+    }
+
+    if (decoder->Synced)
+    {
+        decoder->Stats.Resyncs++;
+        decoder->Synced = 0;
+    }
+    decoder->Stats.Discarded += skip;
+    decoder->Count -= skip;
+    memmove(decoder->Frame, &decoder->Frame[skip], decoder->Count);
+}
+
+/**
+ * @brief Revisa la trama en curso luego de agregarle un byte.
+ *
+ * @return TRUE si la trama quedo completa y valida.
+ */
+static Bool TELEMETRY_Check(TELEMETRY_Decoder_Type* decoder, TELEMETRY_Frame_Type* frame)
+{
+    uint32_t total;
+
+    for (;;)
+    {
+        if (decoder->Count >= 1 && decoder->Frame[0] != TELEMETRY_SYNC0)
+        {
+            TELEMETRY_Drop(decoder);
+            continue;
+        }
+        if (decoder->Count >= 2 && decoder->Frame[1] != TELEMETRY_SYNC1)
+        {
+            TELEMETRY_Drop(decoder);
+            continue;
+        }
+        if (decoder->Count < TELEMETRY_HEADER_SIZE)
+        {
+            return FALSE;
+        }
+        if (TELEMETRY_HeaderValid(decoder->Frame) == FALSE)
+        {
+            decoder->Stats.Header_Errors++;
+            TELEMETRY_Drop(decoder);
+            continue;
+        }
+
+        total = TELEMETRY_OVERHEAD + decoder->Frame[TELEMETRY_OFFSET_LENGTH];
+        if (decoder->Count < total)
+        {
+            return FALSE;
+        }
+        if (TELEMETRY_CrcValid(decoder->Frame, total) == TRUE)
+        {
+            // Tras una resincronizacion puede haber bytes de la trama siguiente detras: se conservan.
+            TELEMETRY_Accept(decoder, decoder->Frame, frame);
+            memcpy(decoder->Payload, frame->Payload, frame->Length);
+            frame->Payload = decoder->Payload;
+            decoder->Count -= total;
+            memmove(decoder->Frame, &decoder->Frame[total], decoder->Count);
+            return TRUE;
+        }
+
+        // Un sincronismo falso o una trama dañada: se busca otro inicio dentro de los bytes ya acumulados.
+        decoder->Stats.Crc_Errors++;
+        TELEMETRY_Drop(decoder);
+    }
+}
+
+uint32_t TELEMETRY_Seal(uint8_t* frame, uint8_t type, uint8_t sequence, uint8_t length)
+{
+    uint32_t total = TELEMETRY_OVERHEAD + length;
+    uint16_t crc;
+
+    if (length > TELEMETRY_MAX_PAYLOAD)
+    {
+        return 0;
+    }
+
+    frame[0] = TELEMETRY_SYNC0;
+    frame[1] = TELEMETRY_SYNC1;
+    frame[TELEMETRY_OFFSET_VERSION] = TELEMETRY_VERSION;
+    frame[TELEMETRY_OFFSET_TYPE] = type;
+    frame[TELEMETRY_OFFSET_SEQUENCE] = sequence;
+    frame[TELEMETRY_OFFSET_LENGTH] = length;
+
+    // El CRC cubre desde la version hasta el final de la carga:
+    crc = CRC16_Update(CRC16_INIT, &frame[TELEMETRY_OFFSET_VERSION],
+                       total - TELEMETRY_OFFSET_VERSION - TELEMETRY_CRC_SIZE);
+    frame[total - TELEMETRY_CRC_SIZE] = (uint8_t)(crc >> 8);
+    frame[total - 1] = (uint8_t)crc;
+
+    return total;
+}
+
+void TELEMETRY_DecoderInit(TELEMETRY_Decoder_Type* decoder)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->Synced = 1;
+}
+
+uint32_t TELEMETRY_Decode(TELEMETRY_Decoder_Type* decoder, const uint8_t* data, uint32_t length,
+                          TELEMETRY_Frame_Type* frame)
+{
+    uint32_t pos = 0;
+    uint32_t total;
+
+    frame->Payload = NULL;
+
+    // Bytes que quedaron acumulados detras de la ultima trama entregada:
+    if (decoder->Count != 0 && TELEMETRY_Check(decoder, frame) == TRUE)
+    {
+        return 0;
+    }
+
+    while (pos < length)
+    {
+        // Camino rapido: trama entera y valida al comienzo de lo que queda del bloque.
+        if (decoder->Count == 0 && length - pos >= TELEMETRY_HEADER_SIZE && data[pos] == TELEMETRY_SYNC0 &&
+            data[pos + 1] == TELEMETRY_SYNC1 && TELEMETRY_HeaderValid(&data[pos]) == TRUE)
+        {
+            total = TELEMETRY_OVERHEAD + data[pos + TELEMETRY_OFFSET_LENGTH];
+            if (length - pos >= total && TELEMETRY_CrcValid(&data[pos], total) == TRUE)
+            {
+                TELEMETRY_Accept(decoder, &data[pos], frame);
+                return pos + total;
+            }
+        }
+
+        decoder->Frame[decoder->Count++] = data[pos++];
+        if (TELEMETRY_Check(decoder, frame) == TRUE)
+        {
+            break;
+        }
+    }
+
+    return pos;
+}
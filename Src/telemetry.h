@@ -0,0 +1,131 @@
+/**
+ * @file telemetry.h
+ * @brief Protocolo de tramas de telemetria: codificacion en el lugar y decodificacion incremental.
+ *
+ * Formato de una trama (version 1):
+ *
+ *     | 0xA5 | 0x5A | version | tipo | secuencia | longitud | carga (0-24 bytes) | CRC16 (MSB, LSB) |
+ *
+ * La palabra de sincronismo marca el inicio, la secuencia aumenta en uno por trama (modulo 256) para detectar
+ * perdidas y el CRC-16/CCITT cubre desde la version hasta el final de la carga. La codificacion arma la trama
+ * alrededor de una carga que ya esta en su lugar, de modo que el firmware escribe directamente en el buffer que
+ * transmite el GPDMA. La decodificacion es incremental y no reserva memoria: procesa bloques de cualquier tamaño,
+ * y ante un error de CRC o de encabezado descarta un byte y busca el siguiente sincronismo, por lo que la perdida
+ * de un byte solo invalida la trama que lo contenia.
+ *
+ * El modulo no depende de perifericos: el receptor de Linux (Reception_Code) usa el mismo codigo.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define TELEMETRY_SYNC0       0xA5 /**< Primer byte de sincronismo */
+#define TELEMETRY_SYNC1       0x5A /**< Segundo byte de sincronismo */
+#define TELEMETRY_VERSION     1    /**< Version del formato */
+#define TELEMETRY_HEADER_SIZE 6    /**< Bytes del encabezado, incluido el sincronismo */
+#define TELEMETRY_CRC_SIZE    2    /**< Bytes del CRC */
+#define TELEMETRY_MAX_PAYLOAD 24   /**< Maximo de bytes de carga */
+
+#define TELEMETRY_OFFSET_VERSION  2 /**< Posicion de la version */
+#define TELEMETRY_OFFSET_TYPE     3 /**< Posicion del tipo */
+#define TELEMETRY_OFFSET_SEQUENCE 4 /**< Posicion de la secuencia */
+#define TELEMETRY_OFFSET_LENGTH   5 /**< Posicion de la longitud de la carga */
+
+#define TELEMETRY_OVERHEAD       (TELEMETRY_HEADER_SIZE + TELEMETRY_CRC_SIZE) /**< Bytes agregados a la carga */
+#define TELEMETRY_FRAME_MAX      (TELEMETRY_OVERHEAD + TELEMETRY_MAX_PAYLOAD) /**< Tamaño maximo de una trama */
+#define TELEMETRY_PAYLOAD(frame) ((frame) + TELEMETRY_HEADER_SIZE)            /**< Carga dentro de una trama */
+
+/**
+ * @brief Tipos de trama.
+ */
+typedef enum
+{
+    TELEMETRY_TYPE_MEASURES = 1 /**< Mediciones: un byte por canal de sensor y la ventilacion (0/1) */
+} TELEMETRY_Kind_Type;
+
+// Carga de TELEMETRY_TYPE_MEASURES: los canales de la tabla de sensores en orden y la ventilacion al final. Los
+// tres primeros son los de la placa base, de modo que una placa sin sensores agregados envia la trama de 4 bytes.
+#define TELEMETRY_MEASURE_CHANNELS     8                                /**< Canales de sensores como maximo */
+#define TELEMETRY_MEASURES_SIZE        4                                /**< Bytes de la carga de la placa base */
+#define TELEMETRY_MEASURES_MAX         (TELEMETRY_MEASURE_CHANNELS + 1) /**< Bytes de la carga como maximo */
+#define TELEMETRY_MEASURE_TEMP         0                                /**< Temperatura, en grados Celsius (0-100) */
+#define TELEMETRY_MEASURE_LIGHT        1                                /**< Iluminacion, en porcentaje */
+#define TELEMETRY_MEASURE_GAS          2                                /**< Gas, en centenas de ppm (0-100) */
+#define TELEMETRY_MEASURE_VENT(length) ((length) - 1)                   /**< Ventilacion: 1 abierta, 0 cerrada */
+
+/**
+ * @brief Trama decodificada. La carga apunta al bloque recibido o al buffer del decodificador y solo es valida
+ *        hasta la proxima llamada a TELEMETRY_Decode().
+ */
+typedef struct
+{
+    uint8_t Type;           /**< Tipo de trama */
+    uint8_t Sequence;       /**< Numero de secuencia */
+    uint8_t Length;         /**< Bytes de carga */
+    const uint8_t* Payload; /**< Carga */
+} TELEMETRY_Frame_Type;
+
+/**
+ * @brief Contadores del decodificador.
+ */
+typedef struct
+{
+    uint32_t Frames;        /**< Tramas validas */
+    uint32_t Discarded;     /**< Bytes descartados buscando sincronismo */
+    uint32_t Resyncs;       /**< Veces que se perdio el sincronismo */
+    uint32_t Crc_Errors;    /**< Tramas con CRC incorrecto */
+    uint32_t Header_Errors; /**< Encabezados con version o longitud invalida */
+    uint32_t Lost;          /**< Tramas perdidas segun los saltos de la secuencia */
+} TELEMETRY_Stats_Type;
+
+/**
+ * @brief Estado del decodificador.
+ */
+typedef struct
+{
+    uint8_t Frame[TELEMETRY_FRAME_MAX];     /**< Trama en curso (y bytes recibidos detras de ella) */
+    uint8_t Payload[TELEMETRY_MAX_PAYLOAD]; /**< Carga de la ultima trama entregada desde Frame */
+    uint8_t Count;                      /**< Bytes acumulados en Frame */
+    uint8_t Synced;                     /**< 0 mientras se descartan bytes buscando sincronismo */
+    uint8_t Started;                    /**< 1 si ya se recibio alguna trama (Next_Sequence es valido) */
+    uint8_t Next_Sequence;              /**< Secuencia esperada en la proxima trama */
+    TELEMETRY_Stats_Type Stats;         /**< Contadores */
+} TELEMETRY_Decoder_Type;
+
+/**
+ * @brief Completa una trama alrededor de su carga: sincronismo, encabezado y CRC.
+ *
+ * La carga debe estar ya escrita en TELEMETRY_PAYLOAD(frame).
+ *
+ * @param frame Buffer de la trama (al menos TELEMETRY_OVERHEAD + length bytes).
+ * @param type Tipo de trama.
+ * @param sequence Numero de secuencia.
+ * @param length Bytes de carga.
+ * @return Bytes de la trama completa, o 0 si la carga es demasiado larga.
+ */
+uint32_t TELEMETRY_Seal(uint8_t* frame, uint8_t type, uint8_t sequence, uint8_t length);
+
+/**
+ * @brief Inicializa el decodificador.
+ */
+void TELEMETRY_DecoderInit(TELEMETRY_Decoder_Type* decoder);
+
+/**
+ * @brief Procesa bytes recibidos hasta completar una trama o agotar el bloque.
+ *
+ * Se llama en un lazo hasta consumir el bloque entero; cada llamada que completa una trama la devuelve en frame.
+ * Puede devolver una trama sin consumir bytes, si quedo completa entre los bytes acumulados de una resincronizacion.
+ *
+ * @param decoder Decodificador.
+ * @param data Bytes recibidos.
+ * @param length Cantidad de bytes.
+ * @param frame Trama completada en esta llamada.
+ * @return Bytes consumidos de data; si se completo una trama, frame->Payload es distinto de NULL.
+ */
+uint32_t TELEMETRY_Decode(TELEMETRY_Decoder_Type* decoder, const uint8_t* data, uint32_t length,
+                          TELEMETRY_Frame_Type* frame);
+
+#endif /* TELEMETRY_H */
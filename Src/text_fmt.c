@@ -0,0 +1,48 @@
+/**
+ * @file text_fmt.c
+ * @brief Armado de las lineas de texto de los reportes que se envian por UART, sin printf.
+ *
+ * Los digitos se calculan del menos significativo al mas significativo en un arreglo local y se copian en orden
+ * inverso: una division por digito, sin tablas de potencias de diez.
+ */
+
+#include "text_fmt.h"
+
+uint32_t TEXT_FMT_PutText(char* line, uint32_t pos, const char* text)
+{
+    while (*text != '\0')
+    {
+        line[pos++] = *text++;
+    }
+
+    return pos;
+}
+
+uint32_t TEXT_FMT_PutNumber(char* line, uint32_t pos, uint32_t value)
+{
+    return TEXT_FMT_PutPadded(line, pos, value, 1);
+}
+
+uint32_t TEXT_FMT_PutPadded(char* line, uint32_t pos, uint32_t value, uint8_t width)
+{
+    char digits[TEXT_FMT_MAX_DIGITS];
+    uint8_t count = 0;
+
+    if (width > TEXT_FMT_MAX_DIGITS)
+    {
+        width = TEXT_FMT_MAX_DIGITS;
+    }
+
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || count < width);
+
+    while (count > 0)
+    {
+        line[pos++] = digits[--count];
+    }
+
+    return pos;
+}
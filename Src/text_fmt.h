@@ -0,0 +1,51 @@
+/**
+ * @file text_fmt.h
+ * @brief Armado de las lineas de texto de los reportes que se envian por UART, sin printf.
+ *
+ * Cada funcion agrega un campo en la posicion dada y devuelve la posicion siguiente, asi que una linea se arma
+ * encadenando llamadas sobre el mismo indice. No se agrega el terminador ni se controla el tamaño: cada modulo
+ * define el de su linea para el peor caso de sus campos (TEXT_FMT_MAX_DIGITS por numero).
+ *
+ * El modulo no depende de perifericos: el receptor de Linux (Reception_Code) lo usa junto con uart_baud.c.
+ */
+
+#ifndef TEXT_FMT_H
+#define TEXT_FMT_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define TEXT_FMT_MAX_DIGITS 10 /**< Digitos decimales de un uint32_t */
+
+/**
+ * @brief Agrega un texto a una linea.
+ *
+ * @param line Linea en construccion.
+ * @param pos Posicion actual dentro de la linea.
+ * @param text Texto terminado en cero.
+ * @return Nueva posicion.
+ */
+uint32_t TEXT_FMT_PutText(char* line, uint32_t pos, const char* text);
+
+/**
+ * @brief Agrega un numero decimal a una linea.
+ *
+ * @param line Linea en construccion.
+ * @param pos Posicion actual dentro de la linea.
+ * @param value Numero a agregar.
+ * @return Nueva posicion.
+ */
+uint32_t TEXT_FMT_PutNumber(char* line, uint32_t pos, uint32_t value);
+
+/**
+ * @brief Agrega un numero decimal con una cantidad minima de digitos, completada con ceros a la izquierda.
+ *
+ * @param line Linea en construccion.
+ * @param pos Posicion actual dentro de la linea.
+ * @param value Numero a agregar.
+ * @param width Cantidad minima de digitos (hasta TEXT_FMT_MAX_DIGITS).
+ * @return Nueva posicion.
+ */
+uint32_t TEXT_FMT_PutPadded(char* line, uint32_t pos, uint32_t value, uint8_t width);
+
+#endif /* TEXT_FMT_H */
@@ -0,0 +1,160 @@
+/**
+ * @file uart_baud.c
+ * @brief Busqueda de los divisores de velocidad del UART: DLM:DLL, divisor fraccional (FDR) y divisor de PCLK.
+ *
+ * Los calculos son enteros de 64 bits: solo se hacen al configurar el UART y evitan el redondeo de la division
+ * flotante que usa el driver (uart_set_divisors()), que ademas no informa el error que obtiene.
+ */
+
+#include "uart_baud.h"
+
+#include <stddef.h>
+
+#include "text_fmt.h"
+
+// Divisores de PCLK en orden de preferencia ante igual error (menor consumo primero):
+static const uint8_t Pclk_Divs[] = {8, 4, 2, 1};
+
+/**
+ * @brief Valor absoluto de un error en ppm.
+ */
+static uint32_t UART_BAUD_Abs(int32_t error)
+{
+    return (error < 0) ? (uint32_t)(-error) : (uint32_t)error;
+}
+
+/**
+ * @brief Evalua un DLM:DLL para una fraccion y lo guarda si mejora el error.
+ *
+ * @param config Mejor configuracion hasta el momento (Baud y Pclk ya cargados).
+ * @param best Valor absoluto del error de config.
+ * @param divisor DLM:DLL a evaluar (se lleva a su rango valido).
+ * @param mul MULVAL.
+ * @param add DIVADDVAL.
+ */
+static void UART_BAUD_Try(UART_BAUD_Config_Type* config, uint32_t* best, uint64_t divisor, uint8_t mul, uint8_t add)
+{
+    uint64_t numerator = (uint64_t)config->Pclk * mul;
+    uint64_t denominator;
+    uint32_t min_divisor = (add > 0) ? UART_BAUD_MIN_FRACTION : 1;
+    int32_t error;
+
+    if (divisor < min_divisor)
+    {
+        divisor = min_divisor;
+    }
+    if (divisor > UART_BAUD_MAX_DIVISOR)
+    {
+        divisor = UART_BAUD_MAX_DIVISOR;
+    }
+
+    // Error exacto de la velocidad obtenida, redondeado a ppm:
+    denominator = 16ULL * divisor * (uint32_t)(mul + add);
+    error = (int32_t)((int64_t)((numerator * 1000000ULL + denominator * config->Baud / 2) /
+                                (denominator * config->Baud)) -
+                      1000000);
+
+    if (UART_BAUD_Abs(error) < *best)
+    {
+        *best = UART_BAUD_Abs(error);
+        config->Actual = (uint32_t)((numerator + denominator / 2) / denominator);
+        config->Error_Ppm = error;
+        config->Divisor = (uint16_t)divisor;
+        config->Div_Add = add;
+        config->Mul = mul;
+    }
+}
+
+Status UART_BAUD_SearchPclk(uint32_t pclk, uint32_t baud, UART_BAUD_Config_Type* config)
+{
+    uint64_t divisor;
+    uint32_t best = UINT32_MAX;
+
+    config->Baud = baud;
+    config->Actual = 0;
+    config->Error_Ppm = 0;
+    config->Pclk = pclk;
+    config->Divisor = 0;
+    config->Div_Add = 0;
+    config->Mul = 1;
+    config->Pclk_Div = 0;
+
+    if (pclk == 0 || baud == 0)
+    {
+        return ERROR;
+    }
+
+    for (uint8_t mul = 1; mul <= UART_BAUD_MAX_MUL; mul++)
+    {
+        // Con DIVADDVAL en cero el MULVAL no influye: basta con probar MULVAL = 1 (el valor de reset del FDR).
+        for (uint8_t add = (mul == 1) ? 0 : 1; add < mul; add++)
+        {
+            // El error depende de 1 / DLM:DLL: el mas cercano puede ser cualquiera de los dos enteros que rodean
+            // al ideal, pclk * mul / (16 * baud * (mul + add)).
+            divisor = (uint64_t)pclk * mul / (16ULL * baud * (uint32_t)(mul + add));
+            UART_BAUD_Try(config, &best, divisor, mul, add);
+            UART_BAUD_Try(config, &best, divisor + 1, mul, add);
+        }
+    }
+
+    return (best <= UART_BAUD_MAX_ERROR_PPM) ? SUCCESS : ERROR;
+}
+
+Status UART_BAUD_Search(uint32_t cclk, uint8_t pclk_div, uint32_t baud, UART_BAUD_Config_Type* config)
+{
+    UART_BAUD_Config_Type candidate;
+    uint32_t best;
+
+    // Primero a la PCLK actual, para no cambiar el reloj del UART si no hace falta:
+    if (UART_BAUD_SearchPclk(cclk / pclk_div, baud, config) == SUCCESS)
+    {
+        config->Pclk_Div = pclk_div;
+        return SUCCESS;
+    }
+    config->Pclk_Div = pclk_div;
+    best = (config->Divisor != 0) ? UART_BAUD_Abs(config->Error_Ppm) : UINT32_MAX;
+
+    for (uint8_t i = 0; i < sizeof(Pclk_Divs); i++)
+    {
+        UART_BAUD_SearchPclk(cclk / Pclk_Divs[i], baud, &candidate);
+        candidate.Pclk_Div = Pclk_Divs[i];
+
+        if (candidate.Divisor != 0 && UART_BAUD_Abs(candidate.Error_Ppm) < best)
+        {
+            best = UART_BAUD_Abs(candidate.Error_Ppm);
+            *config = candidate;
+        }
+    }
+
+    return (best <= UART_BAUD_MAX_ERROR_PPM) ? SUCCESS : ERROR;
+}
+
+uint32_t UART_BAUD_Format(char* line, const UART_BAUD_Config_Type* config)
+{
+    uint32_t error = UART_BAUD_Abs(config->Error_Ppm);
+    uint32_t pos = 0;
+
+    // El error se muestra en porcentaje con dos decimales: 100 ppm por centesimo.
+    error = (error + 50) / 100;
+
+    pos = TEXT_FMT_PutText(line, pos, "BAUD ");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Baud);
+    pos = TEXT_FMT_PutText(line, pos, " real=");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Actual);
+    pos = TEXT_FMT_PutText(line, pos, (config->Error_Ppm < 0 && error != 0) ? " err=-" : " err=+");
+    pos = TEXT_FMT_PutNumber(line, pos, error / 100);
+    pos = TEXT_FMT_PutText(line, pos, ".");
+    pos = TEXT_FMT_PutPadded(line, pos, error % 100, 2);
+    pos = TEXT_FMT_PutText(line, pos, "% pclk=");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Pclk);
+    pos = TEXT_FMT_PutText(line, pos, " dl=");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Divisor);
+    pos = TEXT_FMT_PutText(line, pos, " fdr=");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Div_Add);
+    pos = TEXT_FMT_PutText(line, pos, "/");
+    pos = TEXT_FMT_PutNumber(line, pos, config->Mul);
+    pos = TEXT_FMT_PutText(line, pos, "\r\n");
+    line[pos] = '\0';
+
+    return pos;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file uart_baud.h
+ * @brief Busqueda de los divisores de velocidad del UART: DLM:DLL, divisor fraccional (FDR) y divisor de PCLK.
+ *
+ * La velocidad de un UART del LPC1769 es
+ *
+ *     baudios = PCLK / (16 * (256 * DLM + DLL) * (1 + DIVADDVAL / MULVAL))
+ *
+ * con 1 <= MULVAL <= 15, 0 <= DIVADDVAL < MULVAL y, si DIVADDVAL > 0, DLM:DLL >= 3. La busqueda recorre todas las
+ * fracciones y para cada una prueba los dos DLM:DLL que rodean al ideal, quedandose con el error menor. A 25 MHz de
+ * PCLK (CCLK / 4, el valor de system_LPC17xx.c) la velocidad maxima con divisor fraccional es 520833 baudios, por lo
+ * que 921600 requiere cambiar el divisor de PCLK del UART (PCLKSEL): si a la PCLK actual el error no es aceptable,
+ * UART_BAUD_Search() prueba tambien los demas divisores.
+ *
+ * El modulo no depende de perifericos: el receptor de Linux (Reception_Code) lo usa para verificar la tabla de
+ * divisores de cada velocidad estandar.
+ */
+
+#ifndef UART_BAUD_H
+#define UART_BAUD_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define UART_BAUD_MAX_ERROR_PPM 15000 /**< Error maximo aceptado (1,5 %): deja margen para el error del otro extremo */
+#define UART_BAUD_MAX_DIVISOR   65535 /**< Maximo valor de DLM:DLL */
+#define UART_BAUD_MIN_FRACTION  3     /**< Minimo DLM:DLL con divisor fraccional activo (DIVADDVAL > 0) */
+#define UART_BAUD_MAX_MUL       15    /**< Maximo MULVAL */
+#define UART_BAUD_DEFAULT_DIV   4     /**< Divisor de PCLK de system_LPC17xx.c (PCLKSEL0/1 en cero) */
+#define UART_BAUD_LINE_SIZE     96    /**< Tamaño maximo de la linea de UART_BAUD_Format() */
+#define UART_BAUD_REPORT_CMD    'B'   /**< Byte recibido por UART2 que pide el envio de la velocidad configurada */
+
+/**
+ * @brief Divisores elegidos para una velocidad y resultado obtenido.
+ */
+typedef struct
+{
+    uint32_t Baud;      /**< Velocidad pedida */
+    uint32_t Actual;    /**< Velocidad obtenida (redondeada) */
+    int32_t Error_Ppm;  /**< Error relativo de Actual respecto de Baud, en partes por millon */
+    uint32_t Pclk;      /**< PCLK del UART, en Hz */
+    uint16_t Divisor;   /**< DLM:DLL */
+    uint8_t Div_Add;    /**< DIVADDVAL del FDR */
+    uint8_t Mul;        /**< MULVAL del FDR */
+    uint8_t Pclk_Div;   /**< Divisor de CCLK que da Pclk: 1, 2, 4 u 8 */
+} UART_BAUD_Config_Type;
+
+/**
+ * @brief Busca los divisores de menor error para una PCLK fija.
+ *
+ * @param pclk PCLK del UART, en Hz.
+ * @param baud Velocidad pedida.
+ * @param config Divisores elegidos (Pclk_Div queda en 0: no se conoce la CCLK).
+ * @return SUCCESS si el error es como maximo UART_BAUD_MAX_ERROR_PPM, ERROR si no (config queda con la mejor
+ *         opcion encontrada, o con Divisor en 0 si ninguna es posible).
+ */
+Status UART_BAUD_SearchPclk(uint32_t pclk, uint32_t baud, UART_BAUD_Config_Type* config);
+
+/**
+ * @brief Busca los divisores de menor error, cambiando el divisor de PCLK solo si hace falta.
+ *
+ * Si a la PCLK actual (cclk / pclk_div) el error es aceptable se queda con ella; si no, elige el menor error de
+ * los cuatro divisores de PCLK y, a igual error, el divisor mayor (menor consumo).
+ *
+ * @param cclk Frecuencia del nucleo, en Hz.
+ * @param pclk_div Divisor de PCLK actual del UART: 1, 2, 4 u 8.
+ * @param baud Velocidad pedida.
+ * @param config Divisores elegidos.
+ * @return SUCCESS si el error es como maximo UART_BAUD_MAX_ERROR_PPM, ERROR si no.
+ */
+Status UART_BAUD_Search(uint32_t cclk, uint8_t pclk_div, uint32_t baud, UART_BAUD_Config_Type* config);
+
+/**
+ * @brief Arma la linea de texto que describe una configuracion.
+ *
+ * Formato: "BAUD <pedida> real=<obtenida> err=<+/-x.xx>% pclk=<Hz> dl=<DLM:DLL> fdr=<DIVADDVAL>/<MULVAL>\r\n".
+ *
+ * @param line Donde se arma la linea (UART_BAUD_LINE_SIZE bytes).
+ * @param config Configuracion a describir.
+ * @return Longitud de la linea (sin terminador).
+ */
+uint32_t UART_BAUD_Format(char* line, const UART_BAUD_Config_Type* config);
+
+#endif /* UART_BAUD_H */
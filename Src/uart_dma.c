@@ -0,0 +1,175 @@
+/**
+ * @file uart_dma.c
+ * @brief Transmision no bloqueante por UART2 alimentada por un canal del GPDMA.
+ *
+ * El codigo que encola la trama solo la arma (o la copia) en un buffer libre y, si el canal esta libre, programa el
+ * GPDMA en modo memoria a periferico (M2P) hacia el THR del UART2. El resto del envio ocurre sin intervencion de la
+ * CPU.
+ */
+
+#include "uart_dma.h"
+
+#include "LPC17xx.h"
+#include "ahbram.h"
+#include "lpc17xx_gpdma.h"
+#include "ramfunc.h"
+
+#define UART_DMA_IDLE 0xFF /**< Indice que marca la ausencia de buffer activo o pendiente */
+
+AHBRAM1_NOINIT static uint8_t Frames[UART_DMA_BUFFERS][UART_DMA_FRAME_SIZE]; /**< Buffers de trama (ver ahbram.h) */
+
+static uint32_t Frame_Length[UART_DMA_BUFFERS];               /**< Longitud de cada trama encolada */
+static volatile uint8_t Active_Frame = UART_DMA_IDLE;         /**< Buffer que esta transmitiendo el GPDMA */
+static volatile uint8_t Pending_Frame = UART_DMA_IDLE;        /**< Buffer en espera de ser transmitido */
+static uint8_t Acquired_Frame = UART_DMA_IDLE;                /**< Buffer reservado para armar una trama */
+static volatile uint32_t Dropped_Frames = 0;                  /**< Tramas descartadas por falta de buffer */
+static UART_DMA_Callback Frame_Callback = NULL;               /**< Callback de fin de trama */
+
+/**
+ * @brief Programa el canal del GPDMA para transmitir uno de los buffers.
+ *
+ * @param frame Indice del buffer a transmitir.
+ */
+static void UART_DMA_Start(uint8_t frame)
+{
+    GPDMA_Channel_CFG_Type DMAChannel;
+    DMAChannel.ChannelNum = UART_DMA_CHANNEL;         // Canal DMA del UART2
+    DMAChannel.SrcMemAddr = (uint32_t)Frames[frame];  // Direccion de origen (buffer de la trama)
+    DMAChannel.DstMemAddr = 0;                        // No se usa, el destino es el THR del UART2
+    DMAChannel.TransferSize = Frame_Length[frame];    // Cantidad de bytes de la trama
+    DMAChannel.TransferWidth = 0;                     // Solo se usa en M2M
+    DMAChannel.TransferType = GPDMA_TRANSFERTYPE_M2P; // Tipo de transferencia (memoria a periferico)
+    DMAChannel.SrcConn = 0;                           // No se usa conexion para el origen
+    DMAChannel.DstConn = GPDMA_CONN_UART2_Tx;         // Conexion del destino (UART2 TX)
+    DMAChannel.DMALLI = 0;                            // Transferencia unica, sin lista enlazada
+
+    Active_Frame = frame;
+    GPDMA_Setup(&DMAChannel);
+    GPDMA_ChannelCmd(UART_DMA_CHANNEL, ENABLE);
+}
+
+void UART_DMA_Init(UART_DMA_Callback callback)
+{
+    Frame_Callback = callback;
+    Active_Frame = UART_DMA_IDLE;
+    Pending_Frame = UART_DMA_IDLE;
+    Acquired_Frame = UART_DMA_IDLE;
+    Dropped_Frames = 0;
+}
+
+uint8_t* UART_DMA_Acquire(void)
+{
+    uint8_t* buffer = NULL;
+
+    // Se evita que la interrupcion del GPDMA cambie el estado de los buffers mientras se elige uno:
+    NVIC_DisableIRQ(DMA_IRQn);
+
+    if (Pending_Frame != UART_DMA_IDLE || Acquired_Frame != UART_DMA_IDLE)
+    {
+        // Ambos buffers ocupados: se descarta la trama en lugar de bloquear.
+        Dropped_Frames++;
+    }
+    else
+    {
+        // El buffer que no esta transmitiendo sigue libre aunque la transferencia en curso termine antes del Commit.
+        Acquired_Frame = (Active_Frame == UART_DMA_IDLE) ? 0 : (Active_Frame ^ 1);
+        buffer = Frames[Acquired_Frame];
+    }
+
+    NVIC_EnableIRQ(DMA_IRQn);
+    return buffer;
+}
+
+Status UART_DMA_Commit(uint32_t length)
+{
+    uint8_t frame = Acquired_Frame;
+
+    Acquired_Frame = UART_DMA_IDLE;
+    if (frame == UART_DMA_IDLE || length == 0 || length > UART_DMA_FRAME_SIZE)
+    {
+        return ERROR;
+    }
+    Frame_Length[frame] = length;
+
+    NVIC_DisableIRQ(DMA_IRQn);
+
+    if (Active_Frame == UART_DMA_IDLE)
+    {
+        UART_DMA_Start(frame); // Canal libre: se transmite de inmediato
+    }
+    else
+    {
+        Pending_Frame = frame; // Canal ocupado: queda en espera
+    }
+
+    NVIC_EnableIRQ(DMA_IRQn);
+    return SUCCESS;
+}
+
+Status UART_DMA_Send(const volatile uint8_t* data, uint32_t length)
+{
+    uint8_t* buffer;
+
+    if (length == 0 || length > UART_DMA_FRAME_SIZE)
+    {
+        return ERROR;
+    }
+
+    buffer = UART_DMA_Acquire();
+    if (buffer == NULL)
+    {
+        return ERROR;
+    }
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        buffer[i] = data[i];
+    }
+
+    return UART_DMA_Commit(length);
+}
+
+Bool UART_DMA_Busy(void)
+{
+    return (Active_Frame != UART_DMA_IDLE) ? TRUE : FALSE;
+}
+
+uint32_t UART_DMA_GetDropped(void)
+{
+    return Dropped_Frames;
+}
+
+RAMFUNC void UART_DMA_IRQHandler(void)
+{
+    uint8_t frame;
+
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INT, UART_DMA_CHANNEL) == RESET)
+    {
+        return;
+    }
+
+    // Limpiamos las banderas de fin de transferencia y de error del canal:
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC, UART_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC, UART_DMA_CHANNEL);
+    }
+    if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR, UART_DMA_CHANNEL) == SET)
+    {
+        GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR, UART_DMA_CHANNEL);
+    }
+
+    Active_Frame = UART_DMA_IDLE;
+
+    // Si hay una trama pendiente se lanza antes del callback para no dejar la linea ociosa:
+    if (Pending_Frame != UART_DMA_IDLE)
+    {
+        frame = Pending_Frame;
+        Pending_Frame = UART_DMA_IDLE;
+        UART_DMA_Start(frame);
+    }
+
+    if (Frame_Callback != NULL)
+    {
+        Frame_Callback();
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file uart_dma.h
+ * @brief Transmision no bloqueante por UART2 alimentada por un canal del GPDMA.
+ *
+ * Las tramas se encolan en uno de dos buffers (doble buffer): mientras el GPDMA vacia uno hacia el THR del UART2,
+ * el otro queda libre para la trama siguiente. Al terminar cada transferencia se invoca un callback de completado.
+ *
+ * Las tramas se pueden armar directamente en el buffer que lee el GPDMA, sin copias intermedias: UART_DMA_Acquire()
+ * entrega el buffer libre y UART_DMA_Commit() lo encola. UART_DMA_Send() hace lo mismo copiando datos ya armados.
+ */
+
+#ifndef UART_DMA_H
+#define UART_DMA_H
+
+#include "lpc_types.h"
+
+// Definiciones del modulo:
+#define UART_DMA_CHANNEL    1  /**< Canal del GPDMA usado para UART2 TX (el canal 0 queda para el ADC) */
+#define UART_DMA_FRAME_SIZE 32 /**< Tamaño maximo de una trama en bytes (una trama de telemetria completa) */
+#define UART_DMA_BUFFERS    2  /**< Cantidad de buffers de trama (doble buffer) */
+
+/**
+ * @brief Tipo del callback que se llama al completar el envio de una trama.
+ *
+ * Se ejecuta en contexto de la interrupcion del GPDMA, por lo que debe ser breve.
+ */
+typedef void (*UART_DMA_Callback)(void);
+
+/**
+ * @brief Inicializa el envio por DMA del UART2.
+ *
+ * Requiere que el GPDMA ya haya sido inicializado con GPDMA_Init() y que el UART2 tenga habilitado el modo DMA
+ * de sus FIFOs.
+ *
+ * @param callback Funcion a invocar al terminar cada trama (puede ser NULL).
+ */
+void UART_DMA_Init(UART_DMA_Callback callback);
+
+/**
+ * @brief Encola una trama para su envio y retorna inmediatamente.
+ *
+ * Copia los datos a un buffer libre. Si el canal esta ocioso la transferencia comienza en el momento; si no,
+ * queda pendiente hasta que termine la trama en curso.
+ *
+ * @param data Puntero a los datos a enviar.
+ * @param length Cantidad de bytes (como maximo UART_DMA_FRAME_SIZE).
+ * @return SUCCESS si la trama fue encolada, ERROR si no habia buffer libre o la longitud es invalida.
+ */
+Status UART_DMA_Send(const volatile uint8_t* data, uint32_t length);
+
+/**
+ * @brief Reserva el buffer libre para armar una trama en el lugar.
+ *
+ * El buffer queda reservado hasta UART_DMA_Commit(). Solo puede haber una reserva a la vez y debe hacerse desde un
+ * unico contexto (el bucle principal), igual que UART_DMA_Send().
+ *
+ * @return Buffer de UART_DMA_FRAME_SIZE bytes, o NULL si ambos buffers estan ocupados (la trama se cuenta como
+ *         descartada).
+ */
+uint8_t* UART_DMA_Acquire(void);
+
+/**
+ * @brief Encola la trama armada en el buffer reservado con UART_DMA_Acquire().
+ *
+ * @param length Cantidad de bytes de la trama (como maximo UART_DMA_FRAME_SIZE).
+ * @return SUCCESS si la trama fue encolada, ERROR si no habia reserva o la longitud es invalida (la reserva se
+ *         libera igual).
+ */
+Status UART_DMA_Commit(uint32_t length);
+
+/**
+ * @brief Indica si hay una transferencia en curso o una trama pendiente.
+ *
+ * @return TRUE si el canal esta ocupado, FALSE si esta ocioso.
+ */
+Bool UART_DMA_Busy(void);
+
+/**
+ * @brief Devuelve la cantidad de tramas descartadas por falta de buffer libre.
+ *
+ * @return Contador de tramas descartadas.
+ */
+uint32_t UART_DMA_GetDropped(void);
+
+/**
+ * @brief Atiende la interrupcion de fin de transferencia del canal del UART2.
+ *
+ * Debe llamarse desde DMA_IRQHandler. Limpia las banderas del canal, invoca el callback y lanza la trama
+ * pendiente, si la hay.
+ */
+void UART_DMA_IRQHandler(void);
+
+#endif /* UART_DMA_H */
@@ -0,0 +1,166 @@
+/**
+ * @file uart_ring.c
+ * @brief Transmision y recepcion por interrupciones del UART2 sobre buffers circulares SPSC.
+ *
+ * Las tramas de telemetria del GPDMA (uart_dma.c) y los bytes de este modulo comparten el THR del UART2: la FIFO
+ * solo se carga desde aqui cuando el canal DMA esta libre, y el fin de cada trama DMA vuelve a disparar la
+ * transmision. Una trama DMA nunca se parte, pero puede quedar entre dos rafagas de este modulo.
+ */
+
+#include "uart_ring.h"
+
+#include "LPC17xx.h"
+#include "lpc17xx_clkpwr.h"
+#include "lpc17xx_uart.h"
+#include "ramfunc.h"
+#include "ring_buffer.h"
+#include "uart_dma.h"
+
+static uint8_t TX_Storage[UART_RING_TX_SIZE]; /**< Almacenamiento del buffer de transmision */
+static uint8_t RX_Storage[UART_RING_RX_SIZE]; /**< Almacenamiento del buffer de recepcion */
+static RING_Buffer_Type TX_Ring;              /**< Buffer de transmision: main produce, el handler consume */
+static RING_Buffer_Type RX_Ring;              /**< Buffer de recepcion: el handler produce, main consume */
+static volatile uint32_t RX_Overruns = 0;     /**< Bytes recibidos perdidos */
+
+/**
+ * @brief Valor de PCLKSEL para cada divisor de PCLK.
+ *
+ * @param div Divisor: 1, 2, 4 u 8.
+ * @return Campo de dos bits de PCLKSEL (CCLK / 8 es el 3, que el driver no define).
+ */
+static uint32_t UART_Ring_PclkSel(uint8_t div)
+{
+    switch (div)
+    {
+    case 1:
+        return CLKPWR_PCLKSEL_CCLK_DIV_1;
+    case 2:
+        return CLKPWR_PCLKSEL_CCLK_DIV_2;
+    case 8:
+        return 3;
+    default:
+        return CLKPWR_PCLKSEL_CCLK_DIV_4;
+    }
+}
+
+void UART_Ring_Init(void)
+{
+    RING_Init(&TX_Ring, TX_Storage, UART_RING_TX_SIZE);
+    RING_Init(&RX_Ring, RX_Storage, UART_RING_RX_SIZE);
+    RX_Overruns = 0;
+
+    // Habilitación de interrupciones por dato recibido (incluye el timeout de caracter) y por estado de linea:
+    UART_IntConfig(LPC_UART2, UART_INTCFG_RBR, ENABLE);
+    UART_IntConfig(LPC_UART2, UART_INTCFG_RLS, ENABLE);
+}
+
+uint32_t UART_Ring_Write(const uint8_t* data, uint32_t length)
+{
+    uint32_t written = RING_Write(&TX_Ring, data, length);
+
+    UART_Ring_Kick();
+
+    return written;
+}
+
+uint32_t UART_Ring_Read(uint8_t* data, uint32_t length)
+{
+    return RING_Read(&RX_Ring, data, length);
+}
+
+uint32_t UART_Ring_Available(void)
+{
+    return RING_Count(&RX_Ring);
+}
+
+uint32_t UART_Ring_Free(void)
+{
+    return RING_Free(&TX_Ring);
+}
+
+uint32_t UART_Ring_GetOverruns(void)
+{
+    return RX_Overruns;
+}
+
+void UART_Ring_Kick(void)
+{
+    NVIC_SetPendingIRQ(UART2_IRQn);
+}
+
+Status UART_Ring_SetBaud(uint32_t baud, UART_BAUD_Config_Type* config)
+{
+    UART_BAUD_Config_Type found;
+    uint32_t pclk = CLKPWR_GetPCLK(CLKPWR_PCLKSEL_UART2);
+
+    if (UART_BAUD_Search(SystemCoreClock, (uint8_t)(SystemCoreClock / pclk), baud, &found) != SUCCESS)
+    {
+        if (config != NULL)
+        {
+            *config = found;
+        }
+        return ERROR;
+    }
+
+    // Un cambio de divisores con un caracter en el registro de desplazamiento lo corromperia:
+    while ((LPC_UART2->LSR & UART_LSR_TEMT) == 0)
+    {
+    }
+
+    if (found.Pclk != pclk)
+    {
+        CLKPWR_SetPCLKDiv(CLKPWR_PCLKSEL_UART2, UART_Ring_PclkSel(found.Pclk_Div));
+    }
+
+    LPC_UART2->LCR |= UART_LCR_DLAB_EN;
+    LPC_UART2->DLM = UART_LOAD_DLM(found.Divisor);
+    LPC_UART2->DLL = UART_LOAD_DLL(found.Divisor);
+    LPC_UART2->LCR &= (~UART_LCR_DLAB_EN) & UART_LCR_BITMASK;
+    LPC_UART2->FDR = (UART_FDR_MULVAL(found.Mul) | UART_FDR_DIVADDVAL(found.Div_Add)) & UART_FDR_BITMASK;
+
+    if (config != NULL)
+    {
+        *config = found;
+    }
+    return SUCCESS;
+}
+
+RAMFUNC uint32_t UART_Ring_IRQHandler(void)
+{
+    uint8_t burst[UART_TX_FIFO_SIZE];
+    uint32_t received = 0;
+    uint32_t count;
+    uint8_t status;
+
+    // La lectura del IIR reconoce la interrupcion THRE; la del LSR, la de estado de linea:
+    UART_GetIntId(LPC_UART2);
+    status = LPC_UART2->LSR;
+
+    if (status & UART_LSR_OE)
+    {
+        RX_Overruns++; // La FIFO de hardware se desbordo
+    }
+
+    // Recepcion: se vacia la FIFO completa en una sola pasada.
+    while (status & UART_LSR_RDR)
+    {
+        if (RING_Put(&RX_Ring, LPC_UART2->RBR) == FALSE)
+        {
+            RX_Overruns++;
+        }
+        received++;
+        status = LPC_UART2->LSR;
+    }
+
+    // Transmision: con la FIFO vacia se carga una rafaga completa, salvo que el GPDMA este enviando una trama.
+    if ((status & UART_LSR_THRE) && UART_DMA_Busy() == FALSE)
+    {
+        count = RING_Read(&TX_Ring, burst, UART_TX_FIFO_SIZE);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            LPC_UART2->THR = burst[i];
+        }
+    }
+
+    return received;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file uart_ring.h
+ * @brief Transmision y recepcion por interrupciones del UART2 sobre buffers circulares SPSC.
+ *
+ * La recepcion vacia la FIFO de hardware en rafagas hacia un buffer circular que luego lee el bucle principal.
+ * La transmision toma bytes de otro buffer circular y llena la FIFO de transmision de a UART_TX_FIFO_SIZE bytes
+ * por cada interrupcion THRE. El handler del UART2 es el unico consumidor de TX y el unico productor de RX.
+ */
+
+#ifndef UART_RING_H
+#define UART_RING_H
+
+#include "lpc_types.h"
+#include "uart_baud.h"
+
+// Definiciones del modulo:
+#define UART_RING_TX_SIZE 256 /**< Tamaño del buffer de transmision (potencia de dos) */
+#define UART_RING_RX_SIZE 64  /**< Tamaño del buffer de recepcion (potencia de dos) */
+
+/**
+ * @brief Inicializa los buffers circulares y habilita la interrupcion de recepcion del UART2.
+ *
+ * Debe llamarse luego de UART_Init() y antes de habilitar UART2_IRQn en el NVIC.
+ */
+void UART_Ring_Init(void);
+
+/**
+ * @brief Encola bytes para transmitir (lado productor, bucle principal).
+ *
+ * @param data Datos a transmitir.
+ * @param length Cantidad de bytes.
+ * @return Cantidad de bytes encolados; puede ser menor a length si el buffer esta lleno.
+ */
+uint32_t UART_Ring_Write(const uint8_t* data, uint32_t length);
+
+/**
+ * @brief Lee bytes recibidos (lado consumidor, bucle principal).
+ *
+ * @param data Donde se guardan los bytes.
+ * @param length Cantidad maxima de bytes a leer.
+ * @return Cantidad de bytes leidos.
+ */
+uint32_t UART_Ring_Read(uint8_t* data, uint32_t length);
+
+/**
+ * @brief Devuelve la cantidad de bytes recibidos pendientes de lectura.
+ *
+ * @return Bytes disponibles en el buffer de recepcion.
+ */
+uint32_t UART_Ring_Available(void);
+
+/**
+ * @brief Devuelve el espacio libre del buffer de transmision.
+ * @return Bytes que se pueden encolar sin que UART_Ring_Write() los descarte.
+ */
+uint32_t UART_Ring_Free(void);
+
+/**
+ * @brief Devuelve la cantidad de bytes recibidos que se perdieron por buffer lleno o desborde de la FIFO.
+ *
+ * @return Contador de bytes perdidos.
+ */
+uint32_t UART_Ring_GetOverruns(void);
+
+/**
+ * @brief Fuerza la atencion de la transmision.
+ *
+ * Deja pendiente la interrupcion del UART2 para que su handler cargue la FIFO. Se usa cuando el transmisor
+ * esta ocioso y no se va a generar una interrupcion THRE por si solo.
+ */
+void UART_Ring_Kick(void);
+
+/**
+ * @brief Cambia la velocidad del UART2 a la de menor error que se pueda obtener.
+ *
+ * Busca primero a la PCLK actual del UART2; si el error supera UART_BAUD_MAX_ERROR_PPM prueba los demas divisores
+ * de PCLK (UART_BAUD_Search(); por ejemplo, 921600 baudios necesita PCLK = CCLK). Espera a que se termine de
+ * enviar el caracter en curso, pero no a los buffers: los bytes encolados despues del cambio salen a la nueva
+ * velocidad. Si no hay una configuracion aceptable no modifica el UART.
+ *
+ * @param baud Velocidad pedida.
+ * @param config Divisores elegidos, velocidad obtenida y error (puede ser NULL).
+ * @return SUCCESS si se configuro la velocidad, ERROR si el error minimo supera UART_BAUD_MAX_ERROR_PPM.
+ */
+Status UART_Ring_SetBaud(uint32_t baud, UART_BAUD_Config_Type* config);
+
+/**
+ * @brief Atiende la interrupcion del UART2.
+ *
+ * Debe llamarse desde UART2_IRQHandler. Vacia la FIFO de recepcion y, si el canal DMA de tramas esta libre,
+ * carga la FIFO de transmision.
+ *
+ * @return Cantidad de bytes recibidos en esta interrupcion.
+ */
+uint32_t UART_Ring_IRQHandler(void);
+
+#endif /* UART_RING_H */
@@ -0,0 +1,905 @@
+/**
+ * @file table_gen.c
+ * @brief Generador de las tablas constantes del firmware (se ejecuta en el host durante la compilacion).
+ *
+ * A partir de los modelos de Src/table_config.h calcula en punto flotante:
+ *
+ * - TABLES_Dac_Gamma: valor del DAC para cada porcentaje de luz, con el brillo corregido por gamma.
+ * - TABLES_Lm35: temperatura en °C para cada lectura de TABLE_ADC_BITS bits del LM35.
+ * - TABLES_Mq2: concentracion de GLP en centenas de ppm para cada lectura del MQ-2 (curva logaritmica).
+ *
+ * y escribe sensor_tables.h y sensor_tables.c con arreglos const, que el enlazador deja en flash (.rodata). Cada
+ * entrada de un sensor se calcula en el centro del intervalo de lecturas que la indexa.
+ *
+ * Ademas informa el costo en flash de cada tabla frente a los ciclos que ahorra por uso, y con -c verifica las
+ * tablas (monotonia, extremos y puntos conocidos de cada modelo) y termina con codigo 2 si alguna falla.
+ *
+ * Con -p verifica las tablas de intervalos del motor paso a paso que arma el firmware (Src/step_profile.c, el
+ * mismo codigo) contra el perfil ideal integrado en punto flotante, para la maniobra de table_config.h y para
+ * perfiles extremos, e informa la duracion de la maniobra frente a la velocidad constante de arranque.
+ *
+ * Con -f compara la etapa de filtros de los sensores (Src/sensor_filter.c, aritmetica de carriles empaquetados) con
+ * una implementacion escalar directa, muestra a muestra, y mide el tiempo por muestra de ambas en el host.
+ *
+ * Uso:
+ *     table_gen -o directorio
+ *     table_gen -c
+ *     table_gen -p
+ *     table_gen -f
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sensor_filter.h"
+#include "step_profile.h"
+#include "table_config.h"
+
+// Definiciones del modulo:
+#define GEN_PATH_SIZE   512 /**< Longitud maxima de la ruta de un archivo generado */
+#define GEN_PER_LINE_8  16  /**< Valores por linea en las tablas de 8 bits */
+#define GEN_PER_LINE_16 12  /**< Valores por linea en las tablas de 16 bits */
+
+#define GEN_STEP_TICK_RATE 25000000 /**< Ticks por segundo del TIMER1 (PCLK de 25 MHz) */
+#define GEN_STEP_MAX_STEPS 4096     /**< Pasos maximos de los perfiles verificados */
+#define GEN_STEP_EPSILON   1e-9     /**< Error admitido de la integral del perfil ideal, en segundos */
+#define GEN_STEP_DEPTH     40       /**< Profundidad maxima de la integracion adaptativa */
+#define GEN_STEP_TOLERANCE 0.001    /**< Error relativo admitido de cada intervalo (ademas de un tick) */
+
+#define GEN_FILTER_LEVELS  5       /**< Niveles por entrada en la verificacion exhaustiva de la mediana */
+#define GEN_FILTER_RANDOM  1000000 /**< Muestras de la secuencia aleatoria */
+#define GEN_FILTER_BENCH   4000000 /**< Muestras de la medicion de tiempo */
+#define GEN_FILTER_SAMPLES 4096    /**< Muestras distintas de la medicion (se recorren en anillo) */
+
+
+/**
+ * @brief Tabla generada y su costo frente a la alternativa aritmetica.
+ *
+ * Los ciclos son estimaciones con los tiempos de instruccion del Cortex-M3 (sin esperas de la flash): la busqueda
+ * es un LDRB/LDRH con su direccion; la alternativa es el calculo que la tabla reemplaza.
+ */
+typedef struct
+{
+    const char* Name;        /**< Nombre del arreglo */
+    const char* Type;        /**< Tipo de C de los elementos */
+    size_t Element_Size;     /**< Bytes por elemento */
+    size_t Count;            /**< Cantidad de elementos */
+    const char* Alternative; /**< Calculo que reemplaza */
+    unsigned Compute_Cycles; /**< Ciclos estimados del calculo */
+    unsigned Lookup_Cycles;  /**< Ciclos estimados de la busqueda */
+} GEN_Table_Type;
+
+static uint16_t Dac_Gamma[TABLE_DAC_SIZE]; /**< Valor del DAC por porcentaje de luz */
+static uint8_t Lm35[TABLE_ADC_SIZE];       /**< °C por lectura del LM35 */
+static uint8_t Mq2[TABLE_ADC_SIZE];        /**< Centenas de ppm por lectura del MQ-2 */
+
+static const GEN_Table_Type Tables[] = {
+    {"TABLES_Dac_Gamma", "uint16_t", sizeof(uint16_t), TABLE_DAC_SIZE, "powf() en punto flotante por software", 2500,
+     3},
+    {"TABLES_Lm35", "uint8_t", sizeof(uint8_t), TABLE_ADC_SIZE, "CALIB_Convert() lineal en Q15", 30, 3},
+    {"TABLES_Mq2", "uint8_t", sizeof(uint8_t), TABLE_ADC_SIZE, "log10f() y powf() en punto flotante por software",
+     6000, 3},
+};
+
+/**
+ * @brief Perfil de velocidad del motor que se verifica con -p.
+ */
+typedef struct
+{
+    const char* Name;                /**< Descripcion */
+    STEP_PROFILE_Config_Type Config; /**< Parametros */
+    uint32_t Steps;                  /**< Pasos de la maniobra */
+} GEN_Profile_Type;
+
+static const GEN_Profile_Type Profiles[] = {
+    {"puerta (curva S)",
+     {STEP_PROFILE_SCURVE, TABLE_MOTOR_START_SPEED, TABLE_MOTOR_MAX_SPEED, TABLE_MOTOR_ACCEL, GEN_STEP_TICK_RATE},
+     TABLE_MOTOR_STEPS},
+    {"puerta (trapecio)",
+     {STEP_PROFILE_TRAPEZOID, TABLE_MOTOR_START_SPEED, TABLE_MOTOR_MAX_SPEED, TABLE_MOTOR_ACCEL, GEN_STEP_TICK_RATE},
+     TABLE_MOTOR_STEPS},
+    {"un paso", {STEP_PROFILE_SCURVE, 500, 4000, 40000, GEN_STEP_TICK_RATE}, 1},
+    {"velocidad constante", {STEP_PROFILE_TRAPEZOID, 2000, 2000, 1000, GEN_STEP_TICK_RATE}, 100},
+    {"crucero (trapecio)", {STEP_PROFILE_TRAPEZOID, 200, 8000, 20000, GEN_STEP_TICK_RATE}, GEN_STEP_MAX_STEPS},
+    {"crucero (curva S)", {STEP_PROFILE_SCURVE, 200, 8000, 20000, GEN_STEP_TICK_RATE}, GEN_STEP_MAX_STEPS},
+    {"arranque lento", {STEP_PROFILE_SCURVE, 1, 100, 50, GEN_STEP_TICK_RATE}, 256},
+    {"rampa brusca", {STEP_PROFILE_TRAPEZOID, 100, 50000, 2000000, GEN_STEP_TICK_RATE}, 2000},
+};
+
+static uint32_t Intervals[GEN_STEP_MAX_STEPS]; /**< Tabla del perfil que se verifica */
+
+/**
+ * @brief Implementacion escalar de referencia de la etapa de filtros, un canal por vez.
+ */
+typedef struct
+{
+    uint16_t History[FILTER_MAX_CHANNELS][FILTER_MEDIAN_TAPS]; /**< Ultimas entradas */
+    uint16_t Past[FILTER_MAX_CHANNELS][FILTER_RATE_TAPS];      /**< Ultimas medias */
+    uint16_t Median[FILTER_MAX_CHANNELS];                      /**< Mediana de la ultima muestra */
+    uint16_t Average[FILTER_MAX_CHANNELS];                     /**< Media exponencial */
+    int32_t Rate[FILTER_MAX_CHANNELS];                         /**< Pendiente */
+    unsigned History_Index;                                    /**< Proxima posicion de History */
+    unsigned Past_Index;                                       /**< Proxima posicion de Past */
+    unsigned Channels;                                         /**< Canales filtrados */
+} GEN_Filter_Type;
+
+/**
+ * @brief Cantidades de canales que se verifican: la de la placa base (impar, con un carril vacio) y el maximo.
+ */
+static const uint8_t Filter_Channels[] = {3, FILTER_MAX_CHANNELS};
+
+static uint16_t Filter_Samples[GEN_FILTER_SAMPLES][FILTER_MAX_CHANNELS]; /**< Entradas de la medicion de tiempo */
+
+/**
+ * @brief Redondea y satura un valor a [0, max].
+ */
+static long GEN_Clamp(double value, long max)
+{
+    long rounded = lround(value);
+
+    return (rounded < 0) ? 0 : ((rounded > max) ? max : rounded);
+}
+
+/**
+ * @brief Tension relativa a VREF en el centro del intervalo de una lectura.
+ */
+static double GEN_Fraction(unsigned code)
+{
+    return (code + 0.5) / TABLE_ADC_SIZE;
+}
+
+/**
+ * @brief Temperatura del LM35, en °C, para una tension relativa a VREF.
+ */
+static double GEN_Lm35(double x)
+{
+    return x * TABLE_VREF_MV / TABLE_LM35_MV_PER_C + TABLE_LM35_OFFSET;
+}
+
+/**
+ * @brief Concentracion del MQ-2, en centenas de ppm, para una tension relativa a VREF.
+ *
+ * Con RL en serie con el sensor, Rs / RL = (1 - x) / x; la recta del datasheet da log10(ppm) a partir de
+ * log10(Rs / R0).
+ */
+static double GEN_Mq2(double x)
+{
+    double ratio = (1.0 - x) / x * TABLE_MQ2_RL_R0;
+    double ppm = pow(10.0, (log10(ratio) - TABLE_MQ2_LOG_RATIO) / TABLE_MQ2_SLOPE + TABLE_MQ2_LOG_PPM);
+
+    ppm = (ppm > TABLE_MQ2_MAX_PPM) ? TABLE_MQ2_MAX_PPM : ppm;
+    return ppm / 100.0 * TABLE_MQ2_GAIN + TABLE_MQ2_OFFSET;
+}
+
+/**
+ * @brief Valor del DAC para un porcentaje de luz: el LED brilla mas cuanto menos luz hay.
+ */
+static double GEN_Dac(unsigned light)
+{
+    return TABLE_DAC_MAX * pow((TABLE_LDR_MAX - light) / (double)TABLE_LDR_MAX, TABLE_DAC_GAMMA);
+}
+
+/**
+ * @brief Calcula todas las tablas.
+ */
+static void GEN_Build(void)
+{
+    for (unsigned light = 0; light < TABLE_DAC_SIZE; light++)
+    {
+        Dac_Gamma[light] = (uint16_t)GEN_Clamp(GEN_Dac(light), TABLE_DAC_MAX);
+    }
+
+    for (unsigned code = 0; code < TABLE_ADC_SIZE; code++)
+    {
+        Lm35[code] = (uint8_t)GEN_Clamp(GEN_Lm35(GEN_Fraction(code)), TABLE_LM35_MAX);
+        Mq2[code] = (uint8_t)GEN_Clamp(GEN_Mq2(GEN_Fraction(code)), TABLE_MQ2_MAX);
+    }
+}
+
+/**
+ * @brief Escribe los elementos de una tabla, varios por linea.
+ */
+static void GEN_WriteValues(FILE* file, const void* data, size_t count, size_t element_size)
+{
+    size_t per_line = (element_size == 1) ? GEN_PER_LINE_8 : GEN_PER_LINE_16;
+    unsigned value;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        value = (element_size == 1) ? ((const uint8_t*)data)[i] : ((const uint16_t*)data)[i];
+        fprintf(file, "%s%*u%s", (i % per_line == 0) ? "    " : " ", (element_size == 1) ? 3 : 4, value,
+                (i + 1 == count) ? "\n" : ",");
+        if (i + 1 != count && (i + 1) % per_line == 0)
+        {
+            fputc('\n', file);
+        }
+    }
+}
+
+/**
+ * @brief Abre un archivo de salida del directorio elegido.
+ */
+static FILE* GEN_Open(const char* directory, const char* name)
+{
+    char path[GEN_PATH_SIZE];
+    FILE* file;
+
+    snprintf(path, sizeof(path), "%s/%s", directory, name);
+    file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "table_gen: no se puede crear %s: %s\n", path, strerror(errno));
+    }
+
+    return file;
+}
+
+/**
+ * @brief Escribe sensor_tables.h y sensor_tables.c.
+ *
+ * @return 0 si se escribieron, 1 si no.
+ */
+static int GEN_Write(const char* directory)
+{
+    static const void* const Data[] = {Dac_Gamma, Lm35, Mq2};
+    static const char* const Sizes[] = {"TABLE_DAC_SIZE", "TABLE_ADC_SIZE", "TABLE_ADC_SIZE"};
+    FILE* header = GEN_Open(directory, "sensor_tables.h");
+    FILE* source = GEN_Open(directory, "sensor_tables.c");
+    int result = 0;
+
+    if (header == NULL || source == NULL)
+    {
+        result = 1;
+    }
+    else
+    {
+        fprintf(header, "/**\n * @file sensor_tables.h\n * @brief Tablas generadas por Table_Generator/table_gen.c a "
+                        "partir de Src/table_config.h. No editar.\n */\n\n"
+                        "#ifndef SENSOR_TABLES_H\n#define SENSOR_TABLES_H\n\n#include <stdint.h>\n\n"
+                        "#include \"table_config.h\"\n\n");
+        fprintf(source, "/**\n * @file sensor_tables.c\n * @brief Tablas generadas por Table_Generator/table_gen.c a "
+                        "partir de Src/table_config.h. No editar.\n */\n\n#include \"sensor_tables.h\"\n");
+
+        for (size_t t = 0; t < sizeof(Tables) / sizeof(Tables[0]); t++)
+        {
+            fprintf(header, "extern const %s %s[%s];\n", Tables[t].Type, Tables[t].Name, Sizes[t]);
+            fprintf(source, "\nconst %s %s[%s] = {\n", Tables[t].Type, Tables[t].Name, Sizes[t]);
+            GEN_WriteValues(source, Data[t], Tables[t].Count, Tables[t].Element_Size);
+            fprintf(source, "};\n");
+        }
+        fprintf(header, "\n#endif /* SENSOR_TABLES_H */\n");
+
+        if (ferror(header) || ferror(source))
+        {
+            fprintf(stderr, "table_gen: error al escribir en %s\n", directory);
+            result = 1;
+        }
+    }
+
+    if (header != NULL && fclose(header) != 0)
+    {
+        result = 1;
+    }
+    if (source != NULL && fclose(source) != 0)
+    {
+        result = 1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Informa el costo en flash de cada tabla y los ciclos que ahorra.
+ */
+static void GEN_Report(void)
+{
+    size_t total = 0;
+    size_t bytes;
+
+    for (size_t t = 0; t < sizeof(Tables) / sizeof(Tables[0]); t++)
+    {
+        bytes = Tables[t].Count * Tables[t].Element_Size;
+        total += bytes;
+        fprintf(stderr, "table_gen: %-16s %5zu bytes de flash, ~%u ciclos por uso en lugar de ~%u (%s)\n",
+                Tables[t].Name, bytes, Tables[t].Lookup_Cycles, Tables[t].Compute_Cycles, Tables[t].Alternative);
+    }
+    fprintf(stderr, "table_gen: total %zu bytes de flash\n", total);
+}
+
+/**
+ * @brief Cuenta una falla de la verificacion.
+ */
+static void GEN_Fail(unsigned* failures, const char* message, long index, long value)
+{
+    if ((*failures)++ < 10)
+    {
+        fprintf(stderr, "table_gen: FALLA: %s (indice %ld, valor %ld)\n", message, index, value);
+    }
+}
+
+/**
+ * @brief Verifica las tablas calculadas.
+ *
+ * @return 0 si son correctas, 2 si alguna falla.
+ */
+static int GEN_Check(void)
+{
+    unsigned failures = 0;
+    double low;
+    double high;
+    long expected;
+
+    // DAC: decreciente, de TABLE_DAC_MAX a 0, y 50 % de luz = 0,5^gamma de la escala.
+    if (Dac_Gamma[0] != TABLE_DAC_MAX || Dac_Gamma[TABLE_DAC_SIZE - 1] != 0)
+    {
+        GEN_Fail(&failures, "extremos del DAC", 0, Dac_Gamma[0]);
+    }
+    for (unsigned i = 1; i < TABLE_DAC_SIZE; i++)
+    {
+        if (Dac_Gamma[i] > Dac_Gamma[i - 1])
+        {
+            GEN_Fail(&failures, "DAC no decreciente", i, Dac_Gamma[i]);
+        }
+    }
+    expected = lround(TABLE_DAC_MAX * pow(0.5, TABLE_DAC_GAMMA));
+    if (Dac_Gamma[TABLE_LDR_MAX / 2] != expected)
+    {
+        GEN_Fail(&failures, "DAC al 50 %", TABLE_LDR_MAX / 2, Dac_Gamma[TABLE_LDR_MAX / 2]);
+    }
+
+    // Sensores: crecientes y dentro del modelo evaluado en los bordes de cada intervalo (mas el redondeo).
+    for (unsigned code = 0; code < TABLE_ADC_SIZE; code++)
+    {
+        if (code > 0 && (Lm35[code] < Lm35[code - 1] || Mq2[code] < Mq2[code - 1]))
+        {
+            GEN_Fail(&failures, "tabla de sensor no creciente", code, code);
+        }
+
+        low = GEN_Lm35((double)code / TABLE_ADC_SIZE);
+        high = GEN_Lm35((double)(code + 1) / TABLE_ADC_SIZE);
+        if (Lm35[code] < GEN_Clamp(low - 0.5, TABLE_LM35_MAX) || Lm35[code] > GEN_Clamp(high + 0.5, TABLE_LM35_MAX))
+        {
+            GEN_Fail(&failures, "LM35 fuera del modelo", code, Lm35[code]);
+        }
+
+        low = (code == 0) ? 0.0 : GEN_Mq2((double)code / TABLE_ADC_SIZE);
+        high = GEN_Mq2((double)(code + 1) / TABLE_ADC_SIZE);
+        if (Mq2[code] < GEN_Clamp(low - 0.5, TABLE_MQ2_MAX) || Mq2[code] > GEN_Clamp(high + 0.5, TABLE_MQ2_MAX))
+        {
+            GEN_Fail(&failures, "MQ-2 fuera del modelo", code, Mq2[code]);
+        }
+    }
+
+    // Puntos conocidos: 250 mV del LM35 son 25 °C; en el punto de referencia del MQ-2 (200 ppm) Rs / R0 = 10^A.
+    expected = lround(250.0 / TABLE_LM35_MV_PER_C + TABLE_LM35_OFFSET);
+    if (Lm35[(unsigned)(250.0 / TABLE_VREF_MV * TABLE_ADC_SIZE)] != expected)
+    {
+        GEN_Fail(&failures, "LM35 a 250 mV", expected, Lm35[(unsigned)(250.0 / TABLE_VREF_MV * TABLE_ADC_SIZE)]);
+    }
+    low = 1.0 / (1.0 + pow(10.0, TABLE_MQ2_LOG_RATIO) / TABLE_MQ2_RL_R0);
+    expected = lround(pow(10.0, TABLE_MQ2_LOG_PPM) / 100.0 * TABLE_MQ2_GAIN + TABLE_MQ2_OFFSET);
+    if (labs(Mq2[(unsigned)(low * TABLE_ADC_SIZE)] - expected) > 1)
+    {
+        GEN_Fail(&failures, "MQ-2 en el punto de referencia", expected, Mq2[(unsigned)(low * TABLE_ADC_SIZE)]);
+    }
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "table_gen: %u fallas\ntable_gen: FALLA\n", failures);
+        return 2;
+    }
+    fprintf(stderr, "table_gen: OK\n");
+    return 0;
+}
+
+/**
+ * @brief Velocidad ideal del perfil en una posicion, con las mismas rampas que Src/step_profile.c.
+ *
+ * @param position Posicion en pasos desde el comienzo de la maniobra.
+ * @return Velocidad en pasos/s.
+ */
+static double GEN_StepSpeed(const GEN_Profile_Type* profile, double position)
+{
+    const STEP_PROFILE_Config_Type* config = &profile->Config;
+    double start = (double)config->Start_Speed * config->Start_Speed;
+    double peak = (double)config->Max_Speed * config->Max_Speed;
+    double ramp = ceil((peak - start) / config->Accel); // medios pasos de cada rampa
+    double distance = fmin(position, profile->Steps - position) * 2.0;
+    double u;
+
+    if (ramp >= profile->Steps)
+    {
+        ramp = profile->Steps;
+        peak = fmin(peak, start + (double)config->Accel * profile->Steps);
+    }
+    if (distance >= ramp)
+    {
+        return sqrt(peak);
+    }
+
+    u = distance / ramp;
+    if (config->Shape == STEP_PROFILE_SCURVE)
+    {
+        u = u * u * (3.0 - 2.0 * u);
+    }
+    return sqrt(start + (peak - start) * u);
+}
+
+/**
+ * @brief Integral de 1 / v entre dos posiciones, por Simpson adaptativo.
+ *
+ * 1 / v cambia mucho dentro de un paso a velocidades bajas, asi que el intervalo se parte hasta que la estimacion
+ * de cada mitad coincide con la del total.
+ *
+ * @param whole Estimacion de Simpson sobre [a, b].
+ */
+static double GEN_StepTime(const GEN_Profile_Type* profile, double a, double b, double fa, double fm, double fb,
+                           double whole, double epsilon, unsigned depth)
+{
+    double m = (a + b) / 2.0;
+    double flm = 1.0 / GEN_StepSpeed(profile, (a + m) / 2.0);
+    double frm = 1.0 / GEN_StepSpeed(profile, (m + b) / 2.0);
+    double left = (m - a) / 6.0 * (fa + 4.0 * flm + fm);
+    double right = (b - m) / 6.0 * (fm + 4.0 * frm + fb);
+
+    if (depth == 0 || fabs(left + right - whole) <= 15.0 * epsilon)
+    {
+        return left + right + (left + right - whole) / 15.0;
+    }
+
+    return GEN_StepTime(profile, a, m, fa, flm, fm, left, epsilon / 2.0, depth - 1) +
+           GEN_StepTime(profile, m, b, fm, frm, fb, right, epsilon / 2.0, depth - 1);
+}
+
+/**
+ * @brief Intervalo ideal de un paso: integral de 1 / v sobre el paso, en ticks.
+ */
+static double GEN_StepInterval(const GEN_Profile_Type* profile, uint32_t step)
+{
+    double fa = 1.0 / GEN_StepSpeed(profile, step);
+    double fm = 1.0 / GEN_StepSpeed(profile, step + 0.5);
+    double fb = 1.0 / GEN_StepSpeed(profile, step + 1.0);
+    double whole = (fa + 4.0 * fm + fb) / 6.0;
+
+    return GEN_StepTime(profile, step, step + 1.0, fa, fm, fb, whole, GEN_STEP_EPSILON, GEN_STEP_DEPTH) *
+           profile->Config.Tick_Rate;
+}
+
+/**
+ * @brief Verifica las tablas de intervalos del motor contra el perfil ideal.
+ *
+ * @return 0 si son correctas, 2 si alguna falla.
+ */
+static int GEN_CheckProfiles(void)
+{
+    unsigned failures = 0;
+
+    for (size_t p = 0; p < sizeof(Profiles) / sizeof(Profiles[0]); p++)
+    {
+        const GEN_Profile_Type* profile = &Profiles[p];
+        const STEP_PROFILE_Config_Type* config = &profile->Config;
+        uint32_t steps = profile->Steps;
+        uint32_t total = STEP_PROFILE_Build(config, steps, Intervals);
+        uint32_t ramp = STEP_PROFILE_Ramp(config, steps);
+        uint64_t sum = 0;
+        double ideal_total = 0.0;
+        double worst = 0.0;
+        uint32_t fastest = UINT32_MAX;
+
+        if (total == 0 || 2 * ramp > steps + 1)
+        {
+            GEN_Fail(&failures, profile->Name, 0, 0);
+            continue;
+        }
+
+        for (uint32_t k = 0; k < steps; k++)
+        {
+            double ideal = GEN_StepInterval(profile, k);
+            double error = fabs(Intervals[k] - ideal);
+
+            sum += Intervals[k];
+            ideal_total += ideal;
+            fastest = (Intervals[k] < fastest) ? Intervals[k] : fastest;
+            worst = fmax(worst, error / ideal);
+
+            // Cada intervalo cerca del ideal, sin superar la velocidad maxima ni quedar por debajo de la de arranque:
+            if (error > 1.0 + ideal * GEN_STEP_TOLERANCE)
+            {
+                GEN_Fail(&failures, "intervalo lejos del perfil ideal", k, Intervals[k]);
+            }
+            if (Intervals[k] + 1 < config->Tick_Rate / config->Max_Speed ||
+                Intervals[k] > config->Tick_Rate / config->Start_Speed + 1)
+            {
+                GEN_Fail(&failures, "intervalo fuera de [1 / Max_Speed, 1 / Start_Speed]", k, Intervals[k]);
+            }
+
+            // Acelera (intervalos no crecientes) hasta la mitad y desacelera en espejo:
+            if (k > 0 && 2 * k < steps && Intervals[k] > Intervals[k - 1])
+            {
+                GEN_Fail(&failures, "aceleracion no monotona", k, Intervals[k]);
+            }
+            if (k > 0 && 2 * k > steps && Intervals[k] < Intervals[k - 1])
+            {
+                GEN_Fail(&failures, "desaceleracion no monotona", k, Intervals[k]);
+            }
+            if (labs((long)Intervals[k] - (long)Intervals[steps - 1 - k]) > 1)
+            {
+                GEN_Fail(&failures, "perfil no simetrico", k, Intervals[k]);
+            }
+
+            // Entre las rampas (STEP_PROFILE_Ramp()) el motor va a la velocidad maxima:
+            if (k >= ramp && k + ramp < steps && Intervals[k] > config->Tick_Rate / config->Max_Speed + 1)
+            {
+                GEN_Fail(&failures, "crucero fuera de las rampas", k, Intervals[k]);
+            }
+        }
+
+        if (sum != total || fabs(total - ideal_total) > 1.0 + ideal_total * GEN_STEP_TOLERANCE)
+        {
+            GEN_Fail(&failures, "duracion total", steps, total);
+        }
+
+        fprintf(stderr,
+                "table_gen: %-20s %4u pasos en %8.3f ms (ideal %8.3f ms), pico %5.0f pasos/s, error maximo %.4f %%\n",
+                profile->Name, steps, total * 1000.0 / config->Tick_Rate, ideal_total * 1000.0 / config->Tick_Rate,
+                (double)config->Tick_Rate / fastest, worst * 100.0);
+    }
+
+    // Ganancia de las rampas en la maniobra de la puerta frente a moverse siempre a la velocidad de arranque:
+    if (STEP_PROFILE_Build(&Profiles[0].Config, TABLE_MOTOR_STEPS, Intervals) != 0)
+    {
+        fprintf(stderr, "table_gen: puerta: %.3f ms con rampas, %.3f ms a %u pasos/s constantes; tabla de %zu bytes\n",
+                STEP_PROFILE_Build(&Profiles[0].Config, TABLE_MOTOR_STEPS, Intervals) * 1000.0 / GEN_STEP_TICK_RATE,
+                TABLE_MOTOR_STEPS * 1000.0 / TABLE_MOTOR_START_SPEED, TABLE_MOTOR_START_SPEED,
+                2 * TABLE_MOTOR_STEPS * sizeof(uint32_t));
+    }
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "table_gen: %u fallas\ntable_gen: FALLA\n", failures);
+        return 2;
+    }
+    fprintf(stderr, "table_gen: OK\n");
+    return 0;
+}
+
+/**
+ * @brief Generador pseudoaleatorio (xorshift de 32 bits), reproducible entre corridas.
+ */
+static uint32_t GEN_Random(uint32_t* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+/**
+ * @brief Ordena por insercion las entradas de la mediana de un canal.
+ */
+static void GEN_Sort(uint16_t* values)
+{
+    uint16_t value;
+    unsigned j;
+
+    for (unsigned i = 1; i < FILTER_MEDIAN_TAPS; i++)
+    {
+        value = values[i];
+        for (j = i; j > 0 && values[j - 1] > value; j--)
+        {
+            values[j] = values[j - 1];
+        }
+        values[j] = value;
+    }
+}
+
+/**
+ * @brief Inicializa la referencia escalar como FILTER_Init().
+ */
+static void GEN_FilterInit(GEN_Filter_Type* filter, const uint16_t* values, uint8_t channels)
+{
+    filter->Channels = channels;
+    for (unsigned ch = 0; ch < channels; ch++)
+    {
+        uint16_t value = (values[ch] > FILTER_MAX_VALUE) ? FILTER_MAX_VALUE : values[ch];
+
+        for (unsigned i = 0; i < FILTER_MEDIAN_TAPS; i++)
+        {
+            filter->History[ch][i] = value;
+        }
+        for (unsigned i = 0; i < FILTER_RATE_TAPS; i++)
+        {
+            filter->Past[ch][i] = value;
+        }
+        filter->Median[ch] = value;
+        filter->Average[ch] = value;
+        filter->Rate[ch] = 0;
+    }
+    filter->History_Index = 0;
+    filter->Past_Index = 0;
+}
+
+/**
+ * @brief Procesa una muestra con la referencia escalar: mediana ordenando, media redondeada hacia arriba en las
+ * mitades y pendiente restando.
+ */
+static void GEN_FilterUpdate(GEN_Filter_Type* filter, const uint16_t* values)
+{
+    uint16_t sorted[FILTER_MEDIAN_TAPS];
+    int32_t diff;
+
+    for (unsigned ch = 0; ch < filter->Channels; ch++)
+    {
+        filter->History[ch][filter->History_Index] = (values[ch] > FILTER_MAX_VALUE) ? FILTER_MAX_VALUE : values[ch];
+        memcpy(sorted, filter->History[ch], sizeof(sorted));
+        GEN_Sort(sorted);
+        filter->Median[ch] = sorted[FILTER_MEDIAN_TAPS / 2];
+
+        diff = (int32_t)filter->Median[ch] - filter->Average[ch];
+        filter->Average[ch] += (int32_t)floor((diff + (1 << (FILTER_EMA_SHIFT - 1))) / (double)(1 << FILTER_EMA_SHIFT));
+
+        filter->Rate[ch] = (int32_t)filter->Average[ch] - filter->Past[ch][filter->Past_Index];
+        filter->Past[ch][filter->Past_Index] = filter->Average[ch];
+    }
+    filter->History_Index = (filter->History_Index + 1) % FILTER_MEDIAN_TAPS;
+    filter->Past_Index = (filter->Past_Index + 1) % FILTER_RATE_TAPS;
+}
+
+/**
+ * @brief Procesa una muestra con las dos implementaciones y compara sus salidas.
+ */
+static void GEN_FilterStep(FILTER_State_Type* state, GEN_Filter_Type* filter, const uint16_t* values, long index,
+                           unsigned* failures)
+{
+    FILTER_Update(state, values);
+    GEN_FilterUpdate(filter, values);
+
+    for (uint8_t ch = 0; ch < filter->Channels; ch++)
+    {
+        if (FILTER_GetMedian(state, ch) != filter->Median[ch])
+        {
+            GEN_Fail(failures, "mediana distinta de la referencia", index, FILTER_GetMedian(state, ch));
+        }
+        if (FILTER_GetAverage(state, ch) != filter->Average[ch])
+        {
+            GEN_Fail(failures, "media distinta de la referencia", index, FILTER_GetAverage(state, ch));
+        }
+        if (FILTER_GetRate(state, ch) != filter->Rate[ch])
+        {
+            GEN_Fail(failures, "pendiente distinta de la referencia", index, FILTER_GetRate(state, ch));
+        }
+    }
+}
+
+/**
+ * @brief Segundos de reloj monotono.
+ */
+static double GEN_Now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Verifica la etapa de filtros con una cantidad de canales contra la referencia escalar y mide su tiempo por
+ * muestra.
+ *
+ * Secuencias: todas las combinaciones de GEN_FILTER_LEVELS niveles (con repetidos y extremos) en las entradas de
+ * la mediana, un pico aislado, escalones de escala completa en ambos sentidos y ruido aleatorio con picos,
+ * incluidas entradas por encima de FILTER_MAX_VALUE.
+ *
+ * @param channels Canales filtrados.
+ * @param failures Contador de fallas.
+ */
+static void GEN_CheckFilterChannels(uint8_t channels, unsigned* failures)
+{
+    static const uint16_t levels[GEN_FILTER_LEVELS] = {0, 1, 0x4000, FILTER_MAX_VALUE - 1, FILTER_MAX_VALUE};
+    FILTER_State_Type state;
+    GEN_Filter_Type filter;
+    uint16_t values[FILTER_MAX_CHANNELS] = {0};
+    uint32_t seed = 0x2545F491;
+    long index = 0;
+    unsigned combinations = 1;
+    double start;
+    double packed;
+    double scalar;
+    volatile uint32_t sink = 0;
+
+    FILTER_Init(&state, values, channels);
+    GEN_FilterInit(&filter, values, channels);
+
+    // Mediana exhaustiva: cada muestra es una entrada de una combinacion, distinta en cada canal.
+    for (unsigned i = 0; i < FILTER_MEDIAN_TAPS; i++)
+    {
+        combinations *= GEN_FILTER_LEVELS;
+    }
+    for (unsigned n = 0; n < combinations; n++)
+    {
+        for (unsigned i = 0; i < FILTER_MEDIAN_TAPS; i++)
+        {
+            for (unsigned ch = 0; ch < channels; ch++)
+            {
+                unsigned code = (n + ch * (combinations / channels)) % combinations;
+
+                for (unsigned k = 0; k < i; k++)
+                {
+                    code /= GEN_FILTER_LEVELS;
+                }
+                values[ch] = levels[code % GEN_FILTER_LEVELS];
+            }
+            GEN_FilterStep(&state, &filter, values, index++, failures);
+        }
+    }
+
+    // Un pico aislado no llega a la media:
+    for (unsigned ch = 0; ch < channels; ch++)
+    {
+        values[ch] = 1000;
+    }
+    FILTER_Init(&state, values, channels);
+    GEN_FilterInit(&filter, values, channels);
+    values[0] = FILTER_MAX_VALUE;
+    GEN_FilterStep(&state, &filter, values, index++, failures);
+    if (FILTER_GetAverage(&state, 0) != 1000)
+    {
+        GEN_Fail(failures, "un pico aislado cambia la media", 0, FILTER_GetAverage(&state, 0));
+    }
+
+    // Escalones de escala completa, en sentidos opuestos en canales vecinos:
+    for (unsigned n = 0; n < 8 * FILTER_RATE_TAPS * FILTER_MEDIAN_TAPS; n++)
+    {
+        for (unsigned ch = 0; ch < channels; ch++)
+        {
+            values[ch] = (((n / (2 * FILTER_RATE_TAPS * FILTER_MEDIAN_TAPS)) + ch) % 2) ? FILTER_MAX_VALUE : 0;
+        }
+        GEN_FilterStep(&state, &filter, values, index++, failures);
+    }
+
+    // Ruido aleatorio sobre un nivel que deriva, con picos y entradas fuera de rango:
+    for (long n = 0; n < GEN_FILTER_RANDOM; n++)
+    {
+        for (unsigned ch = 0; ch < channels; ch++)
+        {
+            uint32_t noise = GEN_Random(&seed);
+            long level = (long)((n / 1000 + ch * 3000) % 0x8000) + (long)(noise % 64) - 32;
+
+            if (noise % 53 == 0)
+            {
+                level = (long)(noise >> 16);
+            }
+            values[ch] = (uint16_t)((level < 0) ? 0 : level);
+        }
+        GEN_FilterStep(&state, &filter, values, index++, failures);
+    }
+
+    // Tiempo por muestra de las dos implementaciones sobre las mismas entradas:
+    for (unsigned n = 0; n < GEN_FILTER_SAMPLES; n++)
+    {
+        for (unsigned ch = 0; ch < channels; ch++)
+        {
+            Filter_Samples[n][ch] = (uint16_t)(GEN_Random(&seed) % (FILTER_MAX_VALUE + 1));
+        }
+    }
+    start = GEN_Now();
+    for (long n = 0; n < GEN_FILTER_BENCH; n++)
+    {
+        FILTER_Update(&state, Filter_Samples[n % GEN_FILTER_SAMPLES]);
+        sink += state.Average[0];
+    }
+    packed = (GEN_Now() - start) / GEN_FILTER_BENCH;
+    start = GEN_Now();
+    for (long n = 0; n < GEN_FILTER_BENCH; n++)
+    {
+        GEN_FilterUpdate(&filter, Filter_Samples[n % GEN_FILTER_SAMPLES]);
+        sink += filter.Average[0];
+    }
+    scalar = (GEN_Now() - start) / GEN_FILTER_BENCH;
+
+    fprintf(stderr, "table_gen: filtros: %ld muestras de %u canales comparadas con la referencia escalar\n", index,
+            channels);
+    fprintf(stderr, "table_gen: filtros: %.1f ns por muestra en carriles (%.1f por canal), %.1f ns la referencia\n",
+            packed * 1e9, packed * 1e9 / channels, scalar * 1e9);
+}
+
+/**
+ * @brief Verifica la etapa de filtros con cada cantidad de Filter_Channels.
+ *
+ * @return 0 si es correcta, 2 si alguna salida difiere.
+ */
+static int GEN_CheckFilter(void)
+{
+    unsigned failures = 0;
+
+    for (unsigned i = 0; i < sizeof(Filter_Channels) / sizeof(Filter_Channels[0]); i++)
+    {
+        GEN_CheckFilterChannels(Filter_Channels[i], &failures);
+    }
+    fprintf(stderr, "table_gen: filtros: estado de %zu bytes (%u canales como maximo)\n", sizeof(FILTER_State_Type),
+            FILTER_MAX_CHANNELS);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "table_gen: %u fallas\ntable_gen: FALLA\n", failures);
+        return 2;
+    }
+    fprintf(stderr, "table_gen: OK\n");
+    return 0;
+}
+
+/**
+ * @brief Muestra la ayuda.
+ */
+static void GEN_Usage(const char* program)
+{
+    fprintf(stderr,
+            "Uso: %s -o directorio | -c | -p | -f\n"
+            "  -o directorio  escribe sensor_tables.h y sensor_tables.c\n"
+            "  -c             verifica las tablas\n"
+            "  -p             verifica los perfiles del motor paso a paso\n"
+            "  -f             verifica la etapa de filtros de los sensores y mide su tiempo por muestra\n",
+            program);
+}
+
+int main(int argc, char** argv)
+{
+    const char* directory = NULL;
+    int check = 0;
+    int profiles = 0;
+    int filter = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:cpfh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'o':
+            directory = optarg;
+            break;
+        case 'c':
+            check = 1;
+            break;
+        case 'p':
+            profiles = 1;
+            break;
+        case 'f':
+            filter = 1;
+            break;
+        default:
+            GEN_Usage(argv[0]);
+            return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (directory == NULL && check == 0 && profiles == 0 && filter == 0)
+    {
+        GEN_Usage(argv[0]);
+        return 1;
+    }
+
+    if (profiles)
+    {
+        return GEN_CheckProfiles();
+    }
+
+    if (filter)
+    {
+        return GEN_CheckFilter();
+    }
+
+    GEN_Build();
+
+    if (check)
+    {
+        return GEN_Check();
+    }
+
+    GEN_Report();
+    return GEN_Write(directory);
+}
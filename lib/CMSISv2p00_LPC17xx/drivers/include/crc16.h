@@ -0,0 +1,72 @@
+/**
+ * @file		crc16.h
+ * @brief	Table-driven CRC-16/CCITT shared by the drivers and the application
+ *
+ * Non-reflected CRC-16, polynomial 0x1021, initial value 0xFFFF and no final XOR (CRC-16/CCITT-FALSE). The
+ * 256-entry lookup table lives in flash as const data (512 bytes). Appending the CRC to a message most
+ * significant byte first makes the CRC of the whole message zero, which lets a receiver check a frame with a
+ * single pass.
+ */
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup CRC16 CRC16
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup CRC16_Public_Macros CRC16 Public Macros
+ * @{
+ */
+
+#define CRC16_INIT  (0xFFFFU) /**< Initial register value */
+#define CRC16_CHECK (0x29B1U) /**< CRC16_Compute() of the ASCII string "123456789" */
+
+/**
+ * @}
+ */
+
+/* Public Variables ----------------------------------------------------------- */
+/** @defgroup CRC16_Public_Variables CRC16 Public Variables
+ * @{
+ */
+
+/** Lookup table indexed by the high byte of the register XOR the next data byte */
+extern const uint16_t CRC16_Table[256];
+
+/**
+ * @}
+ */
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup CRC16_Public_Functions CRC16 Public Functions
+ * @{
+ */
+
+uint16_t CRC16_Update(uint16_t crc, const uint8_t* data, uint32_t length);
+uint16_t CRC16_Compute(const uint8_t* data, uint32_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC16_H_ */
+
+/**
+ * @}
+ */
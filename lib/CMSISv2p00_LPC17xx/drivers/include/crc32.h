@@ -0,0 +1,73 @@
+/**
+ * @file		crc32.h
+ * @brief	Table-driven CRC-32 (IEEE 802.3) shared by the drivers and the application
+ *
+ * Reflected CRC-32, polynomial 0x04C11DB7 (0xEDB88320 reflected). The lookup tables live in flash as const
+ * data: CRC32_Update() uses the first 256-entry table (1 KB) and CRC32_Update_Slice4() uses all four
+ * (4 KB) to consume one 32-bit word per iteration.
+ */
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup CRC32 CRC32
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup CRC32_Public_Macros CRC32 Public Macros
+ * @{
+ */
+
+#define CRC32_INIT   (0xFFFFFFFFUL) /**< Initial register value */
+#define CRC32_XOROUT (0xFFFFFFFFUL) /**< Final XOR applied by CRC32_Compute() */
+#define CRC32_CHECK  (0xCBF43926UL) /**< CRC32_Compute() of the ASCII string "123456789" */
+
+/**
+ * @}
+ */
+
+/* Public Variables ----------------------------------------------------------- */
+/** @defgroup CRC32_Public_Variables CRC32 Public Variables
+ * @{
+ */
+
+/** Lookup tables: CRC32_Table[0] is the classic byte table, [1]..[3] extend it for slice-by-4 */
+extern const uint32_t CRC32_Table[4][256];
+
+/**
+ * @}
+ */
+
+/* Public Functions ----------------------------------------------------------- */
+/** @defgroup CRC32_Public_Functions CRC32 Public Functions
+ * @{
+ */
+
+uint32_t CRC32_Update(uint32_t crc, const uint8_t* data, uint32_t length);
+uint32_t CRC32_Update_Slice4(uint32_t crc, const uint8_t* data, uint32_t length);
+uint32_t CRC32_Compute(const uint8_t* data, uint32_t length);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRC32_H_ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,45 @@
+/**
+ * @file		lpc17xx_ahbram.h
+ * @brief	Section attributes for the two AHB SRAM banks (AHBRAM0 and AHBRAM1, 16 KB each)
+ *
+ * The linker script gathers each bank without a load image, so the variables placed there take no
+ * initial value: the _BSS sections are zeroed by Reset_Handler, the _NOINIT ones keep whatever the
+ * memory holds. Building with NO_AHBRAM defined, and on any non-ARM host, leaves every macro empty
+ * and the variables in .bss.
+ */
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup AHBRAM AHBRAM
+ * @ingroup LPC1700CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC17XX_AHBRAM_H_
+#define LPC17XX_AHBRAM_H_
+
+/* Public Macros -------------------------------------------------------------- */
+/** @defgroup AHBRAM_Public_Macros AHBRAM Public Macros
+ * @{
+ */
+
+#if defined(__arm__) && !defined(NO_AHBRAM)
+#define AHBRAM0_BSS    __attribute__((section(".ahbram0.bss")))    /**< AHBRAM0, zeroed at startup */
+#define AHBRAM0_NOINIT __attribute__((section(".ahbram0.noinit"))) /**< AHBRAM0, not zeroed */
+#define AHBRAM1_BSS    __attribute__((section(".ahbram1.bss")))    /**< AHBRAM1, zeroed at startup */
+#define AHBRAM1_NOINIT __attribute__((section(".ahbram1.noinit"))) /**< AHBRAM1, not zeroed */
+#else
+#define AHBRAM0_BSS    /**< No relocation: the variable stays in .bss */
+#define AHBRAM0_NOINIT /**< No relocation: the variable stays in .bss */
+#define AHBRAM1_BSS    /**< No relocation: the variable stays in .bss */
+#define AHBRAM1_NOINIT /**< No relocation: the variable stays in .bss */
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* LPC17XX_AHBRAM_H_ */
+
+/**
+ * @}
+ */
@@ -37,6 +37,8 @@
 
 /* Includes ------------------------------------------------------------------- */
 #include "lpc17xx_emac.h"
+#include "crc32.h"
+#include "lpc17xx_ahbram.h"
 #include "lpc17xx_clkpwr.h"
 
 /* If this source file built with example, the LPC17xx FW library configuration
@@ -59,31 +61,32 @@
 /* MII Mgmt Configuration register - Clock divider setting */
 const uint8_t EMAC_clkdiv[] = {4, 6, 8, 10, 14, 20, 28, 36, 40, 44, 48, 52, 56, 60, 64};
 
-/* EMAC local DMA Descriptors */
+/* EMAC DMA Descriptors and buffers, in the AHBRAM0 bank (see lpc17xx_ahbram.h): the EMAC is an AHB master
+ * of its own and reaches them without competing with the CPU for the local SRAM. Descriptors and
+ * status are zeroed at startup; the buffers are always written before being read. */
 
 /** Rx Descriptor data array */
-static RX_Desc Rx_Desc[EMAC_NUM_RX_FRAG];
+AHBRAM0_BSS static RX_Desc Rx_Desc[EMAC_NUM_RX_FRAG];
 
 /** Rx Status data array - Must be 8-Byte aligned */
 #if defined(__CC_ARM)
-static __align(8) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
+AHBRAM0_BSS static __align(8) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
 #elif defined(__ICCARM__)
 #pragma data_alignment = 8
-static RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
+AHBRAM0_BSS static RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
 #elif defined(__GNUC__)
-static __attribute__((aligned(8))) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
+AHBRAM0_BSS static __attribute__((aligned(8))) RX_Stat Rx_Stat[EMAC_NUM_RX_FRAG];
 #endif
 
 /** Tx Descriptor data array */
-static TX_Desc Tx_Desc[EMAC_NUM_TX_FRAG];
+AHBRAM0_BSS static TX_Desc Tx_Desc[EMAC_NUM_TX_FRAG];
 /** Tx Status data array */
-static TX_Stat Tx_Stat[EMAC_NUM_TX_FRAG];
+AHBRAM0_BSS static TX_Stat Tx_Stat[EMAC_NUM_TX_FRAG];
 
-/* EMAC local DMA buffers */
 /** Rx buffer data */
-static uint32_t rx_buf[EMAC_NUM_RX_FRAG][EMAC_ETH_MAX_FLEN >> 2];
+AHBRAM0_NOINIT static uint32_t rx_buf[EMAC_NUM_RX_FRAG][EMAC_ETH_MAX_FLEN >> 2];
 /** Tx buffer data */
-static uint32_t tx_buf[EMAC_NUM_TX_FRAG][EMAC_ETH_MAX_FLEN >> 2];
+AHBRAM0_NOINIT static uint32_t tx_buf[EMAC_NUM_TX_FRAG][EMAC_ETH_MAX_FLEN >> 2];
 
 /**
  * @}
@@ -239,54 +242,8 @@ static void setEmacAddr(uint8_t abStationAddr[])
                                                                          **********************************************************************/
 static int32_t emac_CRCCalc(uint8_t frame_no_fcs[], int32_t frame_len)
 {
-    int i;              // iterator
-    int j;              // another iterator
-    char byte;          // current byte
-    int crc;            // CRC result
-    int q0, q1, q2, q3; // temporary variables
-    crc = 0xFFFFFFFF;
-    for (i = 0; i < frame_len; i++)
-    {
-        byte = *frame_no_fcs++;
-        for (j = 0; j < 2; j++)
-        {
-            if (((crc >> 28) ^ (byte >> 3)) & 0x00000001)
-            {
-                q3 = 0x04C11DB7;
-            }
-            else
-            {
-                q3 = 0x00000000;
-            }
-            if (((crc >> 29) ^ (byte >> 2)) & 0x00000001)
-            {
-                q2 = 0x09823B6E;
-            }
-            else
-            {
-                q2 = 0x00000000;
-            }
-            if (((crc >> 30) ^ (byte >> 1)) & 0x00000001)
-            {
-                q1 = 0x130476DC;
-            }
-            else
-            {
-                q1 = 0x00000000;
-            }
-            if (((crc >> 31) ^ (byte >> 0)) & 0x00000001)
-            {
-                q0 = 0x2608EDB8;
-            }
-            else
-            {
-                q0 = 0x00000000;
-            }
-            crc = (crc << 4) ^ q3 ^ q2 ^ q1 ^ q0;
-            byte >>= 4;
-        }
-    }
-    return crc;
+    /* IEEE 802.3 CRC computed LSB-first with the shared tables; the hash filter expects it bit-reversed */
+    return (int32_t)__RBIT(CRC32_Update_Slice4(CRC32_INIT, frame_no_fcs, (uint32_t)frame_len));
 }
 /* End of Private Functions --------------------------------------------------- */
 
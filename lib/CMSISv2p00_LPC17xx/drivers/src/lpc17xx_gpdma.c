@@ -169,7 +169,7 @@ const uint8_t GPDMA_LUTPerWid[] = {
     GPDMA_WIDTH_WORD, // ADC
     GPDMA_WIDTH_WORD, // I2S channel 0
     GPDMA_WIDTH_WORD, // I2S channel 1
-    GPDMA_WIDTH_BYTE, // DAC
+    GPDMA_WIDTH_WORD, // DAC (the DACR VALUE field is bits 15:6, a byte write cannot reach it)
     GPDMA_WIDTH_BYTE, // UART0 Tx
     GPDMA_WIDTH_BYTE, // UART0 Rx
     GPDMA_WIDTH_BYTE, // UART1 Tx
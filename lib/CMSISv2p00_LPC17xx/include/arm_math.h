@@ -245,7 +245,10 @@
  * @defgroup groupController Controller Functions
  */
 
-/**/ ***@brief** / *@defgroup groupStats Statistics Functions* /
+/**
+ * @ingroup DSP_Functions
+ * @defgroup groupStats Statistics Functions
+ */
 
 /**
  * @ingroup DSP_Functions
@@ -177,7 +177,8 @@ __attribute__((section(".isr_vector"))) void (*const g_pfnVectors[])(void) = {
 //
 // The following are constructs created by the linker, indicating where the
 // the "data" and "bss" segments reside in memory.  The initializers for the
-// for the "data" segment resides immediately following the "text" segment.
+// for the "data" segment resides immediately following the "text" segment,
+// and the code of the "ramfunc" segment immediately following them.
 //
 //*****************************************************************************
 extern unsigned long _etext;
@@ -185,6 +186,13 @@ extern unsigned long _data;
 extern unsigned long _edata;
 extern unsigned long _bss;
 extern unsigned long _ebss;
+extern unsigned long _ramfunc_load;
+extern unsigned long _ramfunc;
+extern unsigned long _eramfunc;
+extern unsigned long _ahbram0_bss;
+extern unsigned long _eahbram0_bss;
+extern unsigned long _ahbram1_bss;
+extern unsigned long _eahbram1_bss;
 
 //*****************************************************************************
 // Reset entry point for your code.
@@ -205,6 +213,16 @@ void Reset_Handler(void)
         *pulDest++ = *pulSrc++;
     }
 
+    //
+    // Copy the functions that run from SRAM (RAMFUNC, .ramfunc section), stored
+    // in flash after the data initializers.
+    //
+    pulSrc = &_ramfunc_load;
+    for (pulDest = &_ramfunc; pulDest < &_eramfunc;)
+    {
+        *pulDest++ = *pulSrc++;
+    }
+
     //
     // Zero fill the bss segment.  This is done with inline assembly since this
     // will clear the value of pulDest if it is not kept in a register.
@@ -219,6 +237,19 @@ void Reset_Handler(void)
           "        strlt   r2, [r0], #4\n"
           "        blt     zero_loop");
 
+    //
+    // Zero fill the .bss parts of the peripheral SRAM banks (AHBRAM0_BSS and
+    // AHBRAM1_BSS); their .noinit parts are left as they are.
+    //
+    for (pulDest = &_ahbram0_bss; pulDest < &_eahbram0_bss;)
+    {
+        *pulDest++ = 0;
+    }
+    for (pulDest = &_ahbram1_bss; pulDest < &_eahbram1_bss;)
+    {
+        *pulDest++ = 0;
+    }
+
     // Call SystemInit to initialize clocks, etc.
     SystemInit();
 
@@ -0,0 +1,198 @@
+/**
+ * @file test_calibration.c
+ * @brief Prueba de host de la calibracion de los sensores (Src/calibration.c).
+ *
+ * Enlaza el CALIB_Convert() y los descriptores CALIB_Channels del firmware con las tablas que genero table_gen en
+ * build/generated/sensor_tables.c (por eso "make test" corre despues de "make tables"). Pasa las 32768 lecturas Q15
+ * de cada curva por CALIB_Convert() y las compara con los modelos en punto flotante de Src/table_config.h, que se
+ * repiten aca como referencia; informa el error maximo de cada curva, el de la conversion anterior (porcentaje de
+ * VREF) y el tiempo por conversion de las tres.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include "calibration.h"
+#include "table_config.h"
+#include "test_util.h"
+
+// Definiciones del modulo:
+#define TEST_CALIB_INPUTS 32768      /**< Lecturas de CALIB_Convert(): fraccion Q15 de VREF, 0 a 0x7FFF */
+#define TEST_CALIB_BENCH  (1L << 24) /**< Conversiones de cada medicion de tiempo */
+
+/**
+ * @brief Temperatura del LM35, en °C, para una tension relativa a VREF.
+ */
+static double TEST_Lm35(double x)
+{
+    return x * TABLE_VREF_MV / TABLE_LM35_MV_PER_C + TABLE_LM35_OFFSET;
+}
+
+/**
+ * @brief Porcentaje del LDR para una tension relativa a VREF (la recta de CALIB_LIGHT).
+ */
+static double TEST_Ldr(double x)
+{
+    return x * TABLE_LDR_SPAN + TABLE_LDR_OFFSET;
+}
+
+/**
+ * @brief Concentracion del MQ-2, en centenas de ppm, para una tension relativa a VREF.
+ *
+ * Con RL en serie con el sensor, Rs / RL = (1 - x) / x; la recta del datasheet da log10(ppm) a partir de
+ * log10(Rs / R0).
+ */
+static double TEST_Mq2(double x)
+{
+    double ratio = (1.0 - x) / x * TABLE_MQ2_RL_R0;
+    double ppm = pow(10.0, (log10(ratio) - TABLE_MQ2_LOG_RATIO) / TABLE_MQ2_SLOPE + TABLE_MQ2_LOG_PPM);
+
+    ppm = (ppm > TABLE_MQ2_MAX_PPM) ? TABLE_MQ2_MAX_PPM : ppm;
+    return ppm / 100.0 * TABLE_MQ2_GAIN + TABLE_MQ2_OFFSET;
+}
+
+/**
+ * @brief Curva verificada: el canal de CALIB_Channels y su modelo.
+ */
+typedef struct
+{
+    const char* Name;          /**< Nombre de la curva */
+    uint8_t Channel;           /**< Curva de CALIB_Channels (CALIB_Channel_Id_Type) */
+    double (*Model)(double x); /**< Modelo en punto flotante */
+    double Tolerance;          /**< Error maximo admitido, en unidades, mas alla del intervalo de la tabla */
+} TEST_Calib_Type;
+
+static const TEST_Calib_Type Curves[] = {
+    {"LM35", CALIB_TEMPERATURE, TEST_Lm35, 0.5},
+    {"LDR", CALIB_LIGHT, TEST_Ldr, 0.5 + 1e-3},
+    {"MQ-2", CALIB_GAS, TEST_Mq2, 0.5},
+};
+
+/**
+ * @brief Conversion anterior a calibration.c: porcentaje de VREF truncado, igual para todos los canales.
+ */
+static uint8_t TEST_CalibOld(int32_t value)
+{
+    return (uint8_t)((value * 100) >> 15);
+}
+
+/**
+ * @brief Modelo de una curva saturado a [0, Max] del canal, sin redondear.
+ */
+static double TEST_CalibReference(const TEST_Calib_Type* curve, double x)
+{
+    double units = curve->Model(x);
+    double max = CALIB_Channels[curve->Channel].Max;
+
+    return (units < 0) ? 0 : ((units > max) ? max : units);
+}
+
+/**
+ * @brief Verifica la calibracion de todas las curvas contra el modelo y mide el tiempo por conversion.
+ *
+ * Una lectura de una curva con tabla puede devolver el valor de cualquier punto del intervalo de TABLE_ADC_BITS que
+ * la indexa: el error se mide contra el modelo en la lectura exacta, pero solo es falla si el resultado queda fuera
+ * de los valores del modelo en los extremos del intervalo (las curvas son monotonas) mas la tolerancia.
+ *
+ * @return 0 si es correcta, 2 si algun resultado queda fuera.
+ */
+int main(void)
+{
+    const size_t curves = sizeof(Curves) / sizeof(Curves[0]);
+    volatile uint32_t sink = 0;
+    unsigned failures = 0;
+    uint64_t cycles[3];
+    double elapsed[3];
+    double start;
+
+    TEST_Init("test_calibration");
+
+    if (CALIB_Convert(CALIB_CHANNELS, 0x4000) != 0)
+    {
+        TEST_Fail(&failures, "CALIB_Convert de un canal invalido", CALIB_CHANNELS, 0x4000);
+    }
+
+    for (size_t i = 0; i < curves; i++)
+    {
+        const TEST_Calib_Type* curve = &Curves[i];
+        int lookup = (CALIB_Channels[curve->Channel].Kind == CALIB_LOOKUP);
+        double max_error = 0;
+        double old_error = 0;
+        long worst = 0;
+
+        for (int32_t value = 0; value < TEST_CALIB_INPUTS; value++)
+        {
+            uint8_t result = CALIB_Convert(curve->Channel, (q15_t)value);
+            double reference = TEST_CalibReference(curve, (double)value / TEST_CALIB_INPUTS);
+            double low = reference;
+            double high = reference;
+            double error = fabs(result - reference);
+
+            if (lookup)
+            {
+                // Extremos del intervalo de la tabla (x = 0 se evita: el modelo del MQ-2 no esta definido ahi):
+                int32_t first = (value >> CALIB_LOOKUP_SHIFT) << CALIB_LOOKUP_SHIFT;
+                double a = TEST_CalibReference(curve, (first + 0.5) / TEST_CALIB_INPUTS);
+                double b = TEST_CalibReference(curve, (first + (1 << CALIB_LOOKUP_SHIFT)) / (double)TEST_CALIB_INPUTS);
+
+                low = (a < b) ? a : b;
+                high = (a < b) ? b : a;
+            }
+            if (result < low - curve->Tolerance || result > high + curve->Tolerance)
+            {
+                TEST_Fail(&failures, curve->Name, value, result);
+            }
+            if (error > max_error)
+            {
+                max_error = error;
+                worst = value;
+            }
+            if (!lookup && fabs(TEST_CalibOld(value) - reference) > old_error)
+            {
+                old_error = fabs(TEST_CalibOld(value) - reference);
+            }
+        }
+
+        if (lookup)
+        {
+            TEST_Print("%-5s error maximo %.2f (lectura 0x%04lx, tabla)", curve->Name, max_error, worst);
+        }
+        else
+        {
+            TEST_Print("%-5s error maximo %.2f (lectura 0x%04lx, recta Q15), conversion anterior %.2f", curve->Name,
+                       max_error, worst, old_error);
+        }
+    }
+
+    // Tiempo por conversion: la de CALIB_Convert(), la anterior y el modelo en punto flotante:
+    for (int method = 0; method < 3; method++)
+    {
+        start = TEST_Now();
+        cycles[method] = TEST_Cycles();
+        for (long n = 0; n < TEST_CALIB_BENCH; n++)
+        {
+            const TEST_Calib_Type* curve = &Curves[n % curves];
+            int32_t value = (int32_t)((n * 7919) % TEST_CALIB_INPUTS);
+
+            if (method == 0)
+            {
+                sink += CALIB_Convert(curve->Channel, (q15_t)value);
+            }
+            else if (method == 1)
+            {
+                sink += TEST_CalibOld(value);
+            }
+            else
+            {
+                sink += (uint32_t)TEST_CalibReference(curve, (double)value / TEST_CALIB_INPUTS);
+            }
+        }
+        cycles[method] = TEST_Cycles() - cycles[method];
+        elapsed[method] = TEST_Now() - start;
+    }
+    TEST_Print("%.1f ns por conversion (%.1f ciclos), %.1f ns la anterior, %.1f ns en punto flotante",
+               elapsed[0] * 1e9 / TEST_CALIB_BENCH, (double)cycles[0] / TEST_CALIB_BENCH,
+               elapsed[1] * 1e9 / TEST_CALIB_BENCH, elapsed[2] * 1e9 / TEST_CALIB_BENCH);
+
+    return TEST_Result(failures);
+}
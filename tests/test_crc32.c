@@ -0,0 +1,181 @@
+/**
+ * @file test_crc32.c
+ * @brief Prueba de host del CRC-32 de la biblioteca de drivers (crc32.c, el que usa emac_CRCCalc()).
+ *
+ * Verifica el vector estandar "123456789" y compara, sobre tramas al azar, las dos implementaciones de crc32.c entre
+ * si y con la rutina bit a bit que reemplazaron en lpc17xx_emac.c; mide los bytes por ciclo de las tres en el host.
+ */
+
+#include <stdint.h>
+
+#include "crc32.h"
+#include "test_util.h"
+
+// Definiciones del modulo:
+#define TEST_CRC_FRAME  1536         /**< Trama mas larga del EMAC (EMAC_ETH_MAX_FLEN) */
+#define TEST_CRC_FRAMES 20000        /**< Tramas al azar comparadas con la rutina anterior */
+#define TEST_CRC_BENCH  (16UL << 20) /**< Bytes de cada medicion de rendimiento */
+
+/**
+ * @brief CRC de una trama con la rutina bit a bit que usaba emac_CRCCalc() antes de la tabla: un nibble por paso,
+ * con el registro sin reflejar (el resultado es el registro reflejado de CRC32_Update() con los bits invertidos).
+ */
+static uint32_t TEST_Crc32Nibble(const uint8_t* frame, uint32_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t q0, q1, q2, q3;
+    uint8_t byte;
+
+    for (uint32_t i = 0; i < length; i++)
+    {
+        byte = frame[i];
+        for (int j = 0; j < 2; j++)
+        {
+            q3 = (((crc >> 28) ^ (byte >> 3)) & 1) ? 0x04C11DB7 : 0;
+            q2 = (((crc >> 29) ^ (byte >> 2)) & 1) ? 0x09823B6E : 0;
+            q1 = (((crc >> 30) ^ (byte >> 1)) & 1) ? 0x130476DC : 0;
+            q0 = (((crc >> 31) ^ (byte >> 0)) & 1) ? 0x2608EDB8 : 0;
+            crc = (crc << 4) ^ q3 ^ q2 ^ q1 ^ q0;
+            byte >>= 4;
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Invierte el orden de los bits de una palabra (__RBIT del Cortex-M3).
+ */
+static uint32_t TEST_Reverse32(uint32_t value)
+{
+    uint32_t reversed = 0;
+
+    for (int i = 0; i < 32; i++)
+    {
+        reversed = (reversed << 1) | ((value >> i) & 1);
+    }
+
+    return reversed;
+}
+
+/**
+ * @brief Mide una implementacion del CRC sobre tramas de TEST_CRC_FRAME bytes e informa su tiempo por byte.
+ *
+ * @param name Nombre de la implementacion.
+ * @param method 0: CRC32_Update_Slice4(), 1: CRC32_Update(), 2: la rutina bit a bit.
+ * @param frame Trama medida.
+ */
+static void TEST_CrcBench(const char* name, int method, const uint8_t* frame)
+{
+    volatile uint32_t sink = 0;
+    uint64_t cycles;
+    double start;
+    double elapsed;
+
+    start = TEST_Now();
+    cycles = TEST_Cycles();
+    for (unsigned long n = 0; n < TEST_CRC_BENCH / TEST_CRC_FRAME; n++)
+    {
+        if (method == 0)
+        {
+            sink += CRC32_Update_Slice4(CRC32_INIT, frame, TEST_CRC_FRAME);
+        }
+        else if (method == 1)
+        {
+            sink += CRC32_Update(CRC32_INIT, frame, TEST_CRC_FRAME);
+        }
+        else
+        {
+            sink += TEST_Crc32Nibble(frame, TEST_CRC_FRAME);
+        }
+    }
+    cycles = TEST_Cycles() - cycles;
+    elapsed = TEST_Now() - start;
+
+    if (cycles != 0)
+    {
+        TEST_Print("%-12s %6.2f ns por byte, %.3f bytes por ciclo", name, elapsed * 1e9 / TEST_CRC_BENCH,
+                   (double)TEST_CRC_BENCH / cycles);
+    }
+    else
+    {
+        TEST_Print("%-12s %6.2f ns por byte", name, elapsed * 1e9 / TEST_CRC_BENCH);
+    }
+}
+
+/**
+ * @brief Verifica el CRC-32 de los drivers y mide su rendimiento.
+ *
+ * El vector estandar se verifica con las tres funciones y con la rutina anterior. Sobre tramas de largo y
+ * alineacion al azar, CRC32_Update_Slice4() debe coincidir con CRC32_Update(), tambien partida en dos llamadas, y
+ * __RBIT de su resultado (lo que devuelve emac_CRCCalc()) con la rutina bit a bit.
+ *
+ * @return 0 si es correcto, 2 si alguna verificacion falla.
+ */
+int main(void)
+{
+    static const uint8_t check[] = "123456789";
+    static uint8_t frame[TEST_CRC_FRAME + 4];
+    uint32_t seed = 0x1B873593;
+    unsigned failures = 0;
+    uint32_t length;
+    uint32_t split;
+    uint8_t* data;
+    uint32_t slice;
+
+    TEST_Init("test_crc32");
+
+    if (CRC32_Compute(check, 9) != CRC32_CHECK)
+    {
+        TEST_Fail(&failures, "CRC32_Compute del vector estandar", 0, CRC32_Compute(check, 9));
+    }
+    if (CRC32_Update(CRC32_INIT, check, 9) != (CRC32_CHECK ^ CRC32_XOROUT))
+    {
+        TEST_Fail(&failures, "CRC32_Update del vector estandar", 0, CRC32_Update(CRC32_INIT, check, 9));
+    }
+    if (CRC32_Update_Slice4(CRC32_INIT, check, 9) != (CRC32_CHECK ^ CRC32_XOROUT))
+    {
+        TEST_Fail(&failures, "CRC32_Update_Slice4 del vector estandar", 0, CRC32_Update_Slice4(CRC32_INIT, check, 9));
+    }
+    if (TEST_Reverse32(TEST_Crc32Nibble(check, 9)) != (CRC32_CHECK ^ CRC32_XOROUT))
+    {
+        TEST_Fail(&failures, "rutina bit a bit del vector estandar", 0, TEST_Crc32Nibble(check, 9));
+    }
+
+    for (long n = 0; n < TEST_CRC_FRAMES; n++)
+    {
+        // Largo de 0 a TEST_CRC_FRAME y cualquier alineacion, para los restos de la pasada de a cuatro bytes:
+        length = TEST_Random(&seed) % (TEST_CRC_FRAME + 1);
+        data = frame + TEST_Random(&seed) % 4;
+        split = (length == 0) ? 0 : TEST_Random(&seed) % length;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            data[i] = (uint8_t)TEST_Random(&seed);
+        }
+
+        slice = CRC32_Update_Slice4(CRC32_INIT, data, length);
+        if (slice != CRC32_Update(CRC32_INIT, data, length))
+        {
+            TEST_Fail(&failures, "CRC32_Update_Slice4 distinto de CRC32_Update", n, length);
+        }
+        if (slice != CRC32_Update_Slice4(CRC32_Update_Slice4(CRC32_INIT, data, split), data + split, length - split))
+        {
+            TEST_Fail(&failures, "CRC32_Update_Slice4 partido en dos llamadas", n, split);
+        }
+        if (TEST_Reverse32(slice) != TEST_Crc32Nibble(data, length))
+        {
+            TEST_Fail(&failures, "emac_CRCCalc distinto de la rutina bit a bit", n, length);
+        }
+    }
+    TEST_Print("vector estandar y %d tramas al azar de hasta %d bytes", TEST_CRC_FRAMES, TEST_CRC_FRAME);
+
+    for (uint32_t i = 0; i < TEST_CRC_FRAME; i++)
+    {
+        frame[i] = (uint8_t)TEST_Random(&seed);
+    }
+    TEST_CrcBench("slice-by-4", 0, frame);
+    TEST_CrcBench("tabla", 1, frame);
+    TEST_CrcBench("bit a bit", 2, frame);
+
+    return TEST_Result(failures);
+}
@@ -0,0 +1,327 @@
+/**
+ * @file test_ring_buffer.c
+ * @brief Prueba de host del buffer circular de Src/ring_buffer.c.
+ *
+ * Verifica el buffer vacio y lleno, el desborde de los indices de 32 bits y un productor y un consumidor intercalados
+ * como la interrupcion y el bucle principal, y mide los bytes por segundo que pasan por el con el productor en otro
+ * hilo.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ring_buffer.h"
+#include "test_util.h"
+
+// Definiciones del modulo:
+#define TEST_RING_SIZE       64           /**< Tamaño del buffer verificado (el de recepcion de uart_ring.h) */
+#define TEST_RING_BENCH_SIZE 256          /**< Tamaño del buffer de la medicion (el de transmision de uart_ring.h) */
+#define TEST_RING_BURST      8            /**< Bytes maximos por interrupcion (nivel de disparo del FIFO del UART2) */
+#define TEST_RING_STEPS      1000000      /**< Operaciones de la secuencia intercalada */
+#define TEST_RING_BENCH      (32UL << 20) /**< Bytes de cada medicion de rendimiento */
+#define TEST_RING_CHUNK      16           /**< Bytes por llamada de la medicion en bloque (el FIFO de transmision) */
+
+/**
+ * @brief Byte n de la secuencia que escribe el productor (sin periodo comun con el tamaño del buffer).
+ */
+static uint8_t TEST_RingByte(uint32_t n)
+{
+    return (uint8_t)(n ^ (n >> 8));
+}
+
+/**
+ * @brief Verifica el buffer vacio y lleno, de a un byte y en bloque, con los indices arrancando en start.
+ */
+static void TEST_CheckRingLimits(uint32_t start, unsigned* failures)
+{
+    uint8_t storage[TEST_RING_SIZE];
+    uint8_t block[TEST_RING_SIZE + 1];
+    RING_Buffer_Type ring;
+    uint8_t value;
+
+    RING_Init(&ring, storage, TEST_RING_SIZE);
+    ring.Head = start;
+    ring.Tail = start;
+
+    if (RING_Count(&ring) != 0 || RING_Free(&ring) != TEST_RING_SIZE || RING_Get(&ring, &value) != FALSE ||
+        RING_Read(&ring, block, 1) != 0)
+    {
+        TEST_Fail(failures, "buffer vacio", start, RING_Count(&ring));
+    }
+
+    // Lleno y vaciado de a un byte:
+    for (uint32_t n = 0; n < TEST_RING_SIZE; n++)
+    {
+        if (RING_Put(&ring, TEST_RingByte(n)) != TRUE)
+        {
+            TEST_Fail(failures, "RING_Put rechazado con lugar libre", start, n);
+        }
+    }
+    if (RING_Put(&ring, 0) != FALSE || RING_Write(&ring, block, 1) != 0 || RING_Count(&ring) != TEST_RING_SIZE ||
+        RING_Free(&ring) != 0)
+    {
+        TEST_Fail(failures, "buffer lleno", start, RING_Count(&ring));
+    }
+    for (uint32_t n = 0; n < TEST_RING_SIZE; n++)
+    {
+        if (RING_Get(&ring, &value) != TRUE || value != TEST_RingByte(n))
+        {
+            TEST_Fail(failures, "orden de RING_Get", start, n);
+        }
+    }
+
+    // Lleno y vaciado en bloque, pidiendo un byte de mas:
+    for (uint32_t n = 0; n <= TEST_RING_SIZE; n++)
+    {
+        block[n] = TEST_RingByte(n);
+    }
+    if (RING_Write(&ring, block, TEST_RING_SIZE + 1) != TEST_RING_SIZE || RING_Free(&ring) != 0)
+    {
+        TEST_Fail(failures, "RING_Write de mas del lugar libre", start, RING_Free(&ring));
+    }
+    memset(block, 0, sizeof(block));
+    if (RING_Read(&ring, block, TEST_RING_SIZE + 1) != TEST_RING_SIZE || RING_Count(&ring) != 0)
+    {
+        TEST_Fail(failures, "RING_Read de mas de lo almacenado", start, RING_Count(&ring));
+    }
+    for (uint32_t n = 0; n < TEST_RING_SIZE; n++)
+    {
+        if (block[n] != TEST_RingByte(n))
+        {
+            TEST_Fail(failures, "orden de RING_Read", start, n);
+        }
+    }
+}
+
+/**
+ * @brief Intercala al azar un productor y un consumidor sobre el mismo buffer, con los indices arrancando en start.
+ *
+ * El productor es la interrupcion de recepcion: rafagas de 1 a TEST_RING_BURST bytes, de a uno con RING_Put() o en
+ * bloque con RING_Write(). El consumidor es el bucle principal: lee con RING_Read() lo que pide o con RING_Get() de
+ * a un byte. Cada byte leido se compara con la secuencia escrita y la cantidad almacenada con la diferencia.
+ */
+static void TEST_CheckRingInterleaved(uint32_t start, unsigned* failures)
+{
+    uint8_t storage[TEST_RING_SIZE];
+    uint8_t block[TEST_RING_SIZE + TEST_RING_BURST];
+    RING_Buffer_Type ring;
+    uint32_t seed = 0x9E3779B9;
+    uint32_t produced = 0;
+    uint32_t consumed = 0;
+    uint32_t count;
+    uint32_t length;
+    uint32_t done;
+    uint8_t value;
+
+    RING_Init(&ring, storage, TEST_RING_SIZE);
+    ring.Head = start;
+    ring.Tail = start;
+
+    for (long step = 0; step < TEST_RING_STEPS; step++)
+    {
+        uint32_t r = TEST_Random(&seed);
+
+        count = produced - consumed;
+        if (r & 1)
+        {
+            length = 1 + (r >> 1) % TEST_RING_BURST;
+            if (r & 0x100)
+            {
+                for (done = 0; done < length && RING_Put(&ring, TEST_RingByte(produced + done)) == TRUE; done++)
+                {
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < length; i++)
+                {
+                    block[i] = TEST_RingByte(produced + i);
+                }
+                done = RING_Write(&ring, block, length);
+            }
+            if (done != ((length < TEST_RING_SIZE - count) ? length : TEST_RING_SIZE - count))
+            {
+                TEST_Fail(failures, "bytes escritos por el productor", step, done);
+            }
+            produced += done;
+        }
+        else
+        {
+            length = (r & 0x100) ? 1 + (r >> 1) % sizeof(block) : 1;
+            if (length == 1 && (r & 0x200))
+            {
+                done = (RING_Get(&ring, &block[0]) == TRUE) ? 1 : 0;
+            }
+            else
+            {
+                done = RING_Read(&ring, block, length);
+            }
+            if (done != ((length < count) ? length : count))
+            {
+                TEST_Fail(failures, "bytes leidos por el consumidor", step, done);
+            }
+            for (uint32_t i = 0; i < done; i++)
+            {
+                if (block[i] != TEST_RingByte(consumed + i))
+                {
+                    TEST_Fail(failures, "byte leido fuera de orden", step, block[i]);
+                }
+            }
+            consumed += done;
+        }
+
+        if (RING_Count(&ring) != produced - consumed || RING_Free(&ring) != TEST_RING_SIZE - (produced - consumed))
+        {
+            TEST_Fail(failures, "cantidad almacenada", step, RING_Count(&ring));
+        }
+    }
+
+    // Lo que quedo sale completo y en orden:
+    while (RING_Get(&ring, &value) == TRUE)
+    {
+        if (value != TEST_RingByte(consumed++))
+        {
+            TEST_Fail(failures, "byte leido fuera de orden al vaciar", consumed, value);
+        }
+    }
+    if (consumed != produced)
+    {
+        TEST_Fail(failures, "bytes perdidos", produced, consumed);
+    }
+}
+
+/**
+ * @brief Buffer y parametros de una medicion de rendimiento con dos hilos.
+ */
+typedef struct
+{
+    RING_Buffer_Type Ring; /**< Buffer compartido */
+    uint32_t Chunk;        /**< Bytes por llamada; 0 para RING_Put()/RING_Get() */
+} TEST_Ring_Bench_Type;
+
+/**
+ * @brief Productor de la medicion: escribe TEST_RING_BENCH bytes de la secuencia y cede la CPU si no hay lugar.
+ */
+static void* TEST_RingProducer(void* arg)
+{
+    TEST_Ring_Bench_Type* bench = arg;
+    uint8_t block[TEST_RING_CHUNK];
+    uint32_t n = 0;
+    uint32_t done;
+
+    while (n < TEST_RING_BENCH)
+    {
+        if (bench->Chunk == 0)
+        {
+            done = (RING_Put(&bench->Ring, TEST_RingByte(n)) == TRUE) ? 1 : 0;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < bench->Chunk; i++)
+            {
+                block[i] = TEST_RingByte(n + i);
+            }
+            done = RING_Write(&bench->Ring, block, bench->Chunk);
+        }
+        n += done;
+        if (done == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Mide los bytes por segundo con el productor en otro hilo y el consumidor en este, y verifica la secuencia.
+ *
+ * @return Bytes por segundo, o 0 si no se pudo crear el hilo.
+ */
+static double TEST_RingBench(uint32_t chunk, unsigned* failures)
+{
+    static uint8_t storage[TEST_RING_BENCH_SIZE];
+    TEST_Ring_Bench_Type bench;
+    uint8_t block[TEST_RING_BENCH_SIZE];
+    pthread_t producer;
+    uint32_t n = 0;
+    uint32_t done;
+    double start;
+
+    RING_Init(&bench.Ring, storage, TEST_RING_BENCH_SIZE);
+    bench.Chunk = chunk;
+
+    start = TEST_Now();
+    if (pthread_create(&producer, NULL, TEST_RingProducer, &bench) != 0)
+    {
+        TEST_Fail(failures, "no se pudo crear el hilo del productor", 0, errno);
+        return 0;
+    }
+    while (n < TEST_RING_BENCH)
+    {
+        if (chunk == 0)
+        {
+            done = (RING_Get(&bench.Ring, &block[0]) == TRUE) ? 1 : 0;
+        }
+        else
+        {
+            done = RING_Read(&bench.Ring, block, sizeof(block));
+        }
+        for (uint32_t i = 0; i < done; i++)
+        {
+            if (block[i] != TEST_RingByte(n + i))
+            {
+                TEST_Fail(failures, "byte fuera de orden entre hilos", n + i, block[i]);
+            }
+        }
+        n += done;
+        if (done == 0)
+        {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+
+    return TEST_RING_BENCH / (TEST_Now() - start);
+}
+
+/**
+ * @brief Verifica el buffer circular y mide su rendimiento.
+ *
+ * @return 0 si es correcto, 2 si alguna verificacion falla.
+ */
+int main(void)
+{
+    static const uint32_t starts[] = {0, 0xFFFFFFFFUL - TEST_RING_SIZE / 2, 0xFFFFFFFFUL, 0xFFFFF000UL};
+    uint8_t storage[TEST_RING_SIZE];
+    RING_Buffer_Type ring;
+    unsigned failures = 0;
+    double bytes;
+    double block;
+
+    TEST_Init("test_ring_buffer");
+
+    if (RING_Init(&ring, storage, 0) != ERROR || RING_Init(&ring, storage, TEST_RING_SIZE - 1) != ERROR)
+    {
+        TEST_Fail(&failures, "RING_Init acepta un tamaño que no es potencia de dos", 0, 0);
+    }
+
+    // Los indices arrancan lejos y cerca del desborde de 32 bits, que la secuencia intercalada cruza:
+    for (unsigned i = 0; i < sizeof(starts) / sizeof(starts[0]); i++)
+    {
+        TEST_CheckRingLimits(starts[i], &failures);
+        TEST_CheckRingInterleaved(starts[i], &failures);
+    }
+    TEST_Print("vacio, lleno y %d operaciones intercaladas desde %zu posiciones", TEST_RING_STEPS,
+               sizeof(starts) / sizeof(starts[0]));
+
+    bytes = TEST_RingBench(0, &failures);
+    block = TEST_RingBench(TEST_RING_CHUNK, &failures);
+    TEST_Print("%.1f MB/s de a un byte, %.1f MB/s en bloques de %d (dos hilos, %d bytes)", bytes / 1e6, block / 1e6,
+               TEST_RING_CHUNK, TEST_RING_BENCH_SIZE);
+
+    return TEST_Result(failures);
+}
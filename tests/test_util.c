@@ -0,0 +1,77 @@
+/**
+ * @file test_util.c
+ * @brief Utilidades comunes de las pruebas de host de los modulos del firmware (tests/).
+ */
+
+#include "test_util.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const char* Name = "test"; /**< Nombre de la prueba en los mensajes */
+
+void TEST_Init(const char* name)
+{
+    Name = name;
+}
+
+void TEST_Print(const char* format, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "%s: ", Name);
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+}
+
+void TEST_Fail(unsigned* failures, const char* message, long index, long value)
+{
+    if ((*failures)++ < TEST_MAX_REPORTED)
+    {
+        TEST_Print("FALLA: %s (indice %ld, valor %ld)", message, index, value);
+    }
+}
+
+int TEST_Result(unsigned failures)
+{
+    if (failures != 0)
+    {
+        TEST_Print("%u fallas", failures);
+        TEST_Print("FALLA");
+        return 2;
+    }
+
+    TEST_Print("OK");
+    return 0;
+}
+
+uint32_t TEST_Random(uint32_t* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+double TEST_Now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+uint64_t TEST_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
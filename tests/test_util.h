@@ -0,0 +1,68 @@
+/**
+ * @file test_util.h
+ * @brief Utilidades comunes de las pruebas de host de los modulos del firmware (tests/).
+ *
+ * Cada prueba es un programa que enlaza el modulo real de Src o de la biblioteca de drivers, cuenta sus fallas con
+ * TEST_Fail() y termina con el codigo de TEST_Result(): 0 si todo es correcto, 2 si alguna verificacion falla. Los
+ * mensajes salen por stderr con el nombre de la prueba adelante, como los de Table_Generator/table_gen.c.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdint.h>
+
+// Definiciones del modulo:
+#define TEST_MAX_REPORTED 10 /**< Fallas que se informan una por una */
+
+/**
+ * @brief Fija el nombre con el que salen los mensajes de la prueba.
+ *
+ * @param name Nombre de la prueba (debe seguir existiendo).
+ */
+void TEST_Init(const char* name);
+
+/**
+ * @brief Informa un resultado de la prueba, con su nombre adelante y un fin de linea.
+ *
+ * @param format Formato de printf.
+ */
+void TEST_Print(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief Cuenta una falla de la verificacion e informa las primeras TEST_MAX_REPORTED.
+ *
+ * @param failures Contador de fallas.
+ * @param message Verificacion que fallo.
+ * @param index Iteracion o entrada en la que fallo.
+ * @param value Valor obtenido.
+ */
+void TEST_Fail(unsigned* failures, const char* message, long index, long value);
+
+/**
+ * @brief Informa el resultado final de la prueba.
+ *
+ * @param failures Fallas contadas.
+ * @return 0 si no hubo fallas, 2 si las hubo (codigo de salida del programa).
+ */
+int TEST_Result(unsigned failures);
+
+/**
+ * @brief Generador pseudoaleatorio (xorshift de 32 bits), reproducible entre corridas.
+ *
+ * @param seed Estado del generador (distinto de cero).
+ * @return Siguiente valor.
+ */
+uint32_t TEST_Random(uint32_t* seed);
+
+/**
+ * @brief Segundos de reloj monotono.
+ */
+double TEST_Now(void);
+
+/**
+ * @brief Ciclos del contador de marcas de tiempo del host (0 si el host no tiene uno).
+ */
+uint64_t TEST_Cycles(void);
+
+#endif /* TEST_UTIL_H */